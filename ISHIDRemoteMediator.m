@@ -186,6 +186,7 @@ static NSString *kHIDRemoteDNStatusActionStop			= @"stop";
 					if ((pidUser = [self resourceUserForPID:notificationPID createIfNotExists:YES]) != nil)
 					{
 						ISResourceMediatorResourceAccess access = kISResourceMediatorResourceAccessUnknown;
+						ISResourceUserChanges changes = 0;
 					
 						switch (remoteMode)
 						{
@@ -207,12 +208,19 @@ static NSString *kHIDRemoteDNStatusActionStop			= @"stop";
 							break;
 						}
 						
-						pidUser.preferredAccess = pidUser.actualAccess = access;
+						if (pidUser.preferredAccess != access)
+						{
+							changes |= kISResourceUserChangePreferredAccess;
+						}
 
-						if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userUpdated:)]))
+						if (pidUser.actualAccess != access)
 						{
-							[delegate resourceMediator:self userUpdated:pidUser];
+							changes |= kISResourceUserChangeActualAccess;
 						}
+
+						pidUser.preferredAccess = pidUser.actualAccess = access;
+
+						[self noteChanges:changes ofUser:pidUser];
 					}
 				}
 			}
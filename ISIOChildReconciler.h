@@ -0,0 +1,113 @@
+//
+//  ISIOChildReconciler.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISIOChildReconciler keeps track of the children of a registry entry (for ISIOResourceMediator: the user clients of a
+	device) and reports children that appeared or disappeared since the last reconciliation.
+
+	Children are kept keyed by registry entry ID, so a reconciliation only costs one lookup per unchanged child - objects
+	are created only for new children. Change notifications are coalesced: -setNeedsReconciliation can be called any
+	number of times, at most one reconciliation is scheduled, and it runs once no further change was noted for
+	debounceInterval (or maximumDelay after the first unreconciled change, for devices that never settle).
+
+	Registry access goes through the ISIORegistry protocol. The reconciler itself doesn't depend on IOKit, so it can be
+	tested and benchmarked against a fake registry.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorDeadlineScheduler.h"
+
+@class ISIOChildReconciler;
+
+@protocol ISIORegistry <NSObject>
+
+- (BOOL)enumerateChildrenOfEntry:(id)entry usingBlock:(void(^)(uint64_t childEntryID, void *childRef))block; //!< Calls block for every child of entry. childRef is only valid during the call. Returns NO if the children couldn't be enumerated.
+- (id)newChildWithEntryID:(uint64_t)childEntryID ref:(void *)childRef NS_RETURNS_RETAINED; //!< Returns a new object representing the child. Only called from within the block passed to -enumerateChildrenOfEntry:usingBlock:, for children that weren't there at the last reconciliation.
+- (id)newPropertyForKey:(NSString *)key ofEntry:(id)entry NS_RETURNS_RETAINED; //!< Returns a new copy of the property of entry for key, or nil if entry doesn't have it.
+
+@end
+
+@protocol ISIOChildReconcilerDelegate <NSObject>
+
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childAppeared:(id)child; //!< Called for each new child.
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childDisappeared:(id)child; //!< Called for each child that is gone.
+
+@end
+
+@interface ISIOChildReconciler : NSObject
+{
+	id entry;
+	NSObject <ISIORegistry> *registry;
+	NSObject <ISIOChildReconcilerDelegate> *delegate;
+
+	ISResourceMediatorDeadlineScheduler *deadlineScheduler;
+	NSValue *deadlineKey;
+
+	NSTimeInterval debounceInterval;
+	NSTimeInterval maximumDelay;
+
+	NSMutableDictionary <NSNumber *, id> *childrenByEntryID;
+
+	uint64_t changeGeneration;
+	uint64_t reconciledGeneration;
+	NSTimeInterval firstChangeTime;
+	NSTimeInterval lastChangeTime;
+	BOOL reconciliationScheduled;
+
+	NSUInteger reconciliationCount;
+}
+
+@property(retain,readonly) id entry; //!< The registry entry whose children are tracked.
+@property(retain,readonly) NSObject <ISIORegistry> *registry;
+@property(assign) NSObject <ISIOChildReconcilerDelegate> *delegate;
+
+@property(retain,readonly) ISResourceMediatorDeadlineScheduler *deadlineScheduler; //!< Scheduler running the debounce timer and providing its clock.
+
+@property(assign) NSTimeInterval debounceInterval; //!< Time without further changes after which a reconciliation runs. Defaults to 0.1 seconds.
+@property(assign) NSTimeInterval maximumDelay; //!< Maximum time between the first unreconciled change and the reconciliation. Defaults to 1 second.
+
+@property(readonly) NSArray *children; //!< Children found by the last reconciliation.
+@property(readonly) uint64_t changeGeneration; //!< Number of changes noted through -setNeedsReconciliation.
+@property(readonly) NSUInteger reconciliationCount; //!< Number of reconciliations run.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithEntry:(id)anEntry registry:(NSObject <ISIORegistry> *)aRegistry deadlineScheduler:(ISResourceMediatorDeadlineScheduler *)aDeadlineScheduler;
+
+#pragma mark - Reconciliation
+- (void)setNeedsReconciliation; //!< Notes a change to the children. The reconciliation is debounced.
+- (BOOL)reconcile; //!< Reconciles immediately (cancelling a scheduled reconciliation). Returns NO if the children couldn't be enumerated, in which case the known children are kept.
+- (NSArray *)invalidate; //!< Cancels a scheduled reconciliation and forgets all children, which are returned. The delegate is not called.
+
+@end
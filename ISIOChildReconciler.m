@@ -0,0 +1,270 @@
+//
+//  ISIOChildReconciler.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISIOChildReconciler.h"
+
+#define kISIOChildReconcilerDefaultDebounceInterval	0.1
+#define kISIOChildReconcilerDefaultMaximumDelay		1.0
+
+@implementation ISIOChildReconciler
+
+@synthesize entry;
+@synthesize registry;
+@synthesize delegate;
+
+@synthesize deadlineScheduler;
+
+@synthesize debounceInterval;
+@synthesize maximumDelay;
+
+@synthesize changeGeneration;
+@synthesize reconciliationCount;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithEntry:(id)anEntry registry:(NSObject <ISIORegistry> *)aRegistry deadlineScheduler:(ISResourceMediatorDeadlineScheduler *)aDeadlineScheduler
+{
+	if ((self = [self init]) != nil)
+	{
+		entry = [anEntry retain];
+		registry = [aRegistry retain];
+		deadlineScheduler = [aDeadlineScheduler retain];
+
+		// Unique per reconciler, so many reconcilers can share one scheduler
+		deadlineKey = [[NSValue valueWithNonretainedObject:self] retain];
+
+		debounceInterval = kISIOChildReconcilerDefaultDebounceInterval;
+		maximumDelay = kISIOChildReconcilerDefaultMaximumDelay;
+
+		childrenByEntryID = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[deadlineScheduler cancelDeadlineForKey:deadlineKey];
+
+	[entry release];
+	entry = nil;
+
+	[registry release];
+	registry = nil;
+
+	[deadlineScheduler release];
+	deadlineScheduler = nil;
+
+	[deadlineKey release];
+	deadlineKey = nil;
+
+	[childrenByEntryID release];
+	childrenByEntryID = nil;
+
+	delegate = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Children
+- (NSArray *)children
+{
+	@synchronized(self)
+	{
+		return (childrenByEntryID.allValues);
+	}
+}
+
+#pragma mark - Reconciliation
+- (void)setNeedsReconciliation
+{
+	NSTimeInterval now = [deadlineScheduler currentTime];
+
+	@synchronized(self)
+	{
+		if (changeGeneration == reconciledGeneration)
+		{
+			firstChangeTime = now;
+		}
+
+		changeGeneration++;
+		lastChangeTime = now;
+
+		if (reconciliationScheduled)
+		{
+			// The scheduled reconciliation picks this change up, too
+			return;
+		}
+
+		reconciliationScheduled = YES;
+	}
+
+	[self _scheduleReconciliationAt:(now + debounceInterval)];
+}
+
+- (void)_scheduleReconciliationAt:(NSTimeInterval)reconciliationTime
+{
+	[deadlineScheduler scheduleDeadline:reconciliationTime forKey:deadlineKey handler:^{
+		[self _scheduledReconciliationDue];
+	}];
+}
+
+- (void)_scheduledReconciliationDue
+{
+	NSTimeInterval now = [deadlineScheduler currentTime], reconciliationTime;
+
+	@synchronized(self)
+	{
+		if (!reconciliationScheduled)
+		{
+			return;
+		}
+
+		// Changes kept coming in - wait for the device to settle, but not longer than maximumDelay
+		reconciliationTime = MIN(lastChangeTime + debounceInterval, firstChangeTime + maximumDelay);
+	}
+
+	if (reconciliationTime > now)
+	{
+		[self _scheduleReconciliationAt:reconciliationTime];
+		return;
+	}
+
+	[self reconcile];
+}
+
+- (BOOL)reconcile
+{
+	__block NSMutableArray *appearedChildren = nil;
+	NSMutableArray *disappearedChildren = nil;
+	BOOL enumerated;
+
+	[deadlineScheduler cancelDeadlineForKey:deadlineKey];
+
+	@synchronized(self)
+	{
+		NSMutableDictionary <NSNumber *, id> *previousChildrenByEntryID = childrenByEntryID;
+		NSMutableDictionary <NSNumber *, id> *currentChildrenByEntryID = [NSMutableDictionary dictionaryWithCapacity:previousChildrenByEntryID.count];
+		NSObject <ISIORegistry> *theRegistry = registry;
+
+		reconciliationScheduled = NO;
+		reconciledGeneration = changeGeneration;
+		reconciliationCount++;
+
+		enumerated = [registry enumerateChildrenOfEntry:entry usingBlock:^(uint64_t childEntryID, void *childRef) {
+			NSNumber *childEntryIDNumber = @(childEntryID);
+			id child;
+
+			if ((child = [previousChildrenByEntryID objectForKey:childEntryIDNumber]) != nil)
+			{
+				// Unchanged
+				[currentChildrenByEntryID setObject:child forKey:childEntryIDNumber];
+			}
+			else if ([currentChildrenByEntryID objectForKey:childEntryIDNumber] == nil)
+			{
+				// New
+				if ((child = [theRegistry newChildWithEntryID:childEntryID ref:childRef]) != nil)
+				{
+					[currentChildrenByEntryID setObject:child forKey:childEntryIDNumber];
+
+					if (appearedChildren == nil)
+					{
+						appearedChildren = [NSMutableArray array];
+					}
+
+					[appearedChildren addObject:child];
+
+					[child release];
+				}
+			}
+		}];
+
+		if (enumerated)
+		{
+			if (currentChildrenByEntryID.count != (previousChildrenByEntryID.count + appearedChildren.count))
+			{
+				// Some children are gone
+				disappearedChildren = [NSMutableArray array];
+
+				[previousChildrenByEntryID enumerateKeysAndObjectsUsingBlock:^(NSNumber *childEntryIDNumber, id child, BOOL *stop) {
+					if ([currentChildrenByEntryID objectForKey:childEntryIDNumber] == nil)
+					{
+						[disappearedChildren addObject:child];
+					}
+				}];
+			}
+
+			[childrenByEntryID release];
+			childrenByEntryID = [currentChildrenByEntryID retain];
+		}
+		else
+		{
+			// Keep the children we know about
+			appearedChildren = nil;
+		}
+	}
+
+	// Call delegate outside the critical section
+	for (id child in appearedChildren)
+	{
+		[delegate childReconciler:self childAppeared:child];
+	}
+
+	for (id child in disappearedChildren)
+	{
+		[delegate childReconciler:self childDisappeared:child];
+	}
+
+	return (enumerated);
+}
+
+- (NSArray *)invalidate
+{
+	NSArray *children;
+
+	[deadlineScheduler cancelDeadlineForKey:deadlineKey];
+
+	@synchronized(self)
+	{
+		reconciliationScheduled = NO;
+		reconciledGeneration = changeGeneration;
+
+		children = childrenByEntryID.allValues;
+		[childrenByEntryID removeAllObjects];
+	}
+
+	return (children);
+}
+
+@end
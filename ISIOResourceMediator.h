@@ -37,6 +37,7 @@ DAMAGE.
 #import "ISResourceMediator.h"
 #import <IOKit/IOKitLib.h>
 #import "ISIOObject.h"
+#import "ISIOChildReconciler.h"
 
 @class ISIOResourceMediator;
 
@@ -58,13 +59,23 @@ DAMAGE.
 	
 	io_iterator_t deviceMatchIterator;
 	
+	NSObject <ISIORegistry> *registry;
+
 	NSMutableArray *trackedDevices;
+	NSTimeInterval childReconciliationInterval;
+
+	NSMutableDictionary <NSNumber *, ISResourceUser *> *usersByUserClientID;
+	NSMutableDictionary <NSNumber *, id> *userClientCreatorsByID;
 
 	NSObject <ISIOResourceMediatorDelegate> *ioDelegate;
 }
 
 @property(assign,nonatomic) NSObject <ISIOResourceMediatorDelegate> *ioDelegate; // convenience accessor
 
+@property(retain) NSObject <ISIORegistry> *registry; //!< Registry used to look up user clients and their creators. Defaults to the IOKit registry.
+
+@property(assign) NSTimeInterval childReconciliationInterval; //!< Time to wait for a device to settle after it signaled opening or closing of a user client, before re-checking its user clients. Bursts of signals are coalesced into one check. Defaults to 0.1 seconds. Applies to devices found after the change.
+
 #pragma mark - Init & Dealloc
 - (instancetype)initMediatorForResourceWithIdentifier:(NSString *)aResourceIdentifier deviceClassName:(NSString *)deviceClassName userClientClassName:(NSString *)userClientClassName delegate:(NSObject <ISIOResourceMediatorDelegate> *)aDelegate;
 
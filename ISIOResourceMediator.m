@@ -39,15 +39,39 @@ DAMAGE.
 #import "ISIOResourceMediator.h"
 #import "ISIOObject.h"
 
+#define kISIOResourceMediatorDefaultChildReconciliationInterval 0.1
+#define kISIOResourceMediatorUserClientCreatorCacheLimit 256
+
+#define kISIOUserClientCreatorKey @"IOUserClientCreator"
+
 static void ISIOResourceMediatorDeviceMatchedHandler(void *refcon, io_iterator_t iterator);
 
 static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_service_t service, uint32_t messageType, void *messageArgument);
 
-@interface ISIOResourceTrackedDevice : ISIOObject
+@interface ISIOKitRegistry : NSObject <ISIORegistry>
+
++ (instancetype)sharedRegistry;
+
+@end
+
+@interface ISIOUserClientCreator : NSObject
+{
+	pid_t pid;
+	NSString *name;
+}
+
+@property(assign) pid_t pid;
+@property(retain) NSString *name;
+
++ (instancetype)creatorWithCreatorString:(NSString *)creatorString;
+
+@end
+
+@interface ISIOResourceTrackedDevice : ISIOObject <ISIOChildReconcilerDelegate>
 {
 	io_object_t busyInterestNotification;
 
-	NSMutableSet *childObjects;
+	ISIOChildReconciler *childReconciler;
 	
 	ISIOResourceMediator *resourceMediator;
 }
@@ -66,6 +90,104 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 - (void)_handleUserClientMatched:(ISIOObject *)userClientObj;
 - (void)_handleUserClientTerminated:(ISIOObject *)userClientObj;
 
+- (ISIOUserClientCreator *)_creatorOfUserClient:(ISIOObject *)userClientObj;
+
+@end
+
+@implementation ISIOKitRegistry
+
++ (instancetype)sharedRegistry
+{
+	static ISIOKitRegistry *sharedRegistry;
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		sharedRegistry = [ISIOKitRegistry new];
+	});
+
+	return (sharedRegistry);
+}
+
+- (BOOL)enumerateChildrenOfEntry:(id)entry usingBlock:(void (^)(uint64_t, void *))block
+{
+	io_iterator_t childIterator;
+	io_object_t childIOObject;
+
+	if (IORegistryEntryGetChildIterator(((ISIOObject *)entry).ioObject, kIOServicePlane, &childIterator) != kIOReturnSuccess)
+	{
+		return (NO);
+	}
+
+	while ((childIOObject = IOIteratorNext(childIterator)) != 0)
+	{
+		uint64_t childEntryID = 0;
+
+		if (IORegistryEntryGetRegistryEntryID(childIOObject, &childEntryID) == kIOReturnSuccess)
+		{
+			block(childEntryID, (void *)(uintptr_t)childIOObject);
+		}
+
+		IOObjectRelease(childIOObject);
+	}
+
+	IOObjectRelease(childIterator);
+
+	return (YES);
+}
+
+- (id)newChildWithEntryID:(uint64_t)childEntryID ref:(void *)childRef
+{
+	return ([[ISIOObject alloc] initWithIOObject:(io_object_t)(uintptr_t)childRef]);
+}
+
+- (id)newPropertyForKey:(NSString *)key ofEntry:(id)entry
+{
+	return ((id)IORegistryEntryCreateCFProperty(((ISIOObject *)entry).ioObject, (CFStringRef)key, kCFAllocatorDefault, 0));
+}
+
+@end
+
+@implementation ISIOUserClientCreator
+
+@synthesize pid;
+@synthesize name;
+
++ (instancetype)creatorWithCreatorString:(NSString *)creatorString
+{
+	ISIOUserClientCreator *creator = nil;
+
+	// Format: "pid [pid], [name]"
+	if ([creatorString isKindOfClass:[NSString class]])
+	{
+		NSRange endRange;
+		
+		endRange = [creatorString rangeOfString:@", "];
+		
+		if ((endRange.location != NSNotFound) && (endRange.location > 4))
+		{
+			pid_t creatorPID;
+
+			if ((creatorPID = [[creatorString substringWithRange:NSMakeRange(4, endRange.location-4)] intValue]) != 0)
+			{
+				creator = [[self new] autorelease];
+
+				creator.pid = creatorPID;
+				creator.name = [creatorString substringFromIndex:endRange.location+endRange.length];
+			}
+		}
+	}
+
+	return (creator);
+}
+
+- (void)dealloc
+{
+	[name release];
+	name = nil;
+
+	[super dealloc];
+}
+
 @end
 
 @implementation ISIOResourceTrackedDevice
@@ -80,8 +202,10 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 		busyInterestNotification = 0;
 	}
 	
-	[childObjects release];
-	childObjects = nil;
+	childReconciler.delegate = nil;
+	[childReconciler invalidate];
+	[childReconciler release];
+	childReconciler = nil;
 	
 	[super dealloc];
 }
@@ -97,72 +221,34 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 	
 	if ((kernRet = IOServiceAddInterestNotification(notificationPort, self.ioObject, kIOGeneralInterest, ISIOResourceMediatorBusyInterestChangeHandler, self, &busyInterestNotification)) == kIOReturnSuccess)
 	{
+		@synchronized(self)
+		{
+			if (childReconciler == nil)
+			{
+				// The reconciler gets its own ISIOObject for the device, so it doesn't retain us
+				childReconciler = [[ISIOChildReconciler alloc] initWithEntry:[[self copy] autorelease] registry:resourceMediator.registry deadlineScheduler:resourceMediator.deadlineScheduler];
+				childReconciler.debounceInterval = resourceMediator.childReconciliationInterval;
+				childReconciler.delegate = self;
+			}
+		}
+
 		[self updateChildObjects];
 	}
 }
 
 - (void)updateChildObjects
 {
-	@synchronized(self)
-	{
-		io_iterator_t childIterator;
-		kern_return_t kernRet;
-	
-		if (childObjects == nil)
-		{
-			childObjects = [NSMutableSet new];
-		}
-		
-		if ((kernRet = IORegistryEntryGetChildIterator(self.ioObject, kIOServicePlane, &childIterator)) == kIOReturnSuccess)
-		{
-			io_object_t childIOObject;
-			NSMutableSet *newChildObjects;
-			
-			if ((newChildObjects = [NSMutableSet new]) != nil)
-			{
-				NSMutableSet *newChildren=nil, *removedChildren=nil;
-				
-				while ((childIOObject = IOIteratorNext(childIterator)) != 0)
-				{
-					ISIOObject *childObj;
-					
-					if ((childObj = [ISIOObject withIOObject:childIOObject]) != nil)
-					{
-						[newChildObjects addObject:childObj];
-					}
-				}
-				
-				newChildren = [NSMutableSet setWithSet:newChildObjects];
-				[newChildren minusSet:childObjects];
-				
-				if ([newChildren count] > 0)
-				{
-					for (ISIOObject *newChild in newChildren)
-					{
-						[resourceMediator _handleUserClientMatched:newChild];
-					}
-				}
-
-				removedChildren = [NSMutableSet setWithSet:childObjects];
-				[removedChildren minusSet:newChildObjects];
+	[childReconciler reconcile];
+}
 
-				if ([removedChildren count] > 0)
-				{
-					for (ISIOObject *removedChild in removedChildren)
-					{
-						[resourceMediator _handleUserClientTerminated:removedChild];
-					}
-				}
-				
-				// NSLog(@"New objects: %@ Removed objects: %@", newChildren, removedChildren);
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childAppeared:(id)child
+{
+	[resourceMediator _handleUserClientMatched:child];
+}
 
-				[childObjects release];
-				childObjects = newChildObjects;
-			}
-			
-			IOObjectRelease(childIterator);
-		}
-	}
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childDisappeared:(id)child
+{
+	[resourceMediator _handleUserClientTerminated:child];
 }
 
 - (void)_handleService:(io_service_t)service messageType:(uint32_t)messageType messageArgument:(void *)messageArgument
@@ -170,12 +256,9 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 	switch(messageType)
 	{
 		case kIOMessageServiceIsTerminated:
-			@synchronized(self)
+			for (ISIOObject *ioObj in [childReconciler invalidate])
 			{
-				for (ISIOObject *ioObj in childObjects)
-				{
-					[resourceMediator _handleUserClientTerminated:ioObj];
-				}
+				[resourceMediator _handleUserClientTerminated:ioObj];
 			}
 			[resourceMediator _handleDeviceTerminated:self];
 		break;
@@ -183,9 +266,8 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 		case kIOMessageServiceIsRequestingClose:
 		case kIOMessageServiceIsAttemptingOpen:
 		case kIOMessageServiceWasClosed:
-			dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-				[self updateChildObjects];
-			});
+			// Bursts of these are coalesced into one reconciliation
+			[childReconciler setNeedsReconciliation];
 		break;
 		
 		default:
@@ -206,6 +288,8 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 @implementation ISIOResourceMediator
 
 @synthesize ioDelegate;
+@synthesize registry;
+@synthesize childReconciliationInterval;
 
 #pragma mark - Init & Dealloc
 - (instancetype)initMediatorForResourceWithIdentifier:(NSString *)aResourceIdentifier deviceClassName:(NSString *)aDeviceClassName userClientClassName:(NSString *)aUserClientClassName delegate:(NSObject<ISIOResourceMediatorDelegate> *)aDelegate
@@ -215,7 +299,14 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 		deviceClassName = [aDeviceClassName retain];
 		userClientClassName = [aUserClientClassName retain];
 		
+		registry = [[ISIOKitRegistry sharedRegistry] retain];
+
 		trackedDevices = [NSMutableArray new];
+
+		usersByUserClientID = [NSMutableDictionary new];
+		userClientCreatorsByID = [NSMutableDictionary new];
+
+		childReconciliationInterval = kISIOResourceMediatorDefaultChildReconciliationInterval;
 	}
 	
 	return (self);
@@ -234,6 +325,15 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 	[trackedDevices release];
 	trackedDevices = nil;
 
+	[usersByUserClientID release];
+	usersByUserClientID = nil;
+
+	[userClientCreatorsByID release];
+	userClientCreatorsByID = nil;
+
+	[registry release];
+	registry = nil;
+
 	[super dealloc];
 }
 
@@ -348,120 +448,105 @@ static void ISIOResourceMediatorBusyInterestChangeHandler(void *refcon, io_servi
 {
 	if (userClientObj != nil)
 	{
-		NSString *pidLine = nil, *appName = nil;
-		pid_t userClientPid = 0;
-		
-		if ((pidLine = (NSString *)IORegistryEntryCreateCFProperty(userClientObj.ioObject, (CFStringRef)@"IOUserClientCreator", kCFAllocatorDefault, 0)) != nil)
+		ISIOUserClientCreator *creator = nil;
+
+		if ((creator = [self _creatorOfUserClient:userClientObj]) != nil)
 		{
-			NSRange endRange;
-			
-			endRange = [pidLine rangeOfString:@", "];
-			
-			if (endRange.location != NSNotFound)
+			if ([self trackUserClient:userClientObj pid:creator.pid name:creator.name])
 			{
-				NSString *pidString;
+				ISResourceUser *user = nil;
 				
-				if (endRange.location > 4)
-				{
-					pidString = [pidLine substringWithRange:NSMakeRange(4, endRange.location-4)];
-					
-					if (pidString.length > 0)
-					{
-						userClientPid = [pidString intValue];
-						appName   = [pidLine substringFromIndex:endRange.location+endRange.length];
-					}
-				}
-			}
-		
-			if ((userClientPid != 0) && (appName != nil))
-			{
-				if ([self trackUserClient:userClientObj pid:userClientPid name:appName])
+				@synchronized(self)
 				{
-					ISResourceUser *user = nil;
-					
-					@synchronized(self)
+					if ((user = [self resourceUserForPID:creator.pid createIfNotExists:YES]) != nil)
 					{
-						if ((user = [self resourceUserForPID:userClientPid createIfNotExists:YES]) != nil)
+						NSMutableDictionary <NSNumber *, ISIOObject *> *userClientsByID;
+
+						if ((userClientsByID = user.trackingObject) == nil)
 						{
-							if (user.trackingObject != nil)
-							{
-								if ([user.trackingObject isKindOfClass:[NSMutableArray class]])
-								{
-									[(NSMutableArray *)user.trackingObject addObject:userClientObj];
-								}
-								else
-								{
-									user.trackingObject = [NSMutableArray arrayWithObjects:user.trackingObject, userClientObj, nil];
-								}
-							}
-							else
-							{
-								user.trackingObject = userClientObj;
-							}
+							user.trackingObject = userClientsByID = [NSMutableDictionary dictionary];
 						}
+
+						[userClientsByID setObject:userClientObj forKey:@(userClientObj.uniqueID)];
+						[usersByUserClientID setObject:user forKey:@(userClientObj.uniqueID)];
 					}
 				}
 			}
-			
-			[pidLine release];
 		}
 	}
 }
 
 - (void)_handleUserClientTerminated:(ISIOObject *)userClientObj
 {
-	if (userClientObj  != nil)
+	if (userClientObj != nil)
 	{
+		NSNumber *userClientID = @(userClientObj.uniqueID);
+		ISResourceUser *user = nil;
+
 		@synchronized(self)
 		{
-			NSMutableArray *usersPendingRemoval = [NSMutableArray new];
-		
-			for (ISResourceUser *user in users)
+			[userClientCreatorsByID removeObjectForKey:userClientID];
+
+			if ((user = [[[usersByUserClientID objectForKey:userClientID] retain] autorelease]) != nil)
 			{
-				if (user.trackingObject != nil)
+				NSMutableDictionary <NSNumber *, ISIOObject *> *userClientsByID = user.trackingObject;
+
+				[usersByUserClientID removeObjectForKey:userClientID];
+				[userClientsByID removeObjectForKey:userClientID];
+
+				if (userClientsByID.count == 0)
 				{
-					if ([user.trackingObject isKindOfClass:[NSMutableArray class]])
-					{
-						if ([(NSMutableArray *)user.trackingObject containsObject:userClientObj])
-						{
-							[(NSMutableArray *)user.trackingObject removeObject:userClientObj];
-						}
-						
-						if ([(NSMutableArray *)user.trackingObject count] == 0)
-						{
-							user.trackingObject = nil;
-							
-							if (!user.isUsingResourceMediator)
-							{
-								// Only remove users who don't use resource mediator
-								[usersPendingRemoval addObject:user];
-							}
-						}
-					}
-					else
+					user.trackingObject = nil;
+
+					// Only remove users who don't use resource mediator (and haven't been removed in the meantime)
+					if (!user.isUsingResourceMediator && ([usersByPID objectForKey:@(user.pid)] == user))
 					{
-						if ([user.trackingObject isEqual:userClientObj])
-						{
-							user.trackingObject = nil;
-							
-							if (!user.isUsingResourceMediator)
-							{
-								// Only remove users who don't use resource mediator
-								[usersPendingRemoval addObject:user];
-							}
-						}
+						[self userTerminated:user];
 					}
 				}
 			}
-			
-			for (ISResourceUser *removeUser in usersPendingRemoval)
+		}
+	}
+}
+
+- (ISIOUserClientCreator *)_creatorOfUserClient:(ISIOObject *)userClientObj
+{
+	NSNumber *userClientID = @(userClientObj.uniqueID);
+	id creator = nil;
+
+	@synchronized(self)
+	{
+		creator = [[[userClientCreatorsByID objectForKey:userClientID] retain] autorelease];
+	}
+
+	if (creator == nil)
+	{
+		NSString *creatorString = nil;
+
+		// The creator of a user client doesn't change, so it only needs to be fetched and parsed once
+		if ((creatorString = [registry newPropertyForKey:kISIOUserClientCreatorKey ofEntry:userClientObj]) != nil)
+		{
+			if ((creator = [ISIOUserClientCreator creatorWithCreatorString:creatorString]) == nil)
 			{
-				[self userTerminated:removeUser];
+				// Remember unparseable creators, too
+				creator = [NSNull null];
+			}
+
+			[creatorString release];
+
+			@synchronized(self)
+			{
+				if (userClientCreatorsByID.count >= kISIOResourceMediatorUserClientCreatorCacheLimit)
+				{
+					[userClientCreatorsByID removeAllObjects];
+				}
+
+				[userClientCreatorsByID setObject:creator forKey:userClientID];
 			}
-			
-			[usersPendingRemoval release];
 		}
 	}
+
+	return ((creator != [NSNull null]) ? creator : nil);
 }
 
 #pragma mark - Matching
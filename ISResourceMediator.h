@@ -34,7 +34,21 @@ ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF S
 DAMAGE.
 */
 
-#import <Cocoa/Cocoa.h>
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorCodec.h"
+#import "ISResourceMediatorHub.h"
+#import "ISResourceMediatorStatusTable.h"
+#import "ISResourceMediatorDeadlineScheduler.h"
+#import "ISResourceMediatorProcessWatcher.h"
+#import "ISResourceMediatorTraceRecorder.h"
+
+#if __has_include(<AppKit/AppKit.h>)
+#import <AppKit/AppKit.h>
+
+#define ISRESOURCEMEDIATOR_APPKIT 1 //!< Application events and NSRunningApplication are available. The core itself only needs Foundation.
+#else
+#define ISRESOURCEMEDIATOR_APPKIT 0
+#endif /* __has_include(<AppKit/AppKit.h>) */
 
 /*!
      @abstract Represents different access patterns to a shared resource.
@@ -52,17 +66,21 @@ typedef NS_ENUM(NSUInteger, ISResourceMediatorResourceAccess)
 	kISResourceMediatorResourceAccessBlocking 
 };
 
+#define kISResourceMediatorResourceAccessCount (kISResourceMediatorResourceAccessBlocking+1) //!< Number of ISResourceMediatorResourceAccess values
+
 /*!
      @abstract Result of an operation.
      @constant kISResourceMediatorResultSuccess  The operation succeeded.
      @constant kISResourceMediatorResultError	 There was an error executing the operation.
      @constant kISResourceMediatorResultDeny	 The operation was rejected by the application.
+     @constant kISResourceMediatorResultTimeout	 No response was received in time.
 */
 typedef NS_ENUM(NSUInteger, ISResourceMediatorResult)
 {
 	kISResourceMediatorResultSuccess,
 	kISResourceMediatorResultError,
-	kISResourceMediatorResultDeny
+	kISResourceMediatorResultDeny,
+	kISResourceMediatorResultTimeout
 };
 
 /*!
@@ -80,10 +98,38 @@ typedef NS_ENUM(NSUInteger, ISResourceMediatorAccessPressure)
 	kISResourceMediatorAccessPressureRequired	    = 100
 };
 
+/*!
+     @abstract Properties of an ISResourceUser, as reported to -resourceMediator:userUpdated:changes:.
+     @constant kISResourceUserChangeIsUsingResourceMediator	isUsingResourceMediator changed.
+     @constant kISResourceUserChangePreferredAccess		preferredAccess changed.
+     @constant kISResourceUserChangeActualAccess		actualAccess changed.
+     @constant kISResourceUserChangeAccessPressure		accessPressure changed.
+     @constant kISResourceUserChangeCapabilities		capabilities changed.
+     @constant kISResourceUserChangeResourceCapacity		resourceCapacity changed.
+     @constant kISResourceUserChangeSlotCount			slotCount changed.
+     @constant kISResourceUserChangeBroadcastInfo		broadcastInfo changed.
+*/
+typedef NS_OPTIONS(NSUInteger, ISResourceUserChanges)
+{
+	kISResourceUserChangeIsUsingResourceMediator	= (1 << 0),
+	kISResourceUserChangePreferredAccess		= (1 << 1),
+	kISResourceUserChangeActualAccess		= (1 << 2),
+	kISResourceUserChangeAccessPressure		= (1 << 3),
+	kISResourceUserChangeCapabilities		= (1 << 4),
+	kISResourceUserChangeResourceCapacity		= (1 << 5),
+	kISResourceUserChangeSlotCount			= (1 << 6),
+	kISResourceUserChangeBroadcastInfo		= (1 << 7)
+};
+
 typedef void(^ISResourceMediatorCommand)(dispatch_block_t completionHandler);
 
+struct ISResourceMediatorCommandQueue;
+
 @class ISResourceMediator;
 @class ISResourceUser;
+@class ISResourceMediatorMulticastAccessRequest;
+@class ISResourceMediatorLease;
+@class ISResourceMediatorWaiter;
 
 @protocol ISResourceMediatorDelegate <NSObject>
 
@@ -106,14 +152,16 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 
 @optional
 - (void)resourceMediator:(ISResourceMediator *)mediator userAppeared:(ISResourceUser *)user; /*!< Called when a new user of the resource was found. */
-- (void)resourceMediator:(ISResourceMediator *)mediator userUpdated:(ISResourceUser *)user; /*!< Called when user of the resource (may have) updated its data. */
+- (void)resourceMediator:(ISResourceMediator *)mediator userUpdated:(ISResourceUser *)user; /*!< Called when user of the resource updated its data. Not called if -resourceMediator:userUpdated:changes: is implemented. */
+- (void)resourceMediator:(ISResourceMediator *)mediator userUpdated:(ISResourceUser *)user changes:(ISResourceUserChanges)changes; /*!< Called when user of the resource updated its data, with the properties that changed. Changes made within one run loop turn are reported with a single call. */
 - (void)resourceMediator:(ISResourceMediator *)mediator userDisappeared:(ISResourceUser *)user; /*!< Called when user is no longer interested in a resource or has been quit. */
 
 - (void)resourceMediator:(ISResourceMediator *)mediator actualAccessChangedTo:(ISResourceMediatorResourceAccess)actualAccess; /*!< Called to notify about changes to actual resource access. */
 
-- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user respondedToAccessRequestWith:(ISResourceMediatorResult)accessRequestResponse; /*!< Called after sending a response to an access request from another app. */
+- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user respondedToAccessRequestWith:(ISResourceMediatorResult)accessRequestResponse; /*!< Called after receiving a response to an access request from another app - or with kISResourceMediatorResultTimeout if the app didn't respond to any retry of the request in time. */
+- (void)resourceMediator:(ISResourceMediator *)mediator users:(NSArray <ISResourceUser *> *)users respondedToAccessRequestWith:(ISResourceMediatorResult)accessRequestResponse; /*!< Called once with the aggregated result of a multicast access request to several apps: kISResourceMediatorResultSuccess if all of them relinquished access, otherwise the first other result received. If not implemented, -resourceMediator:user:respondedToAccessRequestWith: is called for each of the users instead. */
 
-- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user updatedBroadcastInfo:(NSDictionary *)newBroadcastInfo;  /*!< Called when a user (may have) updated its broadcast info. */
+- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user updatedBroadcastInfo:(NSDictionary *)newBroadcastInfo;  /*!< Called when the broadcast info of a user changed. */
 
 @end
 
@@ -127,12 +175,23 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 	ISResourceMediatorResourceAccess actualAccess;
 	
 	ISResourceMediatorAccessPressure accessPressure;
+
+	ISResourceMediatorCapabilities capabilities;
+
+	NSUInteger resourceCapacity;
+	NSUInteger slotCount;
 	
 	NSDictionary *broadcastInfo;
+	uint64_t broadcastInfoHash;
 	
+#if ISRESOURCEMEDIATOR_APPKIT
 	NSRunningApplication *runningApplication;
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
 	
 	id trackingObject;
+
+	uint64_t statusSequence;
+	NSTimeInterval statusResyncRequestTime;
 }
 
 @property(assign) pid_t pid; /*!< The pid of the user. */
@@ -144,20 +203,39 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 
 @property(assign) ISResourceMediatorAccessPressure accessPressure;  /*!< How urgently this user needs to access the resource. */
 
+@property(assign) ISResourceMediatorCapabilities capabilities; /*!< Optional protocol features supported by this user's mediator. */
+
+@property(assign) NSUInteger resourceCapacity; /*!< Number of slots of the resource, as configured by this user. 0 if not counted. */
+@property(assign) NSUInteger slotCount; /*!< Number of slots this user uses with shared access of a counted resource. 0 if unknown, which counts as 1. */
+
 @property(retain) NSDictionary *broadcastInfo; /*!< User-defined metadata broadcasted by this user. */
+@property(assign) uint64_t broadcastInfoHash; /*!< Content hash of broadcastInfo - do not touch. */
 
-@property(retain) NSRunningApplication *runningApplication;  /*!< Convenience access to information about the resource using application. */
+#if ISRESOURCEMEDIATOR_APPKIT
+@property(retain) NSRunningApplication *runningApplication;  /*!< Convenience access to information about the resource using application. Only available with AppKit. */
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
 
 @property(retain) id trackingObject; /*!< Tracking object used by subclasses - do not touch. */
 
+@property(assign) uint64_t statusSequence; /*!< Sequence number of the last [STATUS] applied for this user - do not touch. */
+@property(assign) NSTimeInterval statusResyncRequestTime; /*!< Time a full [STATUS] was last requested from this user - do not touch. */
+
 @end
 
-@interface ISResourceMediator : NSObject
+@interface ISResourceMediator : NSObject <ISResourceMediatorProcessWatcherObserver>
 {
 	NSString *resourceIdentifier;
 	id representedObject;
+
+	ISResourceMediatorHub *hub;
+	ISResourceMediatorStatusTable *statusTable;
+	ISResourceMediatorDeadlineScheduler *deadlineScheduler;
+	ISResourceMediatorProcessWatcher *processWatcher;
 	
 	NSDictionary *broadcastInfo;
+	uint64_t broadcastInfoHash; // Content hash of broadcastInfo
+	NSMutableDictionary<NSNumber *, NSDictionary *> *broadcastInfoCache; // broadcastInfo received from users, by content hash
+	NSMutableDictionary<NSNumber *, NSNumber *> *broadcastInfoFetchHashesByPID; // Content hash of the broadcastInfo we asked a pid for
 	
 	ISResourceMediatorResourceAccess preferredAccess;
 	ISResourceMediatorResourceAccess actualAccess;
@@ -168,22 +246,76 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 	
 	BOOL active;
 	NSTimeInterval accessStartTime;
+	NSTimeInterval accessHoldStartTime; // Time actualAccess last changed to something other than None
+	NSTimeInterval minimumHoldTime;
 	
 	NSMutableSet<ISResourceUser *> *pendingResponse;
 	ISResourceMediatorResourceAccess lendingUserFromPreferredAccess;
 	ISResourceMediatorAccessPressure lendingUserFromAccessPressure;
 	ISResourceUser *lendingUser;
-	ISResourceUser *lentFromUser;  // matters only for lending blocking access, so keeping track of one source is sufficient. For shared access, by definition, the order of apps requesting shared access should not matter.
+	NSTimeInterval accessRequestTimeout;
+	NSUInteger accessRequestRetryLimit;
+	double accessRequestBackoffFactor;
+	NSMutableDictionary<NSNumber *, NSNumber *> *accessRequestAttemptsByPID; // Number of unanswered access requests per pid. Exceeding accessRequestRetryLimit means: gave up - until that user's status changes.
+	NSMutableDictionary<NSNumber *, NSNumber *> *accessRequestTimesByPID; // Time the first access request was sent to a pid (for metrics)
+	NSMutableDictionary<NSNumber *, NSNumber *> *accessRequestLeaseEpochsByPID; // Lease epoch known when the first access request was sent to a pid. Grants with an epoch not above it are stale.
+	BOOL usesMulticastAccessRequests;
+	uint64_t lastAccessRequestID;
+	ISResourceMediatorMulticastAccessRequest *multicastAccessRequest; // The multicast [ACCESS_REQUEST] in progress, if any
+	NSNumber *accessReservedForPID; // pid of the requester whose prepared multicast [ACCESS_REQUEST] we agreed to
+	uint64_t accessReservedForRequestID;
+	ISResourceMediatorLease *borrowedLease;  // Lease on the access we were lent, naming the lender. Matters only for lending blocking access, so keeping track of one source is sufficient. For shared access, by definition, the order of apps requesting shared access should not matter.
+	ISResourceMediatorLease *lentLease; // Lease on the access we lent out, naming the borrower - until it's handed back
+	uint64_t leaseEpoch; // Highest lease epoch seen for the resource
+	NSMutableArray<ISResourceMediatorWaiter *> *waiters; // Requesters whose [ACCESS_REQUEST] we denied, but queued - to be granted access when we release it
+	NSMutableSet<ISResourceUser *> *queuedAtUsers; // Holders that queued our denied [ACCESS_REQUEST]. Not asked again until they grant access or their status changes.
 	
 	ISResourceMediatorAccessPressure accessPressure;
+
+	NSUInteger resourceCapacity;
+	NSUInteger slotCount;
+	NSUInteger effectiveResourceCapacity; // Smallest non-zero resourceCapacity of us and all users
 	
 	NSInteger statusNotificationsSuspended;
+
+	NSTimeInterval statusCoalescingInterval;
+	BOOL statusFlushScheduled;
+	uint64_t statusSequence;
+	BOOL hasBroadcastStatus;
+	ISResourceMediatorResourceAccess broadcastPreferredAccess;
+	ISResourceMediatorResourceAccess broadcastActualAccess;
+	ISResourceMediatorAccessPressure broadcastAccessPressure;
+	NSUInteger broadcastResourceCapacity;
+	NSUInteger broadcastSlotCount;
+	uint64_t broadcastBroadcastInfoHash;
 	
 	NSMutableDictionary <NSNumber *, ISResourceUser *> *usersByPID;
 	NSMutableArray <ISResourceUser *> *users;
+	NSArray <ISResourceUser *> *usersSnapshot; // Immutable copy of users, replaced whenever users changes
+	uint64_t usersGeneration;
+	NSMutableDictionary <NSNumber *, NSNumber *> *pendingUserChangesByPID; // ISResourceUserChanges not yet reported to the delegate, by pid
+
+	NSMutableArray <ISResourceUser *> *holdersByActualAccess[kISResourceMediatorResourceAccessCount]; // Users of resource mediator (other than self) by actualAccess, sorted by ascending accessPressure. Not used for kISResourceMediatorResourceAccessNone.
+
+	struct ISResourceMediatorCommandQueue *commandQueue;
+
+	dispatch_queue_t executionQueue;
 
-	NSMutableArray *commandQueue;
-	BOOL commandQueueIsExecuting;
+	ISResourceMediatorMetrics *metrics;
+
+	ISResourceMediatorTraceRecorder *traceRecorder;
+	uint16_t traceMediatorID;
+
+	uint32_t scanCount;
+	uint64_t scanEpoch;
+	NSTimeInterval scanStartTime;
+	BOOL discoveryInProgress;
+	BOOL hasCompletedDiscovery;
+	NSMutableSet<NSNumber *> *pendingDiscoveryPIDs;
+
+	ISResourceMediatorWireFormat wireFormat;
+	NSMutableSet<NSNumber *> *propertyListPeerPIDs;
+	NSMutableSet<NSNumber *> *binaryPeerPIDs;
 }
 
 @property(retain,readonly) NSString *resourceIdentifier; //!< Identifier of the resource to manage.
@@ -200,13 +332,49 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 
 @property(assign,nonatomic) ISResourceMediatorAccessPressure accessPressure; //!< A ISResourceMediatorAccessPressure value indicating how strongly the application needs access to the resource. The stronger an application needs a resource, the higher this value. The idea here is to follow the user's intent in running different applications targeting the same resource: if a user f.ex. installs a media player supporting a remote, but also runs an application to enhance that remote, it's highly likely the user wants the enhancer to take control. Using the pressure value allows the ISResourceMediator instances to automatically release access and claim access to the resource in a way that fits this. Please see the descriptions of the available ISResourceMediatorAccessPressure values to determine which one is right for your application. If unsure, don't set this property. A default value of kISResourceMediatorAccessPressureOptional will then be used.
 
-@property(retain,readonly,nonatomic) NSMutableArray *users; //!< Array of ISResourceUser instances - one for each active user of the resource managed by ISResourceMediator.
+@property(assign,nonatomic) NSUInteger resourceCapacity; //!< Number of slots of a counted resource, f.ex. the number of hardware decoder units: shared access is then limited to resourceCapacity slots in total, and a requester only asks as many holders to give up access (those with the lowest accessPressure first) as needed to free the slots it needs. If users configured different capacities, the smallest one is used. Defaults to 0: the resource is not counted and shared access is never limited.
+@property(assign,nonatomic) NSUInteger slotCount; //!< Number of slots the application uses with shared access of a counted resource. Blocking access always uses all slots. Defaults to 1. Set before requesting access.
+
+@property(retain,readonly,nonatomic) NSMutableArray *users; //!< Array of ISResourceUser instances - one for each active user of the resource managed by ISResourceMediator. Returns a new copy of usersSnapshot on every call.
+@property(retain,readonly) NSArray <ISResourceUser *> *usersSnapshot; //!< Immutable array of ISResourceUser instances - one for each active user of the resource. Replaced when users appear or disappear, so it can be kept and read from any thread without copying.
+@property(readonly) uint64_t usersGeneration; //!< Incremented whenever users appear or disappear or a property of a user changes. Compare with the value seen when last reading usersSnapshot to find out if anything changed since.
 
 @property(assign,nonatomic) NSObject <ISResourceMediatorDelegate> *delegate; //!< Recipient of ISResourceMediatorDelegate delegate method calls.
 
+@property(retain,nonatomic) ISResourceMediatorHub *hub; //!< The hub routing messages to this mediator. Defaults to +[ISResourceMediatorHub sharedHub]. Change only while the mediator is inactive.
+
+@property(retain,nonatomic) ISResourceMediatorStatusTable *statusTable; //!< Optional shared-memory status table for resourceIdentifier. If set, the mediator publishes its status to the table and - on activation - picks up the status of all other users from it, so it can arbitrate immediately instead of waiting for [STATUS] replies to its [SCAN]. All participants should use the table - typically the one returned by +[ISResourceMediatorStatusTable statusTableForResourceIdentifier:]. Mediators of one process share their pid's slot, which stays claimed until the last of them deactivates. Change only while the mediator is inactive.
+
+@property(assign) NSTimeInterval statusCoalescingInterval; //!< Status changes made within this interval are coalesced into a single [STATUS] message carrying only the changed fields. Defaults to 0, which coalesces all changes made within one run loop turn.
+
+@property(retain,nonatomic) ISResourceMediatorDeadlineScheduler *deadlineScheduler; //!< The scheduler running all timers of the mediator (status flushes, discovery and access request timeouts) and providing its clock. Created on first use - targeting the executionQueue (if enabled) or the main queue. Assign a subclass to drive the mediator from a virtual clock. Change only while the mediator is inactive.
+
+@property(retain,nonatomic) ISResourceMediatorProcessWatcher *processWatcher; //!< Notifies the mediator when the process of a user exits, so the user can be removed. Defaults to +[ISResourceMediatorProcessWatcher sharedProcessWatcher]. Set to nil to not watch processes, f.ex. when simulating users.
+
+@property(assign) NSTimeInterval accessRequestTimeout; //!< Time to wait for the response to an access request before re-sending it. Defaults to 1 second.
+@property(assign) NSUInteger accessRequestRetryLimit; //!< Number of times an unanswered access request is re-sent, before the mediator gives up and reports kISResourceMediatorResultTimeout to the delegate. Defaults to 2.
+@property(assign) double accessRequestBackoffFactor; //!< Factor by which the timeout grows with each retry. Defaults to 2.0.
+@property(assign) NSTimeInterval minimumHoldTime; //!< Time the application keeps access after getting it, before it relinquishes it to a requester with the same accessPressure. Requests from users with a higher accessPressure are honored right away. Requesters are queued meanwhile and get access once the time is up. Use to avoid thrashing if apps frequently change their access. Defaults to 0.
+@property(assign) BOOL usesMulticastAccessRequests; //!< If YES, access that is held by several users is requested from all of them with one multicast [ACCESS_REQUEST], and only relinquished if all of them agree. Only used if all known users support it. Defaults to YES.
+
+@property(assign) ISResourceMediatorWireFormat wireFormat; //!< Encoding used for outgoing messages. Defaults to kISResourceMediatorWireFormatAutomatic, which broadcasts in the compact binary format once discovery completed and every known peer has been seen using it, and sends targeted messages in it unless the target predates it.
+
+@property(readonly,nonatomic) dispatch_queue_t executionQueue; //!< The serial queue the mediator executes on, if serial execution has been enabled. NULL otherwise.
+
+@property(retain,readonly) ISResourceMediatorMetrics *metrics; //!< Messages sent and received by this mediator, command queue depth and wait times, delegate and access handoff latencies. Always enabled.
+- (NSDictionary *)metricsSnapshot; //!< Snapshot of metrics, with the snapshot of the hub's metrics added as "hub". Property list and JSON compatible.
+
+@property(retain,nonatomic) ISResourceMediatorTraceRecorder *traceRecorder; //!< Opt-in: records all messages, app changes and delegate access changes of the mediator, so they can be replayed with ISResourceMediatorTraceReplayer. Several mediators can share one recorder. Set before activating the mediator to get a replayable trace. Defaults to nil.
+
 #pragma mark - Init & Dealloc
 - (instancetype)initMediatorForResourceWithIdentifier:(NSString *)aResourceIdentifier delegate:(NSObject <ISResourceMediatorDelegate> *)aDelegate;
 
+#pragma mark - Serial execution
+- (void)enableSerialExecutionWithTargetQueue:(dispatch_queue_t)targetQueue; //!< Opt-in: the mediator creates a serial queue (targeting targetQueue, if not NULL) and from then on executes property changes, incoming messages and timers on it, in the order they were made. Property changes made from other threads are applied asynchronously. Delegate methods are called on that queue, after the mediator finished processing the event that triggered them. Call once, before activating the mediator.
+
+#pragma mark - Message handling
+- (void)handleMediatorMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)userInfo peerFormat:(ISResourceMediatorWireFormat)peerFormat; //!< Called by the hub for every message targeting this mediator.
+
 #pragma mark - Access mediation
 - (void)considerRequestingAccess;
 
@@ -214,6 +382,7 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 - (ISResourceUser *)newUser NS_RETURNS_RETAINED;
 - (ISResourceUser *)resourceUserForPID:(pid_t)userPID createIfNotExists:(BOOL)createIfNotExists;
 - (void)userTerminated:(ISResourceUser *)user;
+- (void)noteChanges:(ISResourceUserChanges)changes ofUser:(ISResourceUser *)user; //!< For subclasses changing the properties of users: reports changes to the delegate (batched per run loop turn) and increments usersGeneration. Does nothing if changes is 0.
 
 @end
 
@@ -222,21 +391,73 @@ IMPORTANT: Because ISResourceMediator takes measures to ensure that this delegat
 	
 	Discovery
 	[SCAN] => All active mediators for that resource ID send their current status as [STATUS] notification
+	- each [SCAN] carries a scan epoch, which is echoed in the [STATUS] replies to it
+	- the scanning mediator expects replies from all known peers (the hub's known peers + known users) and holds off arbitration
+	  until all of them answered or - as a fallback - until the hub's adaptive discovery timeout expires. Peers that didn't answer
+	  in time are forgotten by the hub.
 	
 	Access request
 	[ACCESS_REQUEST] => [USER] Targeting particular user who holds access (adding [USER] to pendingResponse set) => [USER] decides, takes action, sets [ORIGIN] as lendingUser, sends [ACCESS_RESPONSE] to requester:
 		[ACCESS_RESPONSE]
-			=> [SUCCESS] => grab access, set lentFromUser to [USER], issue [SCAN] with targetPID of [USER], as to ask it to inform everybody about its new status, remove [USER] from pendingResponse set
+			=> [SUCCESS] => grab access, remember the lease borrowed from [USER], issue [SCAN] with targetPID of [USER], as to ask it to inform everybody about its new status, remove [USER] from pendingResponse set
+				(if the response carries a lease epoch, the [SCAN] is skipped: the lease already tells that [USER] gave up access - and its [STATUS] follows anyway)
 			=> [ERROR/DENY] => don't grab access, remove [USER] from pendingResponse set
+		no [ACCESS_RESPONSE] within accessRequestTimeout => remove [USER] from pendingResponse set and ask again, with exponential backoff, up to accessRequestRetryLimit
+			times. Then give up (reporting kISResourceMediatorResultTimeout to the delegate) until [USER] sends an updated [STATUS].
+		preferredAccess changes => all pending requests are cancelled. Late [ACCESS_RESPONSE]s to cancelled requests are ignored.
+	Multicast access request (if several users hold access - and all known users announced kISResourceMediatorCapabilityMulticastAccessRequest)
+	[ACCESS_REQUEST] (phase PREPARE, with targetPIDs of all holders) => each [USER] decides without taking action. If it agrees, it reserves its access for the
+		requester (denying other requests until COMMIT, ABORT or the reservation expires) => [ACCESS_RESPONSE] (phase PREPARE) to requester
+		=> all [SUCCESS] => [ACCESS_REQUEST] (phase COMMIT) => each [USER] relinquishes access, sets [ORIGIN] as lendingUser and confirms with its updated [STATUS]
+			(or, if it had no access to give up or failed to, with an [ACCESS_RESPONSE] (phase COMMIT))
+			=> all confirmed => grab access (if a [USER] confirmed with an [ACCESS_RESPONSE], issue one [SCAN] with targetPIDs of all [USER]s).
+			No lease is borrowed, as only shared access is lent by several users.
+		=> any [ERROR/DENY] => [ACCESS_REQUEST] (phase ABORT) - no [USER] relinquished access
+		no [ACCESS_RESPONSE]s from all within accessRequestTimeout => ABORT, then ask again, counting an attempt for each [USER] that didn't respond
+		The delegate receives one aggregated result.
+
+	Waiter queue (if the requester announced kISResourceMediatorCapabilityWaiterQueue)
+	- a holder that denies a targeted [ACCESS_REQUEST] queues the requester and tells it its position in the [ACCESS_RESPONSE]. The requester
+	  doesn't ask the holder again until the holder grants access or its status changes.
+	- the queue is ordered by accessPressure, which grows with the time waited (aging), so low pressure requesters don't starve
+	- a holder releasing access grants it to the first waiter with an unsolicited [ACCESS_RESPONSE] (unless it returns a borrowed lease)
+	- a holder denying a request from a user with the same accessPressure because it didn't hold access for minimumHoldTime yet, relinquishes
+	  access to the first waiter (if it would no longer deny its request) once minimumHoldTime is up
+	- the queue is dropped when the holder loses access
+
+	Leases (if the requester announced kISResourceMediatorCapabilityLeases)
+	- every grant carries a lease with an epoch, which is higher than any epoch known to the granter or - as sent in the [ACCESS_REQUEST] - the requester
+	- [ACCESS_RESPONSE]s with an epoch not above the one the requester knew when it first asked are stale. The lease is handed back right away.
+	- the lender keeps the lease it lent out until it's handed back. While its preferences are the same as when it lent access, it doesn't send
+	  [ACCESS_REQUEST]s, but waits for the lease to come back.
+	- a borrower that lends access on keeps the lease it borrowed, so leases form a chain. Access is handed back along the chain, one hop at a time:
+	  a lender that gets its lease back and no longer needs access hands its own lease back right away.
+
 	- consider suspending sending update notifications in [USER] between receiving [ACCESS_REQUEST] and sending [ACCESS_RESPONSE], to avoid a [STATUS] notification going out for updates made by the app/class inbetween
 	
+	Status updates
+	[STATUS] => carries a per-sender sequence number. Full [STATUS] messages (replies to [SCAN]) always apply. Changes made within
+	statusCoalescingInterval are sent as a single delta [STATUS] containing only the changed fields. Receivers apply deltas in order,
+	ignore duplicates and, on detecting a gap, send a [SCAN] targeting the sender to request a full [STATUS].
+	- [STATUS] messages carry a content hash of broadcastInfo. Full [STATUS] messages also carry broadcastInfo itself, delta [STATUS] messages
+	  only if a user doesn't support hashes. Receivers look hashes up in a bounded cache and, on a miss, fetch broadcastInfo with a [SCAN]
+	  targeting the sender and carrying the hash. The sender replies with a targeted [STATUS] carrying just its broadcastInfo and hash.
+
 	Ending/Returning access
 	- by quitting
-	- by posting updated [STATUS] notification (if lent, first targeted to lentFromUser [USER], then globally, to give the lender a better chance of winning any competition)
-	=> if that app lent access to anybody, the lender should now run -considerRequestingAccess to take it back
+	- by posting updated [STATUS] notification (if lent, first targeted to the lender [USER], carrying the lease epoch, then globally, to give the lender a better chance of winning any competition)
+	=> if that app lent access to anybody, the lender should now run -considerRequestingAccess to take it back. A lender receiving its lease back does so right away.
 
 	Consider access
 	- if preferredAccess == Shared => address any users with Exclusive lock
+	  - for counted resources (resourceCapacity > 0), also address users with Shared lock, lowest accessPressure first, until enough slots would be free.
+	    [STATUS] and [ACCESS_REQUEST] messages carry the sender's slotCount, [STATUS] messages also its resourceCapacity.
 	- if preferredAccess == Exclusive => address any users with Shared or Exclusive lock
 	- exclude users in pendingResponse
+
+	Execution
+	- by default, the mediator runs on the thread it is called from (the main thread for messages and timers), protected by @synchronized
+	- with -enableSerialExecutionWithTargetQueue:, all events are processed in order on the mediator's executionQueue. Delegate methods
+	  are called on that queue after the triggering event has been processed, so they never run inside the mediator's critical section.
+	- setApplicationAccessForResource commands are serialized through a lock-free MPSC queue: any thread may submit, one command runs at a time
 */
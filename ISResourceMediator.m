@@ -36,28 +36,8 @@ DAMAGE.
 
 #import "ISResourceMediator.h"
 
-static NSString *kISResourceMediatorNotificationNamePrefix = @"com.iospirit.resourcemediator.";
-
-static NSString *kISResourceMediatorNotificationScanNameSuffix = @"scan";
-static NSString *kISResourceMediatorNotificationStatusNameSuffix = @"status";
-static NSString *kISResourceMediatorNotificationAccessRequestNameSuffix = @"accessRequest";
-static NSString *kISResourceMediatorNotificationAccessResponseNameSuffix = @"accessResponse";
-
-static NSString *kISResourceMediatorNotificationResourceIdentifierKey = @"resourceIdentifier";
-static NSString *kISResourceMediatorNotificationPIDKey = @"pid";
-static NSString *kISResourceMediatorNotificationTargetPIDKey = @"targetPID";
-static NSString *kISResourceMediatorNotificationBroadcastInfoKey = @"broadcastInfo";
-static NSString *kISResourceMediatorNotificationPreferredAccessKey = @"preferredAccess";
-static NSString *kISResourceMediatorNotificationActualAccessKey = @"actualAccess";
-static NSString *kISResourceMediatorNotificationAccessPressureKey = @"accessPressure";
-static NSString *kISResourceMediatorNotificationAccessStartTimeKey = @"accessStartTime";
-static NSString *kISResourceMediatorNotificationResultKey = @"result";
-
-#define ISResourceMediatorNotificationName(suffix)		[NSString stringWithFormat:@"%@%@.%@", kISResourceMediatorNotificationNamePrefix,resourceIdentifier,suffix]
-#define kISResourceMediatorNotificationScanName			ISResourceMediatorNotificationName(kISResourceMediatorNotificationScanNameSuffix)
-#define kISResourceMediatorNotificationStatusName		ISResourceMediatorNotificationName(kISResourceMediatorNotificationStatusNameSuffix)
-#define kISResourceMediatorNotificationAccessRequestName	ISResourceMediatorNotificationName(kISResourceMediatorNotificationAccessRequestNameSuffix)
-#define kISResourceMediatorNotificationAccessResponseName	ISResourceMediatorNotificationName(kISResourceMediatorNotificationAccessResponseNameSuffix)
+#include <stdatomic.h>
+#include <Block.h>
 
 @implementation ISResourceUser
 
@@ -69,18 +49,31 @@ static NSString *kISResourceMediatorNotificationResultKey = @"result";
 @synthesize actualAccess;
 @synthesize accessPressure;
 
+@synthesize capabilities;
+
+@synthesize resourceCapacity;
+@synthesize slotCount;
+
 @synthesize broadcastInfo;
+@synthesize broadcastInfoHash;
+#if ISRESOURCEMEDIATOR_APPKIT
 @synthesize runningApplication;
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
 
 @synthesize trackingObject;
 
+@synthesize statusSequence;
+@synthesize statusResyncRequestTime;
+
 - (void)dealloc
 {
 	[broadcastInfo release];
 	broadcastInfo = nil;
 	
+#if ISRESOURCEMEDIATOR_APPKIT
 	[runningApplication release];
 	runningApplication = nil;
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
 	
 	[trackingObject release];
 	trackingObject = nil;
@@ -90,6 +83,356 @@ static NSString *kISResourceMediatorNotificationResultKey = @"result";
 
 @end
 
+#define kISResourceMediatorDefaultAccessRequestTimeout		1.0
+#define kISResourceMediatorDefaultAccessRequestRetryLimit	2
+#define kISResourceMediatorDefaultAccessRequestBackoffFactor	2.0
+
+#define kISResourceMediatorStatusFlushDeadlineKey		@"statusFlush"
+#define kISResourceMediatorDiscoveryTimeoutDeadlineKey		@"discoveryTimeout"
+#define kISResourceMediatorMulticastAccessRequestDeadlineKey	@"multicastAccessRequest"
+#define kISResourceMediatorAccessReservationDeadlineKey		@"accessReservation"
+#define kISResourceMediatorLeaseReturnDeadlineKey			@"leaseReturn"
+#define kISResourceMediatorHoldTimeDeadlineKey			@"holdTime"
+#define kISResourceMediatorUserChangesDeadlineKey		@"userChanges"
+
+#define kISResourceMediatorWaiterAgingRate			10.0 // Access pressure a waiter gains per second waited
+
+#define kISResourceMediatorBroadcastInfoCacheLimit		64
+
+#define kISResourceMediatorCapabilities				(kISResourceMediatorCapabilityMulticastAccessRequest | kISResourceMediatorCapabilityLeases | kISResourceMediatorCapabilityWaiterQueue | kISResourceMediatorCapabilityBroadcastInfoHash)
+
+#pragma mark - Lease
+@interface ISResourceMediatorLease : NSObject
+{
+	ISResourceUser *user;
+	uint64_t epoch;
+
+	ISResourceMediatorResourceAccess preferredAccess;
+	ISResourceMediatorAccessPressure accessPressure;
+
+	BOOL returnAwaited;
+}
+
+@property(retain) ISResourceUser *user; //!< The lender of a borrowed lease, the borrower of a lent lease.
+@property(assign) uint64_t epoch; //!< Epoch of the lease. 0 if the lender doesn't support leases.
+
+@property(assign) ISResourceMediatorResourceAccess preferredAccess; //!< Lent leases: our preferredAccess at the time of lending.
+@property(assign) ISResourceMediatorAccessPressure accessPressure; //!< Lent leases: our accessPressure at the time of lending.
+
+@property(assign) BOOL returnAwaited; //!< Lent leases: YES once we hold back requests until the lease returns (or the return times out).
+
+- (instancetype)initWithUser:(ISResourceUser *)aUser epoch:(uint64_t)anEpoch;
+
+@end
+
+@implementation ISResourceMediatorLease
+
+@synthesize user;
+@synthesize epoch;
+
+@synthesize preferredAccess;
+@synthesize accessPressure;
+
+@synthesize returnAwaited;
+
+- (instancetype)initWithUser:(ISResourceUser *)aUser epoch:(uint64_t)anEpoch
+{
+	if ((self = [super init]) != nil)
+	{
+		user = [aUser retain];
+		epoch = anEpoch;
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[user release];
+	user = nil;
+
+	[super dealloc];
+}
+
+@end
+
+#pragma mark - Waiter
+@interface ISResourceMediatorWaiter : NSObject
+{
+	ISResourceUser *user;
+
+	ISResourceMediatorAccessPressure accessPressure;
+	NSTimeInterval accessStartTime;
+
+	NSTimeInterval queueTime;
+}
+
+@property(retain) ISResourceUser *user;
+
+@property(assign) ISResourceMediatorAccessPressure accessPressure; //!< accessPressure of the (latest) queued request.
+@property(assign) NSTimeInterval accessStartTime; //!< accessStartTime of the (latest) queued request.
+
+@property(assign) NSTimeInterval queueTime; //!< Time the user was first queued. Kept when it asks again.
+
+- (instancetype)initWithUser:(ISResourceUser *)aUser queueTime:(NSTimeInterval)aQueueTime;
+
+- (double)priorityAtTime:(NSTimeInterval)time; //!< accessPressure, aged by the time waited.
+
+@end
+
+@implementation ISResourceMediatorWaiter
+
+@synthesize user;
+
+@synthesize accessPressure;
+@synthesize accessStartTime;
+
+@synthesize queueTime;
+
+- (instancetype)initWithUser:(ISResourceUser *)aUser queueTime:(NSTimeInterval)aQueueTime
+{
+	if ((self = [super init]) != nil)
+	{
+		user = [aUser retain];
+		queueTime = aQueueTime;
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[user release];
+	user = nil;
+
+	[super dealloc];
+}
+
+- (double)priorityAtTime:(NSTimeInterval)time
+{
+	return ((double)accessPressure + (kISResourceMediatorWaiterAgingRate * MAX(time - queueTime, 0)));
+}
+
+@end
+
+#pragma mark - Multicast access request
+@interface ISResourceMediatorMulticastAccessRequest : NSObject
+{
+	uint64_t requestID;
+	ISResourceMediatorAccessRequestPhase phase;
+	ISResourceMediatorResourceAccess preferredAccess;
+	NSArray <ISResourceUser *> *users;
+	NSMutableDictionary <NSNumber *, NSNumber *> *resultsByPID;
+	NSTimeInterval requestTime;
+	BOOL needsStatusRefresh;
+}
+
+@property(assign) uint64_t requestID;
+@property(assign) ISResourceMediatorAccessRequestPhase phase; //!< Phase the request is currently collecting responses for.
+@property(assign) ISResourceMediatorResourceAccess preferredAccess; //!< preferredAccess at the time of the request.
+@property(retain) NSArray <ISResourceUser *> *users; //!< The users asked to relinquish access.
+@property(retain) NSMutableDictionary <NSNumber *, NSNumber *> *resultsByPID; //!< Results received (by pid) in the current phase.
+@property(assign) NSTimeInterval requestTime;
+@property(assign) BOOL needsStatusRefresh; //!< YES if a user confirmed the commit with an [ACCESS_RESPONSE] rather than a [STATUS].
+
+- (NSArray <NSNumber *> *)targetPIDs;
+
+@end
+
+@implementation ISResourceMediatorMulticastAccessRequest
+
+@synthesize requestID;
+@synthesize phase;
+@synthesize preferredAccess;
+@synthesize users;
+@synthesize resultsByPID;
+@synthesize requestTime;
+@synthesize needsStatusRefresh;
+
+- (void)dealloc
+{
+	[users release];
+	users = nil;
+
+	[resultsByPID release];
+	resultsByPID = nil;
+
+	[super dealloc];
+}
+
+- (NSArray <NSNumber *> *)targetPIDs
+{
+	NSMutableArray <NSNumber *> *targetPIDs = [NSMutableArray arrayWithCapacity:users.count];
+
+	for (ISResourceUser *user in users)
+	{
+		[targetPIDs addObject:@(user.pid)];
+	}
+
+	return (targetPIDs);
+}
+
+@end
+
+#pragma mark - Command queue helpers
+// Intrusive multi-producer/single-consumer queue (Dmitry Vyukov's algorithm). Any thread can push in O(1) without locks.
+// The consumer role is held by whoever sets "executing" - commands are executed one at a time, in order.
+typedef struct ISResourceMediatorCommandNode
+{
+	struct ISResourceMediatorCommandNode * _Atomic next;
+
+	ISResourceMediatorCommand command;
+	NSTimeInterval enqueueTime;
+
+	_Atomic int state;
+} ISResourceMediatorCommandNode;
+
+struct ISResourceMediatorCommandQueue
+{
+	ISResourceMediatorCommandNode * _Atomic tail;
+	ISResourceMediatorCommandNode *head;
+	ISResourceMediatorCommandNode stub;
+
+	atomic_uint_fast32_t pendingCount;
+	atomic_uint_fast32_t linkedCount; // Number of pushes that finished linking their node
+	atomic_bool executing;
+};
+
+enum
+{
+	kISResourceMediatorCommandStateRunning = 0,
+	kISResourceMediatorCommandStateCompleted,
+	kISResourceMediatorCommandStateReturned
+};
+
+static struct ISResourceMediatorCommandQueue *ISResourceMediatorCommandQueueCreate(void)
+{
+	struct ISResourceMediatorCommandQueue *queue = calloc(1, sizeof(struct ISResourceMediatorCommandQueue));
+
+	atomic_store(&queue->stub.next, NULL);
+	atomic_store(&queue->tail, &queue->stub);
+	queue->head = &queue->stub;
+
+	return (queue);
+}
+
+static void ISResourceMediatorCommandQueuePushNode(struct ISResourceMediatorCommandQueue *queue, ISResourceMediatorCommandNode *node)
+{
+	ISResourceMediatorCommandNode *previousNode;
+
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+
+	previousNode = atomic_exchange_explicit(&queue->tail, node, memory_order_acq_rel);
+
+	atomic_store_explicit(&previousNode->next, node, memory_order_release);
+}
+
+static NSUInteger ISResourceMediatorCommandQueuePush(struct ISResourceMediatorCommandQueue *queue, ISResourceMediatorCommand command, NSTimeInterval enqueueTime) // Returns the queue depth after pushing
+{
+	ISResourceMediatorCommandNode *node = calloc(1, sizeof(ISResourceMediatorCommandNode));
+	NSUInteger depth;
+
+	node->command = Block_copy(command);
+	node->enqueueTime = enqueueTime;
+
+	depth = atomic_fetch_add(&queue->pendingCount, 1) + 1;
+
+	ISResourceMediatorCommandQueuePushNode(queue, node);
+
+	atomic_fetch_add(&queue->linkedCount, 1);
+
+	return (depth);
+}
+
+static ISResourceMediatorCommandNode *ISResourceMediatorCommandQueuePop(struct ISResourceMediatorCommandQueue *queue) // Consumer only
+{
+	ISResourceMediatorCommandNode *head = queue->head;
+	ISResourceMediatorCommandNode *next = atomic_load_explicit(&head->next, memory_order_acquire);
+
+	if (head == &queue->stub)
+	{
+		if (next == NULL)
+		{
+			return (NULL);
+		}
+
+		queue->head = next;
+		head = next;
+		next = atomic_load_explicit(&next->next, memory_order_acquire);
+	}
+
+	if (next != NULL)
+	{
+		queue->head = next;
+		return (head);
+	}
+
+	if (head != atomic_load_explicit(&queue->tail, memory_order_acquire))
+	{
+		// A push is in progress
+		return (NULL);
+	}
+
+	ISResourceMediatorCommandQueuePushNode(queue, &queue->stub);
+
+	if ((next = atomic_load_explicit(&head->next, memory_order_acquire)) != NULL)
+	{
+		queue->head = next;
+		return (head);
+	}
+
+	return (NULL);
+}
+
+static void ISResourceMediatorCommandNodeFree(ISResourceMediatorCommandNode *node)
+{
+	Block_release(node->command);
+	free(node);
+}
+
+static void ISResourceMediatorCommandQueueFree(struct ISResourceMediatorCommandQueue *queue)
+{
+	ISResourceMediatorCommandNode *node;
+
+	while ((node = ISResourceMediatorCommandQueuePop(queue)) != NULL)
+	{
+		ISResourceMediatorCommandNodeFree(node);
+	}
+
+	free(queue);
+}
+
+static char kISResourceMediatorExecutionQueueKey;
+
+#pragma mark - Holder index helpers
+static NSUInteger ISResourceMediatorHolderIndexForAccessPressure(NSArray <ISResourceUser *> *holders, ISResourceMediatorAccessPressure accessPressure)
+{
+	NSUInteger lowerBound = 0, upperBound = holders.count;
+
+	// First index with a pressure >= accessPressure
+	while (lowerBound < upperBound)
+	{
+		NSUInteger middle = (lowerBound + upperBound) / 2;
+
+		if ([holders objectAtIndex:middle].accessPressure < accessPressure)
+		{
+			lowerBound = middle + 1;
+		}
+		else
+		{
+			upperBound = middle;
+		}
+	}
+
+	return (lowerBound);
+}
+
+@interface ISResourceMediator ()
+
+@property(retain,readwrite) NSArray <ISResourceUser *> *usersSnapshot;
+
+@end
+
 @implementation ISResourceMediator
 
 #pragma mark - Properties
@@ -100,16 +443,42 @@ static NSString *kISResourceMediatorNotificationResultKey = @"result";
 
 @synthesize accessPressure;
 
+@synthesize resourceCapacity;
+@synthesize slotCount;
+
 @synthesize resourceIdentifier;
 @synthesize representedObject;
 @synthesize pid;
 
 @synthesize users;
+@synthesize usersSnapshot;
+@synthesize usersGeneration;
 
 @synthesize broadcastInfo;
 
 @synthesize delegate;
 
+@synthesize wireFormat;
+
+@synthesize statusCoalescingInterval;
+
+@synthesize hub;
+@synthesize statusTable;
+@synthesize deadlineScheduler;
+@synthesize processWatcher;
+
+@synthesize accessRequestTimeout;
+@synthesize accessRequestRetryLimit;
+@synthesize accessRequestBackoffFactor;
+@synthesize usesMulticastAccessRequests;
+@synthesize minimumHoldTime;
+
+@synthesize executionQueue;
+
+@synthesize metrics;
+
+@synthesize traceRecorder;
+
 #pragma mark - Init & Dealloc
 - (instancetype)initMediatorForResourceWithIdentifier:(NSString *)aResourceIdentifier delegate:(NSObject <ISResourceMediatorDelegate> *)aDelegate
 {
@@ -117,18 +486,51 @@ static NSString *kISResourceMediatorNotificationResultKey = @"result";
 	{
 		resourceIdentifier = [aResourceIdentifier retain];
 		self.delegate = aDelegate;
+
+		hub = [[ISResourceMediatorHub sharedHub] retain];
+
+		processWatcher = [[ISResourceMediatorProcessWatcher sharedProcessWatcher] retain];
 		
 		users = [NSMutableArray new];
+		usersSnapshot = [NSArray new];
 		usersByPID = [NSMutableDictionary new];
+		pendingUserChangesByPID = [NSMutableDictionary new];
+
+		for (NSUInteger access=0; access < kISResourceMediatorResourceAccessCount; access++)
+		{
+			holdersByActualAccess[access] = [NSMutableArray new];
+		}
+
 		pendingResponse = [NSMutableSet new];
+
+		accessRequestAttemptsByPID = [NSMutableDictionary new];
+		accessRequestTimesByPID = [NSMutableDictionary new];
+		accessRequestLeaseEpochsByPID = [NSMutableDictionary new];
+		waiters = [NSMutableArray new];
+		queuedAtUsers = [NSMutableSet new];
+		broadcastInfoCache = [NSMutableDictionary new];
+		broadcastInfoFetchHashesByPID = [NSMutableDictionary new];
+		accessRequestTimeout = kISResourceMediatorDefaultAccessRequestTimeout;
+		accessRequestRetryLimit = kISResourceMediatorDefaultAccessRequestRetryLimit;
+		accessRequestBackoffFactor = kISResourceMediatorDefaultAccessRequestBackoffFactor;
+		usesMulticastAccessRequests = YES;
 		
-		commandQueue = [NSMutableArray new];
+		commandQueue = ISResourceMediatorCommandQueueCreate();
+
+		metrics = [ISResourceMediatorMetrics new];
+
+		propertyListPeerPIDs = [NSMutableSet new];
+		binaryPeerPIDs = [NSMutableSet new];
+
+		pendingDiscoveryPIDs = [NSMutableSet new];
 		
 		preferredAccess = kISResourceMediatorResourceAccessNone;
 		actualAccess    = kISResourceMediatorResourceAccessNone;
 
 		accessPressure = kISResourceMediatorAccessPressureOptional;
 
+		slotCount = 1;
+
 		pid = getpid();
 	}
 	
@@ -137,784 +539,3197 @@ static NSString *kISResourceMediatorNotificationResultKey = @"result";
 
 - (void)dealloc
 {
-	self.active = NO;
+	// Stop process exit notifications before tearing down
+	[processWatcher removeObserver:self];
+	[processWatcher release];
+	processWatcher = nil;
+
+	[self _setActive:NO];
 
 	[resourceIdentifier release];
 	resourceIdentifier = nil;
-	
+
+	[hub release];
+	hub = nil;
+
+	[statusTable release];
+	statusTable = nil;
+
 	[representedObject release];
 	representedObject = nil;
 	
 	[broadcastInfo release];
 	broadcastInfo = nil;
 
+	[broadcastInfoCache release];
+	broadcastInfoCache = nil;
+
+	[broadcastInfoFetchHashesByPID release];
+	broadcastInfoFetchHashesByPID = nil;
+
 	[lendingUser release];
 	lendingUser = nil;
 	
-	[lentFromUser release];
-	lentFromUser = nil;
+	[borrowedLease release];
+	borrowedLease = nil;
+
+	[lentLease release];
+	lentLease = nil;
 	
 	[usersByPID release];
 	usersByPID = nil;
+
+	for (NSUInteger access=0; access < kISResourceMediatorResourceAccessCount; access++)
+	{
+		[holdersByActualAccess[access] release];
+		holdersByActualAccess[access] = nil;
+	}
 	
 	[pendingResponse release];
 	pendingResponse = nil;
+
+	[accessRequestAttemptsByPID release];
+	accessRequestAttemptsByPID = nil;
+
+	[accessRequestTimesByPID release];
+	accessRequestTimesByPID = nil;
+
+	[accessRequestLeaseEpochsByPID release];
+	accessRequestLeaseEpochsByPID = nil;
+
+	[waiters release];
+	waiters = nil;
+
+	[queuedAtUsers release];
+	queuedAtUsers = nil;
+
+	[multicastAccessRequest release];
+	multicastAccessRequest = nil;
+
+	[accessReservedForPID release];
+	accessReservedForPID = nil;
+
+	[deadlineScheduler release];
+	deadlineScheduler = nil;
 	
-	[commandQueue release];
-	commandQueue = nil;
-	
-	for (ISResourceUser *user in users)
+	if (commandQueue != NULL)
 	{
-		if (user.runningApplication != nil)
-		{
-			[user removeObserver:self forKeyPath:@"runningApplication.isTerminated" context:(void *)self];
-			user.runningApplication = nil;
-		}
+		ISResourceMediatorCommandQueueFree(commandQueue);
+		commandQueue = NULL;
+	}
+
+	if (executionQueue != NULL)
+	{
+		dispatch_release(executionQueue);
+		executionQueue = NULL;
 	}
+
+	[metrics release];
+	metrics = nil;
+
+	[traceRecorder release];
+	traceRecorder = nil;
+
+	[propertyListPeerPIDs release];
+	propertyListPeerPIDs = nil;
+
+	[binaryPeerPIDs release];
+	binaryPeerPIDs = nil;
+
+	[pendingDiscoveryPIDs release];
+	pendingDiscoveryPIDs = nil;
 	
 	[users release];
 	users = nil;
+
+	[usersSnapshot release];
+	usersSnapshot = nil;
+
+	[pendingUserChangesByPID release];
+	pendingUserChangesByPID = nil;
 	
 	delegate = nil;
 
 	[super dealloc];
 }
 
-#pragma mark - Start/Stop Mediator
-- (void)setActive:(BOOL)newActive
+#pragma mark - Serial execution
+- (void)enableSerialExecutionWithTargetQueue:(dispatch_queue_t)targetQueue
 {
-	if (active != newActive)
+	if ((executionQueue == NULL) && !active)
 	{
-		active = newActive;
-		
-		if (active)
-		{
-			// Register for application events
-			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationWillTerminateNotification    object:nil];
-			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationDidBecomeActiveNotification  object:nil];
-			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationWillResignActiveNotification object:nil];
+		executionQueue = dispatch_queue_create([[NSString stringWithFormat:@"com.iospirit.resourcemediator.%@", resourceIdentifier] UTF8String], DISPATCH_QUEUE_SERIAL);
 
-			// Register for mediator notifications
-			[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleMediatorNotification:) name:kISResourceMediatorNotificationScanName		 object:nil suspensionBehavior:NSNotificationSuspensionBehaviorDeliverImmediately];
-			[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleMediatorNotification:) name:kISResourceMediatorNotificationStatusName	 object:nil suspensionBehavior:NSNotificationSuspensionBehaviorDeliverImmediately];
-			[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleMediatorNotification:) name:kISResourceMediatorNotificationAccessRequestName  object:nil suspensionBehavior:NSNotificationSuspensionBehaviorDeliverImmediately];
-			[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleMediatorNotification:) name:kISResourceMediatorNotificationAccessResponseName object:nil suspensionBehavior:NSNotificationSuspensionBehaviorDeliverImmediately];
+		dispatch_queue_set_specific(executionQueue, &kISResourceMediatorExecutionQueueKey, (void *)self, NULL);
 
-			// Scan for other apps using resource
-			[self _postNotificationWithName:kISResourceMediatorNotificationScanName userInfo:@{
-				kISResourceMediatorNotificationPIDKey			: @(pid),
-				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier, 
-			}];
-			
-			// Consider requesting access after giving the app some time to discover other users and get a picture of the current usage
-			[self performSelector:@selector(considerRequestingAccess) withObject:nil afterDelay:0.2];
-		}
-		else
+		if (targetQueue != NULL)
 		{
-			// Unregister from mediator notifications
-			[[NSDistributedNotificationCenter defaultCenter] removeObserver:self name:kISResourceMediatorNotificationScanName	    object:nil];
-			[[NSDistributedNotificationCenter defaultCenter] removeObserver:self name:kISResourceMediatorNotificationStatusName	    object:nil];
-			[[NSDistributedNotificationCenter defaultCenter] removeObserver:self name:kISResourceMediatorNotificationAccessRequestName  object:nil];
-			[[NSDistributedNotificationCenter defaultCenter] removeObserver:self name:kISResourceMediatorNotificationAccessResponseName object:nil];
+			dispatch_set_target_queue(executionQueue, targetQueue);
+		}
+	}
+}
 
-			// Unregister from application events
+- (BOOL)_dispatchToExecutionQueue:(dispatch_block_t)block
+{
+	// Returns YES if block was dispatched to the execution queue, NO if the caller is already on the execution queue or serial execution is not enabled
+	if ((executionQueue != NULL) && (dispatch_get_specific(&kISResourceMediatorExecutionQueueKey) != (void *)self))
+	{
+		dispatch_async(executionQueue, block);
+		return (YES);
+	}
+
+	return (NO);
+}
+
+- (dispatch_queue_t)_callbackQueue
+{
+	return ((executionQueue != NULL) ? executionQueue : dispatch_get_main_queue());
+}
+
+- (void)_notifyDelegate:(dispatch_block_t)notification
+{
+	if (executionQueue != NULL)
+	{
+		// Run after the current event has been fully processed
+		dispatch_async(executionQueue, notification);
+	}
+	else
+	{
+		notification();
+	}
+}
+
+#pragma mark - Start/Stop Mediator
+- (void)setActive:(BOOL)newActive
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setActive:newActive]; }])
+	{
+		return;
+	}
+
+	[self _setActive:newActive];
+}
+
+- (void)_setActive:(BOOL)newActive
+{
+	if (active != newActive)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventActivation value:newActive userInfo:@{
+			kISResourceMediatorNotificationPIDKey			: @(pid),
+			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+		}];
+
+		active = newActive;
+		
+		if (active)
+		{
+			BOOL readStatusTable;
+
+#if ISRESOURCEMEDIATOR_APPKIT
+			// Register for application events
+			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationWillTerminateNotification    object:nil];
+			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationDidBecomeActiveNotification  object:nil];
+			[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(handleApplicationNotifications:) name:NSApplicationWillResignActiveNotification object:nil];
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
+
+			// Register for mediator messages
+			[hub addMediator:self];
+
+			// Publish own status and pick up the current status of all other users from the status table
+			readStatusTable = [self _readStatusTable];
+
+			// Hold off arbitration until all known peers answered the [SCAN] - unless the status table already provided a picture of the current usage
+			[self _beginDiscoveryWaitingForReplies:!readStatusTable];
+
+			// Scan for other apps using resource (as property list, so that peers predating the binary format can answer, too)
+			[self _postMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+				kISResourceMediatorNotificationPIDKey			: @(pid),
+				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier, 
+				kISResourceMediatorNotificationScanEpochKey		: @(scanEpoch),
+			} format:((wireFormat == kISResourceMediatorWireFormatBinary) ? kISResourceMediatorWireFormatBinary : kISResourceMediatorWireFormatPropertyList)];
+			
+			if (readStatusTable)
+			{
+				[self considerRequestingAccess];
+			}
+		}
+		else
+		{
+			// Stop waiting for [SCAN] replies
+			[self _endDiscovery];
+
+			// Stop waiting for [ACCESS_RESPONSE]s
+			[self _cancelAccessRequests];
+			[self _releaseAccessReservation];
+
+			// Leases don't survive deactivation
+			@synchronized(self)
+			{
+				[borrowedLease release];
+				borrowedLease = nil;
+
+				[lentLease release];
+				lentLease = nil;
+
+				// Peers drop us when we leave - the first [STATUS] after reactivation has to be full again
+				hasBroadcastStatus = NO;
+			}
+
+			[self _dropWaiters];
+
+			// Unregister from mediator messages
+			[hub removeMediator:self];
+
+			// Free slot in status table
+			[statusTable releaseSlotForPID:pid];
+
+#if ISRESOURCEMEDIATOR_APPKIT
+			// Unregister from application events
 			[[NSNotificationCenter defaultCenter] removeObserver:self name:NSApplicationWillTerminateNotification object:nil];
 			[[NSNotificationCenter defaultCenter] removeObserver:self name:NSApplicationDidBecomeActiveNotification object:nil];
 			[[NSNotificationCenter defaultCenter] removeObserver:self name:NSApplicationWillResignActiveNotification object:nil];
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
+		}
+	}
+}
+
+#pragma mark - Notification handling
+- (void)handleApplicationNotifications:(NSNotification *)notification
+{
+}
+
+- (void)_notePeerWireFormat:(ISResourceMediatorWireFormat)peerFormat forPID:(NSNumber *)peerPIDNumber
+{
+	if ((peerPIDNumber != nil) && ([peerPIDNumber intValue] != self.pid))
+	{
+		@synchronized(self)
+		{
+			if (peerFormat == kISResourceMediatorWireFormatPropertyList)
+			{
+				[propertyListPeerPIDs addObject:peerPIDNumber];
+				[binaryPeerPIDs removeObject:peerPIDNumber];
+			}
+			else
+			{
+				[propertyListPeerPIDs removeObject:peerPIDNumber];
+				[binaryPeerPIDs addObject:peerPIDNumber];
+			}
+		}
+	}
+}
+
+- (ISResourceMediatorWireFormat)_wireFormatForUserInfo:(NSDictionary *)notificationUserInfo
+{
+	ISResourceMediatorWireFormat format = wireFormat;
+
+	if (format == kISResourceMediatorWireFormatAutomatic)
+	{
+		NSNumber *targetPID = [notificationUserInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey];
+
+		@synchronized(self)
+		{
+			format = kISResourceMediatorWireFormatBinary;
+
+			if (targetPID != nil)
+			{
+				// Fall back to property lists for peers that don't understand the binary format
+				if ([propertyListPeerPIDs containsObject:targetPID])
+				{
+					format = kISResourceMediatorWireFormatPropertyList;
+				}
+			}
+			else if (!hasCompletedDiscovery || (propertyListPeerPIDs.count > 0))
+			{
+				// Broadcasts reach peers we haven't heard from yet - some of which may predate the binary format
+				format = kISResourceMediatorWireFormatPropertyList;
+			}
+			else
+			{
+				for (ISResourceUser *user in users)
+				{
+					if (user.isUsingResourceMediator && ![binaryPeerPIDs containsObject:@(user.pid)])
+					{
+						// Only known from the status table so far - it may predate the binary format
+						format = kISResourceMediatorWireFormatPropertyList;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	return (format);
+}
+
+- (void)_postMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)notificationUserInfo
+{
+	[self _postMessage:messageType userInfo:notificationUserInfo format:[self _wireFormatForUserInfo:notificationUserInfo]];
+}
+
+- (void)_postMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)notificationUserInfo format:(ISResourceMediatorWireFormat)format
+{
+	NSString *notificationObjectString = nil;
+
+	// Serialize notificationUserInfo and send it as the "object" string (see -[ISResourceMediatorHub routeMessage:resourceIdentifier:object:] for an explaination)
+	if (notificationUserInfo != nil)
+	{
+		if ((notificationObjectString = [ISResourceMediatorCodec stringWithUserInfo:notificationUserInfo format:format]) == nil)
+		{
+			return;
+		}
+	}
+
+	[metrics noteMessageSent:messageType encodedLength:[notificationObjectString lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+
+	[self _traceEvent:kISResourceMediatorTraceEventMessageSent value:messageType userInfo:notificationUserInfo];
+
+	[hub postMessage:messageType resourceIdentifier:resourceIdentifier targetPID:[[notificationUserInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey] intValue] object:notificationObjectString];
+}
+
+- (void)_requestFullStatusFromUser:(ISResourceUser *)user
+{
+	// At most once per second
+	NSTimeInterval now = [self _currentTime];
+
+	if ((now - user.statusResyncRequestTime) > 1.0)
+	{
+		user.statusResyncRequestTime = now;
+
+		[self _postMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+			kISResourceMediatorNotificationPIDKey			: @(self.pid),
+			kISResourceMediatorNotificationTargetPIDKey		: @(user.pid),
+
+			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+		}];
+	}
+}
+
+- (BOOL)_shouldApplyStatusUserInfo:(NSDictionary *)statusUserInfo fromUser:(ISResourceUser *)user
+{
+	NSNumber *sequenceNumber;
+	uint64_t sequence;
+
+	if ((sequenceNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationStatusSequenceKey]) == nil)
+	{
+		// Peers predating sequence numbers and status table entries always send full status
+		return (YES);
+	}
+
+	sequence = sequenceNumber.unsignedLongLongValue;
+
+	if ([[statusUserInfo objectForKey:kISResourceMediatorNotificationStatusDeltaKey] boolValue])
+	{
+		if (sequence <= user.statusSequence)
+		{
+			// Duplicate or outdated
+			return (NO);
+		}
+
+		if (sequence != (user.statusSequence + 1))
+		{
+			// Missed at least one delta
+			[self _requestFullStatusFromUser:user];
+
+			return (NO);
+		}
+	}
+	else
+	{
+		// Full status
+		user.statusResyncRequestTime = 0;
+	}
+
+	user.statusSequence = sequence;
+
+	return (YES);
+}
+
+- (BOOL)_updateUserWithStatusUserInfo:(NSDictionary *)notificationUserInfo
+{
+	NSNumber *pidNumber = nil;
+	ISResourceUser *user = nil;
+	BOOL isNewUser = NO, conflictSetChanged = NO;
+	BOOL wasIndexed = NO;
+	ISResourceUserChanges changes = 0;
+	ISResourceMediatorResourceAccess previousActualAccess = kISResourceMediatorResourceAccessNone, previousPreferredAccess = kISResourceMediatorResourceAccessNone;
+	ISResourceMediatorAccessPressure previousAccessPressure = kISResourceMediatorAccessPressureNone;
+	
+	if (notificationUserInfo != nil)
+	{
+		if ((pidNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil)
+		{
+			@synchronized(self)
+			{
+				pid_t userPID = [pidNumber intValue];
+			
+				if ((user = [usersByPID objectForKey:@(userPID)]) == nil)
+				{
+					if ((user = [self _addUserForPID:userPID]) != nil)
+					{
+						user.isUsingResourceMediator = YES;
+
+						isNewUser = YES;
+					}
+				}
+				else
+				{
+					wasIndexed = [self _isIndexableUser:user];
+					previousActualAccess = user.actualAccess;
+					previousPreferredAccess = user.preferredAccess;
+					previousAccessPressure = user.accessPressure;
+
+					if (!user.isUsingResourceMediator)
+					{
+						user.isUsingResourceMediator = YES;
+						changes |= kISResourceUserChangeIsUsingResourceMediator;
+					}
+				}
+			}
+		}
+		
+		if ((user != nil) && (isNewUser ? [[notificationUserInfo objectForKey:kISResourceMediatorNotificationStatusDeltaKey] boolValue] : ![self _shouldApplyStatusUserInfo:notificationUserInfo fromUser:user]))
+		{
+			if (isNewUser)
+			{
+				// A delta only applies on top of a full status - which we don't have yet. Leave all fields unknown until it arrives.
+				[self _requestFullStatusFromUser:user];
+			}
+
+			@synchronized(self)
+			{
+				// isUsingResourceMediator may have changed
+				conflictSetChanged = [self _reindexUser:user wasIndexed:wasIndexed actualAccess:previousActualAccess preferredAccess:previousPreferredAccess accessPressure:previousAccessPressure] || isNewUser;
+			}
+
+			if (isNewUser)
+			{
+				[self _notifyDelegate:^{
+					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userAppeared:)]))
+					{
+						[delegate resourceMediator:self userAppeared:user];
+					}
+				}];
+			}
+			else
+			{
+				[self noteChanges:changes ofUser:user];
+			}
+
+			return (conflictSetChanged);
+		}
+
+		if (user != nil)
+		{
+			NSNumber *preferredAccessNumber = nil, *actualAccessNumber = nil, *accessPressureNumber = nil, *capabilitiesNumber = nil;
+			NSNumber *resourceCapacityNumber = nil, *slotCountNumber = nil;
+			BOOL slotsChanged = NO;
+
+			if (isNewUser)
+			{
+				[self _shouldApplyStatusUserInfo:notificationUserInfo fromUser:user];
+			}
+			
+			if ((preferredAccessNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPreferredAccessKey]) != nil)
+			{
+				if (user.preferredAccess != [preferredAccessNumber unsignedIntegerValue])
+				{
+					user.preferredAccess = [preferredAccessNumber unsignedIntegerValue];
+					changes |= kISResourceUserChangePreferredAccess;
+				}
+			}
+			
+			if ((actualAccessNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationActualAccessKey]) != nil)
+			{
+				if (user.actualAccess != [actualAccessNumber unsignedIntegerValue])
+				{
+					user.actualAccess = [actualAccessNumber unsignedIntegerValue];
+					changes |= kISResourceUserChangeActualAccess;
+				}
+			}
+			
+			if ((accessPressureNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessPressureKey]) != nil)
+			{
+				if (user.accessPressure != [accessPressureNumber unsignedIntegerValue])
+				{
+					user.accessPressure = [accessPressureNumber unsignedIntegerValue];
+					changes |= kISResourceUserChangeAccessPressure;
+				}
+			}
+
+			if ((capabilitiesNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationCapabilitiesKey]) != nil)
+			{
+				if (user.capabilities != (ISResourceMediatorCapabilities)[capabilitiesNumber unsignedIntegerValue])
+				{
+					user.capabilities = (ISResourceMediatorCapabilities)[capabilitiesNumber unsignedIntegerValue];
+					changes |= kISResourceUserChangeCapabilities;
+				}
+			}
+
+			if ((slotCountNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationSlotCountKey]) != nil)
+			{
+				if (user.slotCount != [slotCountNumber unsignedIntegerValue])
+				{
+					user.slotCount = [slotCountNumber unsignedIntegerValue];
+					changes |= kISResourceUserChangeSlotCount;
+
+					// Only slots in use change the number of free slots
+					slotsChanged = (user.actualAccess == kISResourceMediatorResourceAccessShared);
+				}
+			}
+			
+			@synchronized(self)
+			{
+				if ((resourceCapacityNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationResourceCapacityKey]) != nil)
+				{
+					if (user.resourceCapacity != [resourceCapacityNumber unsignedIntegerValue])
+					{
+						user.resourceCapacity = [resourceCapacityNumber unsignedIntegerValue];
+						changes |= kISResourceUserChangeResourceCapacity;
+
+						slotsChanged = [self _updateEffectiveResourceCapacity] || slotsChanged;
+					}
+				}
+
+				conflictSetChanged = [self _reindexUser:user wasIndexed:wasIndexed actualAccess:previousActualAccess preferredAccess:previousPreferredAccess accessPressure:previousAccessPressure] || isNewUser || slotsChanged;
+
+				if (conflictSetChanged && ![pendingResponse containsObject:user])
+				{
+					// Give users we gave up on (or that queued us) another chance
+					[accessRequestAttemptsByPID removeObjectForKey:@(user.pid)];
+					[queuedAtUsers removeObject:user];
+				}
+
+				if (isNewUser)
+				{
+					// The snapshot already contains the user - but not yet its status
+					usersGeneration++;
+				}
+			}
+
+			if ([self _updateBroadcastInfoOfUser:user withStatusUserInfo:notificationUserInfo] && !isNewUser)
+			{
+				NSDictionary *broadcastInfoDict = user.broadcastInfo;
+
+				changes |= kISResourceUserChangeBroadcastInfo;
+
+				[self _notifyDelegate:^{
+					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:user:updatedBroadcastInfo:)]))
+					{
+						[delegate resourceMediator:self user:user updatedBroadcastInfo:broadcastInfoDict];
+					}
+				}];
+			}
+			
+			if (isNewUser)
+			{
+				[self _notifyDelegate:^{
+					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userAppeared:)]))
+					{
+						[delegate resourceMediator:self userAppeared:user];
+					}
+				}];
+			}
+			else
+			{
+				// Nothing is reported for messages that didn't change anything
+				[self noteChanges:changes ofUser:user];
+			}
+		}
+	}
+
+	return (conflictSetChanged);
+}
+
+- (void)handleMediatorMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)notificationUserInfo peerFormat:(ISResourceMediatorWireFormat)peerFormat
+{
+	if ([self _dispatchToExecutionQueue:^{ [self handleMediatorMessage:messageType userInfo:notificationUserInfo peerFormat:peerFormat]; }])
+	{
+		return;
+	}
+
+	[metrics noteMessageReceived:messageType encodedLength:0]; // Bytes are counted by the hub, which decodes messages once for all mediators
+
+	[self _traceEvent:kISResourceMediatorTraceEventMessageReceived value:messageType userInfo:notificationUserInfo];
+
+	// Messages targeting other mediators have already been filtered out by the hub
+	if (notificationUserInfo != nil)
+	{
+		[self _notePeerWireFormat:peerFormat forPID:[notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]];
+	}
+
+	// Scan / Discovery
+	if (messageType == kISResourceMediatorMessageTypeScan)
+	{
+		NSNumber *scannerPIDNumber;
+
+		if (((scannerPIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil) &&
+		    ([notificationUserInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoHashKey] != nil))
+		{
+			// Fetch of our broadcastInfo
+			[self _postBroadcastInfoToPID:scannerPIDNumber];
+		}
+		else
+		{
+			// Return information on current and desired usage
+			[self _postStatusNotificationWithScanEpoch:[notificationUserInfo objectForKey:kISResourceMediatorNotificationScanEpochKey]];
+		}
+	}
+
+	// Status updates
+	if (messageType == kISResourceMediatorMessageTypeStatus)
+	{
+		BOOL conflictSetChanged = [self _updateUserWithStatusUserInfo:notificationUserInfo];
+		BOOL discoveryCompleted = [self _noteDiscoveryReply:notificationUserInfo];
+		BOOL multicastAccessRequestCompleted = [self _noteMulticastAccessRequestCommitStatus:notificationUserInfo];
+		BOOL leaseReturned = [self _noteLeaseReturnWithStatusUserInfo:notificationUserInfo];
+
+		// Updates that don't affect whom to ask for access can't change the outcome of arbitration
+		if ((conflictSetChanged || discoveryCompleted || leaseReturned) && !multicastAccessRequestCompleted)
+		{
+			[self considerRequestingAccess];
+		}
+	}
+	
+	// Access request
+	if (messageType == kISResourceMediatorMessageTypeAccessRequest)
+	{
+		NSNumber *sourceUserPIDNumber = nil, *requestIDNumber = nil;
+		ISResourceMediatorAccessPressure sourceAccessPressure = kISResourceMediatorAccessPressureNone;
+		NSTimeInterval sourceAccessStartTime = 0;
+	
+		sourceAccessPressure = [[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessPressureKey] unsignedIntegerValue];
+		sourceAccessStartTime = [[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessStartTimeKey] doubleValue];
+		requestIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessRequestIDKey];
+
+		// Leases we grant need to be newer than any the requester knows about
+		[self _noteLeaseEpoch:[[notificationUserInfo objectForKey:kISResourceMediatorNotificationLeaseEpochKey] unsignedLongLongValue]];
+		
+		if ((sourceUserPIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil)
+		{
+			ISResourceUser *sourceUser = nil;
+		
+			if ((sourceUser = [self resourceUserForPID:[sourceUserPIDNumber intValue] createIfNotExists:YES]) != nil)
+			{
+				NSNumber *slotCountNumber;
+				BOOL conflictSetChanged = NO;
+
+				if ((slotCountNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationSlotCountKey]) != nil)
+				{
+					BOOL isUsingResourceMediator;
+
+					@synchronized(self)
+					{
+						if (!(isUsingResourceMediator = sourceUser.isUsingResourceMediator))
+						{
+							// The request overtook the requester's first [STATUS]. Users not (yet) known to use a mediator aren't indexed,
+							// so stash the slotCount on the user - where it takes effect once that [STATUS] arrives - without making it one.
+							sourceUser.slotCount = [slotCountNumber unsignedIntegerValue];
+						}
+					}
+
+					if (isUsingResourceMediator)
+					{
+						// Apply the slotCount like a [STATUS] carrying only that
+						conflictSetChanged = [self _updateUserWithStatusUserInfo:@{
+							kISResourceMediatorNotificationPIDKey		: sourceUserPIDNumber,
+							kISResourceMediatorNotificationSlotCountKey	: slotCountNumber,
+						}];
+					}
+				}
+
+				if (requestIDNumber != nil)
+				{
+					// Multicast access request
+					[self _handleMulticastAccessRequestFromUser:sourceUser
+									  requestID:[requestIDNumber unsignedLongLongValue]
+									      phase:[[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessRequestPhaseKey] unsignedIntegerValue]
+								     accessPressure:sourceAccessPressure
+								    accessStartTime:sourceAccessStartTime];
+				}
+				else if ([self _shouldDenyAccessRequestFromUser:sourceUser accessPressure:sourceAccessPressure accessStartTime:sourceAccessStartTime])
+				{
+					// Queue the requester, so it gets access once we're done - instead of asking again and again
+					NSUInteger waiterPosition = [self _queueWaiter:sourceUser accessPressure:sourceAccessPressure accessStartTime:sourceAccessStartTime];
+
+					[self _respondToAccessRequestFromUser:sourceUser withResult:kISResourceMediatorResultDeny requestID:0 phase:0 leaseEpoch:0 waiterPosition:waiterPosition];
+				}
+				else
+				{
+					// Try providing access to apps with the same or a higher access pressure level
+					[self _relinquishAccessToUser:sourceUser requestID:0 phase:0];
+				}
+
+				if (conflictSetChanged)
+				{
+					// The requester's [STATUS] won't change the slot count anymore
+					[self considerRequestingAccess];
+				}
+			}
+		}
+	}
+
+	// Access response
+	if (messageType == kISResourceMediatorMessageTypeAccessResponse)
+	{
+		NSNumber *sourceUserPIDNumber = nil;
+		NSNumber *resultNumber = nil;
+	
+		if (((sourceUserPIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil) &&
+		    ((resultNumber	  = [notificationUserInfo objectForKey:kISResourceMediatorNotificationResultKey]) != nil))
+		{
+			ISResourceUser *sourceUser = nil;
+		
+			if ((sourceUser = [self resourceUserForPID:[sourceUserPIDNumber intValue] createIfNotExists:NO]) != nil)
+			{
+				ISResourceMediatorResult result = [resultNumber unsignedIntegerValue];
+				ISResourceMediatorResourceAccess thePreferredAccess = self.preferredAccess;
+				NSTimeInterval responseTime = [self _currentTime], requestTime = 0;
+				NSNumber *requestIDNumber, *leaseEpochNumber;
+				BOOL wasPending = NO, wasQueued = NO, isStaleLease = NO;
+
+				if ((requestIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessRequestIDKey]) != nil)
+				{
+					// Response to a multicast access request
+					[self _handleMulticastAccessResponseFromUser:sourceUser
+									   requestID:[requestIDNumber unsignedLongLongValue]
+									       phase:[[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessRequestPhaseKey] unsignedIntegerValue]
+									      result:result
+									   viaStatus:NO];
+					return;
+				}
+
+				leaseEpochNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationLeaseEpochKey];
+
+				@synchronized(self)
+				{
+					if ((leaseEpochNumber != nil) && ([leaseEpochNumber unsignedLongLongValue] <= [[accessRequestLeaseEpochsByPID objectForKey:sourceUserPIDNumber] unsignedLongLongValue]))
+					{
+						// Granted before our pending request was sent
+						isStaleLease = YES;
+					}
+					else
+					{
+						if ((wasPending = [pendingResponse containsObject:sourceUser]) == YES)
+						{
+							[pendingResponse removeObject:sourceUser];
+
+							requestTime = [[accessRequestTimesByPID objectForKey:sourceUserPIDNumber] doubleValue];
+						}
+						else if ([queuedAtUsers containsObject:sourceUser])
+						{
+							// Access granted by a holder that queued our request
+							[queuedAtUsers removeObject:sourceUser];
+
+							wasPending = wasQueued = YES;
+						}
+
+						[accessRequestAttemptsByPID removeObjectForKey:sourceUserPIDNumber];
+						[accessRequestTimesByPID removeObjectForKey:sourceUserPIDNumber];
+						[accessRequestLeaseEpochsByPID removeObjectForKey:sourceUserPIDNumber];
+					}
+
+					[self _noteLeaseEpoch:[leaseEpochNumber unsignedLongLongValue]];
+				}
+
+				if (isStaleLease)
+				{
+					// Reject the stale lease by handing it straight back - and keep waiting for the response to the pending request
+					if (result == kISResourceMediatorResultSuccess)
+					{
+						[self _postLeaseReturnToUser:sourceUser epoch:[leaseEpochNumber unsignedLongLongValue]];
+					}
+					return;
+				}
+
+				[self.deadlineScheduler cancelDeadlineForKey:sourceUserPIDNumber];
+
+				if (!wasPending)
+				{
+					// Response to a request that timed out or was cancelled. If the user released access, its [STATUS] triggers a new arbitration.
+					return;
+				}
+
+				if (requestTime != 0)
+				{
+					[metrics noteDuration:(responseTime - requestTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffRequestToResponse];
+				}
+
+				@synchronized(self)
+				{
+					if ((result == kISResourceMediatorResultDeny) && !wasQueued && ([notificationUserInfo objectForKey:kISResourceMediatorNotificationWaiterPositionKey] != nil))
+					{
+						// Don't ask again, but wait for the holder to grant access
+						[queuedAtUsers addObject:sourceUser];
+					}
+
+					if (result == kISResourceMediatorResultSuccess)
+					{
+						// Access a holder released to us as its first waiter isn't lent - there's no lease to hand back
+						if (!wasQueued || (leaseEpochNumber != nil))
+						{
+							[borrowedLease release];
+							borrowedLease = [[ISResourceMediatorLease alloc] initWithUser:sourceUser epoch:[leaseEpochNumber unsignedLongLongValue]];
+						}
+						
+						if (lendingUser == sourceUser)
+						{
+							lendingUserFromPreferredAccess = kISResourceMediatorResourceAccessNone;
+							lendingUserFromAccessPressure = kISResourceMediatorAccessPressureNone;
+							[lendingUser release];
+							lendingUser = nil;
+						}
+					}
+				}
+
+				// Call delegate outside the critical section
+				[self _notifyDelegate:^{
+					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:user:respondedToAccessRequestWith:)]))
+					{
+						[delegate resourceMediator:self	user:sourceUser	respondedToAccessRequestWith:result];
+					}
+				}];
+
+				if (result == kISResourceMediatorResultSuccess)
+				{
+					[self setApplicationAccessForResource:thePreferredAccess requestedBy:sourceUser completion:^(ISResourceMediatorResult result) {
+						if (result == kISResourceMediatorResultSuccess)
+						{
+							NSTimeInterval accessTime = [self _currentTime];
+
+							[metrics noteDuration:(accessTime - responseTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffResponseToAccess];
+
+							if (requestTime != 0)
+							{
+								[metrics noteDuration:(accessTime - requestTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffTotal];
+							}
+
+							self.actualAccess = thePreferredAccess;
+						}
+						else if (leaseEpochNumber != nil)
+						{
+							// Couldn't make use of the lease - hand it back right away, so the lender doesn't wait for it
+							[self _returnBorrowedLease];
+						}
+
+						if (leaseEpochNumber == nil)
+						{
+							[self _postMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+								kISResourceMediatorNotificationPIDKey			: @(self.pid),
+								kISResourceMediatorNotificationTargetPIDKey		: sourceUserPIDNumber,
+
+								kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+							}];
+						}
+					}];
+				}
+			}
+		}
+	}
+}
+
+- (void)postStatusNotification
+{
+	@synchronized(self)
+	{
+		if (active && !statusFlushScheduled)
+		{
+			// Coalesce all changes made until the flush into a single [STATUS]
+			statusFlushScheduled = YES;
+
+			[self.deadlineScheduler scheduleAfter:statusCoalescingInterval forKey:kISResourceMediatorStatusFlushDeadlineKey handler:^{
+				[self _flushStatusNotification];
+			}];
+		}
+	}
+}
+
+- (void)_noteBroadcastStatus
+{
+	hasBroadcastStatus = YES;
+
+	broadcastPreferredAccess = preferredAccess;
+	broadcastActualAccess = actualAccess;
+	broadcastAccessPressure = accessPressure;
+	broadcastResourceCapacity = resourceCapacity;
+	broadcastSlotCount = slotCount;
+	broadcastBroadcastInfoHash = broadcastInfoHash;
+}
+
+- (void)_flushStatusNotification
+{
+	@synchronized(self)
+	{
+		statusFlushScheduled = NO;
+
+		if (active && (statusNotificationsSuspended==0))
+		{
+			NSMutableDictionary *statusUserInfo;
+
+			if (!hasBroadcastStatus)
+			{
+				[self _postStatusNotificationWithScanEpoch:nil];
+				return;
+			}
+
+			[self _publishToStatusTable];
+
+			// Only send what changed since the last [STATUS]
+			statusUserInfo = [NSMutableDictionary dictionary];
+
+			if (preferredAccess != broadcastPreferredAccess)
+			{
+				[statusUserInfo setObject:@(preferredAccess) forKey:kISResourceMediatorNotificationPreferredAccessKey];
+			}
+
+			if (actualAccess != broadcastActualAccess)
+			{
+				[statusUserInfo setObject:@(actualAccess) forKey:kISResourceMediatorNotificationActualAccessKey];
+			}
+
+			if (accessPressure != broadcastAccessPressure)
+			{
+				[statusUserInfo setObject:@(accessPressure) forKey:kISResourceMediatorNotificationAccessPressureKey];
+			}
+
+			if (resourceCapacity != broadcastResourceCapacity)
+			{
+				[statusUserInfo setObject:@(resourceCapacity) forKey:kISResourceMediatorNotificationResourceCapacityKey];
+			}
+
+			if (slotCount != broadcastSlotCount)
+			{
+				[statusUserInfo setObject:@(slotCount) forKey:kISResourceMediatorNotificationSlotCountKey];
+			}
+
+			if (broadcastInfoHash != broadcastBroadcastInfoHash)
+			{
+				[statusUserInfo setObject:@(broadcastInfoHash) forKey:kISResourceMediatorNotificationBroadcastInfoHashKey];
+
+				if ([self _usersNeedBroadcastInfo])
+				{
+					[statusUserInfo setObject:((broadcastInfo!=nil) ? broadcastInfo : @"") forKey:kISResourceMediatorNotificationBroadcastInfoKey];
+				}
+			}
+
+			if (statusUserInfo.count == 0)
+			{
+				return;
+			}
+
+			statusSequence++;
+
+			[statusUserInfo addEntriesFromDictionary:@{
+				kISResourceMediatorNotificationPIDKey			: @(pid),
+				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+
+				kISResourceMediatorNotificationStatusSequenceKey	: @(statusSequence),
+				kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+			}];
+
+			[self _noteBroadcastStatus];
+
+			[self _postMessage:kISResourceMediatorMessageTypeStatus userInfo:statusUserInfo];
+		}
+	}
+}
+
+- (void)_postStatusNotificationWithScanEpoch:(NSNumber *)replyToScanEpoch
+{
+	@synchronized(self)
+	{
+		if (active && (statusNotificationsSuspended==0))
+		{
+			NSMutableDictionary *statusUserInfo;
+
+			[self _publishToStatusTable];
+
+			statusSequence++;
+
+			statusUserInfo = [NSMutableDictionary dictionaryWithDictionary:@{
+				kISResourceMediatorNotificationPIDKey			: @(pid),
+
+				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+				kISResourceMediatorNotificationPreferredAccessKey	: @(self.preferredAccess),
+				kISResourceMediatorNotificationActualAccessKey		: @(self.actualAccess),
+				kISResourceMediatorNotificationAccessPressureKey	: @(self.accessPressure),
+
+				kISResourceMediatorNotificationBroadcastInfoKey		: ((broadcastInfo!=nil) ? broadcastInfo : @""),
+				kISResourceMediatorNotificationBroadcastInfoHashKey	: @(broadcastInfoHash),
+
+				kISResourceMediatorNotificationCapabilitiesKey		: @(kISResourceMediatorCapabilities),
+
+				kISResourceMediatorNotificationStatusSequenceKey	: @(statusSequence),
+			}];
+
+			if (resourceCapacity != 0)
+			{
+				// Only needed for counted resources
+				[statusUserInfo setObject:@(resourceCapacity) forKey:kISResourceMediatorNotificationResourceCapacityKey];
+				[statusUserInfo setObject:@(slotCount) forKey:kISResourceMediatorNotificationSlotCountKey];
+			}
+
+			if (replyToScanEpoch != nil)
+			{
+				[statusUserInfo setObject:replyToScanEpoch forKey:kISResourceMediatorNotificationScanEpochKey];
+			}
+
+			[self _noteBroadcastStatus];
+
+			[self _postMessage:kISResourceMediatorMessageTypeStatus userInfo:statusUserInfo];
+		}
+	}
+}
+
+- (void)setBroadcastInfo:(NSDictionary *)newBroadcastInfo
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setBroadcastInfo:newBroadcastInfo]; }])
+	{
+		return;
+	}
+
+	@synchronized(self)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationBroadcastInfoKey : ((newBroadcastInfo!=nil) ? newBroadcastInfo : @"") }];
+
+		[newBroadcastInfo retain];
+		[broadcastInfo autorelease];
+		broadcastInfo = newBroadcastInfo;
+
+		broadcastInfoHash = [ISResourceMediatorCodec contentHashOfPropertyList:broadcastInfo];
+		
+		[self postStatusNotification];
+	}
+}
+
+#pragma mark - Broadcast info
+- (BOOL)_usersNeedBroadcastInfo
+{
+	// Call only from within @synchronized(self)
+	// Mediators that don't understand hashes can't fetch broadcastInfo - it has to be sent along
+	for (ISResourceUser *user in users)
+	{
+		if (user.isUsingResourceMediator && ((user.capabilities & kISResourceMediatorCapabilityBroadcastInfoHash) == 0))
+		{
+			return (YES);
+		}
+	}
+
+	return (NO);
+}
+
+- (void)_postBroadcastInfoToPID:(NSNumber *)targetPIDNumber
+{
+	NSDictionary *statusUserInfo = nil;
+
+	@synchronized(self)
+	{
+		if (active && (statusNotificationsSuspended==0))
+		{
+			// No sequence number: applies independently of the [STATUS] sequence and doesn't change it
+			statusUserInfo = @{
+				kISResourceMediatorNotificationPIDKey			: @(pid),
+				kISResourceMediatorNotificationTargetPIDKey		: targetPIDNumber,
+
+				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+
+				kISResourceMediatorNotificationBroadcastInfoKey		: ((broadcastInfo!=nil) ? broadcastInfo : @""),
+				kISResourceMediatorNotificationBroadcastInfoHashKey	: @(broadcastInfoHash),
+			};
+		}
+	}
+
+	if (statusUserInfo != nil)
+	{
+		[self _postMessage:kISResourceMediatorMessageTypeStatus userInfo:statusUserInfo];
+	}
+}
+
+- (BOOL)_updateBroadcastInfoOfUser:(ISResourceUser *)user withStatusUserInfo:(NSDictionary *)statusUserInfo
+{
+	// Returns YES if the broadcastInfo of user changed
+	id broadcastInfoObject = [statusUserInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoKey];
+	NSNumber *hashNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoHashKey];
+	NSDictionary *newBroadcastInfo = nil;
+	NSNumber *userPIDNumber = @(user.pid);
+	uint64_t hash;
+	BOOL fetch = NO;
+
+	if ((broadcastInfoObject == nil) && (hashNumber == nil))
+	{
+		return (NO);
+	}
+
+	if (broadcastInfoObject != nil)
+	{
+		newBroadcastInfo = [broadcastInfoObject isKindOfClass:[NSDictionary class]] ? broadcastInfoObject : nil;
+
+		// Peers predating hashes only send broadcastInfo
+		hash = (hashNumber != nil) ? hashNumber.unsignedLongLongValue : [ISResourceMediatorCodec contentHashOfPropertyList:newBroadcastInfo];
+	}
+	else
+	{
+		hash = hashNumber.unsignedLongLongValue;
+	}
+
+	@synchronized(self)
+	{
+		if (hash == user.broadcastInfoHash)
+		{
+			[broadcastInfoFetchHashesByPID removeObjectForKey:userPIDNumber];
+			return (NO);
+		}
+
+		if ((broadcastInfoObject == nil) && (hash != 0) && ((newBroadcastInfo = [broadcastInfoCache objectForKey:@(hash)]) == nil))
+		{
+			// Unknown broadcastInfo: fetch it. Deltas announcing a hash we already asked for don't ask again - full [STATUS] messages do, in case the reply got lost.
+			if (([[broadcastInfoFetchHashesByPID objectForKey:userPIDNumber] unsignedLongLongValue] != hash) || ![[statusUserInfo objectForKey:kISResourceMediatorNotificationStatusDeltaKey] boolValue])
+			{
+				[broadcastInfoFetchHashesByPID setObject:@(hash) forKey:userPIDNumber];
+				fetch = YES;
+			}
+		}
+		else
+		{
+			user.broadcastInfo = newBroadcastInfo;
+			user.broadcastInfoHash = hash;
+
+			[broadcastInfoFetchHashesByPID removeObjectForKey:userPIDNumber];
+
+			if (newBroadcastInfo != nil)
+			{
+				if (broadcastInfoCache.count >= kISResourceMediatorBroadcastInfoCacheLimit)
+				{
+					[broadcastInfoCache removeAllObjects];
+				}
+
+				[broadcastInfoCache setObject:newBroadcastInfo forKey:@(hash)];
+			}
+		}
+	}
+
+	if (fetch)
+	{
+		[self _postMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+			kISResourceMediatorNotificationPIDKey			: @(self.pid),
+			kISResourceMediatorNotificationTargetPIDKey		: userPIDNumber,
+
+			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+
+			kISResourceMediatorNotificationBroadcastInfoHashKey	: @(hash),
+		}];
+	}
+
+	return (!fetch);
+}
+
+#pragma mark - Discovery
+- (void)_beginDiscoveryWaitingForReplies:(BOOL)waitForReplies
+{
+	@synchronized(self)
+	{
+		scanEpoch = (((uint64_t)(uint32_t)pid) << 32) | (uint64_t)(++scanCount);
+		scanStartTime = [self _currentTime];
+
+		hasCompletedDiscovery = NO;
+
+		[pendingDiscoveryPIDs removeAllObjects];
+
+		if (waitForReplies)
+		{
+			// Expect replies from every peer known to the hub and every known user
+			[pendingDiscoveryPIDs unionSet:[hub knownPeerPIDsForResourceIdentifier:resourceIdentifier]];
+
+			for (ISResourceUser *user in users)
+			{
+				if (user.isUsingResourceMediator)
+				{
+					[pendingDiscoveryPIDs addObject:@(user.pid)];
+				}
+			}
+
+			[pendingDiscoveryPIDs removeObject:@(pid)];
+
+			discoveryInProgress = YES;
+		}
+	}
+
+	// Unknown peers may exist, too - so always wait for the adaptive timeout, unless all known peers answer earlier. Without waiting
+	// for replies, the timeout still marks the point by which peers answering the [SCAN] have revealed their wire format.
+	[self _scheduleDiscoveryTimeoutAfter:hub.discoveryTimeout];
+}
+
+- (void)_scheduleDiscoveryTimeoutAfter:(NSTimeInterval)delay
+{
+	[self.deadlineScheduler scheduleAfter:delay forKey:kISResourceMediatorDiscoveryTimeoutDeadlineKey handler:^{
+		BOOL isDiscovering;
+
+		@synchronized(self)
+		{
+			isDiscovering = discoveryInProgress;
+		}
+
+		if (isDiscovering)
+		{
+			[self _discoveryTimedOut];
+		}
+		else
+		{
+			@synchronized(self)
+			{
+				hasCompletedDiscovery = active;
+			}
+		}
+	}];
+}
+
+- (BOOL)_noteDiscoveryReply:(NSDictionary *)statusUserInfo
+{
+	NSNumber *peerPIDNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationPIDKey];
+	NSNumber *replyScanEpochNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationScanEpochKey];
+	BOOL discoveryCompleted = NO;
+
+	if (peerPIDNumber == nil)
+	{
+		return (NO);
+	}
+
+	@synchronized(self)
+	{
+		if (replyScanEpochNumber != nil)
+		{
+			if (replyScanEpochNumber.unsignedLongLongValue != scanEpoch)
+			{
+				// Reply to an earlier [SCAN] or to the [SCAN] of another mediator
+				return (NO);
+			}
+
+			[hub noteDiscoveryLatency:([self _currentTime] - scanStartTime)];
+		}
+		else if ([[statusUserInfo objectForKey:kISResourceMediatorNotificationStatusDeltaKey] boolValue] ||
+			 ([statusUserInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey] != nil) ||
+			 (([statusUserInfo objectForKey:kISResourceMediatorNotificationStatusSequenceKey] == nil) && ([statusUserInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoHashKey] != nil)))
+		{
+			// Deltas, lease returns and broadcastInfo fetch replies aren't replies to a [SCAN] - only peers that know scan epochs send them, and those echo the epoch in their reply
+			return (NO);
+		}
+
+		// Peers predating scan epochs reply with a full [STATUS] without one
+		if (discoveryInProgress && [pendingDiscoveryPIDs containsObject:peerPIDNumber])
+		{
+			[pendingDiscoveryPIDs removeObject:peerPIDNumber];
+
+			discoveryCompleted = (pendingDiscoveryPIDs.count == 0);
+		}
+	}
+
+	if (discoveryCompleted)
+	{
+		[self _endDiscovery];
+	}
+
+	return (discoveryCompleted);
+}
+
+- (void)_discoveryTimedOut
+{
+	NSSet <NSNumber *> *unresponsivePeerPIDs = nil;
+
+	@synchronized(self)
+	{
+		unresponsivePeerPIDs = [[pendingDiscoveryPIDs copy] autorelease];
+	}
+
+	// Don't wait for peers that didn't answer in time on the next activation
+	if (unresponsivePeerPIDs.count > 0)
+	{
+		[hub forgetPeerPIDs:unresponsivePeerPIDs forResourceIdentifier:resourceIdentifier];
+	}
+
+	[self _endDiscovery];
+
+	[self considerRequestingAccess];
+}
+
+- (void)_endDiscovery
+{
+	@synchronized(self)
+	{
+		discoveryInProgress = NO;
+		hasCompletedDiscovery = active;
+
+		[pendingDiscoveryPIDs removeAllObjects];
+
+		[deadlineScheduler cancelDeadlineForKey:kISResourceMediatorDiscoveryTimeoutDeadlineKey];
+	}
+}
+
+#pragma mark - Status table
+- (void)_publishToStatusTable
+{
+	if (statusTable != nil)
+	{
+		ISResourceMediatorStatusTableEntry entry = {
+			.pid		 = pid,
+
+			.preferredAccess = (uint8_t)preferredAccess,
+			.actualAccess	 = (uint8_t)actualAccess,
+			.accessPressure	 = (uint8_t)accessPressure,
+
+			.resourceCapacity = (uint16_t)MIN(resourceCapacity, UINT16_MAX),
+			.slotCount	  = (uint16_t)MIN(slotCount, UINT16_MAX),
+
+			.accessStartTime = accessStartTime
+		};
+
+		[statusTable writeEntry:&entry];
+	}
+}
+
+- (BOOL)_readStatusTable
+{
+	ISResourceMediatorStatusTableEntry entries[kISResourceMediatorStatusTableSlotCount];
+	NSUInteger entryCount;
+
+	if (statusTable == nil)
+	{
+		return (NO);
+	}
+
+	// Free slots of crashed processes, then claim our own slot
+	[statusTable reclaimStaleSlots];
+
+	if (![statusTable claimSlotForPID:pid])
+	{
+		NSLog(@"No free slot in status table for %@ - falling back to discovery via [SCAN]", resourceIdentifier);
+		return (NO);
+	}
+
+	@synchronized(self)
+	{
+		[self _publishToStatusTable];
+	}
+
+	entryCount = [statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount];
+
+	for (NSUInteger idx=0; idx < entryCount; idx++)
+	{
+		if (entries[idx].pid != pid)
+		{
+			[self _updateUserWithStatusUserInfo:@{
+				kISResourceMediatorNotificationPIDKey			: @(entries[idx].pid),
+
+				kISResourceMediatorNotificationPreferredAccessKey	: @(entries[idx].preferredAccess),
+				kISResourceMediatorNotificationActualAccessKey		: @(entries[idx].actualAccess),
+				kISResourceMediatorNotificationAccessPressureKey	: @(entries[idx].accessPressure),
+
+				kISResourceMediatorNotificationResourceCapacityKey	: @(entries[idx].resourceCapacity),
+				kISResourceMediatorNotificationSlotCountKey		: @(entries[idx].slotCount),
+			}];
+		}
+	}
+
+	return (YES);
+}
+
+#pragma mark - User administration
+- (ISResourceUser *)newUser
+{
+	return ([[ISResourceUser alloc] init]);
+}
+
+- (ISResourceUser *)_addUserForPID:(pid_t)userPID
+{
+	ISResourceUser *user = nil;
+
+	@synchronized(self)
+	{
+		if (userPID != self.pid)
+		{
+			if ((user = [self newUser]) != nil)
+			{
+				user.pid = userPID;
+#if ISRESOURCEMEDIATOR_APPKIT
+				user.runningApplication = [NSRunningApplication runningApplicationWithProcessIdentifier:userPID];
+#endif /* ISRESOURCEMEDIATOR_APPKIT */
+
+				// Covers all processes, not just applications
+				[processWatcher addObserver:self forPID:userPID];
+			
+				[users addObject:user];
+				[usersByPID setObject:user forKey:@(user.pid)];
+
+				[self _usersChanged];
+				
+				[user autorelease];
+			}
+		}
+	}
+	
+	return (user);
+}
+
+- (void)_removeUser:(ISResourceUser *)user
+{
+	@synchronized(self)
+	{
+		[processWatcher removeObserver:self forPID:user.pid];
+		
+		[self _unindexUser:user actualAccess:user.actualAccess accessPressure:user.accessPressure];
+
+		[pendingResponse removeObject:user];
+		[accessRequestAttemptsByPID removeObjectForKey:@(user.pid)];
+		[accessRequestTimesByPID removeObjectForKey:@(user.pid)];
+		[accessRequestLeaseEpochsByPID removeObjectForKey:@(user.pid)];
+		[deadlineScheduler cancelDeadlineForKey:@(user.pid)];
+
+		[queuedAtUsers removeObject:user];
+		[self _removeWaiterForUser:user];
+
+		if (borrowedLease.user == user)
+		{
+			// The lender is gone - the access is ours now
+			[borrowedLease release];
+			borrowedLease = nil;
+		}
+
+		if (lentLease.user == user)
+		{
+			// The borrower is gone - it won't hand the lease back
+			[lentLease release];
+			lentLease = nil;
+		}
+
+		if ([multicastAccessRequest.users containsObject:user])
+		{
+			ISResourceMediatorMulticastAccessRequest *request = multicastAccessRequest;
+
+			// Don't wait for a response that won't come - restart the request without the user
+			[deadlineScheduler scheduleAfter:0.0 forKey:kISResourceMediatorMulticastAccessRequestDeadlineKey handler:^{
+				[self _multicastAccessRequestTimedOut:request];
+			}];
+		}
+
+		if ([accessReservedForPID isEqual:@(user.pid)])
+		{
+			[self _releaseAccessReservation];
+		}
+
+		if ([pendingDiscoveryPIDs containsObject:@(user.pid)])
+		{
+			[pendingDiscoveryPIDs removeObject:@(user.pid)];
+
+			if (discoveryInProgress && (pendingDiscoveryPIDs.count == 0))
+			{
+				// The last peer we waited for terminated
+				[self _scheduleDiscoveryTimeoutAfter:0.0];
+			}
+		}
+
+		[propertyListPeerPIDs removeObject:@(user.pid)];
+		[binaryPeerPIDs removeObject:@(user.pid)];
+		[broadcastInfoFetchHashesByPID removeObjectForKey:@(user.pid)];
+		[pendingUserChangesByPID removeObjectForKey:@(user.pid)];
+		
+		[users removeObject:user];
+		[usersByPID removeObjectForKey:@(user.pid)];
+
+		[self _usersChanged];
+
+		if (user.resourceCapacity != 0)
+		{
+			[self _updateEffectiveResourceCapacity];
+		}
+	}
+}
+
+- (ISResourceUser *)resourceUserForPID:(pid_t)userPID createIfNotExists:(BOOL)createIfNotExists
+{
+	ISResourceUser *user = nil;
+	BOOL isNewUser = NO;
+
+	@synchronized(self)
+	{
+		if ((user = [usersByPID objectForKey:@(userPID)]) == nil)
+		{
+			if (createIfNotExists)
+			{
+				isNewUser = ((user = [self _addUserForPID:userPID]) != nil);
+			}
+		}
+
+		[[user retain] autorelease];
+	}
+
+	if (isNewUser)
+	{
+		[self _notifyDelegate:^{
+			if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userAppeared:)]))
+			{
+				[delegate resourceMediator:self userAppeared:user];
+			}
+		}];
+	}
+	
+	return (user);
+}
+
+- (void)userTerminated:(ISResourceUser *)user
+{
+	BOOL affectsArbitration;
+
+	if ([self _dispatchToExecutionQueue:^{ [self userTerminated:user]; }])
+	{
+		return;
+	}
+
+	[user retain];
+
+	@synchronized(self)
+	{
+		// Only holders and users we're waiting for can change the outcome of arbitration
+		affectsArbitration = [self _isIndexableUser:user] || [pendingResponse containsObject:user];
+	}
+
+	[self _removeUser:user];
+
+	[hub forgetPeerPIDs:[NSSet setWithObject:@(user.pid)] forResourceIdentifier:resourceIdentifier];
+
+	[self _notifyDelegate:^{
+		if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userDisappeared:)]))
+		{
+			[delegate resourceMediator:self userDisappeared:user];
+		}
+	}];
+
+	[user release];
+	
+	if (affectsArbitration)
+	{
+		[self considerRequestingAccess];
+	}
+}
+
+- (NSMutableArray *)users
+{
+	return ([NSMutableArray arrayWithArray:self.usersSnapshot]);
+}
+
+- (void)_usersChanged
+{
+	// Called with the lock held. Readers holding the previous snapshot keep it unchanged.
+	self.usersSnapshot = [NSArray arrayWithArray:users];
+	usersGeneration++;
+}
+
+#pragma mark - User changes
+- (void)noteChanges:(ISResourceUserChanges)changes ofUser:(ISResourceUser *)user
+{
+	if ((changes == 0) || (user == nil))
+	{
+		return;
+	}
+
+	@synchronized(self)
+	{
+		NSNumber *userPIDNumber = @(user.pid);
+
+		usersGeneration++;
+
+		if ([usersByPID objectForKey:userPIDNumber] != user)
+		{
+			// Removed meanwhile
+			return;
+		}
+
+		if (pendingUserChangesByPID.count == 0)
+		{
+			// Report all changes made until the flush with one call per user
+			[self.deadlineScheduler scheduleAfter:0.0 forKey:kISResourceMediatorUserChangesDeadlineKey handler:^{
+				[self _flushUserChanges];
+			}];
+		}
+
+		[pendingUserChangesByPID setObject:@([[pendingUserChangesByPID objectForKey:userPIDNumber] unsignedIntegerValue] | changes) forKey:userPIDNumber];
+	}
+}
+
+- (void)_flushUserChanges
+{
+	NSDictionary <NSNumber *, NSNumber *> *userChangesByPID = nil;
+
+	@synchronized(self)
+	{
+		userChangesByPID = [[pendingUserChangesByPID copy] autorelease];
+		[pendingUserChangesByPID removeAllObjects];
+	}
+
+	// In the order users appeared
+	for (ISResourceUser *user in self.usersSnapshot)
+	{
+		NSNumber *changesNumber;
+
+		if ((changesNumber = [userChangesByPID objectForKey:@(user.pid)]) != nil)
+		{
+			ISResourceUserChanges changes = [changesNumber unsignedIntegerValue];
+
+			[self _notifyDelegate:^{
+				if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userUpdated:changes:)]))
+				{
+					[delegate resourceMediator:self userUpdated:user changes:changes];
+				}
+				else if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userUpdated:)]))
+				{
+					[delegate resourceMediator:self userUpdated:user];
+				}
+			}];
+		}
+	}
+}
+
+#pragma mark - Process exit
+- (void)setProcessWatcher:(ISResourceMediatorProcessWatcher *)newProcessWatcher
+{
+	ISResourceMediatorProcessWatcher *oldProcessWatcher = nil;
+
+	@synchronized(self)
+	{
+		if (processWatcher != newProcessWatcher)
+		{
+			oldProcessWatcher = processWatcher;
+			processWatcher = [newProcessWatcher retain];
+
+			for (ISResourceUser *user in users)
+			{
+				[processWatcher addObserver:self forPID:user.pid];
+			}
+		}
+	}
+
+	// Outside the lock, as this waits for notifications in progress - which may be waiting for the lock
+	[oldProcessWatcher removeObserver:self];
+	[oldProcessWatcher release];
+}
+
+- (void)processWatcher:(ISResourceMediatorProcessWatcher *)aProcessWatcher processDidExit:(pid_t)exitedPID
+{
+	ISResourceUser *user;
+
+	if ((user = [self resourceUserForPID:exitedPID createIfNotExists:NO]) != nil)
+	{
+		[self userTerminated:user];
+	}
+}
+
+#pragma mark - Holder indexes
+- (BOOL)_isIndexableUser:(ISResourceUser *)user
+{
+	return (user.isUsingResourceMediator && (user.pid != pid) && (user.actualAccess != kISResourceMediatorResourceAccessNone) && (user.actualAccess < kISResourceMediatorResourceAccessCount));
+}
+
+- (void)_indexUser:(ISResourceUser *)user
+{
+	if ([self _isIndexableUser:user])
+	{
+		NSMutableArray <ISResourceUser *> *holders = holdersByActualAccess[user.actualAccess];
+
+		[holders insertObject:user atIndex:ISResourceMediatorHolderIndexForAccessPressure(holders, user.accessPressure)];
+	}
+}
+
+- (void)_unindexUser:(ISResourceUser *)user actualAccess:(ISResourceMediatorResourceAccess)indexedActualAccess accessPressure:(ISResourceMediatorAccessPressure)indexedAccessPressure
+{
+	if ((indexedActualAccess != kISResourceMediatorResourceAccessNone) && (indexedActualAccess < kISResourceMediatorResourceAccessCount))
+	{
+		NSMutableArray <ISResourceUser *> *holders = holdersByActualAccess[indexedActualAccess];
+
+		for (NSUInteger idx = ISResourceMediatorHolderIndexForAccessPressure(holders, indexedAccessPressure); (idx < holders.count) && ([holders objectAtIndex:idx].accessPressure == indexedAccessPressure); idx++)
+		{
+			if ([holders objectAtIndex:idx] == user)
+			{
+				[holders removeObjectAtIndex:idx];
+				return;
+			}
+		}
+	}
+}
+
+- (BOOL)_reindexUser:(ISResourceUser *)user wasIndexed:(BOOL)wasIndexed actualAccess:(ISResourceMediatorResourceAccess)previousActualAccess preferredAccess:(ISResourceMediatorResourceAccess)previousPreferredAccess accessPressure:(ISResourceMediatorAccessPressure)previousAccessPressure
+{
+	BOOL isIndexed = [self _isIndexableUser:user];
+
+	if (!wasIndexed && !isIndexed)
+	{
+		return (NO);
+	}
+
+	if (wasIndexed && isIndexed &&
+	    (previousActualAccess == user.actualAccess) &&
+	    (previousAccessPressure == user.accessPressure) &&
+	    ((previousActualAccess != kISResourceMediatorResourceAccessUnknown) || (previousPreferredAccess == user.preferredAccess))) // preferredAccess only matters for holders with unknown access
+	{
+		return (NO);
+	}
+
+	if (wasIndexed)
+	{
+		[self _unindexUser:user actualAccess:previousActualAccess accessPressure:previousAccessPressure];
+	}
+
+	[self _indexUser:user];
+
+	return (YES);
+}
+
+- (NSArray <ISResourceUser *> *)_conflictingHoldersForAccess:(ISResourceMediatorResourceAccess)access
+{
+	NSMutableArray <ISResourceUser *> *conflictingHolders = [NSMutableArray array];
+
+	switch (access)
+	{
+		case kISResourceMediatorResourceAccessShared:
+			// Shared access conflicts with blocking access ..
+			[conflictingHolders addObjectsFromArray:holdersByActualAccess[kISResourceMediatorResourceAccessBlocking]];
+
+			// .. and - for counted resources - with as many shared holders as need to give up access to free enough slots
+			if (effectiveResourceCapacity != 0)
+			{
+				NSUInteger neededSlots = MIN(MAX(slotCount, 1), effectiveResourceCapacity);
+				NSUInteger usedSlots = 0;
+
+				for (ISResourceUser *user in holdersByActualAccess[kISResourceMediatorResourceAccessShared])
+				{
+					usedSlots += [self _slotsUsedByUser:user];
+				}
+
+				// Holders are sorted by ascending accessPressure, so the ones most likely to agree are asked first
+				for (ISResourceUser *user in holdersByActualAccess[kISResourceMediatorResourceAccessShared])
+				{
+					if ((usedSlots + neededSlots) <= effectiveResourceCapacity)
+					{
+						break;
+					}
+
+					[conflictingHolders addObject:user];
+					usedSlots -= [self _slotsUsedByUser:user];
+				}
+			}
+		break;
+
+		case kISResourceMediatorResourceAccessBlocking:
+			// Blocking access conflicts with any access ..
+			[conflictingHolders addObjectsFromArray:holdersByActualAccess[kISResourceMediatorResourceAccessShared]];
+			[conflictingHolders addObjectsFromArray:holdersByActualAccess[kISResourceMediatorResourceAccessBlocking]];
+
+			// .. and with users of unknown access that got what they wanted with a lower pressure
+			for (ISResourceUser *user in holdersByActualAccess[kISResourceMediatorResourceAccessUnknown])
+			{
+				if (user.accessPressure >= accessPressure)
+				{
+					break;
+				}
+
+				if (user.preferredAccess == kISResourceMediatorResourceAccessUnknown)
+				{
+					[conflictingHolders addObject:user];
+				}
+			}
+		break;
+
+		default:
+		break;
+	}
+
+	return (conflictingHolders);
+}
+
+#pragma mark - Counted resources
+- (BOOL)_updateEffectiveResourceCapacity
+{
+	// Returns YES if the effective capacity changed. The smallest capacity wins, so no user can oversubscribe the resource.
+	NSUInteger newEffectiveResourceCapacity = resourceCapacity;
+
+	for (ISResourceUser *user in users)
+	{
+		if ((user.resourceCapacity != 0) && ((newEffectiveResourceCapacity == 0) || (user.resourceCapacity < newEffectiveResourceCapacity)))
+		{
+			newEffectiveResourceCapacity = user.resourceCapacity;
+		}
+	}
+
+	if (newEffectiveResourceCapacity != effectiveResourceCapacity)
+	{
+		effectiveResourceCapacity = newEffectiveResourceCapacity;
+		return (YES);
+	}
+
+	return (NO);
+}
+
+- (NSUInteger)_slotsUsedByUser:(ISResourceUser *)user
+{
+	// Users that didn't tell use one slot
+	return (MIN(MAX(user.slotCount, 1), effectiveResourceCapacity));
+}
+
+- (void)setResourceCapacity:(NSUInteger)newResourceCapacity
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setResourceCapacity:newResourceCapacity]; }])
+	{
+		return;
+	}
+
+	if (newResourceCapacity != resourceCapacity)
+	{
+		BOOL capacityChanged;
+
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationResourceCapacityKey : @(newResourceCapacity) }];
+
+		@synchronized(self)
+		{
+			resourceCapacity = newResourceCapacity;
+
+			capacityChanged = [self _updateEffectiveResourceCapacity];
+		}
+
+		[self postStatusNotification];
+
+		if (capacityChanged)
+		{
+			[self considerRequestingAccess];
+		}
+	}
+}
+
+- (void)setSlotCount:(NSUInteger)newSlotCount
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setSlotCount:newSlotCount]; }])
+	{
+		return;
+	}
+
+	if (newSlotCount != slotCount)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationSlotCountKey : @(newSlotCount) }];
+
+		slotCount = newSlotCount;
+
+		[self postStatusNotification];
+		[self considerRequestingAccess];
+	}
+}
+
+#pragma mark - Access mediation
+- (void)setPreferredAccess:(ISResourceMediatorResourceAccess)newPreferredAccess
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setPreferredAccess:newPreferredAccess]; }])
+	{
+		return;
+	}
+
+	if (newPreferredAccess != preferredAccess)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationPreferredAccessKey : @(newPreferredAccess) }];
+
+		preferredAccess = newPreferredAccess;
+
+		// Pending requests were made for the previous preferredAccess
+		[self _cancelAccessRequests];
+
+		accessStartTime = [self _currentTime];
+		
+		[self postStatusNotification];
+		
+		[self considerRequestingAccess];
+	}
+}
+
+- (void)setActualAccess:(ISResourceMediatorResourceAccess)newActualAccess
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setActualAccess:newActualAccess]; }])
+	{
+		return;
+	}
+
+	if (newActualAccess != actualAccess)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationActualAccessKey : @(newActualAccess) }];
+
+		actualAccess = newActualAccess;
+		
+		@synchronized(self)
+		{
+			BOOL returnedLease = NO;
+
+			if (actualAccess == kISResourceMediatorResourceAccessNone)
+			{
+				// Unless we lent access on (with a lease newer than the one we borrowed), return it to the lender
+				if ((lentLease == nil) || (lentLease.epoch <= borrowedLease.epoch))
+				{
+					returnedLease = [self _returnBorrowedLease];
+				}
+
+				// Waiters need to ask whoever holds access next
+				[self _dropWaiters];
+			}
+			else
+			{
+				// Any lease we lent out is void now that we have access again
+				[lentLease release];
+				lentLease = nil;
+
+				accessHoldStartTime = [self _currentTime];
+			}
+
+			if (!returnedLease && (actualAccess == preferredAccess))
+			{
+				lendingUserFromPreferredAccess = kISResourceMediatorResourceAccessNone;
+				lendingUserFromAccessPressure = kISResourceMediatorAccessPressureNone;
+				[lendingUser release];
+				lendingUser = nil;
+			}
+		}
+
+		// Send notification to all
+		[self postStatusNotification];
+		
+		// Inform delegate
+		[self _notifyDelegate:^{
+			if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:actualAccessChangedTo:)]))
+			{
+				[delegate resourceMediator:self actualAccessChangedTo:newActualAccess];
+			}
+		}];
+	}
+}
+
+- (void)setAccessPressure:(ISResourceMediatorAccessPressure)newAccessPressure
+{
+	if ([self _dispatchToExecutionQueue:^{ [self setAccessPressure:newAccessPressure]; }])
+	{
+		return;
+	}
+
+	if (newAccessPressure != accessPressure)
+	{
+		[self _traceEvent:kISResourceMediatorTraceEventSetting value:0 userInfo:@{ kISResourceMediatorNotificationAccessPressureKey : @(newAccessPressure) }];
+
+		accessPressure = newAccessPressure;
+
+		accessStartTime = [self _currentTime];
+	
+		[self postStatusNotification];
+		[self considerRequestingAccess];
+	}
+}
+
+- (void)setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+{
+	[self submitToCommandQueue:^(dispatch_block_t commandQueueCompletionHandler){
+		[self _notifyDelegate:^{
+			if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:setApplicationAccessForResource:requestedBy:completion:)]))
+			{
+				NSTimeInterval delegateCallTime = [self _currentTime];
+
+				[self _traceEvent:kISResourceMediatorTraceEventAccessChange value:access userInfo:((user!=nil) ? @{ kISResourceMediatorNotificationTargetPIDKey : @(user.pid) } : nil)];
+
+				[delegate resourceMediator:self setApplicationAccessForResource:access requestedBy:user completion:^(ISResourceMediatorResult result) {
+					[metrics noteDuration:([self _currentTime] - delegateCallTime) forHistogram:kISResourceMediatorMetricsHistogramDelegateAccessChange];
+
+					[self _traceEvent:kISResourceMediatorTraceEventAccessChangeCompletion value:result userInfo:nil];
+
+					if (completionHandler != nil)
+					{
+						completionHandler(result);
+					}
+					
+					if (commandQueueCompletionHandler != nil)
+					{
+						commandQueueCompletionHandler();
+					}
+				}];
+			}
+			else
+			{
+				if (commandQueueCompletionHandler != nil)
+				{
+					commandQueueCompletionHandler();
+				}
+			}
+		}];
+	}];
+}
+
+- (BOOL)_shouldDenyAccessRequestFromUser:(ISResourceUser *)sourceUser accessPressure:(ISResourceMediatorAccessPressure)sourceAccessPressure accessStartTime:(NSTimeInterval)sourceAccessStartTime
+{
+	@synchronized(self)
+	{
+		if ((accessReservedForPID != nil) && ([accessReservedForPID intValue] != sourceUser.pid))
+		{
+			// Access is reserved for the requester of a prepared multicast request
+			return (YES);
+		}
+	}
+
+	return ( (sourceAccessPressure < self.accessPressure) ||		// Do not lend access to app with lower pressure
+
+		((sourceAccessPressure == self.accessPressure) &&	// Do not lend access to app with same pressure and older claim (newer claims win)
+		 (sourceAccessStartTime <= accessStartTime)) ||
+
+		((sourceAccessPressure == self.accessPressure) &&	// Do not lend access to app with same pressure before minimumHoldTime is up
+		 [self _isWithinMinimumHoldTime])
+	       );
+}
+
+- (void)_respondToAccessRequestFromUser:(ISResourceUser *)sourceUser withResult:(ISResourceMediatorResult)result requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase
+{
+	[self _respondToAccessRequestFromUser:sourceUser withResult:result requestID:requestID phase:phase leaseEpoch:0];
+}
+
+- (void)_respondToAccessRequestFromUser:(ISResourceUser *)sourceUser withResult:(ISResourceMediatorResult)result requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase leaseEpoch:(uint64_t)grantedLeaseEpoch
+{
+	[self _respondToAccessRequestFromUser:sourceUser withResult:result requestID:requestID phase:phase leaseEpoch:grantedLeaseEpoch waiterPosition:0];
+}
+
+- (void)_respondToAccessRequestFromUser:(ISResourceUser *)sourceUser withResult:(ISResourceMediatorResult)result requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase leaseEpoch:(uint64_t)grantedLeaseEpoch waiterPosition:(NSUInteger)waiterPosition
+{
+	NSMutableDictionary *responseUserInfo = [NSMutableDictionary dictionaryWithDictionary:@{
+		kISResourceMediatorNotificationPIDKey			: @(self.pid),
+		kISResourceMediatorNotificationTargetPIDKey		: @(sourceUser.pid),
+		kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+
+		kISResourceMediatorNotificationResultKey		: @(result),
+	}];
+
+	if (requestID != 0)
+	{
+		// Response to a multicast access request
+		[responseUserInfo setObject:@(requestID) forKey:kISResourceMediatorNotificationAccessRequestIDKey];
+		[responseUserInfo setObject:@(phase) forKey:kISResourceMediatorNotificationAccessRequestPhaseKey];
+	}
+
+	if (grantedLeaseEpoch != 0)
+	{
+		[responseUserInfo setObject:@(grantedLeaseEpoch) forKey:kISResourceMediatorNotificationLeaseEpochKey];
+	}
+
+	if (waiterPosition != 0)
+	{
+		[responseUserInfo setObject:@(waiterPosition) forKey:kISResourceMediatorNotificationWaiterPositionKey];
+	}
+
+	[self _postMessage:kISResourceMediatorMessageTypeAccessResponse userInfo:responseUserInfo];
+}
+
+- (void)_relinquishAccessToUser:(ISResourceUser *)sourceUser requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase
+{
+	@synchronized(self)
+	{
+		statusNotificationsSuspended++;
+	}
+	
+	[self setApplicationAccessForResource:kISResourceMediatorResourceAccessNone requestedBy:sourceUser completion:^(ISResourceMediatorResult result) {
+		BOOL gaveUpAccess = NO;
+		uint64_t grantedLeaseEpoch = 0;
+
+		if (result == kISResourceMediatorResultSuccess)
+		{
+			gaveUpAccess = (self.actualAccess != kISResourceMediatorResourceAccessNone);
+
+			if (gaveUpAccess && (requestID == 0) && ((sourceUser.capabilities & kISResourceMediatorCapabilityLeases) != 0))
+			{
+				@synchronized(self)
+				{
+					// Grant a lease. Must be in place before giving up access, so a lease we borrowed isn't returned.
+					grantedLeaseEpoch = ++leaseEpoch;
+
+					[lentLease release];
+					lentLease = [[ISResourceMediatorLease alloc] initWithUser:sourceUser epoch:grantedLeaseEpoch];
+					lentLease.preferredAccess = preferredAccess;
+					lentLease.accessPressure = accessPressure;
+				}
+			}
+
+			self.actualAccess = kISResourceMediatorResourceAccessNone;
+			
+			[lendingUser release];
+			lendingUser = [sourceUser retain];
+			lendingUserFromPreferredAccess = preferredAccess;
+			lendingUserFromAccessPressure = lendingUser.accessPressure;
+		}
+
+		// A commit that made us give up access is confirmed by the [STATUS] that follows anyway
+		if (!((phase == kISResourceMediatorAccessRequestPhaseCommit) && gaveUpAccess))
+		{
+			[self _respondToAccessRequestFromUser:sourceUser withResult:result requestID:requestID phase:phase leaseEpoch:grantedLeaseEpoch];
+		}
+
+		@synchronized(self)
+		{
+			if (statusNotificationsSuspended > 0)
+			{
+				statusNotificationsSuspended--;
+			}
+
+			// Send changes made while suspended
+			if (statusNotificationsSuspended == 0)
+			{
+				[self postStatusNotification];
+			}
+		}
+	}];
+}
+
+- (void)requestAccessFrom:(ISResourceUser *)user
+{
+	if (user != nil)
+	{
+		[self _postMessage:kISResourceMediatorMessageTypeAccessRequest userInfo:@{
+			kISResourceMediatorNotificationPIDKey			: @(pid),
+			kISResourceMediatorNotificationTargetPIDKey		: @(user.pid),
+
+			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+		}];
+	}
+}
+
+- (void)considerRequestingAccess
+{
+	if ([self _dispatchToExecutionQueue:^{ [self considerRequestingAccess]; }])
+	{
+		return;
+	}
+
+	if (active && !discoveryInProgress)
+	{
+		if (preferredAccess != actualAccess)
+		{
+			ISResourceMediatorResourceAccess targetAccess = preferredAccess;
+			BOOL resourceShouldBeAvailable = NO, multicast = NO, awaitingLease = NO;
+			NSMutableArray<ISResourceUser *> *requestUsers = nil;
+			
+			switch (preferredAccess)
+			{
+				case kISResourceMediatorResourceAccessNone:
+					// Return resource
+					resourceShouldBeAvailable = YES;
+				break;
+				
+				case kISResourceMediatorResourceAccessShared:
+				case kISResourceMediatorResourceAccessBlocking:
+					@synchronized(self)
+					{
+						// Access we lent out under the same conditions comes back with the lease
+						awaitingLease = (lentLease != nil) && (lentLease.preferredAccess == preferredAccess) && (lentLease.accessPressure == accessPressure);
+
+						resourceShouldBeAvailable = YES;
+						
+						// Only users holding access in a conflicting way need to be asked
+						for (ISResourceUser *user in [self _conflictingHoldersForAccess:preferredAccess])
+						{
+							if (!awaitingLease && (![pendingResponse containsObject:user]) && (![queuedAtUsers containsObject:user]) && (![self _hasGivenUpRequestingAccessFrom:user]) && (!((user==lendingUser) && (lendingUserFromPreferredAccess == preferredAccess) && (lendingUserFromAccessPressure == user.accessPressure))))
+							{
+								[pendingResponse addObject:user];
+
+								if (requestUsers == nil)
+								{
+									requestUsers = [NSMutableArray array];
+								}
+
+								[requestUsers addObject:user];
+							}
+							
+							resourceShouldBeAvailable = NO;
+						}
+					}
+				break;
+				
+				default:
+				break;
+			}
+
+			if (resourceShouldBeAvailable && awaitingLease)
+			{
+				// Grabbing access could take it from somebody down the lending chain, whose lease is on its way back
+				resourceShouldBeAvailable = NO;
+
+				[self _scheduleLeaseReturnDeadline];
+			}
+
+			@synchronized(self)
+			{
+				multicast = [self _canRequestAccessByMulticastFromUsers:requestUsers];
+			}
+
+			// Send access requests (outside the critical section)
+			if (multicast)
+			{
+				[self _requestAccessByMulticastFromUsers:requestUsers];
+			}
+			else
+			{
+				for (ISResourceUser *user in requestUsers)
+				{
+					uint64_t knownLeaseEpoch;
+
+					@synchronized(self)
+					{
+						if ([accessRequestTimesByPID objectForKey:@(user.pid)] == nil)
+						{
+							[accessRequestTimesByPID setObject:@([self _currentTime]) forKey:@(user.pid)];
+							[accessRequestLeaseEpochsByPID setObject:@(leaseEpoch) forKey:@(user.pid)];
+						}
+
+						knownLeaseEpoch = leaseEpoch;
+					}
+
+					[self _postMessage:kISResourceMediatorMessageTypeAccessRequest userInfo:@{
+						kISResourceMediatorNotificationPIDKey	    : @(self.pid),
+						kISResourceMediatorNotificationTargetPIDKey : @(user.pid),
+					
+						kISResourceMediatorNotificationAccessPressureKey    : @(self.accessPressure),
+						kISResourceMediatorNotificationAccessStartTimeKey : @(accessStartTime),
+						kISResourceMediatorNotificationLeaseEpochKey : @(knownLeaseEpoch),
+						kISResourceMediatorNotificationSlotCountKey : @(slotCount),
+					
+						kISResourceMediatorNotificationResourceIdentifierKey : resourceIdentifier,
+					}];
+
+					[self _scheduleAccessRequestDeadlineForUser:user];
+				}
+			}
+
+			if (resourceShouldBeAvailable)
+			{
+				// Resource should be available (or is returned). Go and try grab (or return) it.
+				[self setApplicationAccessForResource:targetAccess requestedBy:nil completion:^(ISResourceMediatorResult result) {
+					if (result == kISResourceMediatorResultSuccess)
+					{
+						// Pick the waiter to hand returned access to before the queue is dropped
+						ISResourceUser *nextWaiter = (targetAccess == kISResourceMediatorResourceAccessNone) ? [self _dequeueNextWaiter] : nil;
+
+						self.actualAccess = targetAccess;
+
+						if (nextWaiter != nil)
+						{
+							[self _respondToAccessRequestFromUser:nextWaiter withResult:kISResourceMediatorResultSuccess requestID:0 phase:0];
+						}
+					}
+				}];
+			}
+		}
+	}
+}
+
+#pragma mark - Leases
+- (void)_noteLeaseEpoch:(uint64_t)epoch
+{
+	@synchronized(self)
+	{
+		if (epoch > leaseEpoch)
+		{
+			leaseEpoch = epoch;
+		}
+	}
+}
+
+- (void)_postLeaseReturnToUser:(ISResourceUser *)lender epoch:(uint64_t)epoch
+{
+	NSMutableDictionary *statusUserInfo;
+
+	@synchronized(self)
+	{
+		// No sequence number: the return is only seen by the lender, so it must neither be applied as a full [STATUS] nor move the lender's view of the sequence. The following delta [STATUS] carries the same changes to everyone.
+		statusUserInfo = [NSMutableDictionary dictionaryWithDictionary:@{
+			kISResourceMediatorNotificationPIDKey			: @(pid),
+			kISResourceMediatorNotificationTargetPIDKey		: @(lender.pid),
+
+			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+			kISResourceMediatorNotificationPreferredAccessKey	: @(preferredAccess),
+			kISResourceMediatorNotificationActualAccessKey		: @(actualAccess),
+
+			kISResourceMediatorNotificationBroadcastInfoHashKey	: @(broadcastInfoHash),
+		}];
+
+		if ((lender.capabilities & kISResourceMediatorCapabilityBroadcastInfoHash) == 0)
+		{
+			[statusUserInfo setObject:((broadcastInfo!=nil) ? broadcastInfo : @"") forKey:kISResourceMediatorNotificationBroadcastInfoKey];
+		}
+	}
+
+	if (epoch != 0)
+	{
+		[statusUserInfo setObject:@(epoch) forKey:kISResourceMediatorNotificationLeaseEpochKey];
+	}
+
+	[self _postMessage:kISResourceMediatorMessageTypeStatus userInfo:statusUserInfo];
+}
+
+- (BOOL)_returnBorrowedLease
+{
+	ISResourceMediatorLease *returnedLease = nil;
+
+	@synchronized(self)
+	{
+		if ((borrowedLease != nil) && (actualAccess == kISResourceMediatorResourceAccessNone) && active && (statusNotificationsSuspended==0))
+		{
+			returnedLease = [borrowedLease autorelease];
+			borrowedLease = nil;
+		}
+	}
+
+	if (returnedLease != nil)
+	{
+		// Hand access back to the lender ahead of the [STATUS] to all, to give it an opportunity to be first to reclaim the resource
+		[self _postLeaseReturnToUser:returnedLease.user epoch:returnedLease.epoch];
+	}
+
+	return (returnedLease != nil);
+}
+
+- (void)_scheduleLeaseReturnDeadline
+{
+	ISResourceMediatorLease *awaitedLease;
+
+	@synchronized(self)
+	{
+		if ((lentLease == nil) || lentLease.returnAwaited)
+		{
+			// Don't push out an already scheduled deadline
+			return;
+		}
+
+		lentLease.returnAwaited = YES;
+		awaitedLease = [[lentLease retain] autorelease];
+	}
+
+	[self.deadlineScheduler scheduleAfter:accessRequestTimeout forKey:kISResourceMediatorLeaseReturnDeadlineKey handler:^{
+		[self _leaseReturnTimedOut:awaitedLease];
+	}];
+}
+
+- (void)_leaseReturnTimedOut:(ISResourceMediatorLease *)awaitedLease
+{
+	BOOL stopWaiting = NO;
+
+	@synchronized(self)
+	{
+		if ((lentLease == awaitedLease) && ([self _conflictingHoldersForAccess:preferredAccess].count == 0))
+		{
+			// Nobody holds access, but the lease didn't come back (f.ex. because its return got lost)
+			[lentLease release];
+			lentLease = nil;
+
+			stopWaiting = YES;
+		}
+	}
+
+	if (stopWaiting)
+	{
+		[self considerRequestingAccess];
+	}
+}
+
+- (BOOL)_noteLeaseReturnWithStatusUserInfo:(NSDictionary *)statusUserInfo
+{
+	// Returns YES if statusUserInfo hands back the lease we lent out
+	NSNumber *leaseEpochNumber, *pidNumber;
+	BOOL leaseReturned = NO, handBack = NO;
+
+	if (((leaseEpochNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationLeaseEpochKey]) != nil) &&
+	    ((pidNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil))
+	{
+		@synchronized(self)
+		{
+			[self _noteLeaseEpoch:[leaseEpochNumber unsignedLongLongValue]];
+
+			// Returns of stale leases are ignored
+			if ((lentLease != nil) && (lentLease.user.pid == [pidNumber intValue]) && (lentLease.epoch == [leaseEpochNumber unsignedLongLongValue]))
+			{
+				[lentLease release];
+				lentLease = nil;
+
+				leaseReturned = YES;
+
+				// Pass it on along the chain if we no longer need access
+				handBack = (preferredAccess == kISResourceMediatorResourceAccessNone);
+			}
+		}
+	}
+
+	if (handBack)
+	{
+		[self _returnBorrowedLease];
+	}
+
+	return (leaseReturned);
+}
+
+#pragma mark - Waiter queue
+- (BOOL)_isWithinMinimumHoldTime
+{
+	return ((minimumHoldTime > 0) && (actualAccess != kISResourceMediatorResourceAccessNone) && ([self _currentTime] < (accessHoldStartTime + minimumHoldTime)));
+}
+
+- (NSArray <ISResourceMediatorWaiter *> *)_waitersInQueueOrder
+{
+	NSTimeInterval now = [self _currentTime];
+
+	// Highest (aged) pressure first, then first come, first served
+	return ([waiters sortedArrayUsingComparator:^NSComparisonResult(ISResourceMediatorWaiter *waiter1, ISResourceMediatorWaiter *waiter2) {
+		double priority1 = [waiter1 priorityAtTime:now], priority2 = [waiter2 priorityAtTime:now];
+
+		if (priority1 != priority2)
+		{
+			return ((priority1 > priority2) ? NSOrderedAscending : NSOrderedDescending);
+		}
+
+		if (waiter1.queueTime != waiter2.queueTime)
+		{
+			return ((waiter1.queueTime < waiter2.queueTime) ? NSOrderedAscending : NSOrderedDescending);
+		}
+
+		return (NSOrderedSame);
+	}]);
+}
+
+- (NSUInteger)_queueWaiter:(ISResourceUser *)user accessPressure:(ISResourceMediatorAccessPressure)waiterAccessPressure accessStartTime:(NSTimeInterval)waiterAccessStartTime
+{
+	// Returns the position of user in the queue - or 0 if it wasn't queued
+	ISResourceMediatorWaiter *queuedWaiter = nil;
+	NSUInteger position = 0;
+	BOOL withinMinimumHoldTime = NO;
+
+	@synchronized(self)
+	{
+		if (((user.capabilities & kISResourceMediatorCapabilityWaiterQueue) == 0) || (actualAccess == kISResourceMediatorResourceAccessNone))
+		{
+			// The requester would ask again anyway - or there's no access to wait for
+			return (0);
+		}
+
+		for (ISResourceMediatorWaiter *waiter in waiters)
+		{
+			if (waiter.user == user)
+			{
+				queuedWaiter = waiter;
+				break;
+			}
+		}
+
+		if (queuedWaiter == nil)
+		{
+			queuedWaiter = [[ISResourceMediatorWaiter alloc] initWithUser:user queueTime:[self _currentTime]];
+			[waiters addObject:queuedWaiter];
+			[queuedWaiter release];
+		}
+
+		queuedWaiter.accessPressure = waiterAccessPressure;
+		queuedWaiter.accessStartTime = waiterAccessStartTime;
+
+		position = [[self _waitersInQueueOrder] indexOfObjectIdenticalTo:queuedWaiter] + 1;
+
+		withinMinimumHoldTime = [self _isWithinMinimumHoldTime];
+	}
+
+	if (withinMinimumHoldTime)
+	{
+		// Check back once we held access long enough
+		[self.deadlineScheduler scheduleDeadline:(accessHoldStartTime + minimumHoldTime) forKey:kISResourceMediatorHoldTimeDeadlineKey handler:^{
+			[self _minimumHoldTimeElapsed];
+		}];
+	}
+
+	return (position);
+}
+
+- (ISResourceUser *)_dequeueNextWaiter
+{
+	ISResourceUser *nextWaiterUser = nil;
+
+	@synchronized(self)
+	{
+		if (borrowedLease != nil)
+		{
+			// Returned access goes back to the lender first
+			return (nil);
+		}
+
+		for (ISResourceMediatorWaiter *waiter in [self _waitersInQueueOrder])
+		{
+			if (waiter.user.preferredAccess != kISResourceMediatorResourceAccessNone)
+			{
+				nextWaiterUser = [[waiter.user retain] autorelease];
+				[waiters removeObjectIdenticalTo:waiter];
+				break;
+			}
+		}
+	}
+
+	return (nextWaiterUser);
+}
+
+- (void)_minimumHoldTimeElapsed
+{
+	ISResourceMediatorWaiter *nextWaiter = nil;
+	NSArray <ISResourceMediatorWaiter *> *queuedWaiters = nil;
+
+	@synchronized(self)
+	{
+		if (actualAccess != kISResourceMediatorResourceAccessNone)
+		{
+			queuedWaiters = [self _waitersInQueueOrder];
+		}
+	}
+
+	// Relinquish access to the first waiter whose request we'd no longer deny
+	for (ISResourceMediatorWaiter *waiter in queuedWaiters)
+	{
+		if ((waiter.user.preferredAccess != kISResourceMediatorResourceAccessNone) &&
+		    ![self _shouldDenyAccessRequestFromUser:waiter.user accessPressure:waiter.accessPressure accessStartTime:waiter.accessStartTime])
+		{
+			nextWaiter = waiter;
+			break;
+		}
+	}
+
+	if (nextWaiter != nil)
+	{
+		@synchronized(self)
+		{
+			[waiters removeObjectIdenticalTo:nextWaiter];
 		}
+
+		[self _relinquishAccessToUser:nextWaiter.user requestID:0 phase:0];
 	}
 }
 
-#pragma mark - Notification handling
-- (void)handleApplicationNotifications:(NSNotification *)notification
+- (void)_removeWaiterForUser:(ISResourceUser *)user
 {
+	@synchronized(self)
+	{
+		for (ISResourceMediatorWaiter *waiter in waiters)
+		{
+			if (waiter.user == user)
+			{
+				[waiters removeObjectIdenticalTo:waiter];
+				break;
+			}
+		}
+	}
 }
 
-- (void)handleMediatorNotification:(NSNotification *)notification
+- (void)_dropWaiters
 {
-	// Reconstruct userInfo from NSNotification name
-	// (OS X App Sandbox prohibits/prevents any NSDistributedNotifications with userInfo dictionary, but will happily accept and
-	// deliver megabyte-sized (!) strings as "objects" (tested this up to 64MB), so we shouldn't hit any limit)
+	@synchronized(self)
+	{
+		[waiters removeAllObjects];
 
-	NSDictionary *userInfo = nil;
+		[deadlineScheduler cancelDeadlineForKey:kISResourceMediatorHoldTimeDeadlineKey];
+	}
+}
 
-	if ((notification.object != nil) && ([notification.object isKindOfClass:[NSString class]]))
+#pragma mark - Multicast access requests
+- (BOOL)_canRequestAccessByMulticastFromUsers:(NSArray <ISResourceUser *> *)requestUsers
+{
+	// Call only from within @synchronized(self)
+	if (!usesMulticastAccessRequests || (requestUsers.count < 2) || (multicastAccessRequest != nil))
 	{
-		NSError *error = nil;
+		return (NO);
+	}
 
-		if ((userInfo = [NSPropertyListSerialization propertyListWithData:[notification.object dataUsingEncoding:NSUTF8StringEncoding] options:NSPropertyListImmutable format:NULL error:&error]) != nil)
-		{
-			if (![userInfo isKindOfClass:[NSDictionary class]])
-			{
-				return;
-			}
-		}
-		else
+	// Mediators that don't understand multicast requests would take them as addressed to them
+	for (ISResourceUser *user in users)
+	{
+		if (user.isUsingResourceMediator && ((user.capabilities & kISResourceMediatorCapabilityMulticastAccessRequest) == 0))
 		{
-			NSLog(@"Error decoding resource mediator notification object '%@': %@", notification.object, error);
-			return;
+			return (NO);
 		}
 	}
 
-	[self _handleMediatorNotificationWithName:notification.name userInfo:userInfo];
+	return (YES);
 }
 
-- (void)_postNotificationWithName:(NSString *)notificationName userInfo:(NSDictionary *)notificationUserInfo
+- (void)_requestAccessByMulticastFromUsers:(NSArray <ISResourceUser *> *)requestUsers
 {
-	NSString *notificationObjectString = nil;
+	ISResourceMediatorMulticastAccessRequest *request = [[ISResourceMediatorMulticastAccessRequest new] autorelease];
+	NSUInteger attempt = 0;
 
-	// Serialize notificationUserInfo as plist and send it as the "object" string (see -handleMediatorNotification: for an explaination)
-	if (notificationUserInfo != nil)
+	@synchronized(self)
 	{
-		NSError *error = nil;
-		NSData *plistData = nil;
+		request.requestID = ++lastAccessRequestID;
+		request.phase = kISResourceMediatorAccessRequestPhasePrepare;
+		request.preferredAccess = preferredAccess;
+		request.users = requestUsers;
+		request.resultsByPID = [NSMutableDictionary dictionary];
+		request.requestTime = [self _currentTime];
 
-		if ((plistData = [NSPropertyListSerialization dataWithPropertyList:notificationUserInfo format:NSPropertyListXMLFormat_v1_0 options:0 error:&error]) != nil)
-		{
-			notificationObjectString = [[[NSString alloc] initWithData:plistData encoding:NSUTF8StringEncoding] autorelease];
-		}
-		else
+		[multicastAccessRequest release];
+		multicastAccessRequest = [request retain];
+
+		for (ISResourceUser *user in requestUsers)
 		{
-			NSLog(@"Error serializing resource mediator userInfo '%@': %@", notificationUserInfo, error);
-			return;
+			attempt = MAX(attempt, [[accessRequestAttemptsByPID objectForKey:@(user.pid)] unsignedIntegerValue]);
 		}
 	}
 
-	[[NSDistributedNotificationCenter defaultCenter] postNotificationName:notificationName object:notificationObjectString userInfo:nil deliverImmediately:YES];
+	[self _postMulticastAccessRequest:request phase:kISResourceMediatorAccessRequestPhasePrepare];
+
+	[self.deadlineScheduler scheduleAfter:(accessRequestTimeout * pow(accessRequestBackoffFactor, (double)attempt)) forKey:kISResourceMediatorMulticastAccessRequestDeadlineKey handler:^{
+		[self _multicastAccessRequestTimedOut:request];
+	}];
 }
 
-- (void)_handleMediatorNotificationWithName:(NSString *)notificationName userInfo:(NSDictionary *)notificationUserInfo
+- (void)_postMulticastAccessRequest:(ISResourceMediatorMulticastAccessRequest *)request phase:(ISResourceMediatorAccessRequestPhase)phase
 {
-	// Ignore notifications for which we aren't the target
-	if (notificationUserInfo != nil)
+	[self _postMessage:kISResourceMediatorMessageTypeAccessRequest userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(self.pid),
+		kISResourceMediatorNotificationTargetPIDsKey		: [request targetPIDs],
+
+		kISResourceMediatorNotificationAccessPressureKey	: @(self.accessPressure),
+		kISResourceMediatorNotificationAccessStartTimeKey	: @(accessStartTime),
+		kISResourceMediatorNotificationSlotCountKey		: @(slotCount),
+
+		kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+
+		kISResourceMediatorNotificationAccessRequestIDKey	: @(request.requestID),
+		kISResourceMediatorNotificationAccessRequestPhaseKey	: @(phase),
+	}];
+}
+
+- (BOOL)_noteMulticastAccessRequestCommitStatus:(NSDictionary *)statusUserInfo
+{
+	ISResourceUser *user = nil;
+	uint64_t requestID = 0;
+
+	@synchronized(self)
 	{
-		NSString *targetPID = [notificationUserInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey];
-		
-		if (targetPID != nil)
+		if ((multicastAccessRequest != nil) && (multicastAccessRequest.phase == kISResourceMediatorAccessRequestPhaseCommit))
 		{
-			if ([targetPID intValue] != self.pid)
+			NSNumber *pidNumber;
+
+			if (((pidNumber = [statusUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil) &&
+			    ((user = [usersByPID objectForKey:pidNumber]) != nil) &&
+			    [multicastAccessRequest.users containsObject:user] &&
+			    (user.actualAccess == kISResourceMediatorResourceAccessNone))
 			{
-				return;
+				requestID = multicastAccessRequest.requestID;
 			}
 		}
 	}
 
-	// Scan / Discovery
-	if ([notificationName isEqual:kISResourceMediatorNotificationScanName])
+	if (requestID == 0)
 	{
-		// Return information on current and desired usage
-		[self postStatusNotification];
+		return (NO);
 	}
 
-	// Status updates
-	if ([notificationName isEqual:kISResourceMediatorNotificationStatusName])
+	// Users confirm a commit by sending their updated [STATUS]
+	return ([self _handleMulticastAccessResponseFromUser:user requestID:requestID phase:kISResourceMediatorAccessRequestPhaseCommit result:kISResourceMediatorResultSuccess viaStatus:YES]);
+}
+
+- (BOOL)_handleMulticastAccessResponseFromUser:(ISResourceUser *)sourceUser requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase result:(ISResourceMediatorResult)result viaStatus:(BOOL)viaStatus
+{
+	ISResourceMediatorMulticastAccessRequest *request = nil;
+	ISResourceMediatorAccessRequestPhase nextPhase = 0;
+	BOOL completed = NO;
+
+	@synchronized(self)
 	{
-		NSNumber *pidNumber = nil;
-		ISResourceUser *user = nil;
-		BOOL isNewUser = NO;
-		
-		if (notificationUserInfo != nil)
+		if ((multicastAccessRequest != nil) && (multicastAccessRequest.requestID == requestID) && (multicastAccessRequest.phase == phase) && [multicastAccessRequest.users containsObject:sourceUser])
 		{
-			if ((pidNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil)
-			{
-				@synchronized(self)
-				{
-					pid_t userPID = [pidNumber intValue];
-				
-					if ((user = [usersByPID objectForKey:@(userPID)]) == nil)
-					{
-						if ((user = [self _addUserForPID:userPID]) != nil)
-						{
-							user.isUsingResourceMediator = YES;
+			request = [[multicastAccessRequest retain] autorelease];
 
-							isNewUser = YES;
-						}
-					}
-					else
-					{
-						user.isUsingResourceMediator = YES;
-					}
-				}
+			[request.resultsByPID setObject:@(result) forKey:@(sourceUser.pid)];
+			[accessRequestAttemptsByPID removeObjectForKey:@(sourceUser.pid)];
+
+			if ((phase == kISResourceMediatorAccessRequestPhaseCommit) && !viaStatus)
+			{
+				// User didn't give up access (because it had none or failed to) - so we may not know its current status
+				request.needsStatusRefresh = YES;
 			}
-			
-			if (user != nil)
+
+			if (result != kISResourceMediatorResultSuccess)
 			{
-				NSNumber *preferredAccessNumber = nil, *actualAccessNumber = nil, *accessPressureNumber = nil;
-				NSDictionary *broadcastInfoDict = nil;
-				
-				if ((preferredAccessNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPreferredAccessKey]) != nil)
-				{
-					user.preferredAccess = [preferredAccessNumber unsignedIntegerValue];
-				}
-				
-				if ((actualAccessNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationActualAccessKey]) != nil)
-				{
-					user.actualAccess = [actualAccessNumber unsignedIntegerValue];
-				}
-				
-				if ((accessPressureNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessPressureKey]) != nil)
-				{
-					user.accessPressure = [accessPressureNumber unsignedIntegerValue];
-				}
-				
-				if ((broadcastInfoDict = [notificationUserInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoKey]) != nil)
+				// All or nothing: if one user disagrees, none relinquishes access
+				completed = YES;
+
+				if (phase == kISResourceMediatorAccessRequestPhasePrepare)
 				{
-					if ([broadcastInfoDict isKindOfClass:[NSDictionary class]])
-					{
-						user.broadcastInfo = broadcastInfoDict;
-					}
-					else
-					{
-						user.broadcastInfo = nil;
-					}
-					
-					if (!isNewUser)
-					{
-						if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:user:updatedBroadcastInfo:)]))
-						{
-							[delegate resourceMediator:self user:user updatedBroadcastInfo:broadcastInfoDict];
-						}
-					}
+					nextPhase = kISResourceMediatorAccessRequestPhaseAbort;
 				}
-				
-				if (isNewUser)
+			}
+			else if (request.resultsByPID.count == request.users.count)
+			{
+				if (phase == kISResourceMediatorAccessRequestPhasePrepare)
 				{
-					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userAppeared:)]))
-					{
-						[delegate resourceMediator:self userAppeared:user];
-					}
+					// All users agreed
+					nextPhase = kISResourceMediatorAccessRequestPhaseCommit;
+
+					request.phase = nextPhase;
+					[request.resultsByPID removeAllObjects];
 				}
 				else
 				{
-					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userUpdated:)]))
-					{
-						[delegate resourceMediator:self userUpdated:user];
-					}
+					// All users relinquished access
+					completed = YES;
 				}
 			}
 		}
+	}
 
-		[self considerRequestingAccess];
+	if (request == nil)
+	{
+		// Response to a request that was aborted, timed out or cancelled
+		return (NO);
 	}
-	
-	// Access request
-	if ([notificationName isEqual:kISResourceMediatorNotificationAccessRequestName])
+
+	if (nextPhase != 0)
 	{
-		NSNumber *sourceUserPIDNumber = nil;
-		ISResourceMediatorAccessPressure sourceAccessPressure = kISResourceMediatorAccessPressureNone;
-		NSTimeInterval sourceAccessStartTime = 0;
-	
-		sourceAccessPressure = [[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessPressureKey] unsignedIntegerValue];
-		sourceAccessStartTime = [[notificationUserInfo objectForKey:kISResourceMediatorNotificationAccessStartTimeKey] doubleValue];
-		
-		if ((sourceUserPIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil)
+		[self _postMulticastAccessRequest:request phase:nextPhase];
+	}
+
+	if (nextPhase == kISResourceMediatorAccessRequestPhaseCommit)
+	{
+		[self.deadlineScheduler scheduleAfter:accessRequestTimeout forKey:kISResourceMediatorMulticastAccessRequestDeadlineKey handler:^{
+			[self _multicastAccessRequestTimedOut:request];
+		}];
+	}
+
+	if (completed)
+	{
+		[self _completeMulticastAccessRequest:request withResult:result notifyDelegate:YES];
+	}
+
+	return (completed);
+}
+
+- (void)_completeMulticastAccessRequest:(ISResourceMediatorMulticastAccessRequest *)request withResult:(ISResourceMediatorResult)result notifyDelegate:(BOOL)notifyDelegate
+{
+	NSTimeInterval responseTime = [self _currentTime], requestTime = request.requestTime;
+	ISResourceMediatorResourceAccess thePreferredAccess = request.preferredAccess;
+	NSArray <ISResourceUser *> *requestUsers = request.users;
+
+	@synchronized(self)
+	{
+		if (multicastAccessRequest != request)
 		{
-			ISResourceUser *sourceUser = nil;
-		
-			if ((sourceUser = [self resourceUserForPID:[sourceUserPIDNumber intValue] createIfNotExists:YES]) != nil)
-			{
-				if ( (sourceAccessPressure < self.accessPressure) ||		// Do not lend access to app with lower pressure
+			return;
+		}
 
-				    ((sourceAccessPressure == self.accessPressure) &&		// Do not lend access to app with same pressure and older claim (newer claims win)
-				     (sourceAccessStartTime <= accessStartTime))
-				   )
-				{
-					// Deny access requests from apps with an access pressure lower than mine
-					[self _postNotificationWithName:kISResourceMediatorNotificationAccessResponseName userInfo:@{
-						kISResourceMediatorNotificationPIDKey			: @(self.pid),
-						kISResourceMediatorNotificationTargetPIDKey		: sourceUserPIDNumber,
-						kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+		[multicastAccessRequest autorelease];
+		multicastAccessRequest = nil;
 
-						kISResourceMediatorNotificationResultKey		: @(kISResourceMediatorResultDeny),
-					}];
+		for (ISResourceUser *user in requestUsers)
+		{
+			[pendingResponse removeObject:user];
+		}
+
+		if ((result == kISResourceMediatorResultSuccess) && (lendingUser != nil) && [requestUsers containsObject:lendingUser])
+		{
+			lendingUserFromPreferredAccess = kISResourceMediatorResourceAccessNone;
+			lendingUserFromAccessPressure = kISResourceMediatorAccessPressureNone;
+			[lendingUser release];
+			lendingUser = nil;
+		}
+	}
+
+	[self.deadlineScheduler cancelDeadlineForKey:kISResourceMediatorMulticastAccessRequestDeadlineKey];
+
+	if (result != kISResourceMediatorResultTimeout)
+	{
+		[metrics noteDuration:(responseTime - requestTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffRequestToResponse];
+	}
+
+	if (notifyDelegate)
+	{
+		// Call delegate outside the critical section
+		[self _notifyDelegate:^{
+			if (delegate!=nil)
+			{
+				if ([delegate respondsToSelector:@selector(resourceMediator:users:respondedToAccessRequestWith:)])
+				{
+					[delegate resourceMediator:self users:requestUsers respondedToAccessRequestWith:result];
 				}
-				else
+				else if ([delegate respondsToSelector:@selector(resourceMediator:user:respondedToAccessRequestWith:)])
 				{
-					// Try providing access to apps with the same or a higher access pressure level
-					@synchronized(self)
+					for (ISResourceUser *user in requestUsers)
 					{
-						statusNotificationsSuspended++;
+						[delegate resourceMediator:self user:user respondedToAccessRequestWith:result];
 					}
-					
-					[self setApplicationAccessForResource:kISResourceMediatorResourceAccessNone requestedBy:sourceUser completion:^(ISResourceMediatorResult result) {
-						if (result == kISResourceMediatorResultSuccess)
-						{
-							self.actualAccess = kISResourceMediatorResourceAccessNone;
-							
-							[lendingUser release];
-							lendingUser = [sourceUser retain];
-							lendingUserFromPreferredAccess = preferredAccess;
-							lendingUserFromAccessPressure = lendingUser.accessPressure;
-						}
-						
-						[self _postNotificationWithName:kISResourceMediatorNotificationAccessResponseName userInfo:@{
-							kISResourceMediatorNotificationPIDKey			: @(self.pid),
-							kISResourceMediatorNotificationTargetPIDKey		: sourceUserPIDNumber,
-							kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
-
-							kISResourceMediatorNotificationResultKey		: @(result),
-						}];
-
-						@synchronized(self)
-						{
-							if (statusNotificationsSuspended > 0)
-							{
-								statusNotificationsSuspended--;
-							}
-						}
-					}];
 				}
 			}
-		}
+		}];
 	}
 
-	// Access response
-	if ([notificationName isEqual:kISResourceMediatorNotificationAccessResponseName])
+	if (result == kISResourceMediatorResultSuccess)
 	{
-		NSNumber *sourceUserPIDNumber = nil;
-		NSNumber *resultNumber = nil;
-	
-		if (((sourceUserPIDNumber = [notificationUserInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil) &&
-		    ((resultNumber	  = [notificationUserInfo objectForKey:kISResourceMediatorNotificationResultKey]) != nil))
-		{
-			ISResourceUser *sourceUser = nil;
-		
-			if ((sourceUser = [self resourceUserForPID:[sourceUserPIDNumber intValue] createIfNotExists:NO]) != nil)
+		[self setApplicationAccessForResource:thePreferredAccess requestedBy:nil completion:^(ISResourceMediatorResult result) {
+			if (result == kISResourceMediatorResultSuccess)
 			{
-				@synchronized(self)
-				{
-					ISResourceMediatorResult result = [resultNumber unsignedIntegerValue];
+				NSTimeInterval accessTime = [self _currentTime];
 
-					if ([pendingResponse containsObject:sourceUser])
-					{
-						[pendingResponse removeObject:sourceUser];
-					}
-
-					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:user:respondedToAccessRequestWith:)]))
-					{
-						[delegate resourceMediator:self	user:sourceUser	respondedToAccessRequestWith:result];
-					}
-					
-					if (result == kISResourceMediatorResultSuccess)
-					{
-						ISResourceMediatorResourceAccess thePreferredAccess = self.preferredAccess;
+				[metrics noteDuration:(accessTime - responseTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffResponseToAccess];
+				[metrics noteDuration:(accessTime - requestTime) forHistogram:kISResourceMediatorMetricsHistogramHandoffTotal];
 
-						[lentFromUser release];
-						lentFromUser = [sourceUser retain];
-						
-						if (lendingUser == sourceUser)
-						{
-							lendingUserFromPreferredAccess = kISResourceMediatorResourceAccessNone;
-							lendingUserFromAccessPressure = kISResourceMediatorAccessPressureNone;
-							[lendingUser release];
-							lendingUser = nil;
-						}
+				self.actualAccess = thePreferredAccess;
+			}
 
-						[self setApplicationAccessForResource:thePreferredAccess requestedBy:sourceUser completion:^(ISResourceMediatorResult result) {
-							if (result == kISResourceMediatorResultSuccess)
-							{
-								self.actualAccess = thePreferredAccess;
-							}
-							
-							[self _postNotificationWithName:kISResourceMediatorNotificationScanName  userInfo:@{
-								kISResourceMediatorNotificationPIDKey			: @(self.pid),
-								kISResourceMediatorNotificationTargetPIDKey		: sourceUserPIDNumber,
+			if (request.needsStatusRefresh)
+			{
+				[self _postMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+					kISResourceMediatorNotificationPIDKey			: @(self.pid),
+					kISResourceMediatorNotificationTargetPIDsKey		: [request targetPIDs],
 
-								kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
-							}];
-						}];
-					}
-				}
+					kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
+				}];
 			}
-		}
+		}];
 	}
 }
 
-- (void)postStatusNotification
+- (void)_multicastAccessRequestTimedOut:(ISResourceMediatorMulticastAccessRequest *)request
 {
+	BOOL abort = NO, gaveUp = NO;
+
 	@synchronized(self)
 	{
-		if (active && (statusNotificationsSuspended==0))
+		if (multicastAccessRequest != request)
 		{
-			[self _postNotificationWithName:kISResourceMediatorNotificationStatusName userInfo:@{
-				kISResourceMediatorNotificationPIDKey			: @(pid),
+			return;
+		}
 
-				kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
-				kISResourceMediatorNotificationPreferredAccessKey	: @(self.preferredAccess),
-				kISResourceMediatorNotificationActualAccessKey		: @(self.actualAccess),
-				kISResourceMediatorNotificationAccessPressureKey	: @(self.accessPressure),
+		abort = (request.phase == kISResourceMediatorAccessRequestPhasePrepare);
 
-				kISResourceMediatorNotificationBroadcastInfoKey		: ((broadcastInfo!=nil) ? broadcastInfo : @"")
-			}];
+		for (ISResourceUser *user in request.users)
+		{
+			if (([request.resultsByPID objectForKey:@(user.pid)] == nil) && ([usersByPID objectForKey:@(user.pid)] == user))
+			{
+				NSUInteger attempt = [[accessRequestAttemptsByPID objectForKey:@(user.pid)] unsignedIntegerValue] + 1;
+
+				[accessRequestAttemptsByPID setObject:@(attempt) forKey:@(user.pid)];
+
+				if (attempt > accessRequestRetryLimit)
+				{
+					gaveUp = YES;
+				}
+			}
 		}
 	}
-}
 
-- (void)setBroadcastInfo:(NSDictionary *)newBroadcastInfo
-{
-	@synchronized(self)
+	if (abort)
 	{
-		[newBroadcastInfo retain];
-		[broadcastInfo autorelease];
-		broadcastInfo = newBroadcastInfo;
-		
-		[self postStatusNotification];
+		[self _postMulticastAccessRequest:request phase:kISResourceMediatorAccessRequestPhaseAbort];
 	}
-}
 
-#pragma mark - User administration
-- (ISResourceUser *)newUser
-{
-	return ([[ISResourceUser alloc] init]);
+	[self _completeMulticastAccessRequest:request withResult:kISResourceMediatorResultTimeout notifyDelegate:gaveUp];
+
+	// Ask again - users we gave up on are skipped (or, if only one user is left, asked with a targeted request)
+	[self considerRequestingAccess];
 }
 
-- (ISResourceUser *)_addUserForPID:(pid_t)userPID
+- (void)_handleMulticastAccessRequestFromUser:(ISResourceUser *)sourceUser requestID:(uint64_t)requestID phase:(ISResourceMediatorAccessRequestPhase)phase accessPressure:(ISResourceMediatorAccessPressure)sourceAccessPressure accessStartTime:(NSTimeInterval)sourceAccessStartTime
 {
-	ISResourceUser *user = nil;
+	BOOL isReserved;
 
 	@synchronized(self)
 	{
-		if (userPID != self.pid)
-		{
-			if ((user = [self newUser]) != nil)
+		isReserved = [accessReservedForPID isEqual:@(sourceUser.pid)] && (accessReservedForRequestID == requestID);
+	}
+
+	switch (phase)
+	{
+		case kISResourceMediatorAccessRequestPhasePrepare:
+			if ([self _shouldDenyAccessRequestFromUser:sourceUser accessPressure:sourceAccessPressure accessStartTime:sourceAccessStartTime])
 			{
-				user.pid = userPID;
-				
-				if ((user.runningApplication = [NSRunningApplication runningApplicationWithProcessIdentifier:userPID]) != nil)
+				[self _respondToAccessRequestFromUser:sourceUser withResult:kISResourceMediatorResultDeny requestID:requestID phase:phase];
+			}
+			else
+			{
+				// Agree, but keep access until the requester knows all users agreed
+				@synchronized(self)
 				{
-					[user addObserver:self forKeyPath:@"runningApplication.isTerminated" options:NSKeyValueObservingOptionOld|NSKeyValueObservingOptionNew context:(void *)self];
+					[accessReservedForPID release];
+					accessReservedForPID = [@(sourceUser.pid) retain];
+					accessReservedForRequestID = requestID;
 				}
-			
-				[users addObject:user];
-				[usersByPID setObject:user forKey:@(user.pid)];
-				
-				[user autorelease];
+
+				// In case neither commit nor abort arrive
+				[self.deadlineScheduler scheduleAfter:(2.0 * accessRequestTimeout) forKey:kISResourceMediatorAccessReservationDeadlineKey handler:^{
+					[self _releaseAccessReservation];
+				}];
+
+				[self _respondToAccessRequestFromUser:sourceUser withResult:kISResourceMediatorResultSuccess requestID:requestID phase:phase];
 			}
-		}
+		break;
+
+		case kISResourceMediatorAccessRequestPhaseCommit:
+			if (isReserved)
+			{
+				[self _releaseAccessReservation];
+			}
+			else if ([self _shouldDenyAccessRequestFromUser:sourceUser accessPressure:sourceAccessPressure accessStartTime:sourceAccessStartTime])
+			{
+				// Reservation expired and the situation changed since
+				[self _respondToAccessRequestFromUser:sourceUser withResult:kISResourceMediatorResultDeny requestID:requestID phase:phase];
+				break;
+			}
+
+			[self _relinquishAccessToUser:sourceUser requestID:requestID phase:phase];
+		break;
+
+		case kISResourceMediatorAccessRequestPhaseAbort:
+			if (isReserved)
+			{
+				[self _releaseAccessReservation];
+			}
+		break;
 	}
-	
-	return (user);
 }
 
-- (void)_removeUser:(ISResourceUser *)user
+- (void)_releaseAccessReservation
 {
 	@synchronized(self)
 	{
-		if (user.runningApplication != nil)
-		{
-			[user removeObserver:self forKeyPath:@"runningApplication.isTerminated" context:(void *)self];
-		}
-		
-		[pendingResponse removeObject:user];
-		
-		[users removeObject:user];
-		[usersByPID removeObjectForKey:@(user.pid)];
+		[accessReservedForPID release];
+		accessReservedForPID = nil;
+		accessReservedForRequestID = 0;
+
+		[deadlineScheduler cancelDeadlineForKey:kISResourceMediatorAccessReservationDeadlineKey];
 	}
 }
 
-- (ISResourceUser *)resourceUserForPID:(pid_t)userPID createIfNotExists:(BOOL)createIfNotExists
+#pragma mark - Metrics
+- (NSDictionary *)metricsSnapshot
 {
-	ISResourceUser *user = nil;
+	NSMutableDictionary *snapshot = [NSMutableDictionary dictionaryWithDictionary:[metrics snapshot]];
+	NSDictionary *hubSnapshot;
+
+	if ((hubSnapshot = [hub.metrics snapshot]) != nil)
+	{
+		[snapshot setObject:hubSnapshot forKey:@"hub"];
+	}
+
+	return (snapshot);
+}
 
+#pragma mark - Tracing
+- (void)setTraceRecorder:(ISResourceMediatorTraceRecorder *)newTraceRecorder
+{
 	@synchronized(self)
 	{
-		if ((user = [usersByPID objectForKey:@(userPID)]) == nil)
+		if (traceRecorder != newTraceRecorder)
 		{
-			if (createIfNotExists)
-			{
-				if ((user = [self _addUserForPID:userPID]) != nil)
-				{
-					if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userAppeared:)]))
-					{
-						[delegate resourceMediator:self userAppeared:user];
-					}
-				}
-			}
-		}
+			[traceRecorder release];
+			traceRecorder = [newTraceRecorder retain];
 
-		[[user retain] autorelease];
+			traceMediatorID = [traceRecorder nextMediatorID];
+		}
 	}
-	
-	return (user);
 }
 
-- (void)userTerminated:(ISResourceUser *)user
+- (void)_traceEvent:(ISResourceMediatorTraceEvent)event value:(uint8_t)value userInfo:(NSDictionary *)userInfo
 {
-	[user retain];
+	ISResourceMediatorTraceRecorder *recorder;
+	uint16_t mediatorID;
 
-	[self _removeUser:user];
+	if (traceRecorder == nil)
+	{
+		// Not recording - the common case
+		return;
+	}
 
-	if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:userDisappeared:)]))
+	@synchronized(self)
 	{
-		[delegate resourceMediator:self userDisappeared:user];
+		recorder = [[traceRecorder retain] autorelease];
+		mediatorID = traceMediatorID;
 	}
 
-	[user release];
-	
-	[self considerRequestingAccess];
+	[recorder recordEvent:event value:value userInfo:userInfo mediatorID:mediatorID time:[self _currentTime]];
 }
 
-- (NSMutableArray *)users
+#pragma mark - Deadlines
+- (ISResourceMediatorDeadlineScheduler *)deadlineScheduler
 {
-	NSMutableArray *usersCopy = nil;
-
 	@synchronized(self)
 	{
-		usersCopy = [NSMutableArray arrayWithArray:users];
+		if (deadlineScheduler == nil)
+		{
+			deadlineScheduler = [[ISResourceMediatorDeadlineScheduler alloc] initWithQueue:[self _callbackQueue]];
+		}
+
+		return ([[deadlineScheduler retain] autorelease]);
 	}
-	
-	return (usersCopy);
 }
 
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
+- (void)setDeadlineScheduler:(ISResourceMediatorDeadlineScheduler *)newDeadlineScheduler
 {
-	if (context == (void*)self)
+	@synchronized(self)
 	{
-		if ([keyPath isEqualToString:@"runningApplication.isTerminated"])
+		if (deadlineScheduler != newDeadlineScheduler)
 		{
-			ISResourceUser *user = (ISResourceUser *)object;
-			
-			if (user != nil)
-			{
-				if (user.runningApplication.terminated)
-				{
-					[self userTerminated:user];
-				}
-			}
+			[deadlineScheduler cancelAllDeadlines];
+			statusFlushScheduled = NO;
+
+			[deadlineScheduler release];
+			deadlineScheduler = [newDeadlineScheduler retain];
 		}
 	}
 }
 
-#pragma mark - Access mediation
-- (void)setPreferredAccess:(ISResourceMediatorResourceAccess)newPreferredAccess
+- (NSTimeInterval)_currentTime
 {
-	if (newPreferredAccess != preferredAccess)
-	{
-		preferredAccess = newPreferredAccess;
+	// All timing goes through the deadline scheduler, so that it can be driven by a virtual clock
+	return ([self.deadlineScheduler currentTime]);
+}
 
-		accessStartTime = [NSDate timeIntervalSinceReferenceDate];
-		
-		[self postStatusNotification];
-		
-		[self considerRequestingAccess];
+- (BOOL)_hasGivenUpRequestingAccessFrom:(ISResourceUser *)user
+{
+	return ([[accessRequestAttemptsByPID objectForKey:@(user.pid)] unsignedIntegerValue] > accessRequestRetryLimit);
+}
+
+- (void)_scheduleAccessRequestDeadlineForUser:(ISResourceUser *)user
+{
+	NSUInteger attempt;
+
+	@synchronized(self)
+	{
+		attempt = [[accessRequestAttemptsByPID objectForKey:@(user.pid)] unsignedIntegerValue];
 	}
+
+	[self.deadlineScheduler scheduleAfter:(accessRequestTimeout * pow(accessRequestBackoffFactor, (double)attempt)) forKey:@(user.pid) handler:^{
+		[self _accessRequestToUserTimedOut:user];
+	}];
 }
 
-- (void)setActualAccess:(ISResourceMediatorResourceAccess)newActualAccess
+- (void)_accessRequestToUserTimedOut:(ISResourceUser *)user
 {
-	if (newActualAccess != actualAccess)
+	BOOL retry = NO, gaveUp = NO;
+
+	@synchronized(self)
 	{
-		actualAccess = newActualAccess;
-		
-		@synchronized(self)
+		if ([pendingResponse containsObject:user])
 		{
-			if ((actualAccess == kISResourceMediatorResourceAccessNone) && (lentFromUser != nil) && active && (statusNotificationsSuspended==0))
-			{
-				// Send notification to lent user in advance to give it an opportunity to be first to reclaim the resource
-				[self _postNotificationWithName:kISResourceMediatorNotificationStatusName userInfo:@{
-					kISResourceMediatorNotificationPIDKey			: @(pid),
-					kISResourceMediatorNotificationTargetPIDKey		: @(lentFromUser.pid),
+			NSUInteger attempt = [[accessRequestAttemptsByPID objectForKey:@(user.pid)] unsignedIntegerValue] + 1;
 
-					kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
-					kISResourceMediatorNotificationPreferredAccessKey	: @(self.preferredAccess),
-					kISResourceMediatorNotificationActualAccessKey		: @(self.actualAccess),
+			[accessRequestAttemptsByPID setObject:@(attempt) forKey:@(user.pid)];
+			[pendingResponse removeObject:user];
 
-					kISResourceMediatorNotificationBroadcastInfoKey		: ((broadcastInfo!=nil) ? broadcastInfo : @"")
-				}];
-				
-				[lentFromUser release];
-				lentFromUser = nil;
+			if (attempt > accessRequestRetryLimit)
+			{
+				[accessRequestTimesByPID removeObjectForKey:@(user.pid)];
+				[accessRequestLeaseEpochsByPID removeObjectForKey:@(user.pid)];
+				gaveUp = YES;
 			}
 			else
 			{
-				if (actualAccess == preferredAccess)
-				{
-					lendingUserFromPreferredAccess = kISResourceMediatorResourceAccessNone;
-					lendingUserFromAccessPressure = kISResourceMediatorAccessPressureNone;
-					[lendingUser release];
-					lendingUser = nil;
-				}
+				retry = YES;
 			}
 		}
-
-		// Send notification to all
-		[self postStatusNotification];
-		
-		// Inform delegate
-		if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:actualAccessChangedTo:)]))
-		{
-			[delegate resourceMediator:self actualAccessChangedTo:newActualAccess];
-		}
 	}
-}
 
-- (void)setAccessPressure:(ISResourceMediatorAccessPressure)newAccessPressure
-{
-	if (newAccessPressure != accessPressure)
+	if (gaveUp)
 	{
-		accessPressure = newAccessPressure;
+		[self _notifyDelegate:^{
+			if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:user:respondedToAccessRequestWith:)]))
+			{
+				[delegate resourceMediator:self	user:user respondedToAccessRequestWith:kISResourceMediatorResultTimeout];
+			}
+		}];
+	}
 
-		accessStartTime = [NSDate timeIntervalSinceReferenceDate];
-	
-		@synchronized(self)
-		{
-			[self postStatusNotification];
-			[self considerRequestingAccess];
-		}
+	if (retry)
+	{
+		// Asks user again - if it still holds access in a conflicting way
+		[self considerRequestingAccess];
 	}
 }
 
-- (void)setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+- (void)_cancelAccessRequests
 {
-	[self submitToCommandQueue:^(dispatch_block_t commandQueueCompletionHandler){
-		if ((delegate!=nil) && ([delegate respondsToSelector:@selector(resourceMediator:setApplicationAccessForResource:requestedBy:completion:)]))
-		{
-			[delegate resourceMediator:self setApplicationAccessForResource:access requestedBy:user completion:^(ISResourceMediatorResult result) {
-				if (completionHandler != nil)
-				{
-					completionHandler(result);
-				}
-				
-				if (commandQueueCompletionHandler != nil)
-				{
-					commandQueueCompletionHandler();
-				}
-			}];
-		}
-		else
+	ISResourceMediatorMulticastAccessRequest *cancelledRequest = nil;
+
+	@synchronized(self)
+	{
+		for (ISResourceUser *user in pendingResponse)
 		{
-			if (commandQueueCompletionHandler != nil)
-			{
-				commandQueueCompletionHandler();
-			}
+			[deadlineScheduler cancelDeadlineForKey:@(user.pid)];
 		}
-	}];
-}
 
-- (void)requestAccessFrom:(ISResourceUser *)user
-{
-	if (user != nil)
-	{
-		[self _postNotificationWithName:kISResourceMediatorNotificationAccessRequestName userInfo:@{
-			kISResourceMediatorNotificationPIDKey			: @(pid),
-			kISResourceMediatorNotificationTargetPIDKey		: @(user.pid),
+		[pendingResponse removeAllObjects];
+		[queuedAtUsers removeAllObjects];
+		[accessRequestAttemptsByPID removeAllObjects];
+		[accessRequestTimesByPID removeAllObjects];
+		[accessRequestLeaseEpochsByPID removeAllObjects];
 
-			kISResourceMediatorNotificationResourceIdentifierKey	: resourceIdentifier,
-		}];
+		if (multicastAccessRequest != nil)
+		{
+			cancelledRequest = [multicastAccessRequest autorelease];
+			multicastAccessRequest = nil;
+
+			[deadlineScheduler cancelDeadlineForKey:kISResourceMediatorMulticastAccessRequestDeadlineKey];
+		}
 	}
-}
 
-- (void)considerRequestingAccess
-{
-	if (active)
+	if (cancelledRequest.phase == kISResourceMediatorAccessRequestPhasePrepare)
 	{
-		if (preferredAccess != actualAccess)
-		{
-			ISResourceMediatorResourceAccess targetAccess = preferredAccess;
-			
-			switch (preferredAccess)
-			{
-				case kISResourceMediatorResourceAccessNone:
-					// Return resource
-					[self setApplicationAccessForResource:targetAccess requestedBy:nil completion:^(ISResourceMediatorResult result) {
-						if (result == kISResourceMediatorResultSuccess)
-						{
-							self.actualAccess = targetAccess;
-						}
-					}];
-				break;
-				
-				case kISResourceMediatorResourceAccessShared:
-				case kISResourceMediatorResourceAccessBlocking:
-					@synchronized(self)
-					{
-						BOOL resourceShouldBeAvailable = YES;
-						
-						for (ISResourceUser *user in users)
-						{
-							if (user.isUsingResourceMediator && (user.pid != pid))
-							{
-								// Send access request?
-								if (((preferredAccess == kISResourceMediatorResourceAccessShared)   && (user.actualAccess == kISResourceMediatorResourceAccessBlocking)) ||
-								    ((preferredAccess == kISResourceMediatorResourceAccessBlocking) && ((user.actualAccess == kISResourceMediatorResourceAccessShared) || (user.actualAccess == kISResourceMediatorResourceAccessBlocking))) ||
-								    ((preferredAccess == kISResourceMediatorResourceAccessBlocking) && (user.actualAccess != kISResourceMediatorResourceAccessNone) && (user.actualAccess == user.preferredAccess) && (user.accessPressure < accessPressure)))
-								{
-									if ((![pendingResponse containsObject:user]) && (!((user==lendingUser) && (lendingUserFromPreferredAccess == preferredAccess) && (lendingUserFromAccessPressure == user.accessPressure))))
-									{
-										// Send access request
-										[pendingResponse addObject:user];
-										
-										[self _postNotificationWithName:kISResourceMediatorNotificationAccessRequestName userInfo:@{
-											kISResourceMediatorNotificationPIDKey	    : @(self.pid),
-											kISResourceMediatorNotificationTargetPIDKey : @(user.pid),
-											
-											kISResourceMediatorNotificationAccessPressureKey    : @(self.accessPressure),
-											kISResourceMediatorNotificationAccessStartTimeKey : @(accessStartTime),
-											
-											kISResourceMediatorNotificationResourceIdentifierKey : resourceIdentifier,
-										}];
-									}
-									
-									resourceShouldBeAvailable = NO;
-								}
-							}
-						}
-						
-						if (resourceShouldBeAvailable)
-						{
-							// Resource should be available. Go and try grab it.
-							[self setApplicationAccessForResource:targetAccess requestedBy:nil completion:^(ISResourceMediatorResult result) {
-								if (result == kISResourceMediatorResultSuccess)
-								{
-									self.actualAccess = targetAccess;
-								}
-							}];
-						}
-					}
-				break;
-				
-				default:
-				break;
-			}
-		}
+		// Free access reserved for us
+		[self _postMulticastAccessRequest:cancelledRequest phase:kISResourceMediatorAccessRequestPhaseAbort];
 	}
 }
 
 #pragma mark - Command queue
 - (void)submitToCommandQueue:(ISResourceMediatorCommand)asyncCommandBlock
 {
-	@synchronized(commandQueue)
-	{
-		[commandQueue addObject:[[asyncCommandBlock copy] autorelease]];
-		[self tryRunningNextCommandOnQueue];
-	}
+	[metrics noteCommandQueueDepth:ISResourceMediatorCommandQueuePush(commandQueue, asyncCommandBlock, [self _currentTime])];
+
+	[self tryRunningNextCommandOnQueue];
 }
 
 - (void)tryRunningNextCommandOnQueue
 {
-	@synchronized(commandQueue)
+	// Commands run one at a time. Synchronously completing commands are drained iteratively, so long chains don't grow the stack.
+	while (!atomic_exchange(&commandQueue->executing, true))
 	{
-		if (!commandQueueIsExecuting)
+		ISResourceMediatorCommandNode *node;
+		uint_fast32_t linkedCount = atomic_load(&commandQueue->linkedCount);
+
+		if ((node = ISResourceMediatorCommandQueuePop(commandQueue)) == NULL)
 		{
-			ISResourceMediatorCommand command;
-			
-			if ((command = [commandQueue firstObject]) != nil)
+			atomic_store(&commandQueue->executing, false);
+
+			if (atomic_load(&commandQueue->linkedCount) == linkedCount)
 			{
-				[[command retain] autorelease];
-			
-				commandQueueIsExecuting = YES;
-				
-				[commandQueue removeObjectAtIndex:0];
-				
-				command(^{
-					@synchronized(commandQueue)
-					{
-						commandQueueIsExecuting = NO;
-						[self tryRunningNextCommandOnQueue];
-					}
-				});
+				// Nothing left - or a push is still linking its node. Don't wait for it: the pushing thread runs tryRunningNextCommandOnQueue itself once done, and finds executing cleared.
+				break;
+			}
+
+			// A push finished while popping - its tryRunningNextCommandOnQueue may have found executing still set
+			continue;
+		}
+
+		[metrics noteCommandQueueDepth:(atomic_fetch_sub(&commandQueue->pendingCount, 1) - 1)];
+		[metrics noteDuration:([self _currentTime] - node->enqueueTime) forHistogram:kISResourceMediatorMetricsHistogramCommandQueueWait];
+
+		node->command(^{
+			if (atomic_exchange(&node->state, kISResourceMediatorCommandStateCompleted) == kISResourceMediatorCommandStateReturned)
+			{
+				// Completed asynchronously, after the command returned
+				ISResourceMediatorCommandNodeFree(node);
+
+				atomic_store(&commandQueue->executing, false);
+				[self tryRunningNextCommandOnQueue];
 			}
+		});
+
+		if (atomic_exchange(&node->state, kISResourceMediatorCommandStateReturned) != kISResourceMediatorCommandStateCompleted)
+		{
+			// Command completes later
+			break;
 		}
+
+		// Completed synchronously
+		ISResourceMediatorCommandNodeFree(node);
+
+		atomic_store(&commandQueue->executing, false);
 	}
 }
 
@@ -0,0 +1,152 @@
+//
+//  ISResourceMediatorCodec.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+     @abstract Encoding used for the "object" string of mediator notifications.
+     @constant kISResourceMediatorWireFormatAutomatic	  Use the binary format, but fall back to property lists for peers that don't understand it. Broadcasts only use it once discovery completed and every known peer has been seen using it. (default)
+     @constant kISResourceMediatorWireFormatPropertyList  Always use XML property lists. Understood by all versions of ISResourceMediator.
+     @constant kISResourceMediatorWireFormatBinary	  Always use the compact binary format.
+*/
+typedef NS_ENUM(NSUInteger, ISResourceMediatorWireFormat)
+{
+	kISResourceMediatorWireFormatAutomatic,
+	kISResourceMediatorWireFormatPropertyList,
+	kISResourceMediatorWireFormatBinary
+};
+
+/*!
+     @abstract Types of messages exchanged between mediators.
+     @constant kISResourceMediatorMessageTypeScan		Request for a STATUS message from all (or the targeted) mediators.
+     @constant kISResourceMediatorMessageTypeStatus		Current status of a mediator.
+     @constant kISResourceMediatorMessageTypeAccessRequest	Request to the targeted mediator - or, as multicast, to all mediators in targetPIDs - to relinquish access.
+     @constant kISResourceMediatorMessageTypeAccessResponse	Response to an access request.
+*/
+typedef NS_ENUM(uint8_t, ISResourceMediatorMessageType)
+{
+	kISResourceMediatorMessageTypeScan,
+	kISResourceMediatorMessageTypeStatus,
+	kISResourceMediatorMessageTypeAccessRequest,
+	kISResourceMediatorMessageTypeAccessResponse,
+
+	kISResourceMediatorMessageTypeCount
+};
+
+/*!
+     @abstract Optional protocol features supported by a mediator.
+     @constant kISResourceMediatorCapabilityMulticastAccessRequest  Understands multicast two-phase [ACCESS_REQUEST]s.
+     @constant kISResourceMediatorCapabilityLeases  Understands leases: accepts lease epochs in [ACCESS_RESPONSE]s and hands leases back to the lender when done.
+     @constant kISResourceMediatorCapabilityWaiterQueue  Understands waiter queues: doesn't repeat [ACCESS_REQUEST]s the holder queued, but waits for the holder to grant access.
+     @constant kISResourceMediatorCapabilityBroadcastInfoHash  Understands broadcastInfo hashes: fetches broadcastInfo it hasn't cached with a targeted [SCAN], so [STATUS] messages to it can omit the broadcastInfo itself.
+*/
+typedef NS_OPTIONS(uint8_t, ISResourceMediatorCapabilities)
+{
+	kISResourceMediatorCapabilityMulticastAccessRequest = (1 << 0),
+	kISResourceMediatorCapabilityLeases = (1 << 1),
+	kISResourceMediatorCapabilityWaiterQueue = (1 << 2),
+	kISResourceMediatorCapabilityBroadcastInfoHash = (1 << 3)
+};
+
+/*!
+     @abstract Phases of a multicast access request.
+     @constant kISResourceMediatorAccessRequestPhasePrepare  Asks all holders whether they would relinquish access. Holders that agree reserve their access for the requester and answer with kISResourceMediatorResultSuccess.
+     @constant kISResourceMediatorAccessRequestPhaseCommit   Sent after all holders agreed. Holders relinquish access and answer with the result.
+     @constant kISResourceMediatorAccessRequestPhaseAbort    Sent if any holder disagreed (or didn't answer). Holders drop their reservation. Not answered.
+*/
+typedef NS_ENUM(uint8_t, ISResourceMediatorAccessRequestPhase)
+{
+	kISResourceMediatorAccessRequestPhasePrepare = 1,
+	kISResourceMediatorAccessRequestPhaseCommit,
+	kISResourceMediatorAccessRequestPhaseAbort
+};
+
+extern NSString * const kISResourceMediatorNotificationResourceIdentifierKey;
+extern NSString * const kISResourceMediatorNotificationPIDKey;
+extern NSString * const kISResourceMediatorNotificationTargetPIDKey;
+extern NSString * const kISResourceMediatorNotificationBroadcastInfoKey;
+extern NSString * const kISResourceMediatorNotificationPreferredAccessKey;
+extern NSString * const kISResourceMediatorNotificationActualAccessKey;
+extern NSString * const kISResourceMediatorNotificationAccessPressureKey;
+extern NSString * const kISResourceMediatorNotificationAccessStartTimeKey;
+extern NSString * const kISResourceMediatorNotificationResultKey;
+extern NSString * const kISResourceMediatorNotificationScanEpochKey; //!< Identifies a [SCAN]. Echoed in the [STATUS] replies to it.
+extern NSString * const kISResourceMediatorNotificationStatusSequenceKey; //!< Per-sender sequence number of a [STATUS].
+extern NSString * const kISResourceMediatorNotificationStatusDeltaKey; //!< Present (with value 1) if a [STATUS] only contains the fields that changed since the previous sequence number.
+extern NSString * const kISResourceMediatorNotificationWireVersionKey; //!< Added to property list encoded messages by senders that also understand the binary format.
+extern NSString * const kISResourceMediatorNotificationCapabilitiesKey; //!< ISResourceMediatorCapabilities of the sender. Part of full [STATUS] messages.
+extern NSString * const kISResourceMediatorNotificationTargetPIDsKey; //!< Array of pids a multicast message is addressed to. Used instead of targetPID.
+extern NSString * const kISResourceMediatorNotificationAccessRequestIDKey; //!< Per-requester identifier of a multicast [ACCESS_REQUEST]. Echoed in the [ACCESS_RESPONSE]s to it.
+extern NSString * const kISResourceMediatorNotificationAccessRequestPhaseKey; //!< ISResourceMediatorAccessRequestPhase of a multicast [ACCESS_REQUEST] or [ACCESS_RESPONSE].
+extern NSString * const kISResourceMediatorNotificationLeaseEpochKey; //!< Lease epoch. In an [ACCESS_REQUEST]: the highest epoch known to the requester. In an [ACCESS_RESPONSE]: the epoch of the lease granted. In a targeted [STATUS]: the epoch of the lease handed back.
+extern NSString * const kISResourceMediatorNotificationResourceCapacityKey; //!< Number of slots of a counted resource, as configured by the sender. Part of [STATUS] messages. 0 or missing: not counted.
+extern NSString * const kISResourceMediatorNotificationSlotCountKey; //!< Number of slots the sender uses (or wants to use) with shared access. In [STATUS] and [ACCESS_REQUEST] messages. Missing: 1.
+extern NSString * const kISResourceMediatorNotificationWaiterPositionKey; //!< Position (starting at 1) of the requester in the holder's waiter queue. In an [ACCESS_RESPONSE] denying a request that was queued.
+extern NSString * const kISResourceMediatorNotificationBroadcastInfoHashKey; //!< Content hash of the sender's broadcastInfo (0 = none). In a [STATUS]: the hash of the current broadcastInfo, which may be omitted. In a targeted [SCAN]: the hash of the broadcastInfo the scanner wants to fetch.
+
+@interface ISResourceMediatorCodec : NSObject
+
+#pragma mark - String encoding
++ (NSString *)stringWithUserInfo:(NSDictionary *)userInfo format:(ISResourceMediatorWireFormat)format; //!< Encodes userInfo as a string that can be sent as the "object" of a distributed notification. If userInfo contains values the binary format can't represent, a property list is returned instead.
++ (NSDictionary *)userInfoWithString:(NSString *)string format:(ISResourceMediatorWireFormat *)outPeerFormat error:(NSError **)outError; //!< Decodes a string created by +stringWithUserInfo:format: (or by versions of ISResourceMediator predating the binary format). Returns the most compact format understood by the sender in outPeerFormat.
+
+#pragma mark - Binary encoding
++ (NSData *)binaryDataWithUserInfo:(NSDictionary *)userInfo; //!< Returns the binary encoding of userInfo, or nil if userInfo contains keys or values it can't represent.
++ (NSDictionary *)userInfoWithBinaryData:(NSData *)data; //!< Returns the userInfo dictionary for binary data created by +binaryDataWithUserInfo:, or nil if the data is malformed.
+
+#pragma mark - Content hashing
++ (uint64_t)contentHashOfPropertyList:(id)propertyList; //!< Returns a 64-bit hash of the contents of propertyList that is the same in all processes. Equal property lists have equal hashes, regardless of dictionary key order. Returns 0 for nil and never 0 otherwise.
+
+@end
+
+/*
+	BINARY FORMAT (version 1)
+
+	String form: "ISRM:" followed by the base64-encoded binary data, so it survives being sent as a notification "object" string.
+	Messages that have to be sent as property list carry a wireVersion key, so receivers know the sender understands the binary format.
+
+	Binary data: [version:UInt8] followed by any number of fields, in any order. Each field starts with a tag byte, where
+	the upper 3 bits are the field type and the lower 5 bits are the field ID. All integers are little endian.
+
+	Field types:
+		0 UInt8		1 byte
+		1 Int32		4 bytes
+		2 UInt64	8 bytes
+		3 Float64	8 bytes (IEEE 754)
+		4 String	UInt16 length + UTF-8 bytes
+		5 PropertyList	UInt32 length + binary property list (length 0 = empty string)
+
+	Receivers skip fields with unknown IDs, so new fields can be added without bumping the version.
+*/
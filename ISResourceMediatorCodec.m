@@ -0,0 +1,630 @@
+//
+//  ISResourceMediatorCodec.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorCodec.h"
+
+NSString * const kISResourceMediatorNotificationResourceIdentifierKey = @"resourceIdentifier";
+NSString * const kISResourceMediatorNotificationPIDKey = @"pid";
+NSString * const kISResourceMediatorNotificationTargetPIDKey = @"targetPID";
+NSString * const kISResourceMediatorNotificationBroadcastInfoKey = @"broadcastInfo";
+NSString * const kISResourceMediatorNotificationPreferredAccessKey = @"preferredAccess";
+NSString * const kISResourceMediatorNotificationActualAccessKey = @"actualAccess";
+NSString * const kISResourceMediatorNotificationAccessPressureKey = @"accessPressure";
+NSString * const kISResourceMediatorNotificationAccessStartTimeKey = @"accessStartTime";
+NSString * const kISResourceMediatorNotificationResultKey = @"result";
+NSString * const kISResourceMediatorNotificationScanEpochKey = @"scanEpoch";
+NSString * const kISResourceMediatorNotificationStatusSequenceKey = @"statusSequence";
+NSString * const kISResourceMediatorNotificationStatusDeltaKey = @"statusDelta";
+NSString * const kISResourceMediatorNotificationWireVersionKey = @"wireVersion";
+NSString * const kISResourceMediatorNotificationCapabilitiesKey = @"capabilities";
+NSString * const kISResourceMediatorNotificationTargetPIDsKey = @"targetPIDs";
+NSString * const kISResourceMediatorNotificationAccessRequestIDKey = @"accessRequestID";
+NSString * const kISResourceMediatorNotificationAccessRequestPhaseKey = @"accessRequestPhase";
+NSString * const kISResourceMediatorNotificationLeaseEpochKey = @"leaseEpoch";
+NSString * const kISResourceMediatorNotificationResourceCapacityKey = @"resourceCapacity";
+NSString * const kISResourceMediatorNotificationSlotCountKey = @"slotCount";
+NSString * const kISResourceMediatorNotificationWaiterPositionKey = @"waiterPosition";
+NSString * const kISResourceMediatorNotificationBroadcastInfoHashKey = @"broadcastInfoHash";
+
+static NSString *kISResourceMediatorCodecBinaryStringPrefix = @"ISRM:";
+
+#define kISResourceMediatorCodecBinaryVersion 1
+
+typedef NS_ENUM(uint8_t, ISResourceMediatorCodecFieldType)
+{
+	kISResourceMediatorCodecFieldTypeUInt8,
+	kISResourceMediatorCodecFieldTypeInt32,
+	kISResourceMediatorCodecFieldTypeUInt64,
+	kISResourceMediatorCodecFieldTypeFloat64,
+	kISResourceMediatorCodecFieldTypeString,
+	kISResourceMediatorCodecFieldTypePropertyList
+};
+
+typedef struct
+{
+	NSString * const *key;
+	uint8_t fieldID;
+	ISResourceMediatorCodecFieldType type;
+} ISResourceMediatorCodecField;
+
+// Field IDs are part of the wire format: never reuse or renumber them
+static const ISResourceMediatorCodecField sISResourceMediatorCodecFields[] = {
+	{ &kISResourceMediatorNotificationPIDKey,			 0, kISResourceMediatorCodecFieldTypeInt32	  },
+	{ &kISResourceMediatorNotificationTargetPIDKey,			 1, kISResourceMediatorCodecFieldTypeInt32	  },
+	{ &kISResourceMediatorNotificationResourceIdentifierKey,	 2, kISResourceMediatorCodecFieldTypeString	  },
+	{ &kISResourceMediatorNotificationPreferredAccessKey,		 3, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationActualAccessKey,		 4, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationAccessPressureKey,		 5, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationAccessStartTimeKey,		 6, kISResourceMediatorCodecFieldTypeFloat64	  },
+	{ &kISResourceMediatorNotificationResultKey,			 7, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationBroadcastInfoKey,		 8, kISResourceMediatorCodecFieldTypePropertyList },
+	{ &kISResourceMediatorNotificationWireVersionKey,		 9, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationScanEpochKey,			10, kISResourceMediatorCodecFieldTypeUInt64	  },
+	{ &kISResourceMediatorNotificationStatusSequenceKey,		11, kISResourceMediatorCodecFieldTypeUInt64	  },
+	{ &kISResourceMediatorNotificationStatusDeltaKey,		12, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationCapabilitiesKey,		13, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationTargetPIDsKey,		14, kISResourceMediatorCodecFieldTypePropertyList },
+	{ &kISResourceMediatorNotificationAccessRequestIDKey,		15, kISResourceMediatorCodecFieldTypeUInt64	  },
+	{ &kISResourceMediatorNotificationAccessRequestPhaseKey,	16, kISResourceMediatorCodecFieldTypeUInt8	  },
+	{ &kISResourceMediatorNotificationLeaseEpochKey,		17, kISResourceMediatorCodecFieldTypeUInt64	  },
+	{ &kISResourceMediatorNotificationResourceCapacityKey,		18, kISResourceMediatorCodecFieldTypeInt32	  },
+	{ &kISResourceMediatorNotificationSlotCountKey,			19, kISResourceMediatorCodecFieldTypeInt32	  },
+	{ &kISResourceMediatorNotificationWaiterPositionKey,		20, kISResourceMediatorCodecFieldTypeInt32	  },
+	{ &kISResourceMediatorNotificationBroadcastInfoHashKey,		21, kISResourceMediatorCodecFieldTypeUInt64	  },
+};
+
+#define kISResourceMediatorCodecFieldCount (sizeof(sISResourceMediatorCodecFields) / sizeof(ISResourceMediatorCodecField))
+
+static const ISResourceMediatorCodecField *ISResourceMediatorCodecFieldForID(uint8_t fieldID)
+{
+	for (NSUInteger i=0; i<kISResourceMediatorCodecFieldCount; i++)
+	{
+		if (sISResourceMediatorCodecFields[i].fieldID == fieldID)
+		{
+			return (&sISResourceMediatorCodecFields[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+@implementation ISResourceMediatorCodec
+
+#pragma mark - String encoding
++ (NSString *)stringWithUserInfo:(NSDictionary *)userInfo format:(ISResourceMediatorWireFormat)format
+{
+	NSString *string = nil;
+
+	if (userInfo == nil)
+	{
+		return (nil);
+	}
+
+	if (format != kISResourceMediatorWireFormatPropertyList)
+	{
+		NSData *binaryData;
+
+		if ((binaryData = [self binaryDataWithUserInfo:userInfo]) != nil)
+		{
+			string = [kISResourceMediatorCodecBinaryStringPrefix stringByAppendingString:[binaryData base64EncodedStringWithOptions:0]];
+		}
+	}
+
+	if (string == nil)
+	{
+		NSMutableDictionary *plistUserInfo = [[userInfo mutableCopy] autorelease];
+		NSError *error = nil;
+		NSData *plistData = nil;
+
+		// Let receivers know we also understand the binary format
+		[plistUserInfo setObject:@(kISResourceMediatorCodecBinaryVersion) forKey:kISResourceMediatorNotificationWireVersionKey];
+
+		if ((plistData = [NSPropertyListSerialization dataWithPropertyList:plistUserInfo format:NSPropertyListXMLFormat_v1_0 options:0 error:&error]) != nil)
+		{
+			string = [[[NSString alloc] initWithData:plistData encoding:NSUTF8StringEncoding] autorelease];
+		}
+		else
+		{
+			NSLog(@"Error serializing resource mediator userInfo '%@': %@", userInfo, error);
+		}
+	}
+
+	return (string);
+}
+
++ (NSDictionary *)userInfoWithString:(NSString *)string format:(ISResourceMediatorWireFormat *)outPeerFormat error:(NSError **)outError
+{
+	NSDictionary *userInfo = nil;
+
+	if ([string hasPrefix:kISResourceMediatorCodecBinaryStringPrefix])
+	{
+		NSData *binaryData;
+
+		if (outPeerFormat != NULL)
+		{
+			*outPeerFormat = kISResourceMediatorWireFormatBinary;
+		}
+
+		if ((binaryData = [[NSData alloc] initWithBase64EncodedString:[string substringFromIndex:kISResourceMediatorCodecBinaryStringPrefix.length] options:0]) != nil)
+		{
+			userInfo = [self userInfoWithBinaryData:binaryData];
+
+			[binaryData release];
+		}
+
+		if ((userInfo == nil) && (outError != NULL))
+		{
+			*outError = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:nil];
+		}
+	}
+	else
+	{
+		if ((userInfo = [NSPropertyListSerialization propertyListWithData:[string dataUsingEncoding:NSUTF8StringEncoding] options:NSPropertyListImmutable format:NULL error:outError]) != nil)
+		{
+			if (![userInfo isKindOfClass:[NSDictionary class]])
+			{
+				userInfo = nil;
+			}
+		}
+
+		if (outPeerFormat != NULL)
+		{
+			// Senders predating the binary format don't include a wire version
+			*outPeerFormat = ([userInfo objectForKey:kISResourceMediatorNotificationWireVersionKey] != nil) ? kISResourceMediatorWireFormatBinary : kISResourceMediatorWireFormatPropertyList;
+		}
+	}
+
+	return (userInfo);
+}
+
+#pragma mark - Binary encoding
++ (NSData *)binaryDataWithUserInfo:(NSDictionary *)userInfo
+{
+	NSMutableData *data = [NSMutableData dataWithCapacity:64];
+	NSUInteger encodedFieldCount = 0;
+	uint8_t version = kISResourceMediatorCodecBinaryVersion;
+
+	[data appendBytes:&version length:1];
+
+	for (NSUInteger i=0; i<kISResourceMediatorCodecFieldCount; i++)
+	{
+		const ISResourceMediatorCodecField *field = &sISResourceMediatorCodecFields[i];
+		id value;
+		uint8_t tag;
+
+		if ((value = [userInfo objectForKey:*field->key]) == nil)
+		{
+			continue;
+		}
+
+		tag = (uint8_t)((field->type << 5) | field->fieldID);
+
+		switch (field->type)
+		{
+			case kISResourceMediatorCodecFieldTypeUInt8:
+			{
+				uint8_t uint8Value;
+
+				if (![value isKindOfClass:[NSNumber class]] || ([value unsignedIntegerValue] > UINT8_MAX))
+				{
+					return (nil);
+				}
+
+				uint8Value = (uint8_t)[value unsignedIntegerValue];
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&uint8Value length:1];
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypeInt32:
+			{
+				uint32_t int32Value;
+
+				if (![value isKindOfClass:[NSNumber class]])
+				{
+					return (nil);
+				}
+
+				int32Value = NSSwapHostIntToLittle((uint32_t)[value intValue]);
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&int32Value length:4];
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypeUInt64:
+			{
+				uint64_t uint64Value;
+
+				if (![value isKindOfClass:[NSNumber class]])
+				{
+					return (nil);
+				}
+
+				uint64Value = NSSwapHostLongLongToLittle([value unsignedLongLongValue]);
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&uint64Value length:8];
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypeFloat64:
+			{
+				NSSwappedDouble float64Value;
+
+				if (![value isKindOfClass:[NSNumber class]])
+				{
+					return (nil);
+				}
+
+				float64Value = NSSwapHostDoubleToLittle([value doubleValue]);
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&float64Value length:8];
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypeString:
+			{
+				NSData *utf8Data;
+				uint16_t length;
+
+				if (![value isKindOfClass:[NSString class]])
+				{
+					return (nil);
+				}
+
+				utf8Data = [value dataUsingEncoding:NSUTF8StringEncoding];
+
+				if (utf8Data.length > UINT16_MAX)
+				{
+					return (nil);
+				}
+
+				length = NSSwapHostShortToLittle((uint16_t)utf8Data.length);
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&length length:2];
+				[data appendData:utf8Data];
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypePropertyList:
+			{
+				NSData *plistData = nil;
+				uint32_t length;
+
+				if ([value isKindOfClass:[NSString class]] && ([value length] == 0))
+				{
+					// Empty string is used as placeholder for "no value"
+					plistData = [NSData data];
+				}
+				else if ((plistData = [NSPropertyListSerialization dataWithPropertyList:value format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL]) == nil)
+				{
+					return (nil);
+				}
+
+				if (plistData.length > UINT32_MAX)
+				{
+					return (nil);
+				}
+
+				length = NSSwapHostIntToLittle((uint32_t)plistData.length);
+
+				[data appendBytes:&tag length:1];
+				[data appendBytes:&length length:4];
+				[data appendData:plistData];
+			}
+			break;
+		}
+
+		encodedFieldCount++;
+	}
+
+	if (encodedFieldCount != userInfo.count)
+	{
+		// userInfo contains keys the binary format doesn't know about
+		return (nil);
+	}
+
+	return (data);
+}
+
++ (NSDictionary *)userInfoWithBinaryData:(NSData *)data
+{
+	NSMutableDictionary *userInfo = nil;
+	const uint8_t *bytes = (const uint8_t *)data.bytes;
+	NSUInteger length = data.length, offset = 1;
+
+	if ((length < 1) || (bytes[0] != kISResourceMediatorCodecBinaryVersion))
+	{
+		return (nil);
+	}
+
+	userInfo = [NSMutableDictionary dictionaryWithCapacity:8];
+
+	while (offset < length)
+	{
+		uint8_t tag = bytes[offset++];
+		ISResourceMediatorCodecFieldType type = (ISResourceMediatorCodecFieldType)(tag >> 5);
+		const ISResourceMediatorCodecField *field = ISResourceMediatorCodecFieldForID(tag & 0x1F);
+		NSUInteger valueLength = 0, headerLength = 0;
+		id value = nil;
+
+		switch (type)
+		{
+			case kISResourceMediatorCodecFieldTypeUInt8:	valueLength = 1; break;
+			case kISResourceMediatorCodecFieldTypeInt32:	valueLength = 4; break;
+			case kISResourceMediatorCodecFieldTypeUInt64:
+			case kISResourceMediatorCodecFieldTypeFloat64:	valueLength = 8; break;
+
+			case kISResourceMediatorCodecFieldTypeString:
+			{
+				uint16_t stringLength;
+
+				if ((offset + 2) > length)
+				{
+					return (nil);
+				}
+
+				memcpy(&stringLength, &bytes[offset], 2);
+
+				headerLength = 2;
+				valueLength = NSSwapLittleShortToHost(stringLength);
+			}
+			break;
+
+			case kISResourceMediatorCodecFieldTypePropertyList:
+			{
+				uint32_t plistLength;
+
+				if ((offset + 4) > length)
+				{
+					return (nil);
+				}
+
+				memcpy(&plistLength, &bytes[offset], 4);
+
+				headerLength = 4;
+				valueLength = NSSwapLittleIntToHost(plistLength);
+			}
+			break;
+
+			default:
+				// Unknown field type - size can't be determined
+				return (nil);
+			break;
+		}
+
+		offset += headerLength;
+
+		if ((valueLength > length) || ((offset + valueLength) > length))
+		{
+			return (nil);
+		}
+
+		if ((field != NULL) && (field->type == type))
+		{
+			const uint8_t *valueBytes = &bytes[offset];
+
+			switch (type)
+			{
+				case kISResourceMediatorCodecFieldTypeUInt8:
+					value = @(valueBytes[0]);
+				break;
+
+				case kISResourceMediatorCodecFieldTypeInt32:
+				{
+					uint32_t int32Value;
+
+					memcpy(&int32Value, valueBytes, 4);
+					value = @((int32_t)NSSwapLittleIntToHost(int32Value));
+				}
+				break;
+
+				case kISResourceMediatorCodecFieldTypeUInt64:
+				{
+					uint64_t uint64Value;
+
+					memcpy(&uint64Value, valueBytes, 8);
+					value = @(NSSwapLittleLongLongToHost(uint64Value));
+				}
+				break;
+
+				case kISResourceMediatorCodecFieldTypeFloat64:
+				{
+					NSSwappedDouble float64Value;
+
+					memcpy(&float64Value, valueBytes, 8);
+					value = @(NSSwapLittleDoubleToHost(float64Value));
+				}
+				break;
+
+				case kISResourceMediatorCodecFieldTypeString:
+					value = [[[NSString alloc] initWithBytes:valueBytes length:valueLength encoding:NSUTF8StringEncoding] autorelease];
+				break;
+
+				case kISResourceMediatorCodecFieldTypePropertyList:
+					if (valueLength == 0)
+					{
+						value = @"";
+					}
+					else
+					{
+						NSData *plistData = [NSData dataWithBytesNoCopy:(void *)valueBytes length:valueLength freeWhenDone:NO];
+
+						value = [NSPropertyListSerialization propertyListWithData:plistData options:NSPropertyListImmutable format:NULL error:NULL];
+					}
+				break;
+			}
+
+			if (value == nil)
+			{
+				return (nil);
+			}
+
+			[userInfo setObject:value forKey:*field->key];
+		}
+
+		offset += valueLength;
+	}
+
+	return (userInfo);
+}
+
+#pragma mark - Content hashing
+#define kISResourceMediatorCodecHashOffsetBasis	0xcbf29ce484222325ULL
+#define kISResourceMediatorCodecHashPrime	0x00000100000001b3ULL
+
+static uint64_t ISResourceMediatorCodecHashBytes(uint64_t hash, const void *bytes, NSUInteger length)
+{
+	const uint8_t *p = (const uint8_t *)bytes;
+
+	// FNV-1a
+	for (NSUInteger i=0; i<length; i++)
+	{
+		hash ^= p[i];
+		hash *= kISResourceMediatorCodecHashPrime;
+	}
+
+	return (hash);
+}
+
+static uint64_t ISResourceMediatorCodecHashTaggedBytes(uint64_t hash, char tag, const void *bytes, NSUInteger length)
+{
+	uint64_t length64 = NSSwapHostLongLongToLittle((uint64_t)length);
+
+	hash = ISResourceMediatorCodecHashBytes(hash, &tag, 1);
+	hash = ISResourceMediatorCodecHashBytes(hash, &length64, sizeof(length64));
+
+	return (ISResourceMediatorCodecHashBytes(hash, bytes, length));
+}
+
+static uint64_t ISResourceMediatorCodecHashPropertyList(uint64_t hash, id propertyList)
+{
+	if ([propertyList isKindOfClass:[NSString class]])
+	{
+		NSData *utf8Data = [propertyList dataUsingEncoding:NSUTF8StringEncoding];
+
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, 's', utf8Data.bytes, utf8Data.length);
+	}
+	else if ([propertyList isKindOfClass:[NSNumber class]])
+	{
+		const char *objCType = [propertyList objCType];
+
+		if (CFGetTypeID((CFTypeRef)propertyList) == CFBooleanGetTypeID())
+		{
+			uint8_t boolValue = [propertyList boolValue] ? 1 : 0;
+
+			hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'b', &boolValue, sizeof(boolValue));
+		}
+		else if ((strcmp(objCType, @encode(float)) == 0) || (strcmp(objCType, @encode(double)) == 0))
+		{
+			NSSwappedDouble doubleValue = NSSwapHostDoubleToLittle([propertyList doubleValue]);
+
+			hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'f', &doubleValue, sizeof(doubleValue));
+		}
+		else
+		{
+			unsigned long long intValue = NSSwapHostLongLongToLittle((unsigned long long)[propertyList longLongValue]);
+
+			hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'i', &intValue, sizeof(intValue));
+		}
+	}
+	else if ([propertyList isKindOfClass:[NSData class]])
+	{
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'd', [propertyList bytes], [propertyList length]);
+	}
+	else if ([propertyList isKindOfClass:[NSDate class]])
+	{
+		NSSwappedDouble timeInterval = NSSwapHostDoubleToLittle([propertyList timeIntervalSinceReferenceDate]);
+
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, 't', &timeInterval, sizeof(timeInterval));
+	}
+	else if ([propertyList isKindOfClass:[NSArray class]])
+	{
+		uint64_t count = NSSwapHostLongLongToLittle((uint64_t)[propertyList count]);
+
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'a', &count, sizeof(count));
+
+		for (id element in propertyList)
+		{
+			hash = ISResourceMediatorCodecHashPropertyList(hash, element);
+		}
+	}
+	else if ([propertyList isKindOfClass:[NSDictionary class]])
+	{
+		uint64_t count = NSSwapHostLongLongToLittle((uint64_t)[propertyList count]);
+
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, 'D', &count, sizeof(count));
+
+		// Property list keys are strings. Hash them in sorted order, so equal dictionaries hash equally
+		for (id key in [[propertyList allKeys] sortedArrayUsingSelector:@selector(compare:)])
+		{
+			hash = ISResourceMediatorCodecHashPropertyList(hash, key);
+			hash = ISResourceMediatorCodecHashPropertyList(hash, [propertyList objectForKey:key]);
+		}
+	}
+	else if (propertyList != nil)
+	{
+		// Not a property list type - fall back to its description
+		NSData *utf8Data = [[propertyList description] dataUsingEncoding:NSUTF8StringEncoding];
+
+		hash = ISResourceMediatorCodecHashTaggedBytes(hash, '?', utf8Data.bytes, utf8Data.length);
+	}
+
+	return (hash);
+}
+
++ (uint64_t)contentHashOfPropertyList:(id)propertyList
+{
+	uint64_t hash;
+
+	if (propertyList == nil)
+	{
+		return (0);
+	}
+
+	if ((hash = ISResourceMediatorCodecHashPropertyList(kISResourceMediatorCodecHashOffsetBasis, propertyList)) == 0)
+	{
+		// 0 means "no broadcastInfo"
+		hash = 1;
+	}
+
+	return (hash);
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  ISResourceMediatorDeadlineScheduler.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorDeadlineScheduler tracks deadlines in a binary min-heap and fires their handlers once they pass.
+
+	A single dispatch timer source is armed for the earliest deadline. Adding, cancelling and firing deadlines is
+	O(log n). Deadlines are identified by a key - scheduling a deadline for a key that already has one replaces it.
+
+	Subclasses can override -currentTime to drive the scheduler from a virtual clock and call -fireDueDeadlines
+	whenever that clock advances. Such schedulers are typically created with a NULL queue, which disables the timer.
+*/
+
+#import <Foundation/Foundation.h>
+
+@class ISResourceMediatorDeadline;
+
+@interface ISResourceMediatorDeadlineScheduler : NSObject
+{
+	dispatch_queue_t queue;
+	dispatch_source_t timer;
+	NSTimeInterval timerDeadline;
+
+	NSMutableArray <ISResourceMediatorDeadline *> *heap;
+	NSMutableDictionary <id, ISResourceMediatorDeadline *> *deadlinesByKey;
+}
+
+@property(readonly) NSUInteger count; //!< Number of scheduled deadlines.
+@property(readonly) NSTimeInterval nextDeadline; //!< The earliest scheduled deadline, 0 if there is none.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithQueue:(dispatch_queue_t)aQueue; //!< Creates a scheduler whose handlers are called on aQueue. If aQueue is NULL, no timer is used and handlers are only called from -fireDueDeadlines.
+
+#pragma mark - Scheduling
+- (void)scheduleDeadline:(NSTimeInterval)deadline forKey:(id <NSCopying>)key handler:(dispatch_block_t)handler; //!< Calls handler on the scheduler's queue once -currentTime reaches deadline. Replaces any deadline already scheduled for key.
+- (void)scheduleAfter:(NSTimeInterval)delay forKey:(id <NSCopying>)key handler:(dispatch_block_t)handler; //!< Convenience wrapper, scheduling handler for -currentTime + delay.
+
+- (BOOL)cancelDeadlineForKey:(id <NSCopying>)key; //!< Removes the deadline scheduled for key. Returns YES if there was one.
+- (void)cancelAllDeadlines; //!< Removes all deadlines.
+
+#pragma mark - Time
+- (NSTimeInterval)currentTime; //!< Current time in seconds since the reference date. Override to use a virtual clock.
+- (void)fireDueDeadlines; //!< Removes all deadlines that passed and calls their handlers (in deadline order).
+
+@end
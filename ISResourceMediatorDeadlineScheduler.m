@@ -0,0 +1,360 @@
+//
+//  ISResourceMediatorDeadlineScheduler.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorDeadlineScheduler.h"
+
+#define kISResourceMediatorDeadlineSchedulerLeeway (NSEC_PER_MSEC)
+
+@interface ISResourceMediatorDeadline : NSObject
+{
+	NSTimeInterval deadline;
+	id key;
+	dispatch_block_t handler;
+
+	NSUInteger heapIndex;
+}
+
+@property(assign) NSTimeInterval deadline;
+@property(retain) id key;
+@property(copy) dispatch_block_t handler;
+
+@property(assign) NSUInteger heapIndex;
+
+@end
+
+@implementation ISResourceMediatorDeadline
+
+@synthesize deadline;
+@synthesize key;
+@synthesize handler;
+
+@synthesize heapIndex;
+
+- (void)dealloc
+{
+	[key release];
+	key = nil;
+
+	[handler release];
+	handler = nil;
+
+	[super dealloc];
+}
+
+@end
+
+@implementation ISResourceMediatorDeadlineScheduler
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithQueue:(dispatch_queue_t)aQueue
+{
+	if ((self = [super init]) != nil)
+	{
+		heap = [NSMutableArray new];
+		deadlinesByKey = [NSMutableDictionary new];
+
+		if ((queue = aQueue) != NULL)
+		{
+			__block ISResourceMediatorDeadlineScheduler *blockSelf = self; // Don't retain self from the timer's event handler
+
+			dispatch_retain(queue);
+
+			timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+
+			dispatch_source_set_event_handler(timer, ^{
+				[blockSelf fireDueDeadlines];
+			});
+
+			dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, kISResourceMediatorDeadlineSchedulerLeeway);
+			dispatch_resume(timer);
+		}
+	}
+
+	return (self);
+}
+
+- (instancetype)init
+{
+	return ([self initWithQueue:dispatch_get_main_queue()]);
+}
+
+- (void)dealloc
+{
+	if (timer != NULL)
+	{
+		dispatch_source_cancel(timer);
+		dispatch_release(timer);
+		timer = NULL;
+	}
+
+	if (queue != NULL)
+	{
+		dispatch_release(queue);
+		queue = NULL;
+	}
+
+	[heap release];
+	heap = nil;
+
+	[deadlinesByKey release];
+	deadlinesByKey = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Heap
+- (void)_swapHeapIndex:(NSUInteger)index withIndex:(NSUInteger)otherIndex
+{
+	ISResourceMediatorDeadline *entry = [heap objectAtIndex:index], *otherEntry = [heap objectAtIndex:otherIndex];
+
+	[heap exchangeObjectAtIndex:index withObjectAtIndex:otherIndex];
+
+	entry.heapIndex = otherIndex;
+	otherEntry.heapIndex = index;
+}
+
+- (void)_siftUpFromIndex:(NSUInteger)index
+{
+	while (index > 0)
+	{
+		NSUInteger parentIndex = (index - 1) / 2;
+
+		if ([heap objectAtIndex:parentIndex].deadline <= [heap objectAtIndex:index].deadline)
+		{
+			break;
+		}
+
+		[self _swapHeapIndex:index withIndex:parentIndex];
+		index = parentIndex;
+	}
+}
+
+- (void)_siftDownFromIndex:(NSUInteger)index
+{
+	NSUInteger count = heap.count;
+
+	while (YES)
+	{
+		NSUInteger smallestIndex = index, leftIndex = (2 * index) + 1, rightIndex = leftIndex + 1;
+
+		if ((leftIndex < count) && ([heap objectAtIndex:leftIndex].deadline < [heap objectAtIndex:smallestIndex].deadline))
+		{
+			smallestIndex = leftIndex;
+		}
+
+		if ((rightIndex < count) && ([heap objectAtIndex:rightIndex].deadline < [heap objectAtIndex:smallestIndex].deadline))
+		{
+			smallestIndex = rightIndex;
+		}
+
+		if (smallestIndex == index)
+		{
+			break;
+		}
+
+		[self _swapHeapIndex:index withIndex:smallestIndex];
+		index = smallestIndex;
+	}
+}
+
+- (void)_removeDeadline:(ISResourceMediatorDeadline *)entry
+{
+	NSUInteger index = entry.heapIndex, lastIndex = heap.count - 1;
+
+	[[entry retain] autorelease];
+
+	if (index != lastIndex)
+	{
+		[self _swapHeapIndex:index withIndex:lastIndex];
+	}
+
+	[heap removeLastObject];
+	[deadlinesByKey removeObjectForKey:entry.key];
+
+	if (index < heap.count)
+	{
+		[self _siftDownFromIndex:index];
+		[self _siftUpFromIndex:index];
+	}
+}
+
+#pragma mark - Timer
+- (void)_updateTimer
+{
+	NSTimeInterval earliestDeadline = (heap.count > 0) ? [heap objectAtIndex:0].deadline : 0;
+
+	if (timer == NULL)
+	{
+		return;
+	}
+
+	if (earliestDeadline != timerDeadline)
+	{
+		timerDeadline = earliestDeadline;
+
+		if (earliestDeadline == 0)
+		{
+			dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, kISResourceMediatorDeadlineSchedulerLeeway);
+		}
+		else
+		{
+			NSTimeInterval delay = MAX(earliestDeadline - [self currentTime], 0);
+
+			dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, kISResourceMediatorDeadlineSchedulerLeeway);
+		}
+	}
+}
+
+#pragma mark - Scheduling
+- (void)scheduleDeadline:(NSTimeInterval)deadline forKey:(id <NSCopying>)key handler:(dispatch_block_t)handler
+{
+	ISResourceMediatorDeadline *entry;
+
+	@synchronized(self)
+	{
+		if ((entry = [deadlinesByKey objectForKey:key]) != nil)
+		{
+			[self _removeDeadline:entry];
+		}
+
+		if ((entry = [ISResourceMediatorDeadline new]) != nil)
+		{
+			entry.deadline = deadline;
+			entry.key = key;
+			entry.handler = handler;
+			entry.heapIndex = heap.count;
+
+			[heap addObject:entry];
+			[deadlinesByKey setObject:entry forKey:key];
+
+			[self _siftUpFromIndex:entry.heapIndex];
+
+			[entry release];
+		}
+
+		[self _updateTimer];
+	}
+}
+
+- (void)scheduleAfter:(NSTimeInterval)delay forKey:(id <NSCopying>)key handler:(dispatch_block_t)handler
+{
+	[self scheduleDeadline:([self currentTime] + delay) forKey:key handler:handler];
+}
+
+- (BOOL)cancelDeadlineForKey:(id <NSCopying>)key
+{
+	ISResourceMediatorDeadline *entry;
+
+	@synchronized(self)
+	{
+		if ((entry = [deadlinesByKey objectForKey:key]) != nil)
+		{
+			[self _removeDeadline:entry];
+			[self _updateTimer];
+
+			return (YES);
+		}
+	}
+
+	return (NO);
+}
+
+- (void)cancelAllDeadlines
+{
+	@synchronized(self)
+	{
+		[heap removeAllObjects];
+		[deadlinesByKey removeAllObjects];
+
+		[self _updateTimer];
+	}
+}
+
+- (NSUInteger)count
+{
+	@synchronized(self)
+	{
+		return (heap.count);
+	}
+}
+
+- (NSTimeInterval)nextDeadline
+{
+	@synchronized(self)
+	{
+		return ((heap.count > 0) ? [heap objectAtIndex:0].deadline : 0);
+	}
+}
+
+#pragma mark - Time
+- (NSTimeInterval)currentTime
+{
+	return ([NSDate timeIntervalSinceReferenceDate]);
+}
+
+- (void)fireDueDeadlines
+{
+	NSMutableArray <dispatch_block_t> *dueHandlers = nil;
+	NSTimeInterval now = [self currentTime];
+
+	@synchronized(self)
+	{
+		ISResourceMediatorDeadline *entry;
+
+		while ((heap.count > 0) && ((entry = [heap objectAtIndex:0]).deadline <= now))
+		{
+			if (dueHandlers == nil)
+			{
+				dueHandlers = [NSMutableArray array];
+			}
+
+			[dueHandlers addObject:entry.handler];
+
+			[self _removeDeadline:entry];
+		}
+
+		// Force re-arming, as the timer may have fired early (within its leeway)
+		timerDeadline = -1;
+		[self _updateTimer];
+	}
+
+	// Call handlers outside the lock, so they can schedule new deadlines
+	for (dispatch_block_t handler in dueHandlers)
+	{
+		handler();
+	}
+}
+
+@end
@@ -0,0 +1,91 @@
+//
+//  ISResourceMediatorHub.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorHub receives mediator messages on behalf of all ISResourceMediator instances of a process.
+
+	Each resource identifier is subscribed to once per (resource identifier, pid) pair on the hub's transport, incoming
+	messages are decoded once and then routed - through a hash table lookup of the resource identifier - to the mediators
+	for that resource identifier. Messages carrying a targetPID are only delivered to the mediator with that pid,
+	multicast messages carrying targetPIDs only to the mediators with those pids.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorCodec.h"
+#import "ISResourceMediatorTransport.h"
+#import "ISResourceMediatorMetrics.h"
+
+@class ISResourceMediator;
+@class ISResourceMediatorHubRoute;
+
+@interface ISResourceMediatorHub : NSObject
+{
+	id <ISResourceMediatorTransport> transport;
+
+	NSMutableDictionary <NSString *, ISResourceMediatorHubRoute *> *routesByResourceIdentifier;
+
+	NSMutableDictionary <NSString *, NSMutableSet <NSNumber *> *> *knownPeerPIDsByResourceIdentifier;
+
+	NSUInteger discoveryLatencySampleCount;
+	NSTimeInterval smoothedDiscoveryLatency;
+	NSTimeInterval discoveryLatencyVariation;
+
+	ISResourceMediatorMetrics *metrics;
+}
+
+@property(retain,readonly) id <ISResourceMediatorTransport> transport; //!< The transport used to exchange messages with other processes.
+@property(retain,readonly) ISResourceMediatorMetrics *metrics; //!< Incoming messages and bytes decoded by the hub, decoding failures and deliveries skipped because of a targetPID.
+
++ (instancetype)sharedHub; //!< The hub used by all ISResourceMediator instances by default. Uses ISResourceMediatorDistributedNotificationTransport.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithTransport:(id <ISResourceMediatorTransport>)aTransport; //!< Creates a hub using aTransport. -init creates a hub using ISResourceMediatorDistributedNotificationTransport.
+
+#pragma mark - Mediator registration
+- (void)addMediator:(ISResourceMediator *)mediator; //!< Starts routing messages for mediator.resourceIdentifier to mediator. Does not retain mediator.
+- (void)removeMediator:(ISResourceMediator *)mediator; //!< Stops routing messages to mediator.
+
+#pragma mark - Sending & receiving
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo; //!< Sends an encoded message through the transport. Use targetPID 0 for broadcasts.
+- (void)routeMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier object:(id)encodedUserInfo; //!< Called by the transport for incoming messages. Decodes the message and delivers it to the mediators for resourceIdentifier.
+
+#pragma mark - Discovery
+- (NSSet <NSNumber *> *)knownPeerPIDsForResourceIdentifier:(NSString *)resourceIdentifier; //!< PIDs of all mediators for resourceIdentifier the hub has seen a [SCAN] or [STATUS] from, including local mediators.
+- (void)forgetPeerPIDs:(NSSet <NSNumber *> *)peerPIDs forResourceIdentifier:(NSString *)resourceIdentifier; //!< Removes peerPIDs from the known peers, f.ex. because they terminated or didn't answer a [SCAN].
+
+- (void)noteDiscoveryLatency:(NSTimeInterval)latency; //!< Adds a measured [SCAN] to [STATUS] round trip time to the latency estimate.
+@property(readonly) NSTimeInterval discoveryTimeout; //!< How long to wait for [STATUS] replies from peers that haven't answered a [SCAN] yet. Derived from the observed round trip times.
+
+@end
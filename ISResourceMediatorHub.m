@@ -0,0 +1,391 @@
+//
+//  ISResourceMediatorHub.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorHub.h"
+#import "ISResourceMediator.h"
+
+#define kISResourceMediatorHubDefaultDiscoveryTimeout	0.2
+#define kISResourceMediatorHubMinimumDiscoveryTimeout	0.025
+#define kISResourceMediatorHubMaximumDiscoveryTimeout	1.0
+
+@interface ISResourceMediatorHubRoute : NSObject
+{
+	NSString *resourceIdentifier;
+
+	NSHashTable *mediators;
+	NSCountedSet <NSNumber *> *subscribedPIDs;
+}
+
+@property(retain,readonly) NSString *resourceIdentifier;
+@property(retain,readonly) NSHashTable *mediators;
+@property(retain,readonly) NSCountedSet <NSNumber *> *subscribedPIDs;
+
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier;
+
+@end
+
+@implementation ISResourceMediatorHubRoute
+
+@synthesize resourceIdentifier;
+@synthesize mediators;
+@synthesize subscribedPIDs;
+
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier
+{
+	if ((self = [self init]) != nil)
+	{
+		resourceIdentifier = [aResourceIdentifier copy];
+
+		// Mediators remove themselves from within -dealloc, so references have to be weak: a message routed on another thread at that time must not reach them anymore
+		mediators = [[NSHashTable alloc] initWithOptions:(NSPointerFunctionsWeakMemory|NSPointerFunctionsObjectPointerPersonality) capacity:4];
+
+		// Weak references to deallocating mediators read as nil, so subscriptions are tracked separately
+		subscribedPIDs = [NSCountedSet new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[resourceIdentifier release];
+	resourceIdentifier = nil;
+
+	[mediators release];
+	mediators = nil;
+
+	[subscribedPIDs release];
+	subscribedPIDs = nil;
+
+	[super dealloc];
+}
+
+@end
+
+@implementation ISResourceMediatorHub
+
+@synthesize transport;
+@synthesize metrics;
+
++ (instancetype)sharedHub
+{
+	static ISResourceMediatorHub *sharedHub;
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		sharedHub = [ISResourceMediatorHub new];
+	});
+
+	return (sharedHub);
+}
+
+#pragma mark - Init & Dealloc
+- (instancetype)init
+{
+	ISResourceMediatorDistributedNotificationTransport *distributedNotificationTransport = [[ISResourceMediatorDistributedNotificationTransport new] autorelease];
+
+	return ([self initWithTransport:distributedNotificationTransport]);
+}
+
+- (instancetype)initWithTransport:(id <ISResourceMediatorTransport>)aTransport
+{
+	if ((self = [super init]) != nil)
+	{
+		transport = [aTransport retain];
+		transport.hub = self;
+
+		routesByResourceIdentifier = [NSMutableDictionary new];
+		knownPeerPIDsByResourceIdentifier = [NSMutableDictionary new];
+
+		metrics = [ISResourceMediatorMetrics new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	if (transport.hub == self)
+	{
+		transport.hub = nil;
+	}
+
+	[transport release];
+	transport = nil;
+
+	[routesByResourceIdentifier release];
+	routesByResourceIdentifier = nil;
+
+	[knownPeerPIDsByResourceIdentifier release];
+	knownPeerPIDsByResourceIdentifier = nil;
+
+	[metrics release];
+	metrics = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Mediator registration
+- (void)addMediator:(ISResourceMediator *)mediator
+{
+	NSString *resourceIdentifier = mediator.resourceIdentifier;
+
+	if (resourceIdentifier == nil)
+	{
+		return;
+	}
+
+	@synchronized(self)
+	{
+		ISResourceMediatorHubRoute *route;
+
+		if ((route = [routesByResourceIdentifier objectForKey:resourceIdentifier]) == nil)
+		{
+			if ((route = [[ISResourceMediatorHubRoute alloc] initWithResourceIdentifier:resourceIdentifier]) != nil)
+			{
+				[routesByResourceIdentifier setObject:route forKey:resourceIdentifier];
+				[route release];
+			}
+		}
+
+		if (![route.mediators containsObject:mediator])
+		{
+			[route.mediators addObject:mediator];
+			[route.subscribedPIDs addObject:@(mediator.pid)];
+
+			[transport subscribePID:mediator.pid toResourceIdentifier:resourceIdentifier];
+		}
+	}
+}
+
+- (void)removeMediator:(ISResourceMediator *)mediator
+{
+	NSString *resourceIdentifier = mediator.resourceIdentifier;
+
+	if (resourceIdentifier == nil)
+	{
+		return;
+	}
+
+	@synchronized(self)
+	{
+		ISResourceMediatorHubRoute *route;
+
+		if ((route = [routesByResourceIdentifier objectForKey:resourceIdentifier]) != nil)
+		{
+			if ([route.subscribedPIDs countForObject:@(mediator.pid)] > 0)
+			{
+				[route.mediators removeObject:mediator];
+				[route.subscribedPIDs removeObject:@(mediator.pid)];
+
+				[transport unsubscribePID:mediator.pid fromResourceIdentifier:resourceIdentifier];
+
+				// Local mediators won't answer [SCAN]s while inactive
+				[[knownPeerPIDsByResourceIdentifier objectForKey:resourceIdentifier] removeObject:@(mediator.pid)];
+			}
+
+			if (route.subscribedPIDs.count == 0)
+			{
+				[routesByResourceIdentifier removeObjectForKey:resourceIdentifier];
+			}
+		}
+	}
+}
+
+#pragma mark - Sending & receiving
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	[transport postMessage:messageType resourceIdentifier:resourceIdentifier targetPID:targetPID object:encodedUserInfo];
+}
+
+- (void)routeMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier object:(id)encodedUserInfo
+{
+	ISResourceMediatorWireFormat peerFormat = kISResourceMediatorWireFormatPropertyList;
+	NSArray <ISResourceMediator *> *mediators = nil;
+	NSDictionary *userInfo = nil;
+	NSNumber *targetPIDNumber = nil;
+	NSArray <NSNumber *> *targetPIDs = nil;
+
+	if (messageType >= kISResourceMediatorMessageTypeCount)
+	{
+		return;
+	}
+
+	@synchronized(self)
+	{
+		// Snapshot under the lock: the array retains every mediator that's still alive and skips those already deallocating
+		mediators = [routesByResourceIdentifier objectForKey:resourceIdentifier].mediators.allObjects;
+	}
+
+	if (mediators.count == 0)
+	{
+		return;
+	}
+
+	// Decode once for all mediators
+	// (OS X App Sandbox prohibits/prevents any NSDistributedNotifications with userInfo dictionary, but will happily accept and
+	// deliver megabyte-sized (!) strings as "objects" (tested this up to 64MB), so we shouldn't hit any limit)
+	if ((encodedUserInfo != nil) && ([encodedUserInfo isKindOfClass:[NSString class]]))
+	{
+		NSError *error = nil;
+
+		if ((userInfo = [ISResourceMediatorCodec userInfoWithString:encodedUserInfo format:&peerFormat error:&error]) == nil)
+		{
+			if (error != nil)
+			{
+				NSLog(@"Error decoding resource mediator notification object '%@': %@", encodedUserInfo, error);
+			}
+
+			[metrics noteMessageDecodingFailed];
+			return;
+		}
+
+		[metrics noteMessageReceived:messageType encodedLength:[(NSString *)encodedUserInfo lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+
+		targetPIDNumber = [userInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey];
+
+		if ((targetPIDs = [userInfo objectForKey:kISResourceMediatorNotificationTargetPIDsKey]) != nil)
+		{
+			if (![targetPIDs isKindOfClass:[NSArray class]])
+			{
+				[metrics noteMessageDecodingFailed];
+				return;
+			}
+		}
+
+		// Remember peers announcing themselves
+		if ((messageType == kISResourceMediatorMessageTypeScan) || (messageType == kISResourceMediatorMessageTypeStatus))
+		{
+			NSNumber *peerPIDNumber;
+
+			if ((peerPIDNumber = [userInfo objectForKey:kISResourceMediatorNotificationPIDKey]) != nil)
+			{
+				@synchronized(self)
+				{
+					NSMutableSet <NSNumber *> *knownPeerPIDs;
+
+					if ((knownPeerPIDs = [knownPeerPIDsByResourceIdentifier objectForKey:resourceIdentifier]) == nil)
+					{
+						knownPeerPIDs = [NSMutableSet set];
+						[knownPeerPIDsByResourceIdentifier setObject:knownPeerPIDs forKey:resourceIdentifier];
+					}
+
+					[knownPeerPIDs addObject:peerPIDNumber];
+				}
+			}
+		}
+	}
+
+	for (ISResourceMediator *mediator in mediators)
+	{
+		// Ignore messages for which the mediator isn't the target
+		if (((targetPIDNumber != nil) && ([targetPIDNumber intValue] != mediator.pid)) ||
+		    ((targetPIDs != nil) && ![targetPIDs containsObject:@(mediator.pid)]))
+		{
+			[metrics noteMessageDroppedByTargetPID];
+			continue;
+		}
+
+		[mediator handleMediatorMessage:messageType userInfo:userInfo peerFormat:peerFormat];
+	}
+}
+
+#pragma mark - Discovery
+- (NSSet <NSNumber *> *)knownPeerPIDsForResourceIdentifier:(NSString *)resourceIdentifier
+{
+	NSSet <NSNumber *> *knownPeerPIDs = nil;
+
+	@synchronized(self)
+	{
+		knownPeerPIDs = [NSSet setWithSet:[knownPeerPIDsByResourceIdentifier objectForKey:resourceIdentifier]];
+	}
+
+	return (knownPeerPIDs);
+}
+
+- (void)forgetPeerPIDs:(NSSet <NSNumber *> *)peerPIDs forResourceIdentifier:(NSString *)resourceIdentifier
+{
+	@synchronized(self)
+	{
+		NSMutableSet <NSNumber *> *knownPeerPIDs;
+
+		if ((knownPeerPIDs = [knownPeerPIDsByResourceIdentifier objectForKey:resourceIdentifier]) != nil)
+		{
+			[knownPeerPIDs minusSet:peerPIDs];
+
+			if (knownPeerPIDs.count == 0)
+			{
+				[knownPeerPIDsByResourceIdentifier removeObjectForKey:resourceIdentifier];
+			}
+		}
+	}
+}
+
+- (void)noteDiscoveryLatency:(NSTimeInterval)latency
+{
+	@synchronized(self)
+	{
+		// Smoothed round trip time and variation, as used for TCP retransmission timeouts (RFC 6298)
+		if (discoveryLatencySampleCount == 0)
+		{
+			smoothedDiscoveryLatency = latency;
+			discoveryLatencyVariation = latency / 2.0;
+		}
+		else
+		{
+			discoveryLatencyVariation = (0.75 * discoveryLatencyVariation) + (0.25 * fabs(smoothedDiscoveryLatency - latency));
+			smoothedDiscoveryLatency  = (0.875 * smoothedDiscoveryLatency) + (0.125 * latency);
+		}
+
+		discoveryLatencySampleCount++;
+	}
+}
+
+- (NSTimeInterval)discoveryTimeout
+{
+	NSTimeInterval discoveryTimeout = kISResourceMediatorHubDefaultDiscoveryTimeout;
+
+	@synchronized(self)
+	{
+		if (discoveryLatencySampleCount > 0)
+		{
+			discoveryTimeout = smoothedDiscoveryLatency + (4.0 * discoveryLatencyVariation);
+		}
+	}
+
+	return (MIN(MAX(discoveryTimeout, kISResourceMediatorHubMinimumDiscoveryTimeout), kISResourceMediatorHubMaximumDiscoveryTimeout));
+}
+
+@end
@@ -0,0 +1,95 @@
+//
+//  ISResourceMediatorMetrics.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorMetrics collects counters and latency histograms for the mediation pipeline.
+
+	All updates are lock-free (relaxed C11 atomics), so metrics can stay enabled in production. Histograms use power-of-two
+	microsecond buckets - percentiles in snapshots are therefore upper bounds, accurate to a factor of two.
+
+	Snapshots are property list compatible dictionaries and can be exported as property list or JSON data.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorCodec.h"
+
+/*!
+     @abstract Latency histograms tracked by ISResourceMediatorMetrics.
+     @constant kISResourceMediatorMetricsHistogramCommandQueueWait		Time commands spent in the command queue before being executed.
+     @constant kISResourceMediatorMetricsHistogramDelegateAccessChange		Time the delegate took in -resourceMediator:setApplicationAccessForResource:requestedBy:completion: until calling the completion handler.
+     @constant kISResourceMediatorMetricsHistogramHandoffRequestToResponse	Time from sending an [ACCESS_REQUEST] (first attempt) to receiving the [ACCESS_RESPONSE].
+     @constant kISResourceMediatorMetricsHistogramHandoffResponseToAccess	Time from receiving a successful [ACCESS_RESPONSE] to actualAccess changing.
+     @constant kISResourceMediatorMetricsHistogramHandoffTotal			Time from sending an [ACCESS_REQUEST] to actualAccess changing.
+*/
+typedef NS_ENUM(NSUInteger, ISResourceMediatorMetricsHistogram)
+{
+	kISResourceMediatorMetricsHistogramCommandQueueWait,
+	kISResourceMediatorMetricsHistogramDelegateAccessChange,
+	kISResourceMediatorMetricsHistogramHandoffRequestToResponse,
+	kISResourceMediatorMetricsHistogramHandoffResponseToAccess,
+	kISResourceMediatorMetricsHistogramHandoffTotal,
+
+	kISResourceMediatorMetricsHistogramCount
+};
+
+struct ISResourceMediatorMetricsStorage;
+
+@interface ISResourceMediatorMetrics : NSObject
+{
+	struct ISResourceMediatorMetricsStorage *storage;
+}
+
+#pragma mark - Recording
+- (void)noteMessageSent:(ISResourceMediatorMessageType)messageType encodedLength:(NSUInteger)encodedLength; //!< Counts an outgoing message and its encoded size in bytes.
+- (void)noteMessageReceived:(ISResourceMediatorMessageType)messageType encodedLength:(NSUInteger)encodedLength; //!< Counts an incoming message and its encoded size in bytes (0 if already counted elsewhere).
+- (void)noteMessageDecodingFailed; //!< Counts an incoming message that couldn't be decoded.
+- (void)noteMessageDroppedByTargetPID; //!< Counts a delivery skipped because the message targeted another pid.
+
+- (void)noteCommandQueueDepth:(NSUInteger)depth; //!< Updates the current (and maximum) command queue depth.
+
+- (void)noteDuration:(NSTimeInterval)duration forHistogram:(ISResourceMediatorMetricsHistogram)histogram; //!< Adds a sample to a latency histogram.
+
+- (void)reset; //!< Resets all counters and histograms.
+
+#pragma mark - Export
+- (NSDictionary *)snapshot; //!< Returns a property list compatible dictionary with the current values of all counters and histograms.
+
+- (NSData *)propertyListDataWithFormat:(NSPropertyListFormat)format error:(NSError **)outError; //!< Returns -snapshot serialized as property list.
+- (NSData *)JSONDataWithError:(NSError **)outError; //!< Returns -snapshot serialized as JSON.
+
++ (NSString *)nameForHistogram:(ISResourceMediatorMetricsHistogram)histogram; //!< Key used for histogram in snapshots.
++ (NSString *)nameForMessageType:(ISResourceMediatorMessageType)messageType; //!< Key used for messageType in snapshots.
+
+@end
@@ -0,0 +1,298 @@
+//
+//  ISResourceMediatorMetrics.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorMetrics.h"
+
+#include <stdatomic.h>
+
+#define kISResourceMediatorMetricsHistogramBucketCount 32 // Bucket n counts samples of [2^(n-1), 2^n) microseconds. Bucket 0 counts samples below 1 µs, the last bucket everything above ~18 minutes.
+
+typedef struct
+{
+	atomic_uint_fast64_t count;
+	atomic_uint_fast64_t sumMicroseconds;
+	atomic_uint_fast64_t maxMicroseconds;
+
+	atomic_uint_fast64_t buckets[kISResourceMediatorMetricsHistogramBucketCount];
+} ISResourceMediatorMetricsHistogramStorage;
+
+struct ISResourceMediatorMetricsStorage
+{
+	atomic_uint_fast64_t messagesSent[kISResourceMediatorMessageTypeCount];
+	atomic_uint_fast64_t messagesReceived[kISResourceMediatorMessageTypeCount];
+	atomic_uint_fast64_t bytesEncoded;
+	atomic_uint_fast64_t bytesDecoded;
+	atomic_uint_fast64_t messagesFailedDecoding;
+	atomic_uint_fast64_t messagesDroppedByTargetPID;
+
+	atomic_uint_fast64_t commandQueueDepth;
+	atomic_uint_fast64_t commandQueueMaxDepth;
+
+	ISResourceMediatorMetricsHistogramStorage histograms[kISResourceMediatorMetricsHistogramCount];
+};
+
+static void ISResourceMediatorMetricsUpdateMaximum(atomic_uint_fast64_t *maximum, uint64_t value)
+{
+	uint64_t currentMaximum = atomic_load_explicit(maximum, memory_order_relaxed);
+
+	while ((value > currentMaximum) && !atomic_compare_exchange_weak_explicit(maximum, &currentMaximum, value, memory_order_relaxed, memory_order_relaxed))
+	{
+	}
+}
+
+static void ISResourceMediatorMetricsAdd(atomic_uint_fast64_t *counter, uint64_t value)
+{
+	atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+static uint64_t ISResourceMediatorMetricsLoad(atomic_uint_fast64_t *counter)
+{
+	return (atomic_load_explicit(counter, memory_order_relaxed));
+}
+
+@implementation ISResourceMediatorMetrics
+
+#pragma mark - Init & Dealloc
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		storage = calloc(1, sizeof(struct ISResourceMediatorMetricsStorage));
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	if (storage != NULL)
+	{
+		free(storage);
+		storage = NULL;
+	}
+
+	[super dealloc];
+}
+
+#pragma mark - Recording
+- (void)noteMessageSent:(ISResourceMediatorMessageType)messageType encodedLength:(NSUInteger)encodedLength
+{
+	if (messageType < kISResourceMediatorMessageTypeCount)
+	{
+		ISResourceMediatorMetricsAdd(&storage->messagesSent[messageType], 1);
+		ISResourceMediatorMetricsAdd(&storage->bytesEncoded, encodedLength);
+	}
+}
+
+- (void)noteMessageReceived:(ISResourceMediatorMessageType)messageType encodedLength:(NSUInteger)encodedLength
+{
+	if (messageType < kISResourceMediatorMessageTypeCount)
+	{
+		ISResourceMediatorMetricsAdd(&storage->messagesReceived[messageType], 1);
+		ISResourceMediatorMetricsAdd(&storage->bytesDecoded, encodedLength);
+	}
+}
+
+- (void)noteMessageDecodingFailed
+{
+	ISResourceMediatorMetricsAdd(&storage->messagesFailedDecoding, 1);
+}
+
+- (void)noteMessageDroppedByTargetPID
+{
+	ISResourceMediatorMetricsAdd(&storage->messagesDroppedByTargetPID, 1);
+}
+
+- (void)noteCommandQueueDepth:(NSUInteger)depth
+{
+	atomic_store_explicit(&storage->commandQueueDepth, depth, memory_order_relaxed);
+	ISResourceMediatorMetricsUpdateMaximum(&storage->commandQueueMaxDepth, depth);
+}
+
+- (void)noteDuration:(NSTimeInterval)duration forHistogram:(ISResourceMediatorMetricsHistogram)histogram
+{
+	ISResourceMediatorMetricsHistogramStorage *histogramStorage;
+	uint64_t microseconds;
+	NSUInteger bucket;
+
+	if (histogram >= kISResourceMediatorMetricsHistogramCount)
+	{
+		return;
+	}
+
+	histogramStorage = &storage->histograms[histogram];
+	microseconds = (duration > 0) ? (uint64_t)(duration * 1000000.0) : 0;
+	bucket = (microseconds == 0) ? 0 : MIN((NSUInteger)(64 - __builtin_clzll(microseconds)), kISResourceMediatorMetricsHistogramBucketCount-1);
+
+	ISResourceMediatorMetricsAdd(&histogramStorage->count, 1);
+	ISResourceMediatorMetricsAdd(&histogramStorage->sumMicroseconds, microseconds);
+	ISResourceMediatorMetricsAdd(&histogramStorage->buckets[bucket], 1);
+	ISResourceMediatorMetricsUpdateMaximum(&histogramStorage->maxMicroseconds, microseconds);
+}
+
+- (void)reset
+{
+	// Storage consists of counters only. Not atomic as a whole - samples recorded concurrently may survive the reset.
+	atomic_uint_fast64_t *counters = (atomic_uint_fast64_t *)storage;
+
+	for (size_t i=0; i < sizeof(struct ISResourceMediatorMetricsStorage) / sizeof(atomic_uint_fast64_t); i++)
+	{
+		atomic_store_explicit(&counters[i], 0, memory_order_relaxed);
+	}
+}
+
+#pragma mark - Export
++ (NSString *)nameForHistogram:(ISResourceMediatorMetricsHistogram)histogram
+{
+	switch (histogram)
+	{
+		case kISResourceMediatorMetricsHistogramCommandQueueWait:		return (@"commandQueueWait");
+		case kISResourceMediatorMetricsHistogramDelegateAccessChange:		return (@"delegateAccessChange");
+		case kISResourceMediatorMetricsHistogramHandoffRequestToResponse:	return (@"handoffRequestToResponse");
+		case kISResourceMediatorMetricsHistogramHandoffResponseToAccess:	return (@"handoffResponseToAccess");
+		case kISResourceMediatorMetricsHistogramHandoffTotal:			return (@"handoffTotal");
+
+		default:
+		break;
+	}
+
+	return (nil);
+}
+
++ (NSString *)nameForMessageType:(ISResourceMediatorMessageType)messageType
+{
+	switch (messageType)
+	{
+		case kISResourceMediatorMessageTypeScan:		return (@"scan");
+		case kISResourceMediatorMessageTypeStatus:		return (@"status");
+		case kISResourceMediatorMessageTypeAccessRequest:	return (@"accessRequest");
+		case kISResourceMediatorMessageTypeAccessResponse:	return (@"accessResponse");
+
+		default:
+		break;
+	}
+
+	return (nil);
+}
+
+- (NSDictionary *)_snapshotForHistogram:(ISResourceMediatorMetricsHistogram)histogram
+{
+	ISResourceMediatorMetricsHistogramStorage *histogramStorage = &storage->histograms[histogram];
+	uint64_t buckets[kISResourceMediatorMetricsHistogramBucketCount];
+	uint64_t count = 0, percentiles[3] = { 0, 0, 0 };
+	const double percentileRanks[3] = { 0.5, 0.9, 0.99 };
+	NSMutableArray <NSNumber *> *bucketNumbers = [NSMutableArray arrayWithCapacity:kISResourceMediatorMetricsHistogramBucketCount];
+
+	// Derive count from the copied buckets, so percentiles are consistent even while samples are added
+	for (NSUInteger bucket=0; bucket < kISResourceMediatorMetricsHistogramBucketCount; bucket++)
+	{
+		buckets[bucket] = ISResourceMediatorMetricsLoad(&histogramStorage->buckets[bucket]);
+		count += buckets[bucket];
+
+		[bucketNumbers addObject:@(buckets[bucket])];
+	}
+
+	for (NSUInteger rank=0; rank < 3; rank++)
+	{
+		uint64_t cumulativeCount = 0, rankCount = (uint64_t)ceil(count * percentileRanks[rank]);
+
+		for (NSUInteger bucket=0; (bucket < kISResourceMediatorMetricsHistogramBucketCount) && (count > 0); bucket++)
+		{
+			cumulativeCount += buckets[bucket];
+
+			if (cumulativeCount >= rankCount)
+			{
+				percentiles[rank] = (1ULL << bucket); // Upper bound of the bucket
+				break;
+			}
+		}
+	}
+
+	return (@{
+		@"count"	: @(count),
+		@"sumUs"	: @(ISResourceMediatorMetricsLoad(&histogramStorage->sumMicroseconds)),
+		@"maxUs"	: @(ISResourceMediatorMetricsLoad(&histogramStorage->maxMicroseconds)),
+		@"p50Us"	: @(percentiles[0]),
+		@"p90Us"	: @(percentiles[1]),
+		@"p99Us"	: @(percentiles[2]),
+		@"buckets"	: bucketNumbers, // Bucket n: samples of [2^(n-1), 2^n) µs
+	});
+}
+
+- (NSDictionary *)snapshot
+{
+	NSMutableDictionary *messagesSent = [NSMutableDictionary dictionary];
+	NSMutableDictionary *messagesReceived = [NSMutableDictionary dictionary];
+	NSMutableDictionary *histograms = [NSMutableDictionary dictionary];
+
+	for (ISResourceMediatorMessageType messageType=0; messageType < kISResourceMediatorMessageTypeCount; messageType++)
+	{
+		NSString *name = [[self class] nameForMessageType:messageType];
+
+		[messagesSent setObject:@(ISResourceMediatorMetricsLoad(&storage->messagesSent[messageType])) forKey:name];
+		[messagesReceived setObject:@(ISResourceMediatorMetricsLoad(&storage->messagesReceived[messageType])) forKey:name];
+	}
+
+	for (ISResourceMediatorMetricsHistogram histogram=0; histogram < kISResourceMediatorMetricsHistogramCount; histogram++)
+	{
+		[histograms setObject:[self _snapshotForHistogram:histogram] forKey:[[self class] nameForHistogram:histogram]];
+	}
+
+	return (@{
+		@"messagesSent"			: messagesSent,
+		@"messagesReceived"		: messagesReceived,
+		@"bytesEncoded"			: @(ISResourceMediatorMetricsLoad(&storage->bytesEncoded)),
+		@"bytesDecoded"			: @(ISResourceMediatorMetricsLoad(&storage->bytesDecoded)),
+		@"messagesFailedDecoding"	: @(ISResourceMediatorMetricsLoad(&storage->messagesFailedDecoding)),
+		@"messagesDroppedByTargetPID"	: @(ISResourceMediatorMetricsLoad(&storage->messagesDroppedByTargetPID)),
+
+		@"commandQueueDepth"		: @(ISResourceMediatorMetricsLoad(&storage->commandQueueDepth)),
+		@"commandQueueMaxDepth"		: @(ISResourceMediatorMetricsLoad(&storage->commandQueueMaxDepth)),
+
+		@"histograms"			: histograms,
+	});
+}
+
+- (NSData *)propertyListDataWithFormat:(NSPropertyListFormat)format error:(NSError **)outError
+{
+	return ([NSPropertyListSerialization dataWithPropertyList:[self snapshot] format:format options:0 error:outError]);
+}
+
+- (NSData *)JSONDataWithError:(NSError **)outError
+{
+	return ([NSJSONSerialization dataWithJSONObject:[self snapshot] options:(NSJSONWritingPrettyPrinted|NSJSONWritingSortedKeys) error:outError]);
+}
+
+@end
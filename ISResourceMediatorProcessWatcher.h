@@ -0,0 +1,80 @@
+//
+//  ISResourceMediatorProcessWatcher.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorProcessWatcher notifies observers when processes exit.
+
+	Every watched pid is backed by exactly one kernel event source, no matter how many observers are interested in it:
+	a DISPATCH_SOURCE_TYPE_PROC source (kqueue EVFILT_PROC) on Apple platforms, a read source on a pidfd on Linux. When
+	the process exits, all of its observers are notified and the source is removed.
+
+	Unlike NSRunningApplication, this covers any process - including daemons and helper tools - and doesn't need AppKit.
+*/
+
+#import <Foundation/Foundation.h>
+
+@class ISResourceMediatorProcessWatcher;
+@class ISResourceMediatorProcessWatch;
+
+@protocol ISResourceMediatorProcessWatcherObserver <NSObject>
+
+- (void)processWatcher:(ISResourceMediatorProcessWatcher *)processWatcher processDidExit:(pid_t)pid; //!< Called on the watcher's queue when a watched process exited. The observer is no longer registered for pid at this point.
+
+@end
+
+@interface ISResourceMediatorProcessWatcher : NSObject
+{
+	dispatch_queue_t queue;
+
+	NSMutableDictionary <NSNumber *, ISResourceMediatorProcessWatch *> *watchesByPID;
+
+	ISResourceMediatorProcessWatch *exitedWatch; //!< Watch of the process whose observers are being notified
+	NSValue *notifiedObserverValue; //!< Observer whose notification is in progress
+	NSCondition *notificationCondition; //!< Signalled when a notification finishes
+}
+
+@property(readonly) NSUInteger watchedProcessCount; //!< Number of processes currently watched - and therefore kernel event sources in use.
+
++ (instancetype)sharedProcessWatcher; //!< The process-wide watcher used by all mediators by default. Notifies observers on the main queue.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithQueue:(dispatch_queue_t)aQueue; //!< Creates a watcher that notifies observers on aQueue, which must be serial.
+
+#pragma mark - Observers
+- (BOOL)addObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer forPID:(pid_t)pid; //!< Notifies observer once the process with pid exits. The observer is not retained. Returns NO if the process can't be watched, f.ex. because it doesn't exist.
+- (void)removeObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer forPID:(pid_t)pid; //!< Stops notifying observer about pid. The process is no longer watched once it has no observers left.
+- (void)removeObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer; //!< Stops notifying observer about any pid. If a notification of observer is in progress on another thread, waits for just that notification to finish, so it's safe to call from -dealloc.
+
+@end
@@ -0,0 +1,361 @@
+//
+//  ISResourceMediatorProcessWatcher.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorProcessWatcher.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#endif /* __linux__ */
+
+@interface ISResourceMediatorProcessWatch : NSObject
+{
+	pid_t pid;
+	dispatch_source_t source;
+
+	NSMutableSet <NSValue *> *observers;
+}
+
+@property(readonly) pid_t pid;
+@property(retain,readonly) NSMutableSet <NSValue *> *observers; //!< Non-retained observers, wrapped in NSValues
+
+- (instancetype)initWithPID:(pid_t)aPID source:(dispatch_source_t)aSource;
+
+@end
+
+@implementation ISResourceMediatorProcessWatch
+
+@synthesize pid;
+@synthesize observers;
+
+- (instancetype)initWithPID:(pid_t)aPID source:(dispatch_source_t)aSource
+{
+	if ((self = [super init]) != nil)
+	{
+		pid = aPID;
+
+		source = aSource;
+		dispatch_retain(source);
+
+		observers = [NSMutableSet new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	if (source != NULL)
+	{
+		dispatch_source_cancel(source);
+		dispatch_release(source);
+		source = NULL;
+	}
+
+	[observers release];
+	observers = nil;
+
+	[super dealloc];
+}
+
+@end
+
+@implementation ISResourceMediatorProcessWatcher
+
++ (instancetype)sharedProcessWatcher
+{
+	static ISResourceMediatorProcessWatcher *sharedProcessWatcher;
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		sharedProcessWatcher = [[ISResourceMediatorProcessWatcher alloc] initWithQueue:dispatch_get_main_queue()];
+	});
+
+	return (sharedProcessWatcher);
+}
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithQueue:(dispatch_queue_t)aQueue
+{
+	if ((self = [super init]) != nil)
+	{
+		queue = aQueue;
+		dispatch_retain(queue);
+
+		// Lets -removeObserver: detect it's called from within a notification. Several watchers can share a queue, so use self as key.
+		dispatch_queue_set_specific(queue, (void *)self, (void *)self, NULL);
+
+		watchesByPID = [NSMutableDictionary new];
+
+		notificationCondition = [NSCondition new];
+	}
+
+	return (self);
+}
+
+- (instancetype)init
+{
+	return ([self initWithQueue:dispatch_get_main_queue()]);
+}
+
+- (void)dealloc
+{
+	// Cancels all sources
+	[watchesByPID release];
+	watchesByPID = nil;
+
+	[notificationCondition release];
+	notificationCondition = nil;
+
+	if (queue != NULL)
+	{
+		dispatch_queue_set_specific(queue, (void *)self, NULL, NULL);
+
+		dispatch_release(queue);
+		queue = NULL;
+	}
+
+	[super dealloc];
+}
+
+#pragma mark - Sources
+- (dispatch_source_t)_newExitSourceForPID:(pid_t)pid
+{
+	__block ISResourceMediatorProcessWatcher *blockSelf = self; // Don't retain self from the source's event handler
+	dispatch_source_t source = NULL;
+
+	#if defined(__linux__)
+	{
+		int pidFD;
+
+		// The pidfd becomes readable when the process exits
+		if ((pidFD = (int)syscall(SYS_pidfd_open, pid, 0)) < 0)
+		{
+			return (NULL);
+		}
+
+		if ((source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)pidFD, 0, queue)) == NULL)
+		{
+			close(pidFD);
+			return (NULL);
+		}
+
+		dispatch_source_set_cancel_handler(source, ^{
+			close(pidFD);
+		});
+	}
+	#else
+	{
+		// EPERM means the process exists, but belongs to another user - which doesn't keep us from watching it
+		if ((kill(pid, 0) != 0) && (errno == ESRCH))
+		{
+			return (NULL);
+		}
+
+		// If the process exits before the source is registered with kqueue, libdispatch delivers the exit right away
+		if ((source = dispatch_source_create(DISPATCH_SOURCE_TYPE_PROC, (uintptr_t)pid, DISPATCH_PROC_EXIT, queue)) == NULL)
+		{
+			return (NULL);
+		}
+	}
+	#endif /* __linux__ */
+
+	dispatch_source_set_event_handler(source, ^{
+		[blockSelf _processExited:pid];
+	});
+
+	return (source);
+}
+
+- (void)_processExited:(pid_t)pid
+{
+	NSArray <NSValue *> *observers = nil;
+
+	@synchronized(self)
+	{
+		if ((exitedWatch = [[watchesByPID objectForKey:@(pid)] retain]) != nil)
+		{
+			observers = [exitedWatch.observers allObjects];
+
+			// Removing the watch cancels its source, so a pid that gets reused later is watched from scratch
+			[watchesByPID removeObjectForKey:@(pid)];
+		}
+	}
+
+	// Notify outside the lock, so observers can call back into the watcher
+	for (NSValue *observerValue in observers)
+	{
+		@synchronized(self)
+		{
+			// Skip observers removed while earlier ones were notified - they may be gone already
+			if (![exitedWatch.observers containsObject:observerValue])
+			{
+				continue;
+			}
+
+			// Marked in the same critical section, so -removeObserver: either prevents the notification or sees it in progress
+			[notificationCondition lock];
+			notifiedObserverValue = observerValue;
+			[notificationCondition unlock];
+		}
+
+		[(id <ISResourceMediatorProcessWatcherObserver>)observerValue.nonretainedObjectValue processWatcher:self processDidExit:pid];
+
+		[notificationCondition lock];
+		notifiedObserverValue = nil;
+		[notificationCondition broadcast];
+		[notificationCondition unlock];
+	}
+
+	@synchronized(self)
+	{
+		[exitedWatch release];
+		exitedWatch = nil;
+	}
+}
+
+#pragma mark - Observers
+- (BOOL)addObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer forPID:(pid_t)pid
+{
+	ISResourceMediatorProcessWatch *watch = nil;
+
+	if ((observer == nil) || (pid <= 0))
+	{
+		return (NO);
+	}
+
+	@synchronized(self)
+	{
+		if ((watch = [watchesByPID objectForKey:@(pid)]) == nil)
+		{
+			dispatch_source_t source;
+
+			if ((source = [self _newExitSourceForPID:pid]) == NULL)
+			{
+				return (NO);
+			}
+
+			if ((watch = [[ISResourceMediatorProcessWatch alloc] initWithPID:pid source:source]) != nil)
+			{
+				[watchesByPID setObject:watch forKey:@(pid)];
+				[watch release];
+
+				dispatch_resume(source);
+			}
+
+			dispatch_release(source);
+		}
+
+		[watch.observers addObject:[NSValue valueWithNonretainedObject:observer]];
+	}
+
+	return (watch != nil);
+}
+
+- (void)removeObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer forPID:(pid_t)pid
+{
+	@synchronized(self)
+	{
+		ISResourceMediatorProcessWatch *watch;
+
+		if ((watch = [watchesByPID objectForKey:@(pid)]) != nil)
+		{
+			[watch.observers removeObject:[NSValue valueWithNonretainedObject:observer]];
+
+			if (watch.observers.count == 0)
+			{
+				[watchesByPID removeObjectForKey:@(pid)];
+			}
+		}
+
+		if (exitedWatch.pid == pid)
+		{
+			[exitedWatch.observers removeObject:[NSValue valueWithNonretainedObject:observer]];
+		}
+	}
+}
+
+- (void)removeObserver:(id <ISResourceMediatorProcessWatcherObserver>)observer
+{
+	NSValue *observerValue = [NSValue valueWithNonretainedObject:observer];
+
+	@synchronized(self)
+	{
+		for (NSNumber *pidNumber in [watchesByPID allKeys])
+		{
+			ISResourceMediatorProcessWatch *watch = [watchesByPID objectForKey:pidNumber];
+
+			[watch.observers removeObject:observerValue];
+
+			if (watch.observers.count == 0)
+			{
+				[watchesByPID removeObjectForKey:pidNumber];
+			}
+		}
+
+		[exitedWatch.observers removeObject:observerValue];
+	}
+
+	if (dispatch_get_specific((void *)self) != (void *)self)
+	{
+		// A notification of observer that started before its removal may still be running - wait for it to finish. Unlike waiting for
+		// the queue, this doesn't block on unrelated work (or a blocked main thread) when observer isn't being notified.
+		[notificationCondition lock];
+
+		while ([notifiedObserverValue isEqual:observerValue])
+		{
+			[notificationCondition wait];
+		}
+
+		[notificationCondition unlock];
+	}
+}
+
+- (NSUInteger)watchedProcessCount
+{
+	@synchronized(self)
+	{
+		return (watchesByPID.count);
+	}
+}
+
+@end
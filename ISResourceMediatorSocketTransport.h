@@ -0,0 +1,96 @@
+//
+//  ISResourceMediatorSocketTransport.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorSocketTransport exchanges messages through a ISResourceMediatorSocketBroker over a Unix domain socket.
+
+	Unlike NSDistributedNotificationCenter, the broker knows which process subscribed which (resource identifier, pid) pairs,
+	so it delivers targeted messages only to the connection of the target and broadcasts only to connections subscribed to
+	the resource identifier.
+
+	Uses nothing but Foundation, POSIX sockets and libdispatch. NOT compatible with the OS X App Sandbox.
+*/
+
+#import "ISResourceMediatorTransport.h"
+
+@class ISResourceMediatorSocketConnection;
+
+@interface ISResourceMediatorSocketBroker : NSObject
+{
+	NSString *socketPath;
+
+	int listenSocket;
+	dispatch_queue_t queue;
+	dispatch_source_t acceptSource;
+
+	NSMutableArray <ISResourceMediatorSocketConnection *> *connections;
+	NSMutableDictionary <NSString *, NSCountedSet <ISResourceMediatorSocketConnection *> *> *connectionsByResourceIdentifier;
+	NSMutableDictionary <NSString *, NSMutableDictionary <NSNumber *, ISResourceMediatorSocketConnection *> *> *connectionsByPIDByResourceIdentifier;
+}
+
+@property(retain,readonly) NSString *socketPath;
+
++ (NSString *)defaultSocketPath; //!< Default path of the broker socket, located in the temporary directory of the user.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSocketPath:(NSString *)aSocketPath;
+
+#pragma mark - Start/Stop
+- (BOOL)start; //!< Creates the socket (replacing any stale one) and starts accepting connections. Returns NO if the socket could not be created.
+- (void)stop; //!< Closes the socket and all connections.
+
+@end
+
+@interface ISResourceMediatorSocketTransport : NSObject <ISResourceMediatorTransport>
+{
+	ISResourceMediatorHub *hub;
+
+	NSString *socketPath;
+
+	dispatch_queue_t queue;
+	ISResourceMediatorSocketConnection *connection;
+
+	NSMutableDictionary <NSString *, NSCountedSet <NSNumber *> *> *subscribedPIDsByResourceIdentifier;
+}
+
+@property(retain,readonly) NSString *socketPath;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSocketPath:(NSString *)aSocketPath; //!< Creates a transport for the broker listening at aSocketPath. Connects lazily and reconnects (re-sending all subscriptions) after the connection was lost.
+
+#pragma mark - Connection
+- (void)disconnect; //!< Closes the connection to the broker. Call before releasing the transport.
+
+@end
@@ -0,0 +1,965 @@
+//
+//  ISResourceMediatorSocketTransport.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorSocketTransport.h"
+#import "ISResourceMediatorHub.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // Darwin uses SO_NOSIGPIPE instead
+#endif
+
+#define kISResourceMediatorSocketFrameHeaderLength	5		// [UInt32 body length][UInt8 frame type]
+#define kISResourceMediatorSocketFrameMaximumLength	(16*1024*1024)
+
+typedef NS_ENUM(uint8_t, ISResourceMediatorSocketFrameType)
+{
+	kISResourceMediatorSocketFrameTypeSubscribe = 1,	// [Int32 pid][resource identifier]
+	kISResourceMediatorSocketFrameTypeUnsubscribe,		// [Int32 pid][resource identifier]
+	kISResourceMediatorSocketFrameTypeMessage		// [UInt8 message type][Int32 target pid][UInt16 resource identifier length][resource identifier][encoded userInfo]
+};
+
+typedef void(^ISResourceMediatorSocketFrameHandler)(ISResourceMediatorSocketConnection *connection, ISResourceMediatorSocketFrameType frameType, NSData *frameBody);
+
+#pragma mark - Frames
+static NSData *ISResourceMediatorSocketFrameData(ISResourceMediatorSocketFrameType frameType, NSData *frameBody)
+{
+	NSMutableData *frameData = [NSMutableData dataWithCapacity:kISResourceMediatorSocketFrameHeaderLength + frameBody.length];
+	uint32_t bodyLength = NSSwapHostIntToLittle((uint32_t)frameBody.length);
+	uint8_t type = frameType;
+
+	[frameData appendBytes:&bodyLength length:4];
+	[frameData appendBytes:&type length:1];
+
+	if (frameBody != nil)
+	{
+		[frameData appendData:frameBody];
+	}
+
+	return (frameData);
+}
+
+static NSData *ISResourceMediatorSocketSubscriptionFrameData(ISResourceMediatorSocketFrameType frameType, pid_t pid, NSString *resourceIdentifier)
+{
+	NSMutableData *frameBody = [NSMutableData dataWithCapacity:64];
+	uint32_t pidValue = NSSwapHostIntToLittle((uint32_t)pid);
+
+	[frameBody appendBytes:&pidValue length:4];
+	[frameBody appendData:[resourceIdentifier dataUsingEncoding:NSUTF8StringEncoding]];
+
+	return (ISResourceMediatorSocketFrameData(frameType, frameBody));
+}
+
+static BOOL ISResourceMediatorSocketParseSubscription(NSData *frameBody, pid_t *outPID, NSString **outResourceIdentifier)
+{
+	const uint8_t *bytes = (const uint8_t *)frameBody.bytes;
+	uint32_t pidValue;
+
+	if (frameBody.length < 5)
+	{
+		return (NO);
+	}
+
+	memcpy(&pidValue, bytes, 4);
+
+	*outPID = (pid_t)NSSwapLittleIntToHost(pidValue);
+	*outResourceIdentifier = [[[NSString alloc] initWithBytes:&bytes[4] length:frameBody.length-4 encoding:NSUTF8StringEncoding] autorelease];
+
+	return (*outResourceIdentifier != nil);
+}
+
+static NSData *ISResourceMediatorSocketMessageFrameData(ISResourceMediatorMessageType messageType, pid_t targetPID, NSString *resourceIdentifier, NSString *encodedUserInfo)
+{
+	NSData *resourceIdentifierData = [resourceIdentifier dataUsingEncoding:NSUTF8StringEncoding];
+	NSData *encodedUserInfoData = [encodedUserInfo dataUsingEncoding:NSUTF8StringEncoding];
+	NSMutableData *frameBody = [NSMutableData dataWithCapacity:7 + resourceIdentifierData.length + encodedUserInfoData.length];
+	uint32_t targetPIDValue = NSSwapHostIntToLittle((uint32_t)targetPID);
+	uint16_t resourceIdentifierLength = NSSwapHostShortToLittle((uint16_t)resourceIdentifierData.length);
+	uint8_t type = messageType;
+
+	[frameBody appendBytes:&type length:1];
+	[frameBody appendBytes:&targetPIDValue length:4];
+	[frameBody appendBytes:&resourceIdentifierLength length:2];
+	[frameBody appendData:resourceIdentifierData];
+
+	if (encodedUserInfoData != nil)
+	{
+		[frameBody appendData:encodedUserInfoData];
+	}
+
+	return (ISResourceMediatorSocketFrameData(kISResourceMediatorSocketFrameTypeMessage, frameBody));
+}
+
+static BOOL ISResourceMediatorSocketParseMessage(NSData *frameBody, ISResourceMediatorMessageType *outMessageType, pid_t *outTargetPID, NSString **outResourceIdentifier, NSString **outEncodedUserInfo)
+{
+	const uint8_t *bytes = (const uint8_t *)frameBody.bytes;
+	uint32_t targetPIDValue;
+	uint16_t resourceIdentifierLength;
+	NSUInteger payloadOffset;
+
+	if (frameBody.length < 7)
+	{
+		return (NO);
+	}
+
+	memcpy(&targetPIDValue, &bytes[1], 4);
+	memcpy(&resourceIdentifierLength, &bytes[5], 2);
+
+	resourceIdentifierLength = NSSwapLittleShortToHost(resourceIdentifierLength);
+	payloadOffset = 7 + resourceIdentifierLength;
+
+	if (payloadOffset > frameBody.length)
+	{
+		return (NO);
+	}
+
+	*outMessageType = (ISResourceMediatorMessageType)bytes[0];
+	*outTargetPID = (pid_t)NSSwapLittleIntToHost(targetPIDValue);
+	*outResourceIdentifier = [[[NSString alloc] initWithBytes:&bytes[7] length:resourceIdentifierLength encoding:NSUTF8StringEncoding] autorelease];
+
+	if (outEncodedUserInfo != NULL)
+	{
+		*outEncodedUserInfo = nil;
+
+		if (payloadOffset < frameBody.length)
+		{
+			*outEncodedUserInfo = [[[NSString alloc] initWithBytes:&bytes[payloadOffset] length:frameBody.length-payloadOffset encoding:NSUTF8StringEncoding] autorelease];
+		}
+	}
+
+	return (*outResourceIdentifier != nil);
+}
+
+static BOOL ISResourceMediatorSocketConfigure(int socketFD)
+{
+	int flags;
+
+	#ifdef SO_NOSIGPIPE
+	int noSigPipe = 1;
+
+	setsockopt(socketFD, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+	#endif
+
+	if ((flags = fcntl(socketFD, F_GETFL, 0)) == -1)
+	{
+		return (NO);
+	}
+
+	return (fcntl(socketFD, F_SETFL, flags | O_NONBLOCK) != -1);
+}
+
+static BOOL ISResourceMediatorSocketAddressForPath(NSString *socketPath, struct sockaddr_un *outAddress)
+{
+	const char *fileSystemPath = socketPath.fileSystemRepresentation;
+
+	memset(outAddress, 0, sizeof(struct sockaddr_un));
+	outAddress->sun_family = AF_UNIX;
+
+	if ((fileSystemPath == NULL) || (strlen(fileSystemPath) >= sizeof(outAddress->sun_path)))
+	{
+		return (NO);
+	}
+
+	strncpy(outAddress->sun_path, fileSystemPath, sizeof(outAddress->sun_path) - 1);
+
+	return (YES);
+}
+
+#pragma mark - Connection
+@interface ISResourceMediatorSocketConnection : NSObject
+{
+	int socketFD;
+
+	dispatch_queue_t queue;
+	dispatch_source_t readSource;
+	dispatch_source_t writeSource;
+	BOOL writeSourceSuspended;
+
+	NSMutableData *readBuffer;
+	NSMutableData *writeBuffer;
+
+	ISResourceMediatorSocketFrameHandler frameHandler;
+	dispatch_block_t closeHandler;
+
+	BOOL closed;
+}
+
+@property(copy) ISResourceMediatorSocketFrameHandler frameHandler; //!< Called on the connection's queue for every received frame.
+@property(copy) dispatch_block_t closeHandler; //!< Called on the connection's queue when the connection was closed.
+
+- (instancetype)initWithSocket:(int)aSocketFD queue:(dispatch_queue_t)aQueue; //!< Takes ownership of aSocketFD.
+
+- (void)resume;
+- (void)sendFrameData:(NSData *)frameData;
+
+- (void)close; //!< Must be called on the connection's queue.
+
+@end
+
+@implementation ISResourceMediatorSocketConnection
+
+@synthesize frameHandler;
+@synthesize closeHandler;
+
+- (instancetype)initWithSocket:(int)aSocketFD queue:(dispatch_queue_t)aQueue
+{
+	if ((self = [super init]) != nil)
+	{
+		__block NSUInteger activeSources = 2;
+		int fd = aSocketFD;
+
+		socketFD = aSocketFD;
+
+		queue = aQueue;
+		dispatch_retain(queue);
+
+		readBuffer = [NSMutableData new];
+		writeBuffer = [NSMutableData new];
+
+		ISResourceMediatorSocketConfigure(socketFD);
+
+		readSource  = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ,  (uintptr_t)socketFD, 0, queue);
+		writeSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_WRITE, (uintptr_t)socketFD, 0, queue);
+		writeSourceSuspended = YES; // Sources are created suspended. The write source is only resumed while there's pending data the socket didn't accept.
+
+		dispatch_source_set_event_handler(readSource,  ^{ [self _readAvailableData]; });
+		dispatch_source_set_event_handler(writeSource, ^{ [self _writePendingData]; });
+
+		// Close the socket only after both sources have been cancelled
+		dispatch_source_set_cancel_handler(readSource, ^{
+			if ((--activeSources) == 0) { close(fd); }
+		});
+
+		dispatch_source_set_cancel_handler(writeSource, ^{
+			if ((--activeSources) == 0) { close(fd); }
+		});
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[readBuffer release];
+	readBuffer = nil;
+
+	[writeBuffer release];
+	writeBuffer = nil;
+
+	[frameHandler release];
+	frameHandler = nil;
+
+	[closeHandler release];
+	closeHandler = nil;
+
+	if (queue != NULL)
+	{
+		dispatch_release(queue);
+		queue = NULL;
+	}
+
+	[super dealloc];
+}
+
+- (void)resume
+{
+	dispatch_resume(readSource);
+}
+
+#pragma mark - Reading
+- (void)_readAvailableData
+{
+	uint8_t buffer[16384];
+	ssize_t bytesRead;
+	NSUInteger consumedLength = 0;
+	BOOL reachedEnd;
+
+	while ((bytesRead = recv(socketFD, buffer, sizeof(buffer), 0)) > 0)
+	{
+		[readBuffer appendBytes:buffer length:(NSUInteger)bytesRead];
+	}
+
+	// Remote end closed the connection or an error occured. Frames received before that are still handled below.
+	reachedEnd = ((bytesRead == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)));
+
+	while (!closed && ((readBuffer.length - consumedLength) >= kISResourceMediatorSocketFrameHeaderLength))
+	{
+		const uint8_t *bytes = ((const uint8_t *)readBuffer.bytes) + consumedLength;
+		uint32_t bodyLength;
+		NSData *frameBody;
+
+		memcpy(&bodyLength, bytes, 4);
+		bodyLength = NSSwapLittleIntToHost(bodyLength);
+
+		if (bodyLength > kISResourceMediatorSocketFrameMaximumLength)
+		{
+			NSLog(@"Closing resource mediator socket connection after receiving a frame of %u bytes", bodyLength);
+			[self close];
+			return;
+		}
+
+		if ((readBuffer.length - consumedLength) < (kISResourceMediatorSocketFrameHeaderLength + bodyLength))
+		{
+			// Incomplete frame
+			break;
+		}
+
+		frameBody = [[NSData alloc] initWithBytes:&bytes[kISResourceMediatorSocketFrameHeaderLength] length:bodyLength];
+
+		consumedLength += kISResourceMediatorSocketFrameHeaderLength + bodyLength;
+
+		if (frameHandler != nil)
+		{
+			frameHandler(self, (ISResourceMediatorSocketFrameType)bytes[4], frameBody);
+		}
+
+		[frameBody release];
+	}
+
+	if (reachedEnd && !closed)
+	{
+		[self close];
+		return;
+	}
+
+	if ((consumedLength > 0) && !closed)
+	{
+		[readBuffer replaceBytesInRange:NSMakeRange(0, consumedLength) withBytes:NULL length:0];
+	}
+}
+
+#pragma mark - Writing
+- (void)sendFrameData:(NSData *)frameData
+{
+	dispatch_async(queue, ^{
+		if (!closed)
+		{
+			[writeBuffer appendData:frameData];
+			[self _writePendingData];
+		}
+	});
+}
+
+- (void)_writePendingData
+{
+	while (!closed && (writeBuffer.length > 0))
+	{
+		ssize_t bytesWritten;
+
+		if ((bytesWritten = send(socketFD, writeBuffer.bytes, writeBuffer.length, MSG_NOSIGNAL)) > 0)
+		{
+			[writeBuffer replaceBytesInRange:NSMakeRange(0, (NSUInteger)bytesWritten) withBytes:NULL length:0];
+		}
+		else if ((bytesWritten < 0) && (errno == EINTR))
+		{
+			continue;
+		}
+		else if ((bytesWritten < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+		{
+			// Wait for the socket to become writable again
+			if (writeSourceSuspended)
+			{
+				writeSourceSuspended = NO;
+				dispatch_resume(writeSource);
+			}
+			return;
+		}
+		else
+		{
+			[self close];
+			return;
+		}
+	}
+
+	if (!closed && !writeSourceSuspended)
+	{
+		writeSourceSuspended = YES;
+		dispatch_suspend(writeSource);
+	}
+}
+
+#pragma mark - Closing
+- (void)close
+{
+	dispatch_block_t theCloseHandler;
+
+	if (closed)
+	{
+		return;
+	}
+
+	closed = YES;
+
+	[self retain];
+
+	dispatch_source_cancel(writeSource);
+
+	if (writeSourceSuspended)
+	{
+		// Suspended sources must be resumed for the cancellation to complete
+		writeSourceSuspended = NO;
+		dispatch_resume(writeSource);
+	}
+
+	dispatch_source_cancel(readSource);
+
+	// Releasing the sources also releases their handler blocks, which retain the connection
+	dispatch_release(writeSource);
+	writeSource = NULL;
+
+	dispatch_release(readSource);
+	readSource = NULL;
+
+	theCloseHandler = [closeHandler retain];
+
+	self.frameHandler = nil;
+	self.closeHandler = nil;
+
+	if (theCloseHandler != nil)
+	{
+		theCloseHandler();
+		[theCloseHandler release];
+	}
+
+	[self release];
+}
+
+@end
+
+#pragma mark - Broker
+@implementation ISResourceMediatorSocketBroker
+
+@synthesize socketPath;
+
++ (NSString *)defaultSocketPath
+{
+	return ([NSTemporaryDirectory() stringByAppendingPathComponent:@"com.iospirit.resourcemediator.socket"]);
+}
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSocketPath:(NSString *)aSocketPath
+{
+	if ((self = [super init]) != nil)
+	{
+		socketPath = [((aSocketPath != nil) ? aSocketPath : [[self class] defaultSocketPath]) copy];
+
+		listenSocket = -1;
+		queue = dispatch_queue_create("com.iospirit.resourcemediator.socket-broker", DISPATCH_QUEUE_SERIAL);
+
+		connections = [NSMutableArray new];
+		connectionsByResourceIdentifier = [NSMutableDictionary new];
+		connectionsByPIDByResourceIdentifier = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[self stop];
+
+	[socketPath release];
+	socketPath = nil;
+
+	[connections release];
+	connections = nil;
+
+	[connectionsByResourceIdentifier release];
+	connectionsByResourceIdentifier = nil;
+
+	[connectionsByPIDByResourceIdentifier release];
+	connectionsByPIDByResourceIdentifier = nil;
+
+	if (queue != NULL)
+	{
+		dispatch_release(queue);
+		queue = NULL;
+	}
+
+	[super dealloc];
+}
+
+#pragma mark - Start/Stop
+- (BOOL)start
+{
+	struct sockaddr_un address;
+	int socketFD;
+
+	if (listenSocket != -1)
+	{
+		return (YES);
+	}
+
+	if (!ISResourceMediatorSocketAddressForPath(socketPath, &address))
+	{
+		NSLog(@"Resource mediator broker socket path '%@' is too long", socketPath);
+		return (NO);
+	}
+
+	if ((socketFD = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+	{
+		return (NO);
+	}
+
+	// Remove a stale socket left behind by a previous broker
+	unlink(address.sun_path);
+
+	if ((bind(socketFD, (struct sockaddr *)&address, sizeof(address)) == -1) ||
+	    (listen(socketFD, 64) == -1) ||
+	    !ISResourceMediatorSocketConfigure(socketFD))
+	{
+		NSLog(@"Error creating resource mediator broker socket at '%@': %s", socketPath, strerror(errno));
+		close(socketFD);
+		return (NO);
+	}
+
+	listenSocket = socketFD;
+
+	acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, (uintptr_t)listenSocket, 0, queue);
+
+	dispatch_source_set_event_handler(acceptSource, ^{
+		[self _acceptConnections];
+	});
+
+	dispatch_source_set_cancel_handler(acceptSource, ^{
+		close(socketFD);
+	});
+
+	dispatch_resume(acceptSource);
+
+	return (YES);
+}
+
+- (void)stop
+{
+	if (listenSocket == -1)
+	{
+		return;
+	}
+
+	dispatch_source_cancel(acceptSource);
+	dispatch_release(acceptSource);
+	acceptSource = NULL;
+
+	listenSocket = -1;
+
+	unlink(socketPath.fileSystemRepresentation);
+
+	dispatch_sync(queue, ^{
+		for (ISResourceMediatorSocketConnection *connection in [[connections copy] autorelease])
+		{
+			[connection close];
+		}
+	});
+}
+
+#pragma mark - Connections
+- (void)_acceptConnections
+{
+	int connectionSocket;
+
+	while ((connectionSocket = accept(listenSocket, NULL, NULL)) != -1)
+	{
+		ISResourceMediatorSocketConnection *connection;
+
+		if ((connection = [[ISResourceMediatorSocketConnection alloc] initWithSocket:connectionSocket queue:queue]) != nil)
+		{
+			connection.frameHandler = ^(ISResourceMediatorSocketConnection *fromConnection, ISResourceMediatorSocketFrameType frameType, NSData *frameBody) {
+				[self _handleFrameType:frameType body:frameBody fromConnection:fromConnection];
+			};
+
+			connection.closeHandler = ^{
+				[self _removeConnection:connection];
+			};
+
+			[connections addObject:connection];
+
+			[connection resume];
+			[connection release];
+		}
+	}
+}
+
+- (void)_removeConnection:(ISResourceMediatorSocketConnection *)connection
+{
+	for (NSString *resourceIdentifier in [connectionsByPIDByResourceIdentifier allKeys])
+	{
+		NSMutableDictionary <NSNumber *, ISResourceMediatorSocketConnection *> *connectionsByPID = [connectionsByPIDByResourceIdentifier objectForKey:resourceIdentifier];
+
+		[connectionsByPID removeObjectsForKeys:[connectionsByPID allKeysForObject:connection]];
+
+		if (connectionsByPID.count == 0)
+		{
+			[connectionsByPIDByResourceIdentifier removeObjectForKey:resourceIdentifier];
+		}
+	}
+
+	for (NSString *resourceIdentifier in [connectionsByResourceIdentifier allKeys])
+	{
+		NSCountedSet <ISResourceMediatorSocketConnection *> *subscribedConnections = [connectionsByResourceIdentifier objectForKey:resourceIdentifier];
+
+		while ([subscribedConnections countForObject:connection] > 0)
+		{
+			[subscribedConnections removeObject:connection];
+		}
+
+		if (subscribedConnections.count == 0)
+		{
+			[connectionsByResourceIdentifier removeObjectForKey:resourceIdentifier];
+		}
+	}
+
+	[connections removeObjectIdenticalTo:connection];
+}
+
+- (void)_handleFrameType:(ISResourceMediatorSocketFrameType)frameType body:(NSData *)frameBody fromConnection:(ISResourceMediatorSocketConnection *)connection
+{
+	switch (frameType)
+	{
+		case kISResourceMediatorSocketFrameTypeSubscribe:
+		{
+			NSString *resourceIdentifier = nil;
+			pid_t pid = 0;
+
+			if (ISResourceMediatorSocketParseSubscription(frameBody, &pid, &resourceIdentifier))
+			{
+				NSCountedSet <ISResourceMediatorSocketConnection *> *subscribedConnections;
+				NSMutableDictionary <NSNumber *, ISResourceMediatorSocketConnection *> *connectionsByPID;
+
+				if ((subscribedConnections = [connectionsByResourceIdentifier objectForKey:resourceIdentifier]) == nil)
+				{
+					subscribedConnections = [NSCountedSet set];
+					[connectionsByResourceIdentifier setObject:subscribedConnections forKey:resourceIdentifier];
+				}
+
+				if ((connectionsByPID = [connectionsByPIDByResourceIdentifier objectForKey:resourceIdentifier]) == nil)
+				{
+					connectionsByPID = [NSMutableDictionary dictionary];
+					[connectionsByPIDByResourceIdentifier setObject:connectionsByPID forKey:resourceIdentifier];
+				}
+
+				[subscribedConnections addObject:connection];
+				[connectionsByPID setObject:connection forKey:@(pid)];
+			}
+		}
+		break;
+
+		case kISResourceMediatorSocketFrameTypeUnsubscribe:
+		{
+			NSString *resourceIdentifier = nil;
+			pid_t pid = 0;
+
+			if (ISResourceMediatorSocketParseSubscription(frameBody, &pid, &resourceIdentifier))
+			{
+				NSCountedSet <ISResourceMediatorSocketConnection *> *subscribedConnections = [connectionsByResourceIdentifier objectForKey:resourceIdentifier];
+				NSMutableDictionary <NSNumber *, ISResourceMediatorSocketConnection *> *connectionsByPID = [connectionsByPIDByResourceIdentifier objectForKey:resourceIdentifier];
+
+				if ([connectionsByPID objectForKey:@(pid)] == connection)
+				{
+					[connectionsByPID removeObjectForKey:@(pid)];
+				}
+
+				[subscribedConnections removeObject:connection];
+
+				if (subscribedConnections.count == 0)
+				{
+					[connectionsByResourceIdentifier removeObjectForKey:resourceIdentifier];
+				}
+
+				if (connectionsByPID.count == 0)
+				{
+					[connectionsByPIDByResourceIdentifier removeObjectForKey:resourceIdentifier];
+				}
+			}
+		}
+		break;
+
+		case kISResourceMediatorSocketFrameTypeMessage:
+		{
+			ISResourceMediatorMessageType messageType;
+			NSString *resourceIdentifier = nil;
+			pid_t targetPID = 0;
+
+			if (ISResourceMediatorSocketParseMessage(frameBody, &messageType, &targetPID, &resourceIdentifier, NULL))
+			{
+				NSData *frameData = ISResourceMediatorSocketFrameData(frameType, frameBody);
+
+				if (targetPID != 0)
+				{
+					// Unicast
+					[[[connectionsByPIDByResourceIdentifier objectForKey:resourceIdentifier] objectForKey:@(targetPID)] sendFrameData:frameData];
+				}
+				else
+				{
+					// Broadcast - once per subscribed connection
+					for (ISResourceMediatorSocketConnection *subscribedConnection in [connectionsByResourceIdentifier objectForKey:resourceIdentifier])
+					{
+						[subscribedConnection sendFrameData:frameData];
+					}
+				}
+			}
+		}
+		break;
+	}
+}
+
+@end
+
+#pragma mark - Transport
+@implementation ISResourceMediatorSocketTransport
+
+@synthesize hub;
+@synthesize socketPath;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSocketPath:(NSString *)aSocketPath
+{
+	if ((self = [super init]) != nil)
+	{
+		socketPath = [((aSocketPath != nil) ? aSocketPath : [ISResourceMediatorSocketBroker defaultSocketPath]) copy];
+
+		queue = dispatch_queue_create("com.iospirit.resourcemediator.socket-transport", DISPATCH_QUEUE_SERIAL);
+
+		subscribedPIDsByResourceIdentifier = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[self disconnect];
+
+	[socketPath release];
+	socketPath = nil;
+
+	[subscribedPIDsByResourceIdentifier release];
+	subscribedPIDsByResourceIdentifier = nil;
+
+	if (queue != NULL)
+	{
+		dispatch_release(queue);
+		queue = NULL;
+	}
+
+	hub = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Connection
+- (ISResourceMediatorSocketConnection *)_connection
+{
+	ISResourceMediatorSocketConnection *theConnection = nil;
+
+	@synchronized(self)
+	{
+		if (connection == nil)
+		{
+			struct sockaddr_un address;
+			int socketFD;
+
+			if (!ISResourceMediatorSocketAddressForPath(socketPath, &address))
+			{
+				return (nil);
+			}
+
+			if ((socketFD = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+			{
+				return (nil);
+			}
+
+			if (connect(socketFD, (struct sockaddr *)&address, sizeof(address)) == -1)
+			{
+				NSLog(@"Error connecting to resource mediator broker at '%@': %s", socketPath, strerror(errno));
+				close(socketFD);
+				return (nil);
+			}
+
+			if ((connection = [[ISResourceMediatorSocketConnection alloc] initWithSocket:socketFD queue:queue]) != nil)
+			{
+				ISResourceMediatorSocketConnection *newConnection = connection;
+
+				connection.frameHandler = ^(ISResourceMediatorSocketConnection *fromConnection, ISResourceMediatorSocketFrameType frameType, NSData *frameBody) {
+					[self _handleFrameType:frameType body:frameBody];
+				};
+
+				connection.closeHandler = ^{
+					@synchronized(self)
+					{
+						if (connection == newConnection)
+						{
+							[connection autorelease];
+							connection = nil;
+						}
+					}
+				};
+
+				[connection resume];
+
+				// (Re-)send subscriptions
+				[subscribedPIDsByResourceIdentifier enumerateKeysAndObjectsUsingBlock:^(NSString *resourceIdentifier, NSCountedSet<NSNumber *> *subscribedPIDs, BOOL *stop) {
+					for (NSNumber *subscribedPID in subscribedPIDs)
+					{
+						[newConnection sendFrameData:ISResourceMediatorSocketSubscriptionFrameData(kISResourceMediatorSocketFrameTypeSubscribe, subscribedPID.intValue, resourceIdentifier)];
+					}
+				}];
+			}
+		}
+
+		theConnection = [[connection retain] autorelease];
+	}
+
+	return (theConnection);
+}
+
+- (void)disconnect
+{
+	ISResourceMediatorSocketConnection *theConnection = nil;
+
+	@synchronized(self)
+	{
+		theConnection = [[connection retain] autorelease];
+	}
+
+	if (theConnection != nil)
+	{
+		dispatch_sync(queue, ^{
+			[theConnection close];
+		});
+	}
+}
+
+#pragma mark - Subscriptions
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier
+{
+	BOOL isNewSubscription = NO;
+
+	@synchronized(self)
+	{
+		NSCountedSet <NSNumber *> *subscribedPIDs;
+
+		if ((subscribedPIDs = [subscribedPIDsByResourceIdentifier objectForKey:resourceIdentifier]) == nil)
+		{
+			subscribedPIDs = [NSCountedSet set];
+			[subscribedPIDsByResourceIdentifier setObject:subscribedPIDs forKey:resourceIdentifier];
+		}
+
+		isNewSubscription = ([subscribedPIDs countForObject:@(pid)] == 0);
+
+		[subscribedPIDs addObject:@(pid)];
+	}
+
+	if (isNewSubscription)
+	{
+		// A new connection sends all subscriptions by itself
+		BOOL wasConnected;
+
+		@synchronized(self)
+		{
+			wasConnected = (connection != nil);
+		}
+
+		ISResourceMediatorSocketConnection *theConnection = [self _connection];
+
+		if (wasConnected)
+		{
+			[theConnection sendFrameData:ISResourceMediatorSocketSubscriptionFrameData(kISResourceMediatorSocketFrameTypeSubscribe, pid, resourceIdentifier)];
+		}
+	}
+}
+
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier
+{
+	BOOL isLastSubscription = NO;
+
+	@synchronized(self)
+	{
+		NSCountedSet <NSNumber *> *subscribedPIDs;
+
+		if ((subscribedPIDs = [subscribedPIDsByResourceIdentifier objectForKey:resourceIdentifier]) != nil)
+		{
+			[subscribedPIDs removeObject:@(pid)];
+
+			isLastSubscription = ([subscribedPIDs countForObject:@(pid)] == 0);
+
+			if (subscribedPIDs.count == 0)
+			{
+				[subscribedPIDsByResourceIdentifier removeObjectForKey:resourceIdentifier];
+			}
+		}
+	}
+
+	if (isLastSubscription)
+	{
+		ISResourceMediatorSocketConnection *theConnection = nil;
+
+		@synchronized(self)
+		{
+			theConnection = [[connection retain] autorelease];
+		}
+
+		[theConnection sendFrameData:ISResourceMediatorSocketSubscriptionFrameData(kISResourceMediatorSocketFrameTypeUnsubscribe, pid, resourceIdentifier)];
+	}
+}
+
+#pragma mark - Sending & receiving
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	[[self _connection] sendFrameData:ISResourceMediatorSocketMessageFrameData(messageType, targetPID, resourceIdentifier, encodedUserInfo)];
+}
+
+- (void)_handleFrameType:(ISResourceMediatorSocketFrameType)frameType body:(NSData *)frameBody
+{
+	ISResourceMediatorMessageType messageType;
+	NSString *resourceIdentifier = nil, *encodedUserInfo = nil;
+	pid_t targetPID = 0;
+
+	if ((frameType == kISResourceMediatorSocketFrameTypeMessage) &&
+	    ISResourceMediatorSocketParseMessage(frameBody, &messageType, &targetPID, &resourceIdentifier, &encodedUserInfo))
+	{
+		// Mediators expect messages on the main thread
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[hub routeMessage:messageType resourceIdentifier:resourceIdentifier object:encodedUserInfo];
+		});
+	}
+}
+
+@end
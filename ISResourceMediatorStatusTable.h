@@ -0,0 +1,102 @@
+//
+//  ISResourceMediatorStatusTable.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	ISResourceMediatorStatusTable is a memory-mapped table holding the status of every mediator of a resource identifier.
+
+	Each participating pid owns one cache-line sized slot, which it claims on activation, updates whenever its status changes
+	and frees on deactivation. Claims are counted per table file across all table objects of a process: mediators of one
+	process share their pid's slot, which is only freed once the last of them released it - whether they share a table
+	object (like the one returned by +statusTableForResourceIdentifier:) or not.
+
+	Writers protect slot updates with a sequence counter (seqlock): the counter is odd while an update is in progress, so
+	readers retry until they copied a slot with an unchanged, even counter. This lets a newly activated mediator read the
+	current status of all other users instantly, instead of waiting for [STATUS] replies to a [SCAN].
+
+	Slots of processes that no longer exist are reclaimed by -reclaimStaleSlots. The table is backed by a file and therefore
+	NOT compatible with the OS X App Sandbox.
+*/
+
+#import <Foundation/Foundation.h>
+
+#define kISResourceMediatorStatusTableSlotCount 64
+
+typedef struct
+{
+	pid_t pid;
+
+	uint8_t preferredAccess;
+	uint8_t actualAccess;
+	uint8_t accessPressure;
+
+	uint16_t resourceCapacity; //!< 0 if the resource is not counted.
+	uint16_t slotCount; //!< 0 if unknown.
+
+	NSTimeInterval accessStartTime;
+} ISResourceMediatorStatusTableEntry;
+
+@interface ISResourceMediatorStatusTable : NSObject
+{
+	NSString *resourceIdentifier;
+	NSString *path;
+
+	int fileDescriptor;
+	void *mappedTable;
+	size_t mappedLength;
+
+	NSCountedSet <NSNumber *> *claimedPIDs; // Shared by all table objects of the process for path
+}
+
+@property(retain,readonly) NSString *resourceIdentifier;
+@property(retain,readonly) NSString *path; //!< Path of the file backing the table.
+
++ (NSString *)defaultDirectoryPath; //!< Default directory for status table files. Shared by all processes of the user.
+
++ (instancetype)statusTableForResourceIdentifier:(NSString *)aResourceIdentifier; //!< The process-wide table for aResourceIdentifier in the default directory, opened on first use. Returns nil if the table can't be mapped.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier; //!< Opens (or creates) the table for aResourceIdentifier in the default directory.
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier directoryPath:(NSString *)directoryPath; //!< Opens (or creates) the table for aResourceIdentifier in directoryPath. Returns nil if the table can't be mapped.
+
+#pragma mark - Slots
+- (BOOL)claimSlotForPID:(pid_t)pid; //!< Claims a slot for pid. Returns YES if pid already owns a slot or a free slot could be claimed. Every successful claim needs to be balanced by a -releaseSlotForPID:.
+- (void)releaseSlotForPID:(pid_t)pid; //!< Releases a claim of pid. Frees its slot once no claim made through any table object of this process for the same file is left.
+- (NSUInteger)reclaimStaleSlots; //!< Frees slots owned by processes that no longer exist. Returns the number of freed slots.
+
+#pragma mark - Status
+- (BOOL)writeEntry:(const ISResourceMediatorStatusTableEntry *)entry; //!< Updates the slot owned by entry->pid. Returns NO if entry->pid doesn't own a slot.
+- (NSUInteger)readEntries:(ISResourceMediatorStatusTableEntry *)outEntries maximumCount:(NSUInteger)maximumCount; //!< Copies consistent snapshots of all claimed slots to outEntries. Returns the number of copied entries.
+
+@end
@@ -0,0 +1,460 @@
+//
+//  ISResourceMediatorStatusTable.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorStatusTable.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+#define kISResourceMediatorStatusTableMagic		0x49535354 // 'ISST'
+#define kISResourceMediatorStatusTableVersion		1
+#define kISResourceMediatorStatusTableCacheLineSize	64
+#define kISResourceMediatorStatusTableReadAttempts	1024
+
+typedef struct
+{
+	_Atomic uint32_t magic;
+	uint32_t version;
+	uint32_t slotCount;
+	uint32_t slotSize;
+
+	char resourceIdentifier[240];
+} ISResourceMediatorStatusTableHeader;
+
+typedef struct
+{
+	_Atomic uint32_t sequence; // odd while the slot is being written
+	_Atomic int32_t pid;	   // 0 if the slot is free
+
+	uint8_t preferredAccess;
+	uint8_t actualAccess;
+	uint8_t accessPressure;
+	uint8_t reserved;
+
+	uint16_t resourceCapacity; // 0 if not counted (or written by a mediator predating counted resources)
+	uint16_t slotCount;
+
+	double accessStartTime;
+} __attribute__((aligned(kISResourceMediatorStatusTableCacheLineSize))) ISResourceMediatorStatusTableSlot;
+
+_Static_assert(sizeof(ISResourceMediatorStatusTableHeader) == 256, "Unexpected status table header size");
+_Static_assert(sizeof(ISResourceMediatorStatusTableSlot) == kISResourceMediatorStatusTableCacheLineSize, "Status table slots must occupy exactly one cache line");
+
+#define ISResourceMediatorStatusTableGetHeader(table)		((ISResourceMediatorStatusTableHeader *)(table))
+#define ISResourceMediatorStatusTableGetSlot(table, idx)	(((ISResourceMediatorStatusTableSlot *)(((uint8_t *)(table)) + sizeof(ISResourceMediatorStatusTableHeader))) + (idx))
+
+#pragma mark - Seqlock
+static void ISResourceMediatorStatusTableSlotBeginWrite(ISResourceMediatorStatusTableSlot *slot)
+{
+	atomic_fetch_add_explicit(&slot->sequence, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+static void ISResourceMediatorStatusTableSlotEndWrite(ISResourceMediatorStatusTableSlot *slot)
+{
+	atomic_fetch_add_explicit(&slot->sequence, 1, memory_order_release);
+}
+
+@implementation ISResourceMediatorStatusTable
+
+@synthesize resourceIdentifier;
+@synthesize path;
+
++ (NSString *)defaultDirectoryPath
+{
+	return (NSTemporaryDirectory());
+}
+
++ (instancetype)statusTableForResourceIdentifier:(NSString *)aResourceIdentifier
+{
+	static NSMutableDictionary <NSString *, ISResourceMediatorStatusTable *> *statusTablesByResourceIdentifier;
+	ISResourceMediatorStatusTable *statusTable = nil;
+
+	if (aResourceIdentifier == nil)
+	{
+		return (nil);
+	}
+
+	@synchronized([ISResourceMediatorStatusTable class])
+	{
+		if (statusTablesByResourceIdentifier == nil)
+		{
+			statusTablesByResourceIdentifier = [NSMutableDictionary new];
+		}
+
+		if ((statusTable = [statusTablesByResourceIdentifier objectForKey:aResourceIdentifier]) == nil)
+		{
+			if ((statusTable = [[self alloc] initWithResourceIdentifier:aResourceIdentifier]) != nil)
+			{
+				[statusTablesByResourceIdentifier setObject:statusTable forKey:aResourceIdentifier];
+				[statusTable release];
+			}
+		}
+	}
+
+	return (statusTable);
+}
+
++ (NSCountedSet <NSNumber *> *)_claimedPIDsForPath:(NSString *)tablePath
+{
+	// Claims are per file, so table objects opened separately for the same file agree on when a slot can be freed
+	static NSMutableDictionary <NSString *, NSCountedSet <NSNumber *> *> *claimedPIDsByPath;
+	NSCountedSet <NSNumber *> *claimedPIDs;
+
+	@synchronized([ISResourceMediatorStatusTable class])
+	{
+		if (claimedPIDsByPath == nil)
+		{
+			claimedPIDsByPath = [NSMutableDictionary new];
+		}
+
+		if ((claimedPIDs = [claimedPIDsByPath objectForKey:tablePath]) == nil)
+		{
+			claimedPIDs = [[NSCountedSet new] autorelease];
+			[claimedPIDsByPath setObject:claimedPIDs forKey:tablePath];
+		}
+	}
+
+	return (claimedPIDs);
+}
+
++ (NSString *)fileNameForResourceIdentifier:(NSString *)aResourceIdentifier
+{
+	NSMutableString *fileName = [NSMutableString stringWithString:@"com.iospirit.resourcemediator."];
+	NSCharacterSet *allowedCharacters = [NSCharacterSet characterSetWithCharactersInString:@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-_"];
+	NSUInteger length = MIN(aResourceIdentifier.length, 160);
+
+	for (NSUInteger idx=0; idx < length; idx++)
+	{
+		unichar character = [aResourceIdentifier characterAtIndex:idx];
+
+		[fileName appendFormat:@"%C", ([allowedCharacters characterIsMember:character] ? character : (unichar)'_')];
+	}
+
+	[fileName appendString:@".status"];
+
+	return (fileName);
+}
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier
+{
+	return ([self initWithResourceIdentifier:aResourceIdentifier directoryPath:[[self class] defaultDirectoryPath]]);
+}
+
+- (instancetype)initWithResourceIdentifier:(NSString *)aResourceIdentifier directoryPath:(NSString *)directoryPath
+{
+	if ((self = [super init]) != nil)
+	{
+		ISResourceMediatorStatusTableHeader *header;
+		const char *identifierCString = aResourceIdentifier.UTF8String;
+		struct stat fileStat;
+
+		resourceIdentifier = [aResourceIdentifier copy];
+		path = [[directoryPath stringByAppendingPathComponent:[[self class] fileNameForResourceIdentifier:aResourceIdentifier]] retain];
+
+		fileDescriptor = -1;
+		claimedPIDs = [[[self class] _claimedPIDsForPath:path.stringByStandardizingPath] retain];
+		mappedLength = sizeof(ISResourceMediatorStatusTableHeader) + (kISResourceMediatorStatusTableSlotCount * sizeof(ISResourceMediatorStatusTableSlot));
+
+		if ((fileDescriptor = open(path.fileSystemRepresentation, O_RDWR|O_CREAT, S_IRUSR|S_IWUSR)) == -1)
+		{
+			NSLog(@"Error opening status table at %@: %s", path, strerror(errno));
+			[self release];
+			return (nil);
+		}
+
+		// Grow (but never shrink) the file. Pages added by ftruncate are zero-filled, so all slots start out free.
+		if ((fstat(fileDescriptor, &fileStat) == -1) ||
+		    ((fileStat.st_size < (off_t)mappedLength) && (ftruncate(fileDescriptor, (off_t)mappedLength) == -1)))
+		{
+			NSLog(@"Error sizing status table at %@: %s", path, strerror(errno));
+			[self release];
+			return (nil);
+		}
+
+		if ((mappedTable = mmap(NULL, mappedLength, PROT_READ|PROT_WRITE, MAP_SHARED, fileDescriptor, 0)) == MAP_FAILED)
+		{
+			NSLog(@"Error mapping status table at %@: %s", path, strerror(errno));
+			mappedTable = NULL;
+			[self release];
+			return (nil);
+		}
+
+		header = ISResourceMediatorStatusTableGetHeader(mappedTable);
+
+		if (atomic_load_explicit(&header->magic, memory_order_acquire) != kISResourceMediatorStatusTableMagic)
+		{
+			// New table. Processes racing to initialize it write identical values.
+			header->version = kISResourceMediatorStatusTableVersion;
+			header->slotCount = kISResourceMediatorStatusTableSlotCount;
+			header->slotSize = sizeof(ISResourceMediatorStatusTableSlot);
+			strlcpy(header->resourceIdentifier, identifierCString, sizeof(header->resourceIdentifier));
+
+			atomic_store_explicit(&header->magic, kISResourceMediatorStatusTableMagic, memory_order_release);
+		}
+
+		if ((header->version != kISResourceMediatorStatusTableVersion) ||
+		    (header->slotCount != kISResourceMediatorStatusTableSlotCount) ||
+		    (header->slotSize != sizeof(ISResourceMediatorStatusTableSlot)) ||
+		    (strncmp(header->resourceIdentifier, identifierCString, sizeof(header->resourceIdentifier)-1) != 0))
+		{
+			NSLog(@"Status table at %@ is incompatible or belongs to a different resource identifier", path);
+			[self release];
+			return (nil);
+		}
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	if (mappedTable != NULL)
+	{
+		munmap(mappedTable, mappedLength);
+		mappedTable = NULL;
+	}
+
+	if (fileDescriptor != -1)
+	{
+		close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+
+	[resourceIdentifier release];
+	resourceIdentifier = nil;
+
+	[path release];
+	path = nil;
+
+	[claimedPIDs release];
+	claimedPIDs = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Slots
+- (ISResourceMediatorStatusTableSlot *)_slotForPID:(pid_t)pid
+{
+	for (NSUInteger idx=0; idx < kISResourceMediatorStatusTableSlotCount; idx++)
+	{
+		ISResourceMediatorStatusTableSlot *slot = ISResourceMediatorStatusTableGetSlot(mappedTable, idx);
+
+		if (atomic_load_explicit(&slot->pid, memory_order_acquire) == pid)
+		{
+			return (slot);
+		}
+	}
+
+	return (NULL);
+}
+
+- (BOOL)_claimFreeSlotForPID:(pid_t)pid
+{
+	// Returns YES if pid owns a slot in the mapped table (f.ex. claimed through another table object) or got a free one
+	if ([self _slotForPID:pid] != NULL)
+	{
+		return (YES);
+	}
+
+	for (NSUInteger idx=0; idx < kISResourceMediatorStatusTableSlotCount; idx++)
+	{
+		ISResourceMediatorStatusTableSlot *slot = ISResourceMediatorStatusTableGetSlot(mappedTable, idx);
+		int32_t freePID = 0;
+
+		if (atomic_compare_exchange_strong_explicit(&slot->pid, &freePID, pid, memory_order_acq_rel, memory_order_relaxed))
+		{
+			ISResourceMediatorStatusTableSlotBeginWrite(slot);
+
+			slot->preferredAccess = 0;
+			slot->actualAccess = 0;
+			slot->accessPressure = 0;
+			slot->resourceCapacity = 0;
+			slot->slotCount = 0;
+			slot->accessStartTime = 0;
+
+			ISResourceMediatorStatusTableSlotEndWrite(slot);
+
+			return (YES);
+		}
+	}
+
+	return (NO);
+}
+
+- (BOOL)claimSlotForPID:(pid_t)pid
+{
+	if (pid == 0)
+	{
+		return (NO);
+	}
+
+	@synchronized(claimedPIDs)
+	{
+		// Several mediators of a process share its slot
+		if (([claimedPIDs countForObject:@(pid)] > 0) || [self _claimFreeSlotForPID:pid])
+		{
+			[claimedPIDs addObject:@(pid)];
+
+			return (YES);
+		}
+	}
+
+	return (NO);
+}
+
+- (void)releaseSlotForPID:(pid_t)pid
+{
+	ISResourceMediatorStatusTableSlot *slot;
+
+	@synchronized(claimedPIDs)
+	{
+		if ([claimedPIDs countForObject:@(pid)] > 1)
+		{
+			// Still in use by another mediator of the process
+			[claimedPIDs removeObject:@(pid)];
+			return;
+		}
+
+		[claimedPIDs removeObject:@(pid)];
+
+		// Freed under the lock, so a claim made through another table object in the meantime doesn't lose its slot
+		if ((pid != 0) && ((slot = [self _slotForPID:pid]) != NULL))
+		{
+			ISResourceMediatorStatusTableSlotBeginWrite(slot);
+			atomic_store_explicit(&slot->pid, 0, memory_order_relaxed);
+			ISResourceMediatorStatusTableSlotEndWrite(slot);
+		}
+	}
+}
+
+- (NSUInteger)reclaimStaleSlots
+{
+	NSUInteger reclaimedSlots = 0;
+
+	for (NSUInteger idx=0; idx < kISResourceMediatorStatusTableSlotCount; idx++)
+	{
+		ISResourceMediatorStatusTableSlot *slot = ISResourceMediatorStatusTableGetSlot(mappedTable, idx);
+		int32_t slotPID = atomic_load_explicit(&slot->pid, memory_order_acquire);
+
+		// kill() with signal 0 only checks for existence. EPERM means the process exists, but belongs to someone else.
+		if ((slotPID != 0) && (kill(slotPID, 0) == -1) && (errno == ESRCH))
+		{
+			if (atomic_compare_exchange_strong_explicit(&slot->pid, &slotPID, 0, memory_order_acq_rel, memory_order_relaxed))
+			{
+				reclaimedSlots++;
+			}
+		}
+	}
+
+	return (reclaimedSlots);
+}
+
+#pragma mark - Status
+- (BOOL)writeEntry:(const ISResourceMediatorStatusTableEntry *)entry
+{
+	ISResourceMediatorStatusTableSlot *slot;
+
+	if ((entry == NULL) || (entry->pid == 0) || ((slot = [self _slotForPID:entry->pid]) == NULL))
+	{
+		return (NO);
+	}
+
+	ISResourceMediatorStatusTableSlotBeginWrite(slot);
+
+	slot->preferredAccess = entry->preferredAccess;
+	slot->actualAccess = entry->actualAccess;
+	slot->accessPressure = entry->accessPressure;
+	slot->resourceCapacity = entry->resourceCapacity;
+	slot->slotCount = entry->slotCount;
+	slot->accessStartTime = entry->accessStartTime;
+
+	ISResourceMediatorStatusTableSlotEndWrite(slot);
+
+	return (YES);
+}
+
+- (NSUInteger)readEntries:(ISResourceMediatorStatusTableEntry *)outEntries maximumCount:(NSUInteger)maximumCount
+{
+	NSUInteger entryCount = 0;
+
+	for (NSUInteger idx=0; (idx < kISResourceMediatorStatusTableSlotCount) && (entryCount < maximumCount); idx++)
+	{
+		ISResourceMediatorStatusTableSlot *slot = ISResourceMediatorStatusTableGetSlot(mappedTable, idx);
+
+		for (NSUInteger attempt=0; attempt < kISResourceMediatorStatusTableReadAttempts; attempt++)
+		{
+			ISResourceMediatorStatusTableEntry entry;
+			uint32_t sequenceBefore, sequenceAfter;
+
+			if (((sequenceBefore = atomic_load_explicit(&slot->sequence, memory_order_acquire)) & 1) != 0)
+			{
+				// Write in progress
+				continue;
+			}
+
+			entry.pid	      = atomic_load_explicit(&slot->pid, memory_order_relaxed);
+			entry.preferredAccess = slot->preferredAccess;
+			entry.actualAccess    = slot->actualAccess;
+			entry.accessPressure  = slot->accessPressure;
+			entry.resourceCapacity = slot->resourceCapacity;
+			entry.slotCount	      = slot->slotCount;
+			entry.accessStartTime = slot->accessStartTime;
+
+			atomic_thread_fence(memory_order_acquire);
+
+			if ((sequenceAfter = atomic_load_explicit(&slot->sequence, memory_order_relaxed)) == sequenceBefore)
+			{
+				if (entry.pid != 0)
+				{
+					outEntries[entryCount] = entry;
+					entryCount++;
+				}
+
+				break;
+			}
+		}
+	}
+
+	return (entryCount);
+}
+
+@end
@@ -0,0 +1,135 @@
+//
+//  ISResourceMediatorTraceRecorder.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+
+/*
+	ISResourceMediatorTraceRecorder captures the traffic of mediators - messages sent and received, changes made by the app,
+	activation and the access changes requested from (and completed by) the delegate - in a compact, append-only binary log.
+
+	The log is a memory-mapped file that is grown in chunks, so appending a record is a memcpy under a lock. As the mapping is
+	shared with the file, records survive a crash of the recording process. Each record carries two timestamps: the time on
+	the mediator's clock, which replays feed back to the mediators, and a monotonic timestamp that orders the records and
+	measures the intervals between them - even if the mediator's clock jumps.
+
+	Logs are read with +[ISResourceMediatorTraceRecord recordsWithContentsOfFile:] and can be fed back into fresh mediators
+	with ISResourceMediatorTraceReplayer.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorCodec.h"
+
+/*!
+     @abstract Events recorded by ISResourceMediatorTraceRecorder.
+     @constant kISResourceMediatorTraceEventActivation			The mediator was (de)activated. value: new active state. userInfo: pid and resourceIdentifier.
+     @constant kISResourceMediatorTraceEventSetting			The app changed preferredAccess, actualAccess, accessPressure, resourceCapacity, slotCount or broadcastInfo. userInfo: the new value.
+     @constant kISResourceMediatorTraceEventMessageSent			The mediator sent a message. value: ISResourceMediatorMessageType. userInfo: the message.
+     @constant kISResourceMediatorTraceEventMessageReceived		The mediator received a message. value: ISResourceMediatorMessageType. userInfo: the message.
+     @constant kISResourceMediatorTraceEventAccessChange		The mediator asked its delegate to change access. value: ISResourceMediatorResourceAccess. userInfo: pid of the requesting user (as targetPID), if any.
+     @constant kISResourceMediatorTraceEventAccessChangeCompletion	The delegate completed the last access change. value: ISResourceMediatorResult.
+*/
+typedef NS_ENUM(uint8_t, ISResourceMediatorTraceEvent)
+{
+	kISResourceMediatorTraceEventActivation,
+	kISResourceMediatorTraceEventSetting,
+	kISResourceMediatorTraceEventMessageSent,
+	kISResourceMediatorTraceEventMessageReceived,
+	kISResourceMediatorTraceEventAccessChange,
+	kISResourceMediatorTraceEventAccessChangeCompletion
+};
+
+@interface ISResourceMediatorTraceRecorder : NSObject
+{
+	NSString *path;
+
+	int fileDescriptor;
+	uint8_t *mappedLog;
+	size_t mappedLength;
+	size_t length;
+
+	uint16_t lastMediatorID;
+}
+
+@property(retain,readonly) NSString *path; //!< Path of the log file.
+@property(readonly) size_t length; //!< Number of bytes written to the log.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithPath:(NSString *)aPath; //!< Creates (or truncates) the log at aPath. Returns nil if the log can't be mapped.
+
+#pragma mark - Recording
+- (uint16_t)nextMediatorID; //!< Returns an ID identifying a mediator in the log. Called by ISResourceMediator when it starts recording to the receiver.
+- (void)recordEvent:(ISResourceMediatorTraceEvent)event value:(uint8_t)value userInfo:(NSDictionary *)userInfo mediatorID:(uint16_t)mediatorID time:(NSTimeInterval)time; //!< Appends a record to the log. Thread safe.
+- (void)close; //!< Trims the file to the records written and closes the log. Further records are dropped. Called on dealloc.
+
+@end
+
+@interface ISResourceMediatorTraceRecord : NSObject
+{
+	ISResourceMediatorTraceEvent event;
+	uint8_t value;
+	uint16_t mediatorID;
+	NSTimeInterval time;
+	uint64_t monotonicTime;
+
+	NSDictionary *userInfo;
+}
+
+@property(assign) ISResourceMediatorTraceEvent event;
+@property(assign) uint8_t value; //!< Event specific value (see ISResourceMediatorTraceEvent).
+@property(assign) uint16_t mediatorID; //!< Identifies the mediator the event belongs to.
+@property(assign) NSTimeInterval time; //!< Time of the event, on the mediator's clock. Can jump (f.ex. if the system clock is set).
+@property(assign) uint64_t monotonicTime; //!< Time of the event in nanoseconds, on the monotonic system clock (see ISResourceMediatorTraceMonotonicTime()). Never decreases within a log.
+
+@property(retain) NSDictionary *userInfo; //!< Event specific data (see ISResourceMediatorTraceEvent). nil if there is none.
+
++ (NSArray <ISResourceMediatorTraceRecord *> *)recordsWithContentsOfFile:(NSString *)path; //!< Reads all records of a log written by ISResourceMediatorTraceRecorder. Stops at the first incomplete record, as left behind by a crash. Returns nil if the file is no trace log.
+
+@end
+
+extern uint64_t ISResourceMediatorTraceMonotonicTime(void); //!< Current time in nanoseconds on the clock used for monotonicTime: CLOCK_UPTIME_RAW on Apple platforms, CLOCK_MONOTONIC elsewhere. Only differences between its values are meaningful.
+
+/*
+	LOG FORMAT (version 2)
+
+	File: "ISRMTRC" followed by the version byte, followed by records. All integers are little endian.
+
+	Record: [length:UInt32][event:UInt8][value:UInt8][mediatorID:UInt16][time:Float64][monotonicTime:UInt64] followed by the
+	userInfo, encoded in the binary format of ISResourceMediatorCodec - or, if the userInfo can't be encoded in it, as binary
+	property list. length includes the 24 byte record header. Records start at 8 byte boundaries; the zero padding in between
+	is not included in length. monotonicTime counts nanoseconds from an unspecified, system-defined starting point, so only
+	the intervals between the records of one log are meaningful.
+
+	length is written last, once the rest of the record is in place. Zero length marks the end of the log - which is where a
+	record cut short by a crash ends it.
+*/
@@ -0,0 +1,326 @@
+//
+//  ISResourceMediatorTraceRecorder.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+
+#import "ISResourceMediatorTraceRecorder.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define kISResourceMediatorTraceMagic		"ISRMTRC"
+#define kISResourceMediatorTraceVersion		2
+#define kISResourceMediatorTraceFileHeaderLength	8
+#define kISResourceMediatorTraceRecordAlignment	8
+#define kISResourceMediatorTraceGrowthLength	(1 << 20) // Grow the log 1 MB at a time
+
+#define ISResourceMediatorTraceAlignOffset(offset)	(((offset) + (kISResourceMediatorTraceRecordAlignment - 1)) & ~((size_t)kISResourceMediatorTraceRecordAlignment - 1))
+
+typedef struct __attribute__((packed))
+{
+	uint32_t length; // written last
+	uint8_t event;
+	uint8_t value;
+	uint16_t mediatorID;
+	NSSwappedDouble time;
+	uint64_t monotonicTime;
+} ISResourceMediatorTraceRecordHeader;
+
+_Static_assert(sizeof(ISResourceMediatorTraceRecordHeader) == 24, "Unexpected trace record header size");
+
+uint64_t ISResourceMediatorTraceMonotonicTime(void)
+{
+	struct timespec now;
+
+#if defined(__APPLE__)
+	// Doesn't advance while the system sleeps - just like CLOCK_MONOTONIC on Linux
+	clock_gettime(CLOCK_UPTIME_RAW, &now);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &now);
+#endif /* __APPLE__ */
+
+	return (((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec);
+}
+
+@implementation ISResourceMediatorTraceRecorder
+
+@synthesize path;
+@synthesize length;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithPath:(NSString *)aPath
+{
+	if ((self = [super init]) != nil)
+	{
+		path = [aPath copy];
+
+		fileDescriptor = -1;
+
+		if ((fileDescriptor = open(path.fileSystemRepresentation, O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR)) == -1)
+		{
+			NSLog(@"Error opening trace log at %@: %s", path, strerror(errno));
+			[self release];
+			return (nil);
+		}
+
+		if (![self _mapLength:kISResourceMediatorTraceGrowthLength])
+		{
+			[self release];
+			return (nil);
+		}
+
+		memcpy(mappedLog, kISResourceMediatorTraceMagic, kISResourceMediatorTraceFileHeaderLength-1);
+		mappedLog[kISResourceMediatorTraceFileHeaderLength-1] = kISResourceMediatorTraceVersion;
+
+		length = kISResourceMediatorTraceFileHeaderLength;
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[self close];
+
+	[path release];
+	path = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Mapping
+- (BOOL)_mapLength:(size_t)newMappedLength
+{
+	// Call only from within @synchronized(self) (or init)
+	if (mappedLog != NULL)
+	{
+		munmap(mappedLog, mappedLength);
+		mappedLog = NULL;
+		mappedLength = 0;
+	}
+
+	// Pages added by ftruncate are zero-filled - which marks the end of the log
+	if (ftruncate(fileDescriptor, (off_t)newMappedLength) == -1)
+	{
+		NSLog(@"Error sizing trace log at %@: %s", path, strerror(errno));
+		return (NO);
+	}
+
+	if ((mappedLog = mmap(NULL, newMappedLength, PROT_READ|PROT_WRITE, MAP_SHARED, fileDescriptor, 0)) == MAP_FAILED)
+	{
+		NSLog(@"Error mapping trace log at %@: %s", path, strerror(errno));
+		mappedLog = NULL;
+		return (NO);
+	}
+
+	mappedLength = newMappedLength;
+
+	return (YES);
+}
+
+#pragma mark - Recording
+- (uint16_t)nextMediatorID
+{
+	@synchronized(self)
+	{
+		return (++lastMediatorID);
+	}
+}
+
+- (void)recordEvent:(ISResourceMediatorTraceEvent)event value:(uint8_t)value userInfo:(NSDictionary *)userInfo mediatorID:(uint16_t)mediatorID time:(NSTimeInterval)time
+{
+	NSData *userInfoData = nil;
+	ISResourceMediatorTraceRecordHeader header;
+
+	if (userInfo != nil)
+	{
+		if ((userInfoData = [ISResourceMediatorCodec binaryDataWithUserInfo:userInfo]) == nil)
+		{
+			userInfoData = [NSPropertyListSerialization dataWithPropertyList:userInfo format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+		}
+	}
+
+	header.length = 0;
+	header.event = event;
+	header.value = value;
+	header.mediatorID = NSSwapHostShortToLittle(mediatorID);
+	header.time = NSSwapHostDoubleToLittle(time);
+
+	@synchronized(self)
+	{
+		size_t recordLength = sizeof(header) + userInfoData.length;
+		size_t recordOffset = ISResourceMediatorTraceAlignOffset(length);
+
+		if (mappedLog == NULL)
+		{
+			return;
+		}
+
+		if ((recordOffset + recordLength) > mappedLength)
+		{
+			size_t growLength = (((recordOffset + recordLength - mappedLength) / kISResourceMediatorTraceGrowthLength) + 1) * kISResourceMediatorTraceGrowthLength;
+
+			if (![self _mapLength:(mappedLength + growLength)])
+			{
+				[self close];
+				return;
+			}
+		}
+
+		// Taken under the lock, so records are in monotonicTime order
+		header.monotonicTime = NSSwapHostLongLongToLittle(ISResourceMediatorTraceMonotonicTime());
+
+		memcpy(mappedLog + recordOffset, &header, sizeof(header));
+		memcpy(mappedLog + recordOffset + sizeof(header), userInfoData.bytes, userInfoData.length);
+
+		// Publish the record: until its length is stored, the record reads as the end of the log
+		atomic_store_explicit((_Atomic uint32_t *)(mappedLog + recordOffset), NSSwapHostIntToLittle((uint32_t)recordLength), memory_order_release);
+
+		length = recordOffset + recordLength;
+	}
+}
+
+- (void)close
+{
+	@synchronized(self)
+	{
+		if (mappedLog != NULL)
+		{
+			msync(mappedLog, length, MS_SYNC);
+			munmap(mappedLog, mappedLength);
+			mappedLog = NULL;
+			mappedLength = 0;
+		}
+
+		if (fileDescriptor != -1)
+		{
+			ftruncate(fileDescriptor, (off_t)length);
+
+			close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+	}
+}
+
+@end
+
+@implementation ISResourceMediatorTraceRecord
+
+@synthesize event;
+@synthesize value;
+@synthesize mediatorID;
+@synthesize time;
+@synthesize monotonicTime;
+
+@synthesize userInfo;
+
+- (void)dealloc
+{
+	[userInfo release];
+	userInfo = nil;
+
+	[super dealloc];
+}
+
++ (NSArray <ISResourceMediatorTraceRecord *> *)recordsWithContentsOfFile:(NSString *)path
+{
+	NSMutableArray <ISResourceMediatorTraceRecord *> *records = nil;
+	NSData *logData;
+
+	if ((logData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL]) != nil)
+	{
+		const uint8_t *bytes = (const uint8_t *)logData.bytes;
+		size_t logLength = logData.length, offset = kISResourceMediatorTraceFileHeaderLength;
+
+		if ((logLength < kISResourceMediatorTraceFileHeaderLength) ||
+		    (memcmp(bytes, kISResourceMediatorTraceMagic, kISResourceMediatorTraceFileHeaderLength-1) != 0) ||
+		    (bytes[kISResourceMediatorTraceFileHeaderLength-1] != kISResourceMediatorTraceVersion))
+		{
+			NSLog(@"%@ is not a trace log", path);
+			return (nil);
+		}
+
+		records = [NSMutableArray array];
+
+		while (((offset = ISResourceMediatorTraceAlignOffset(offset)) + sizeof(ISResourceMediatorTraceRecordHeader)) <= logLength)
+		{
+			ISResourceMediatorTraceRecordHeader header;
+			ISResourceMediatorTraceRecord *record;
+			size_t recordLength;
+
+			memcpy(&header, bytes + offset, sizeof(header));
+
+			recordLength = NSSwapLittleIntToHost(header.length);
+
+			if ((recordLength < sizeof(header)) || ((offset + recordLength) > logLength))
+			{
+				// End of log - or a record cut short by a crash
+				break;
+			}
+
+			record = [[self new] autorelease];
+			record.event = header.event;
+			record.value = header.value;
+			record.mediatorID = NSSwapLittleShortToHost(header.mediatorID);
+			record.time = NSSwapLittleDoubleToHost(header.time);
+			record.monotonicTime = NSSwapLittleLongLongToHost(header.monotonicTime);
+
+			if (recordLength > sizeof(header))
+			{
+				NSData *userInfoData = [NSData dataWithBytesNoCopy:(void *)(bytes + offset + sizeof(header)) length:(recordLength - sizeof(header)) freeWhenDone:NO];
+				NSDictionary *recordUserInfo;
+
+				if ((recordUserInfo = [ISResourceMediatorCodec userInfoWithBinaryData:userInfoData]) == nil)
+				{
+					recordUserInfo = [NSPropertyListSerialization propertyListWithData:userInfoData options:NSPropertyListImmutable format:NULL error:NULL];
+				}
+
+				record.userInfo = [recordUserInfo isKindOfClass:[NSDictionary class]] ? recordUserInfo : nil;
+			}
+
+			[records addObject:record];
+
+			offset += recordLength;
+		}
+	}
+
+	return (records);
+}
+
+@end
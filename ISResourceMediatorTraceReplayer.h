@@ -0,0 +1,91 @@
+//
+//  ISResourceMediatorTraceReplayer.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+
+/*
+	ISResourceMediatorTraceReplayer feeds a trace captured by ISResourceMediatorTraceRecorder back into fresh ISResourceMediator
+	instances - one for each mediator in the trace - and checks that they arrive at the same decisions.
+
+	Inputs (activation, app changes, received messages and delegate completions) are replayed in order. Outputs (sent messages
+	and delegate access changes) are compared with the trace: a replay is faithful if every mediator asks its delegate for the
+	same access changes and answers [ACCESS_REQUEST]s with the same results as when the trace was recorded.
+
+	The replayed mediators run on a virtual clock that follows the recorded mediator clock (holding while it jumps back), so
+	timers fire at the recorded times and replays are deterministic at any speed. Messages the replayed mediators send are dropped: the messages they received
+	are part of the trace. Mediators are replayed with default settings and without status table.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorTraceRecorder.h"
+
+@class ISResourceMediatorTraceReplayNode;
+
+@interface ISResourceMediatorTraceReplayer : NSObject
+{
+	NSArray <ISResourceMediatorTraceRecord *> *records;
+	BOOL usesOriginalTiming;
+
+	NSTimeInterval currentTime;
+
+	NSMutableDictionary <NSNumber *, ISResourceMediatorTraceReplayNode *> *nodesByMediatorID;
+	NSMutableArray <ISResourceMediatorTraceReplayNode *> *nodes; // In order of appearance in the trace
+
+	NSUInteger decisionCount;
+	NSMutableArray <NSString *> *mismatches;
+
+	NSUInteger processedMessageCount[kISResourceMediatorMessageTypeCount];
+	NSTimeInterval processingTime[kISResourceMediatorMessageTypeCount];
+	NSTimeInterval maximumProcessingTime[kISResourceMediatorMessageTypeCount];
+}
+
+@property(retain,readonly) NSArray <ISResourceMediatorTraceRecord *> *records; //!< The records to replay.
+@property(assign) BOOL usesOriginalTiming; //!< If YES, -replay waits between records as long as they were apart when recorded (as measured by their monotonicTime). Defaults to NO: replay at full speed.
+
+@property(readonly) NSTimeInterval currentTime; //!< The virtual time of the replay: the timestamp of the record being replayed (or of the timer firing).
+
+@property(readonly) NSUInteger decisionCount; //!< Number of decisions (delegate access changes and [ACCESS_RESPONSE] results) in the trace.
+@property(retain,readonly) NSArray <NSString *> *mismatches; //!< Descriptions of the decisions of the replay that differ from the trace. Empty if the replay was faithful.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithRecords:(NSArray <ISResourceMediatorTraceRecord *> *)someRecords;
+- (instancetype)initWithContentsOfFile:(NSString *)path; //!< Reads the records of the trace log at path. Returns nil if it can't be read.
+
+#pragma mark - Replay
+- (void)replay; //!< Replays all records. Call once.
+
+#pragma mark - Report
+- (NSDictionary *)processingCostReport; //!< Cost of handling the received messages during the replay, by message type name (see +[ISResourceMediatorMetrics nameForMessageType:]): "count", "totalTime", "meanTime" and "maxTime" (in seconds). Property list and JSON compatible.
+
+@end
@@ -0,0 +1,622 @@
+//
+//  ISResourceMediatorTraceReplayer.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+
+#import "ISResourceMediatorTraceReplayer.h"
+#import "ISResourceMediator.h"
+#import "ISResourceMediatorMetrics.h"
+
+#include <unistd.h>
+
+#define kISResourceMediatorTraceReplayerMismatchLimit 100 // Maximum number of mismatches described
+
+#pragma mark - Scheduler
+@interface ISResourceMediatorTraceReplayScheduler : ISResourceMediatorDeadlineScheduler
+{
+	ISResourceMediatorTraceReplayer *replayer; // Not retained
+}
+
+- (instancetype)initWithReplayer:(ISResourceMediatorTraceReplayer *)aReplayer;
+
+@end
+
+@implementation ISResourceMediatorTraceReplayScheduler
+
+- (instancetype)initWithReplayer:(ISResourceMediatorTraceReplayer *)aReplayer
+{
+	// No timer: the replayer fires deadlines as its virtual clock passes them
+	if ((self = [super initWithQueue:NULL]) != nil)
+	{
+		replayer = aReplayer;
+	}
+
+	return (self);
+}
+
+- (NSTimeInterval)currentTime
+{
+	return (replayer.currentTime);
+}
+
+@end
+
+@class ISResourceMediatorTraceReplayNode;
+
+#pragma mark - Transport
+@interface ISResourceMediatorTraceReplayTransport : NSObject <ISResourceMediatorTransport>
+{
+	ISResourceMediatorHub *hub;
+	ISResourceMediatorTraceReplayNode *node; // Not retained
+}
+
+@property(assign) ISResourceMediatorHub *hub;
+
+- (instancetype)initWithNode:(ISResourceMediatorTraceReplayNode *)aNode;
+
+@end
+
+#pragma mark - Node
+@interface ISResourceMediatorTraceReplayNode : NSObject <ISResourceMediatorDelegate>
+{
+	uint16_t mediatorID;
+	ISResourceMediator *mediator;
+	ISResourceMediatorTraceReplayScheduler *scheduler;
+
+	NSMutableDictionary *pendingSettings; // Settings recorded before the mediator was activated (and could be created)
+	NSMutableArray *pendingCompletions;
+	NSMutableArray *immediateCompletionResults; // For each recorded access change: the result it was completed with before the delegate returned, or NSNull
+
+	NSMutableArray <NSString *> *recordedDecisions;
+	NSMutableArray <NSString *> *replayedDecisions;
+}
+
+@property(readonly) uint16_t mediatorID;
+@property(retain,readonly) ISResourceMediator *mediator; //!< nil until the mediator's first activation was replayed
+@property(retain,readonly) ISResourceMediatorTraceReplayScheduler *scheduler;
+
+@property(retain,readonly) NSMutableArray <NSString *> *recordedDecisions;
+@property(retain,readonly) NSMutableArray <NSString *> *replayedDecisions;
+@property(retain,readonly) NSMutableArray *immediateCompletionResults;
+
++ (NSString *)descriptionOfAccessChange:(ISResourceMediatorResourceAccess)access userInfo:(NSDictionary *)userInfo;
++ (NSString *)descriptionOfAccessResponse:(NSDictionary *)userInfo;
+
+- (instancetype)initWithReplayer:(ISResourceMediatorTraceReplayer *)replayer mediatorID:(uint16_t)aMediatorID;
+
+- (void)replayActivation:(BOOL)active userInfo:(NSDictionary *)userInfo;
+- (void)replaySetting:(NSDictionary *)userInfo;
+- (void)replayMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)userInfo;
+- (void)replayAccessChangeCompletion:(ISResourceMediatorResult)result;
+
+@end
+
+@implementation ISResourceMediatorTraceReplayNode
+
+@synthesize mediatorID;
+@synthesize mediator;
+@synthesize scheduler;
+
+@synthesize recordedDecisions;
+@synthesize replayedDecisions;
+@synthesize immediateCompletionResults;
+
++ (NSString *)descriptionOfAccessChange:(ISResourceMediatorResourceAccess)access userInfo:(NSDictionary *)userInfo
+{
+	return ([NSString stringWithFormat:@"access %lu for %d", (unsigned long)access, [[userInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey] intValue]]);
+}
+
++ (NSString *)descriptionOfAccessResponse:(NSDictionary *)userInfo
+{
+	return ([NSString stringWithFormat:@"response %lu to %d", (unsigned long)[[userInfo objectForKey:kISResourceMediatorNotificationResultKey] unsignedIntegerValue], [[userInfo objectForKey:kISResourceMediatorNotificationTargetPIDKey] intValue]]);
+}
+
+- (instancetype)initWithReplayer:(ISResourceMediatorTraceReplayer *)replayer mediatorID:(uint16_t)aMediatorID
+{
+	if ((self = [super init]) != nil)
+	{
+		mediatorID = aMediatorID;
+
+		scheduler = [[ISResourceMediatorTraceReplayScheduler alloc] initWithReplayer:replayer];
+
+		pendingSettings = [NSMutableDictionary new];
+		pendingCompletions = [NSMutableArray new];
+		immediateCompletionResults = [NSMutableArray new];
+
+		recordedDecisions = [NSMutableArray new];
+		replayedDecisions = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	mediator.delegate = nil;
+	mediator.active = NO;
+
+	[mediator release];
+	mediator = nil;
+
+	[scheduler release];
+	scheduler = nil;
+
+	[pendingSettings release];
+	pendingSettings = nil;
+
+	[pendingCompletions release];
+	pendingCompletions = nil;
+
+	[immediateCompletionResults release];
+	immediateCompletionResults = nil;
+
+	[recordedDecisions release];
+	recordedDecisions = nil;
+
+	[replayedDecisions release];
+	replayedDecisions = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Replay
+- (void)replayActivation:(BOOL)active userInfo:(NSDictionary *)userInfo
+{
+	if (mediator == nil)
+	{
+		ISResourceMediatorTraceReplayTransport *transport;
+		ISResourceMediatorHub *mediatorHub;
+		NSString *resourceIdentifier;
+
+		if ((resourceIdentifier = [userInfo objectForKey:kISResourceMediatorNotificationResourceIdentifierKey]) == nil)
+		{
+			return;
+		}
+
+		// Each mediator gets its own hub: the messages it received are replayed to it alone
+		transport = [[[ISResourceMediatorTraceReplayTransport alloc] initWithNode:self] autorelease];
+		mediatorHub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+
+		mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:resourceIdentifier delegate:self];
+		mediator.pid = [[userInfo objectForKey:kISResourceMediatorNotificationPIDKey] intValue];
+		mediator.hub = mediatorHub;
+		mediator.processWatcher = nil;
+		mediator.deadlineScheduler = scheduler;
+
+		[self replaySetting:pendingSettings];
+		[pendingSettings removeAllObjects];
+	}
+
+	mediator.active = active;
+}
+
+- (void)replaySetting:(NSDictionary *)userInfo
+{
+	NSNumber *number;
+	id broadcastInfoObject;
+
+	if (mediator == nil)
+	{
+		[pendingSettings addEntriesFromDictionary:userInfo];
+		return;
+	}
+
+	if ((number = [userInfo objectForKey:kISResourceMediatorNotificationResourceCapacityKey]) != nil)
+	{
+		mediator.resourceCapacity = number.unsignedIntegerValue;
+	}
+
+	if ((number = [userInfo objectForKey:kISResourceMediatorNotificationSlotCountKey]) != nil)
+	{
+		mediator.slotCount = number.unsignedIntegerValue;
+	}
+
+	if ((number = [userInfo objectForKey:kISResourceMediatorNotificationAccessPressureKey]) != nil)
+	{
+		mediator.accessPressure = number.unsignedIntegerValue;
+	}
+
+	if ((broadcastInfoObject = [userInfo objectForKey:kISResourceMediatorNotificationBroadcastInfoKey]) != nil)
+	{
+		mediator.broadcastInfo = [broadcastInfoObject isKindOfClass:[NSDictionary class]] ? broadcastInfoObject : nil;
+	}
+
+	if ((number = [userInfo objectForKey:kISResourceMediatorNotificationPreferredAccessKey]) != nil)
+	{
+		mediator.preferredAccess = number.unsignedIntegerValue;
+	}
+
+	if ((number = [userInfo objectForKey:kISResourceMediatorNotificationActualAccessKey]) != nil)
+	{
+		// Mostly set by the mediator itself, when the replayed completion arrives - then this doesn't change anything
+		mediator.actualAccess = number.unsignedIntegerValue;
+	}
+}
+
+- (void)replayMessage:(ISResourceMediatorMessageType)messageType userInfo:(NSDictionary *)userInfo
+{
+	NSString *encodedUserInfo;
+
+	// Route through the hub, like the original message, so that it also learns about peers
+	if ((encodedUserInfo = [ISResourceMediatorCodec stringWithUserInfo:userInfo format:kISResourceMediatorWireFormatBinary]) != nil)
+	{
+		[mediator.hub routeMessage:messageType resourceIdentifier:mediator.resourceIdentifier object:encodedUserInfo];
+	}
+}
+
+- (void)replayAccessChangeCompletion:(ISResourceMediatorResult)result
+{
+	void(^completionHandler)(ISResourceMediatorResult result);
+
+	if (pendingCompletions.count == 0)
+	{
+		// The replayed mediator didn't ask for an access change - already reported as mismatch
+		return;
+	}
+
+	completionHandler = [[[pendingCompletions objectAtIndex:0] retain] autorelease];
+	[pendingCompletions removeObjectAtIndex:0];
+
+	completionHandler(result);
+}
+
+#pragma mark - Delegate
+- (void)resourceMediator:(ISResourceMediator *)aMediator setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+{
+	id immediateCompletionResult = nil;
+
+	[replayedDecisions addObject:[[self class] descriptionOfAccessChange:access userInfo:((user!=nil) ? @{ kISResourceMediatorNotificationTargetPIDKey : @(user.pid) } : nil)]];
+
+	if (immediateCompletionResults.count > 0)
+	{
+		immediateCompletionResult = [[[immediateCompletionResults objectAtIndex:0] retain] autorelease];
+		[immediateCompletionResults removeObjectAtIndex:0];
+	}
+
+	if ([immediateCompletionResult isKindOfClass:[NSNumber class]])
+	{
+		// Completed before the delegate returned when recorded - do the same, so the mediator continues in the same order
+		completionHandler([immediateCompletionResult unsignedIntegerValue]);
+	}
+	else
+	{
+		// Completed when the recorded completion is replayed
+		[pendingCompletions addObject:[[completionHandler copy] autorelease]];
+	}
+}
+
+@end
+
+@implementation ISResourceMediatorTraceReplayTransport
+
+@synthesize hub;
+
+- (instancetype)initWithNode:(ISResourceMediatorTraceReplayNode *)aNode
+{
+	if ((self = [super init]) != nil)
+	{
+		node = aNode;
+	}
+
+	return (self);
+}
+
+#pragma mark - Messages
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier
+{
+}
+
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier
+{
+}
+
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	// Dropped - only the decisions matter
+	if (messageType == kISResourceMediatorMessageTypeAccessResponse)
+	{
+		NSDictionary *userInfo;
+
+		if ((userInfo = [ISResourceMediatorCodec userInfoWithString:encodedUserInfo format:NULL error:NULL]) != nil)
+		{
+			[node.replayedDecisions addObject:[ISResourceMediatorTraceReplayNode descriptionOfAccessResponse:userInfo]];
+		}
+	}
+}
+
+@end
+
+#pragma mark - Replayer
+@implementation ISResourceMediatorTraceReplayer
+
+@synthesize records;
+@synthesize usesOriginalTiming;
+
+@synthesize currentTime;
+
+@synthesize decisionCount;
+@synthesize mismatches;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithRecords:(NSArray <ISResourceMediatorTraceRecord *> *)someRecords
+{
+	if ((self = [super init]) != nil)
+	{
+		records = [someRecords copy];
+
+		nodesByMediatorID = [NSMutableDictionary new];
+		nodes = [NSMutableArray new];
+
+		mismatches = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path
+{
+	NSArray <ISResourceMediatorTraceRecord *> *someRecords;
+
+	if ((someRecords = [ISResourceMediatorTraceRecord recordsWithContentsOfFile:path]) == nil)
+	{
+		[self release];
+		return (nil);
+	}
+
+	return ([self initWithRecords:someRecords]);
+}
+
+- (void)dealloc
+{
+	[records release];
+	records = nil;
+
+	[nodesByMediatorID release];
+	nodesByMediatorID = nil;
+
+	[nodes release];
+	nodes = nil;
+
+	[mismatches release];
+	mismatches = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Replay
+- (ISResourceMediatorTraceReplayNode *)_nodeForMediatorID:(uint16_t)mediatorID
+{
+	ISResourceMediatorTraceReplayNode *node;
+
+	if ((node = [nodesByMediatorID objectForKey:@(mediatorID)]) == nil)
+	{
+		node = [[[ISResourceMediatorTraceReplayNode alloc] initWithReplayer:self mediatorID:mediatorID] autorelease];
+
+		[nodesByMediatorID setObject:node forKey:@(mediatorID)];
+		[nodes addObject:node];
+	}
+
+	return (node);
+}
+
+- (void)_advanceToTime:(NSTimeInterval)time
+{
+	// Fire the deadlines of all mediators that pass until time, in deadline order
+	while (YES)
+	{
+		ISResourceMediatorTraceReplayNode *dueNode = nil;
+		NSTimeInterval dueTime = time;
+
+		for (ISResourceMediatorTraceReplayNode *node in nodes)
+		{
+			NSTimeInterval nextDeadline = node.scheduler.nextDeadline;
+
+			if ((nextDeadline != 0) && (nextDeadline <= dueTime))
+			{
+				dueTime = nextDeadline;
+				dueNode = node;
+			}
+		}
+
+		if (dueNode == nil)
+		{
+			break;
+		}
+
+		currentTime = MAX(currentTime, dueTime);
+
+		[dueNode.scheduler fireDueDeadlines];
+	}
+
+	currentTime = MAX(currentTime, time);
+}
+
+- (void)_replayMessageRecord:(ISResourceMediatorTraceRecord *)record toNode:(ISResourceMediatorTraceReplayNode *)node
+{
+	ISResourceMediatorMessageType messageType = record.value;
+	uint64_t startTime;
+	NSTimeInterval duration;
+
+	if ((messageType >= kISResourceMediatorMessageTypeCount) || (node.mediator == nil))
+	{
+		return;
+	}
+
+	startTime = ISResourceMediatorTraceMonotonicTime();
+
+	[node replayMessage:messageType userInfo:record.userInfo];
+
+	duration = (double)(ISResourceMediatorTraceMonotonicTime() - startTime) / NSEC_PER_SEC;
+
+	processedMessageCount[messageType]++;
+	processingTime[messageType] += duration;
+	maximumProcessingTime[messageType] = MAX(maximumProcessingTime[messageType], duration);
+}
+
+- (void)replay
+{
+	uint64_t previousMonotonicTime = records.firstObject.monotonicTime;
+	NSMutableIndexSet *immediateCompletionIndexes = [NSMutableIndexSet indexSet];
+	NSUInteger recordIndex = 0;
+
+	// Decisions made when the trace was recorded
+	for (ISResourceMediatorTraceRecord *record in records)
+	{
+		if (record.event == kISResourceMediatorTraceEventAccessChange)
+		{
+			ISResourceMediatorTraceReplayNode *node = [self _nodeForMediatorID:record.mediatorID];
+			ISResourceMediatorTraceRecord *nextRecord = ((recordIndex + 1) < records.count) ? [records objectAtIndex:(recordIndex + 1)] : nil;
+
+			[node.recordedDecisions addObject:[ISResourceMediatorTraceReplayNode descriptionOfAccessChange:record.value userInfo:record.userInfo]];
+
+			if ((nextRecord.event == kISResourceMediatorTraceEventAccessChangeCompletion) && (nextRecord.mediatorID == record.mediatorID))
+			{
+				// The delegate completed the change right away
+				[node.immediateCompletionResults addObject:@(nextRecord.value)];
+				[immediateCompletionIndexes addIndex:(recordIndex + 1)];
+			}
+			else
+			{
+				[node.immediateCompletionResults addObject:[NSNull null]];
+			}
+		}
+
+		if ((record.event == kISResourceMediatorTraceEventMessageSent) && (record.value == kISResourceMediatorMessageTypeAccessResponse))
+		{
+			[[self _nodeForMediatorID:record.mediatorID].recordedDecisions addObject:[ISResourceMediatorTraceReplayNode descriptionOfAccessResponse:record.userInfo]];
+		}
+
+		recordIndex++;
+	}
+
+	currentTime = records.firstObject.time;
+
+	// Replay inputs. Outputs are made by the replayed mediators.
+	recordIndex = 0;
+
+	for (ISResourceMediatorTraceRecord *record in records)
+	{
+		@autoreleasepool
+		{
+			ISResourceMediatorTraceReplayNode *node = [self _nodeForMediatorID:record.mediatorID];
+
+			if ([immediateCompletionIndexes containsIndex:recordIndex++])
+			{
+				// Replayed from within the delegate method
+				continue;
+			}
+
+			if (usesOriginalTiming && (record.monotonicTime > previousMonotonicTime))
+			{
+				// The monotonic timestamps hold the actual intervals, even if the mediators' clock jumped
+				usleep((useconds_t)((record.monotonicTime - previousMonotonicTime) / NSEC_PER_USEC));
+			}
+
+			previousMonotonicTime = record.monotonicTime;
+
+			[self _advanceToTime:record.time];
+
+			switch (record.event)
+			{
+				case kISResourceMediatorTraceEventActivation:
+					[node replayActivation:(record.value != 0) userInfo:record.userInfo];
+				break;
+
+				case kISResourceMediatorTraceEventSetting:
+					[node replaySetting:record.userInfo];
+				break;
+
+				case kISResourceMediatorTraceEventMessageReceived:
+					[self _replayMessageRecord:record toNode:node];
+				break;
+
+				case kISResourceMediatorTraceEventAccessChangeCompletion:
+					[node replayAccessChangeCompletion:record.value];
+				break;
+
+				default:
+				break;
+			}
+		}
+	}
+
+	// Compare decisions
+	for (ISResourceMediatorTraceReplayNode *node in nodes)
+	{
+		NSUInteger count = MAX(node.recordedDecisions.count, node.replayedDecisions.count);
+
+		decisionCount += node.recordedDecisions.count;
+
+		for (NSUInteger i=0; i<count; i++)
+		{
+			NSString *recordedDecision = (i < node.recordedDecisions.count) ? [node.recordedDecisions objectAtIndex:i] : @"none";
+			NSString *replayedDecision = (i < node.replayedDecisions.count) ? [node.replayedDecisions objectAtIndex:i] : @"none";
+
+			if (![recordedDecision isEqual:replayedDecision] && (mismatches.count < kISResourceMediatorTraceReplayerMismatchLimit))
+			{
+				[mismatches addObject:[NSString stringWithFormat:@"Mediator %u (pid %d), decision %lu: recorded '%@', replayed '%@'", node.mediatorID, node.mediator.pid, (unsigned long)i, recordedDecision, replayedDecision]];
+			}
+		}
+	}
+
+	// Stop the mediators (after the comparison: leaving may lead to further decisions)
+	for (ISResourceMediatorTraceReplayNode *node in nodes)
+	{
+		node.mediator.delegate = nil;
+		node.mediator.active = NO;
+	}
+}
+
+#pragma mark - Report
+- (NSDictionary *)processingCostReport
+{
+	NSMutableDictionary *report = [NSMutableDictionary dictionary];
+
+	for (ISResourceMediatorMessageType messageType=0; messageType < kISResourceMediatorMessageTypeCount; messageType++)
+	{
+		if (processedMessageCount[messageType] > 0)
+		{
+			[report setObject:@{
+				@"count"     : @(processedMessageCount[messageType]),
+				@"totalTime" : @(processingTime[messageType]),
+				@"meanTime"  : @(processingTime[messageType] / processedMessageCount[messageType]),
+				@"maxTime"   : @(maximumProcessingTime[messageType]),
+			} forKey:[ISResourceMediatorMetrics nameForMessageType:messageType]];
+		}
+	}
+
+	return (report);
+}
+
+@end
@@ -0,0 +1,80 @@
+//
+//  ISResourceMediatorTransport.h
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediatorCodec.h"
+
+@class ISResourceMediatorHub;
+
+/*
+	A transport delivers encoded mediator messages between processes. Each ISResourceMediatorHub uses exactly one transport:
+	the hub subscribes (resourceIdentifier, pid) pairs as mediators become active, posts outgoing messages through the
+	transport and receives incoming messages via -[ISResourceMediatorHub routeMessage:resourceIdentifier:object:].
+
+	Transports are free to deliver targeted messages (targetPID != 0) to every subscriber of a resource identifier - the hub
+	filters them - but should route them to the target only where the underlying mechanism allows it.
+
+	Incoming messages must be delivered on the main thread.
+*/
+
+@protocol ISResourceMediatorTransport <NSObject>
+
+@property(assign) ISResourceMediatorHub *hub; //!< The hub to deliver incoming messages to. Set by the hub. Not retained.
+
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier; //!< Start receiving messages for resourceIdentifier that are broadcast or targeted at pid.
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier; //!< Stop receiving messages for resourceIdentifier on behalf of pid.
+
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo; //!< Sends a message to all subscribers of resourceIdentifier (targetPID == 0) or to the subscriber with targetPID.
+
+@end
+
+/*
+	ISResourceMediatorDistributedNotificationTransport exchanges messages via NSDistributedNotificationCenter. This is the
+	default transport and the only one compatible with the OS X App Sandbox. All messages are broadcast.
+*/
+
+@interface ISResourceMediatorDistributedNotificationTransport : NSObject <ISResourceMediatorTransport>
+{
+	ISResourceMediatorHub *hub;
+
+	NSCountedSet <NSString *> *subscribedResourceIdentifiers;
+
+	NSMutableDictionary <NSString *, NSArray <NSString *> *> *notificationNamesByResourceIdentifier;
+	NSMutableDictionary <NSString *, NSString *> *resourceIdentifiersByNotificationName;
+}
+
++ (NSArray <NSString *> *)notificationNamesForResourceIdentifier:(NSString *)resourceIdentifier; //!< Returns the notification names for resourceIdentifier, indexed by ISResourceMediatorMessageType.
+
+@end
@@ -0,0 +1,193 @@
+//
+//  ISResourceMediatorTransport.m
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "ISResourceMediatorTransport.h"
+#import "ISResourceMediatorHub.h"
+
+static NSString *kISResourceMediatorNotificationNamePrefix = @"com.iospirit.resourcemediator.";
+
+static NSString *kISResourceMediatorNotificationScanNameSuffix = @"scan";
+static NSString *kISResourceMediatorNotificationStatusNameSuffix = @"status";
+static NSString *kISResourceMediatorNotificationAccessRequestNameSuffix = @"accessRequest";
+static NSString *kISResourceMediatorNotificationAccessResponseNameSuffix = @"accessResponse";
+
+@implementation ISResourceMediatorDistributedNotificationTransport
+
+@synthesize hub;
+
+#pragma mark - Init & Dealloc
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		subscribedResourceIdentifiers = [NSCountedSet new];
+
+		notificationNamesByResourceIdentifier = [NSMutableDictionary new];
+		resourceIdentifiersByNotificationName = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[[NSDistributedNotificationCenter defaultCenter] removeObserver:self];
+
+	[subscribedResourceIdentifiers release];
+	subscribedResourceIdentifiers = nil;
+
+	[notificationNamesByResourceIdentifier release];
+	notificationNamesByResourceIdentifier = nil;
+
+	[resourceIdentifiersByNotificationName release];
+	resourceIdentifiersByNotificationName = nil;
+
+	hub = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Notification names
++ (NSArray <NSString *> *)notificationNamesForResourceIdentifier:(NSString *)resourceIdentifier
+{
+	NSString *namePrefix = [NSString stringWithFormat:@"%@%@.", kISResourceMediatorNotificationNamePrefix, resourceIdentifier];
+
+	// Order must match ISResourceMediatorMessageType
+	return (@[
+		[namePrefix stringByAppendingString:kISResourceMediatorNotificationScanNameSuffix],
+		[namePrefix stringByAppendingString:kISResourceMediatorNotificationStatusNameSuffix],
+		[namePrefix stringByAppendingString:kISResourceMediatorNotificationAccessRequestNameSuffix],
+		[namePrefix stringByAppendingString:kISResourceMediatorNotificationAccessResponseNameSuffix],
+	]);
+}
+
+#pragma mark - Subscriptions
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier
+{
+	@synchronized(self)
+	{
+		if ([subscribedResourceIdentifiers countForObject:resourceIdentifier] == 0)
+		{
+			NSArray <NSString *> *notificationNames = [[self class] notificationNamesForResourceIdentifier:resourceIdentifier];
+
+			[notificationNamesByResourceIdentifier setObject:notificationNames forKey:resourceIdentifier];
+
+			for (NSString *notificationName in notificationNames)
+			{
+				[resourceIdentifiersByNotificationName setObject:resourceIdentifier forKey:notificationName];
+
+				[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleMediatorNotification:) name:notificationName object:nil suspensionBehavior:NSNotificationSuspensionBehaviorDeliverImmediately];
+			}
+		}
+
+		[subscribedResourceIdentifiers addObject:resourceIdentifier];
+	}
+}
+
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier
+{
+	@synchronized(self)
+	{
+		if ([subscribedResourceIdentifiers countForObject:resourceIdentifier] == 0)
+		{
+			return;
+		}
+
+		[subscribedResourceIdentifiers removeObject:resourceIdentifier];
+
+		if ([subscribedResourceIdentifiers countForObject:resourceIdentifier] == 0)
+		{
+			for (NSString *notificationName in [notificationNamesByResourceIdentifier objectForKey:resourceIdentifier])
+			{
+				[[NSDistributedNotificationCenter defaultCenter] removeObserver:self name:notificationName object:nil];
+
+				[resourceIdentifiersByNotificationName removeObjectForKey:notificationName];
+			}
+
+			[notificationNamesByResourceIdentifier removeObjectForKey:resourceIdentifier];
+		}
+	}
+}
+
+#pragma mark - Sending & receiving
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	NSArray <NSString *> *notificationNames = nil;
+
+	@synchronized(self)
+	{
+		notificationNames = [[[notificationNamesByResourceIdentifier objectForKey:resourceIdentifier] retain] autorelease];
+	}
+
+	if (notificationNames == nil)
+	{
+		notificationNames = [[self class] notificationNamesForResourceIdentifier:resourceIdentifier];
+	}
+
+	if (messageType < notificationNames.count)
+	{
+		[[NSDistributedNotificationCenter defaultCenter] postNotificationName:[notificationNames objectAtIndex:messageType] object:encodedUserInfo userInfo:nil deliverImmediately:YES];
+	}
+}
+
+- (void)handleMediatorNotification:(NSNotification *)notification
+{
+	NSString *notificationName = notification.name;
+	NSString *resourceIdentifier = nil;
+	NSUInteger messageType = NSNotFound;
+
+	@synchronized(self)
+	{
+		if ((resourceIdentifier = [resourceIdentifiersByNotificationName objectForKey:notificationName]) != nil)
+		{
+			NSArray <NSString *> *notificationNames = [notificationNamesByResourceIdentifier objectForKey:resourceIdentifier];
+
+			// Pointer comparison first (notification names are usually the interned instances), string comparison second
+			if ((messageType = [notificationNames indexOfObjectIdenticalTo:notificationName]) == NSNotFound)
+			{
+				messageType = [notificationNames indexOfObject:notificationName];
+			}
+
+			[[resourceIdentifier retain] autorelease];
+		}
+	}
+
+	if ((resourceIdentifier != nil) && (messageType != NSNotFound))
+	{
+		[hub routeMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:resourceIdentifier object:notification.object];
+	}
+}
+
+@end
@@ -176,12 +176,12 @@ typedef NS_ENUM(NSInteger, TrackingMode)
 
 - (NSInteger)numberOfRowsInTableView:(NSTableView *)tableView
 {
-	return ([mediator.users count]);
+	return ([mediator.usersSnapshot count]);
 }
 
 - (id)tableView:(NSTableView *)tableView objectValueForTableColumn:(NSTableColumn *)tableColumn row:(NSInteger)row
 {
-	NSArray *users = mediator.users;
+	NSArray *users = mediator.usersSnapshot;
 	
 	if ((row>=0) && (row<[users count]))
 	{
@@ -0,0 +1,975 @@
+//
+//  MediatorBenchmarks.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorTestSupport.h"
+#import "ISResourceMediatorSocketTransport.h"
+#include <stdatomic.h>
+
+#define kMediatorBenchmarkIterations 20000
+
+@interface MediatorBenchmarkCountingHub : ISResourceMediatorHub
+{
+	NSUInteger routedMessageCount;
+}
+
+@property(assign) NSUInteger routedMessageCount;
+
+@end
+
+@implementation MediatorBenchmarkCountingHub
+
+@synthesize routedMessageCount;
+
+- (void)routeMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier object:(id)encodedUserInfo
+{
+	routedMessageCount++;
+
+	[super routeMessage:messageType resourceIdentifier:resourceIdentifier object:encodedUserInfo];
+}
+
+@end
+
+@interface ISResourceMediator (MediatorBenchmarksCommandQueue)
+
+- (void)submitToCommandQueue:(ISResourceMediatorCommand)asyncCommandBlock;
+
+@end
+
+@interface MediatorBenchmarkQueueCheckingDelegate : NSObject <ISResourceMediatorDelegate>
+{
+	const char *expectedQueueLabel;
+	atomic_uint_fast32_t callbackCount;
+	atomic_uint_fast32_t misplacedCallbackCount;
+}
+
+@property(assign) const char *expectedQueueLabel; //!< Label of the queue delegate methods are expected to be called on
+@property(readonly) NSUInteger callbackCount;
+@property(readonly) NSUInteger misplacedCallbackCount; //!< Number of delegate method calls that happened on another queue than expectedQueueLabel
+
+@end
+
+@implementation MediatorBenchmarkQueueCheckingDelegate
+
+@synthesize expectedQueueLabel;
+
+- (NSUInteger)callbackCount
+{
+	return (atomic_load(&callbackCount));
+}
+
+- (NSUInteger)misplacedCallbackCount
+{
+	return (atomic_load(&misplacedCallbackCount));
+}
+
+- (void)_noteCallback
+{
+	atomic_fetch_add(&callbackCount, 1);
+
+	if ((expectedQueueLabel != NULL) && (strcmp(dispatch_queue_get_label(DISPATCH_CURRENT_QUEUE_LABEL), expectedQueueLabel) != 0))
+	{
+		atomic_fetch_add(&misplacedCallbackCount, 1);
+	}
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+{
+	[self _noteCallback];
+
+	completionHandler(kISResourceMediatorResultSuccess);
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator userAppeared:(ISResourceUser *)user
+{
+	[self _noteCallback];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator userUpdated:(ISResourceUser *)user
+{
+	[self _noteCallback];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator actualAccessChangedTo:(ISResourceMediatorResourceAccess)actualAccess
+{
+	[self _noteCallback];
+}
+
+@end
+
+@interface ISIOResourceMediator (MediatorBenchmarksUserClients)
+
+- (void)_handleUserClientMatched:(ISIOObject *)userClientObj;
+- (void)_handleUserClientTerminated:(ISIOObject *)userClientObj;
+
+@end
+
+@interface MediatorBenchmarks : MediatorTestCase
+
+@end
+
+@implementation MediatorBenchmarks
+
+#pragma mark - Codec
+- (NSDictionary *)codecBenchmarkStatusUserInfo
+{
+	return (@{
+		kISResourceMediatorNotificationPIDKey			: @(0x100A),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0x100B),
+
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"mediator.test",
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessBlocking),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureRequired),
+		kISResourceMediatorNotificationAccessStartTimeKey	: @([NSDate timeIntervalSinceReferenceDate]),
+
+		kISResourceMediatorNotificationBroadcastInfoKey		: @""
+	});
+}
+
+- (void)runCodecBenchmarkWithFormat:(ISResourceMediatorWireFormat)format name:(NSString *)formatName
+{
+	NSDictionary *userInfo = [self codecBenchmarkStatusUserInfo];
+	NSString *encodedString = [ISResourceMediatorCodec stringWithUserInfo:userInfo format:format];
+	NSDictionary *decodedUserInfo;
+	CFAbsoluteTime startTime, encodeTime, decodeTime;
+
+	// Round trip
+	decodedUserInfo = [ISResourceMediatorCodec userInfoWithString:encodedString format:NULL error:NULL];
+
+	for (NSString *key in userInfo)
+	{
+		XCTAssertEqualObjects([userInfo objectForKey:key], [decodedUserInfo objectForKey:key], @"%@ value for %@ changed in round trip", formatName, key);
+	}
+
+	// Encoding
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		@autoreleasepool
+		{
+			[ISResourceMediatorCodec stringWithUserInfo:userInfo format:format];
+		}
+	}
+
+	encodeTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+	// Decoding
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		@autoreleasepool
+		{
+			[ISResourceMediatorCodec userInfoWithString:encodedString format:NULL error:NULL];
+		}
+	}
+
+	decodeTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+	NSLog(@"Codec %@: %lu bytes/message, %.0f ns/encode, %.0f ns/decode", formatName, (unsigned long)[encodedString lengthOfBytesUsingEncoding:NSUTF8StringEncoding], encodeTime * 1e9 / kMediatorBenchmarkIterations, decodeTime * 1e9 / kMediatorBenchmarkIterations);
+}
+
+- (void)testCodecPerformance
+{
+	[self runCodecBenchmarkWithFormat:kISResourceMediatorWireFormatPropertyList name:@"XML"];
+	[self runCodecBenchmarkWithFormat:kISResourceMediatorWireFormatBinary name:@"binary"];
+}
+
+#pragma mark - Hub
+- (void)testHubRoutingCostWithGrowingMediatorCount
+{
+	NSString *statusString = [ISResourceMediatorCodec stringWithUserInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x100A),
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"hub.benchmark.0",
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureOptional),
+	} format:kISResourceMediatorWireFormatBinary];
+
+	for (NSNumber *mediatorCount in @[ @(1), @(10), @(100), @(1000) ])
+	{
+		ISResourceMediatorHub *hub = [ISResourceMediatorHub new];
+		NSMutableArray <ISResourceMediator *> *mediators = [NSMutableArray new];
+		CFAbsoluteTime startTime, routeTime;
+
+		for (NSUInteger i=0; i<mediatorCount.unsignedIntegerValue; i++)
+		{
+			ISResourceMediator *mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:[NSString stringWithFormat:@"hub.benchmark.%lu", (unsigned long)i] delegate:nil];
+
+			mediator.pid = (pid_t)(0x2000 + i);
+			mediator.hub = hub;
+			[hub addMediator:mediator];
+
+			[mediators addObject:mediator];
+			[mediator release];
+		}
+
+		startTime = CFAbsoluteTimeGetCurrent();
+
+		for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+		{
+			@autoreleasepool
+			{
+				[hub routeMessage:kISResourceMediatorMessageTypeStatus resourceIdentifier:@"hub.benchmark.0" object:statusString];
+			}
+		}
+
+		routeTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+		XCTAssertEqual(mediators.firstObject.users.count, 1, @"Status message not delivered");
+
+		NSLog(@"Hub with %@ mediators: %.0f ns/message", mediatorCount, routeTime * 1e9 / kMediatorBenchmarkIterations);
+
+		for (ISResourceMediator *mediator in mediators)
+		{
+			[hub removeMediator:mediator];
+		}
+
+		[mediators release];
+		[hub release];
+	}
+}
+
+#pragma mark - Socket transport
+- (void)testSocketTransportUnicastAndThroughput
+{
+	NSString *socketPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"rm-bench-%d.sock", getpid()]];
+	ISResourceMediatorSocketBroker *broker = [[ISResourceMediatorSocketBroker alloc] initWithSocketPath:socketPath];
+	NSMutableArray <ISResourceMediatorSocketTransport *> *transports = [NSMutableArray new];
+	NSMutableArray <MediatorBenchmarkCountingHub *> *hubs = [NSMutableArray new];
+	NSMutableArray <ISResourceMediator *> *mediators = [NSMutableArray new];
+	MediatorBenchmarkCountingHub *senderHub, *targetHub, *bystanderHub;
+	NSString *statusString;
+	CFAbsoluteTime startTime, deliveryTime;
+
+	XCTAssertTrue([broker start]);
+
+	// One hub + transport per simulated process
+	for (NSUInteger i=0; i<3; i++)
+	{
+		ISResourceMediatorSocketTransport *transport = [[ISResourceMediatorSocketTransport alloc] initWithSocketPath:socketPath];
+		MediatorBenchmarkCountingHub *hub = [[MediatorBenchmarkCountingHub alloc] initWithTransport:transport];
+		ISResourceMediator *mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"socket.benchmark" delegate:nil];
+
+		mediator.pid = (pid_t)(0x3000 + i);
+		mediator.hub = hub;
+		[hub addMediator:mediator];
+
+		[transports addObject:transport];
+		[hubs addObject:hub];
+		[mediators addObject:mediator];
+
+		[transport release];
+		[hub release];
+		[mediator release];
+	}
+
+	senderHub = hubs[0];
+	targetHub = hubs[1];
+	bystanderHub = hubs[2];
+
+	statusString = [ISResourceMediatorCodec stringWithUserInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x3000),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0x3001),
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"socket.benchmark",
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureOptional),
+	} format:kISResourceMediatorWireFormatBinary];
+
+	// Wait for the subscriptions to reach the broker, then verify a targeted message only reaches its target
+	XCTAssertTrue([self waitForCondition:^{
+		[senderHub postMessage:kISResourceMediatorMessageTypeStatus resourceIdentifier:@"socket.benchmark" targetPID:0x3001 object:statusString];
+		return ((BOOL)(targetHub.routedMessageCount > 0));
+	} timeout:5.0]);
+
+	XCTAssertEqual(mediators[1].users.count, 1, @"Targeted status message not delivered");
+	XCTAssertEqual(bystanderHub.routedMessageCount, 0, @"Targeted status message delivered to bystander");
+
+	// Throughput of targeted messages
+	targetHub.routedMessageCount = 0;
+
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		[senderHub postMessage:kISResourceMediatorMessageTypeStatus resourceIdentifier:@"socket.benchmark" targetPID:0x3001 object:statusString];
+	}
+
+	XCTAssertTrue([self waitForCondition:^{ return ((BOOL)(targetHub.routedMessageCount >= kMediatorBenchmarkIterations)); } timeout:30.0]);
+
+	deliveryTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+	XCTAssertEqual(bystanderHub.routedMessageCount, 0, @"Targeted status messages delivered to bystander");
+
+	NSLog(@"Socket transport: %.0f ns/targeted message (%.0f messages/s)", deliveryTime * 1e9 / kMediatorBenchmarkIterations, kMediatorBenchmarkIterations / deliveryTime);
+
+	// Tear down
+	for (NSUInteger i=0; i<mediators.count; i++)
+	{
+		[hubs[i] removeMediator:mediators[i]];
+		[transports[i] disconnect];
+	}
+
+	[mediators release];
+	[hubs release];
+	[transports release];
+
+	[broker stop];
+	[broker release];
+}
+
+#pragma mark - Status table
+- (CFAbsoluteTime)timeToFirstArbitrationUsingStatusTable:(BOOL)useStatusTable
+{
+	ISResourceMediatorStatusTable *statusTable = [[ISResourceMediatorStatusTable alloc] initWithResourceIdentifier:@"statustable.benchmark" directoryPath:[self statusTableDirectoryPath]];
+	MediatorTestDelegate *delegate = [MediatorTestDelegate new];
+	ISResourceMediator *mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"statustable.benchmark" delegate:delegate];
+	ISResourceMediatorStatusTableEntry peerEntry = { .pid = getppid(), .preferredAccess = kISResourceMediatorResourceAccessShared, .actualAccess = kISResourceMediatorResourceAccessShared, .accessPressure = kISResourceMediatorAccessPressureOptional };
+	CFAbsoluteTime startTime, timeToFirstArbitration;
+
+	// A peer sharing the resource (using the pid of a process that is guaranteed to exist, so it isn't reclaimed)
+	[statusTable claimSlotForPID:peerEntry.pid];
+	[statusTable writeEntry:&peerEntry];
+
+	mediator.pid = 0x4000;
+	mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+
+	if (useStatusTable)
+	{
+		mediator.statusTable = statusTable;
+	}
+
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	mediator.active = YES;
+
+	XCTAssertTrue([self waitForCondition:^{ return ((BOOL)(delegate.firstArbitrationTime != 0)); } timeout:2.0]);
+
+	timeToFirstArbitration = delegate.firstArbitrationTime - startTime;
+
+	if (useStatusTable)
+	{
+		XCTAssertEqual(mediator.users.count, 1, @"Peer not picked up from status table");
+	}
+
+	mediator.active = NO;
+
+	[statusTable releaseSlotForPID:peerEntry.pid];
+
+	[mediator release];
+	[delegate release];
+	[statusTable release];
+
+	return (timeToFirstArbitration);
+}
+
+- (void)testTimeToFirstArbitration
+{
+	CFAbsoluteTime scanTime = 0, statusTableTime = 0;
+	NSUInteger runs = 5;
+
+	for (NSUInteger run=0; run < runs; run++)
+	{
+		scanTime	+= [self timeToFirstArbitrationUsingStatusTable:NO];
+		statusTableTime += [self timeToFirstArbitrationUsingStatusTable:YES];
+	}
+
+	NSLog(@"Time to first arbitration: %.3f ms via [SCAN], %.3f ms via status table", scanTime * 1000.0 / runs, statusTableTime * 1000.0 / runs);
+
+	XCTAssertLessThan(statusTableTime, scanTime);
+}
+
+#pragma mark - Discovery
+- (void)testActivationToAccessPercentiles
+{
+	NSMutableArray <NSNumber *> *activationToAccessTimes = [NSMutableArray new];
+	NSUInteger rounds = 10, mediatorsPerRound = 4;
+	NSTimeInterval p50, p99;
+
+	for (NSUInteger round=0; round < rounds; round++)
+	{
+		NSMutableArray <ISResourceMediator *> *mediators = [NSMutableArray new];
+
+		// Mediators join one after another, each after the previous one got access
+		for (NSUInteger i=0; i < mediatorsPerRound; i++)
+		{
+			MediatorTestDelegate *delegate = [[MediatorTestDelegate new] autorelease];
+			ISResourceMediator *mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"discovery.benchmark" delegate:delegate];
+			CFAbsoluteTime startTime;
+
+			mediator.pid = (pid_t)(0x5000 + (round * mediatorsPerRound) + i);
+			mediator.representedObject = delegate;
+			mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+
+			startTime = CFAbsoluteTimeGetCurrent();
+
+			mediator.active = YES;
+
+			XCTAssertTrue([self waitForCondition:^{ return ((BOOL)(delegate.firstAccessTime != 0)); } timeout:2.0]);
+
+			[activationToAccessTimes addObject:@(delegate.firstAccessTime - startTime)];
+
+			[mediators addObject:mediator];
+			[mediator release];
+		}
+
+		for (ISResourceMediator *mediator in mediators)
+		{
+			mediator.active = NO;
+		}
+
+		[mediators release];
+	}
+
+	[activationToAccessTimes sortUsingSelector:@selector(compare:)];
+
+	p50 = [activationToAccessTimes[(activationToAccessTimes.count * 50) / 100] doubleValue];
+	p99 = [activationToAccessTimes[MIN((activationToAccessTimes.count * 99) / 100, activationToAccessTimes.count-1)] doubleValue];
+
+	NSLog(@"Activation to access (%lu activations): p50 = %.1f ms, p99 = %.1f ms", (unsigned long)activationToAccessTimes.count, p50 * 1000.0, p99 * 1000.0);
+
+	XCTAssertLessThan(p50, 0.2, @"Median activation to access time not below the former fixed discovery delay");
+
+	[activationToAccessTimes release];
+}
+
+#pragma mark - Arbitration
+- (void)testArbitrationCostWithThousandsOfUsers
+{
+	for (NSNumber *userCount in @[ @(100), @(1000), @(5000) ])
+	{
+		MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+		ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+		ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"arbitration.benchmark" delegate:nil] autorelease];
+		NSUInteger users = userCount.unsignedIntegerValue;
+		CFAbsoluteTime startTime, statusTime, considerTime;
+
+		mediator.pid = 0x7000;
+		mediator.hub = hub;
+		mediator.active = YES;
+
+		// Let discovery time out
+		[self waitForCondition:^{ return (NO); } timeout:0.3];
+
+		// Many idle users and one blocking holder with a higher pressure
+		for (NSUInteger i=0; i<users; i++)
+		{
+			@autoreleasepool
+			{
+				[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+					kISResourceMediatorNotificationPIDKey			: @(0x10000 + i),
+					kISResourceMediatorNotificationPreferredAccessKey	: @((i == 0) ? kISResourceMediatorResourceAccessBlocking : kISResourceMediatorResourceAccessNone),
+					kISResourceMediatorNotificationActualAccessKey		: @((i == 0) ? kISResourceMediatorResourceAccessBlocking : kISResourceMediatorResourceAccessNone),
+					kISResourceMediatorNotificationAccessPressureKey	: @((i == 0) ? kISResourceMediatorAccessPressureRequired : kISResourceMediatorAccessPressureOptional),
+					kISResourceMediatorNotificationStatusSequenceKey	: @(1),
+				} peerFormat:kISResourceMediatorWireFormatBinary];
+			}
+		}
+
+		// Ask for shared access => one access request to the blocking holder, which stays pending
+		mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+
+		// Burst of status updates from idle users that don't change the conflict set
+		startTime = CFAbsoluteTimeGetCurrent();
+
+		for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+		{
+			@autoreleasepool
+			{
+				NSUInteger userIndex = 1 + (i % (users - 1));
+
+				[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+					kISResourceMediatorNotificationPIDKey			: @(0x10000 + userIndex),
+					kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+					kISResourceMediatorNotificationStatusSequenceKey	: @(2 + (i / (users - 1))),
+					kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+				} peerFormat:kISResourceMediatorWireFormatBinary];
+			}
+		}
+
+		statusTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+		// Full arbitration passes
+		startTime = CFAbsoluteTimeGetCurrent();
+
+		for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+		{
+			@autoreleasepool
+			{
+				[mediator considerRequestingAccess];
+			}
+		}
+
+		considerTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+		XCTAssertEqual(mediator.actualAccess, kISResourceMediatorResourceAccessNone, @"Access granted despite blocking holder");
+		XCTAssertEqual([[transport.postedMessages filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"messageType == %@", @(kISResourceMediatorMessageTypeAccessRequest)]] count], 1, @"Unexpected number of access requests");
+
+		NSLog(@"Arbitration with %@ users: %.0f ns/status update, %.0f ns/arbitration pass", userCount, statusTime * 1e9 / kMediatorBenchmarkIterations, considerTime * 1e9 / kMediatorBenchmarkIterations);
+
+		mediator.active = NO;
+	}
+}
+
+- (void)testCommandQueueUnderConcurrentSubmission
+{
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"commandqueue.benchmark" delegate:nil] autorelease];
+	atomic_uint_fast32_t *counters = calloc(3, sizeof(atomic_uint_fast32_t));
+	atomic_uint_fast32_t *runningCount = &counters[0], *executedCount = &counters[1], *overlapCount = &counters[2];
+	dispatch_queue_t completionQueue = dispatch_queue_create("commandqueue.benchmark.completion", DISPATCH_QUEUE_SERIAL);
+	CFAbsoluteTime startTime;
+
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	dispatch_apply(kMediatorBenchmarkIterations, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+		[mediator submitToCommandQueue:^(dispatch_block_t completionHandler) {
+			if (atomic_fetch_add(runningCount, 1) != 0)
+			{
+				atomic_fetch_add(overlapCount, 1);
+			}
+
+			atomic_fetch_add(executedCount, 1);
+
+			if ((i % 8) == 0)
+			{
+				// Complete asynchronously
+				dispatch_async(completionQueue, ^{
+					atomic_fetch_sub(runningCount, 1);
+					completionHandler();
+				});
+			}
+			else
+			{
+				atomic_fetch_sub(runningCount, 1);
+				completionHandler();
+			}
+		}];
+	});
+
+	XCTAssert([self waitForCondition:^{ return ((BOOL)(atomic_load(executedCount) == kMediatorBenchmarkIterations)); } timeout:10.0], @"Not all commands were executed (%lu)", (unsigned long)atomic_load(executedCount));
+	XCTAssertEqual(atomic_load(overlapCount), 0, @"Commands ran concurrently");
+
+	NSLog(@"Command queue: %.0f ns/command under concurrent submission", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / kMediatorBenchmarkIterations);
+
+	dispatch_sync(completionQueue, ^{});
+	dispatch_release(completionQueue);
+
+	free(counters);
+}
+
+- (void)testContendedUpdatesLockedVersusSerialExecution
+{
+	for (NSNumber *serialExecution in @[ @NO, @YES ])
+	{
+		MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+		ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+		MediatorBenchmarkQueueCheckingDelegate *delegate = [[MediatorBenchmarkQueueCheckingDelegate new] autorelease];
+		ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"contention.benchmark" delegate:delegate] autorelease];
+		CFAbsoluteTime startTime, submitTime, totalTime;
+
+		mediator.pid = 0x8000;
+		mediator.hub = hub;
+
+		if (serialExecution.boolValue)
+		{
+			[mediator enableSerialExecutionWithTargetQueue:NULL];
+			delegate.expectedQueueLabel = dispatch_queue_get_label(mediator.executionQueue);
+		}
+
+		mediator.active = YES;
+
+		// Let discovery time out
+		[self waitForCondition:^{ return (NO); } timeout:0.3];
+
+		startTime = CFAbsoluteTimeGetCurrent();
+
+		// Hammer the mediator from all cores with property changes and incoming [STATUS] messages
+		dispatch_apply(kMediatorBenchmarkIterations, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+			@autoreleasepool
+			{
+				dispatch_block_t update = ^{
+					switch (i % 3)
+					{
+						case 0:
+							mediator.preferredAccess = ((i % 2) == 0) ? kISResourceMediatorResourceAccessShared : kISResourceMediatorResourceAccessNone;
+						break;
+
+						case 1:
+							mediator.broadcastInfo = @{ @"iteration" : @(i) };
+						break;
+
+						case 2:
+							[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+								kISResourceMediatorNotificationPIDKey			: @(0x20000 + (i % 16)),
+								kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessNone),
+								kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+								kISResourceMediatorNotificationBroadcastInfoKey		: @{ @"iteration" : @(i) },
+							} peerFormat:kISResourceMediatorWireFormatBinary];
+						break;
+					}
+				};
+
+				if (serialExecution.boolValue)
+				{
+					update();
+				}
+				else
+				{
+					// Without serial execution, callers have to serialize access themselves - on the mediator's own lock
+					@synchronized(mediator)
+					{
+						update();
+					}
+				}
+			}
+		});
+
+		submitTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+		if (serialExecution.boolValue)
+		{
+			// Drain the execution queue (twice, to include delegate notifications enqueued by the last updates)
+			dispatch_sync(mediator.executionQueue, ^{});
+			dispatch_sync(mediator.executionQueue, ^{});
+		}
+
+		totalTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+		for (pid_t userPID = 0x20000; userPID < 0x20000 + 16; userPID++)
+		{
+			XCTAssertNotNil([mediator resourceUserForPID:userPID createIfNotExists:NO], @"User %d missing after concurrent updates", userPID);
+		}
+
+		XCTAssert(delegate.callbackCount > 0, @"No delegate callbacks");
+		XCTAssertEqual(delegate.misplacedCallbackCount, 0, @"Delegate called outside the execution queue");
+
+		NSLog(@"Contended updates (%@): %.0f ns/update to submit, %.0f ns/update total", (serialExecution.boolValue ? @"serial queue" : @"@synchronized"), submitTime * 1e9 / kMediatorBenchmarkIterations, totalTime * 1e9 / kMediatorBenchmarkIterations);
+
+		mediator.active = NO;
+
+		if (serialExecution.boolValue)
+		{
+			dispatch_sync(mediator.executionQueue, ^{});
+		}
+	}
+}
+
+- (void)testDeadlineSchedulerRescheduleCost
+{
+	ISResourceMediatorDeadlineScheduler *scheduler = [[[ISResourceMediatorDeadlineScheduler alloc] initWithQueue:dispatch_get_main_queue()] autorelease];
+	NSTimeInterval now = [scheduler currentTime];
+	CFAbsoluteTime startTime;
+
+	// Cost of schedule + cancel with many outstanding deadlines
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		[scheduler scheduleDeadline:(now + 100 + (double)((i * 7919) % kMediatorBenchmarkIterations)) forKey:@(i) handler:^{}];
+	}
+
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		[scheduler scheduleDeadline:(now + 100 + (double)i) forKey:@(i) handler:^{}];
+	}
+
+	NSLog(@"Deadline scheduler: %.0f ns/reschedule with %d outstanding deadlines", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / kMediatorBenchmarkIterations, kMediatorBenchmarkIterations);
+
+	[scheduler cancelAllDeadlines];
+}
+
+- (void)testMetricsForAccessHandoff
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	MediatorTestDelegate *delegate = [[MediatorTestDelegate new] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"metrics.benchmark" delegate:delegate] autorelease];
+	NSDictionary *snapshot, *histograms;
+	NSData *jsonData, *plistData;
+	CFAbsoluteTime startTime;
+
+	mediator.pid = 0xA000;
+	mediator.hub = hub;
+	mediator.active = YES;
+
+	// Let discovery time out
+	[self waitForCondition:^{ return (NO); } timeout:0.3];
+
+	// A blocking holder announces itself through the hub, a message for another pid is dropped
+	[hub routeMessage:kISResourceMediatorMessageTypeStatus resourceIdentifier:@"metrics.benchmark" object:[ISResourceMediatorCodec stringWithUserInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0xA001),
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"metrics.benchmark",
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessBlocking),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessBlocking),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureOptional),
+	} format:kISResourceMediatorWireFormatBinary]];
+
+	[hub routeMessage:kISResourceMediatorMessageTypeScan resourceIdentifier:@"metrics.benchmark" object:[ISResourceMediatorCodec stringWithUserInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0xA001),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0xA002),
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"metrics.benchmark",
+	} format:kISResourceMediatorWireFormatBinary]];
+
+	// Request access from the holder, which grants it
+	mediator.accessPressure = kISResourceMediatorAccessPressureRequired;
+	mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+
+	[self waitForCondition:^{ return (NO); } timeout:0.01];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeAccessResponse userInfo:@{
+		kISResourceMediatorNotificationPIDKey		: @(0xA001),
+		kISResourceMediatorNotificationResultKey	: @(kISResourceMediatorResultSuccess),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(mediator.actualAccess, kISResourceMediatorResourceAccessBlocking);
+
+	snapshot = [mediator metricsSnapshot];
+	histograms = snapshot[@"histograms"];
+
+	XCTAssertEqualObjects(snapshot[@"messagesSent"][@"accessRequest"], @(1));
+	XCTAssertEqualObjects(snapshot[@"messagesReceived"][@"accessResponse"], @(1));
+	XCTAssert([snapshot[@"bytesEncoded"] unsignedIntegerValue] > 0);
+	XCTAssertEqualObjects(histograms[@"handoffRequestToResponse"][@"count"], @(1));
+	XCTAssertEqualObjects(histograms[@"handoffResponseToAccess"][@"count"], @(1));
+	XCTAssertEqualObjects(histograms[@"handoffTotal"][@"count"], @(1));
+	XCTAssert([histograms[@"handoffTotal"][@"p50Us"] unsignedIntegerValue] >= 10000, @"Handoff total doesn't include the 10 ms wait");
+	XCTAssert([histograms[@"delegateAccessChange"][@"count"] unsignedIntegerValue] >= 1);
+	XCTAssert([histograms[@"commandQueueWait"][@"count"] unsignedIntegerValue] >= 1);
+
+	XCTAssertEqualObjects(snapshot[@"hub"][@"messagesReceived"][@"status"], @(1));
+	XCTAssertEqualObjects(snapshot[@"hub"][@"messagesDroppedByTargetPID"], @(1));
+	XCTAssert([snapshot[@"hub"][@"bytesDecoded"] unsignedIntegerValue] > 0);
+
+	// Export
+	XCTAssertNotNil((jsonData = [mediator.metrics JSONDataWithError:NULL]));
+	XCTAssertNotNil([NSJSONSerialization JSONObjectWithData:jsonData options:0 error:NULL]);
+	XCTAssertNotNil((plistData = [mediator.metrics propertyListDataWithFormat:NSPropertyListXMLFormat_v1_0 error:NULL]));
+	XCTAssertNotNil([NSJSONSerialization dataWithJSONObject:snapshot options:0 error:NULL], @"Combined snapshot not JSON compatible");
+
+	[mediator.metrics reset];
+	XCTAssertEqualObjects([mediator.metrics snapshot][@"histograms"][@"handoffTotal"][@"count"], @(0));
+
+	// Recording cost
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<kMediatorBenchmarkIterations; i++)
+	{
+		[mediator.metrics noteDuration:(i * 0.000001) forHistogram:kISResourceMediatorMetricsHistogramCommandQueueWait];
+	}
+
+	NSLog(@"Metrics: %.0f ns/histogram sample", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / kMediatorBenchmarkIterations);
+
+	mediator.active = NO;
+}
+
+#pragma mark - Child reconciliation
+- (void)testChildReconciliationCost
+{
+	MediatorTestFakeRegistry *registry = [[MediatorTestFakeRegistry new] autorelease];
+	MediatorTestReconcilerDelegate *delegate = [[MediatorTestReconcilerDelegate new] autorelease];
+	ISIOChildReconciler *reconciler = [[[ISIOChildReconciler alloc] initWithEntry:@"device" registry:registry deadlineScheduler:[[[MediatorTestManualScheduler alloc] initWithQueue:NULL] autorelease]] autorelease];
+	NSUInteger childCount = 1000;
+	CFAbsoluteTime startTime;
+
+	reconciler.delegate = delegate;
+
+	for (NSUInteger i=0; i<childCount; i++)
+	{
+		[registry.childEntryIDs addObject:@(0x100000000ULL + i)];
+	}
+
+	XCTAssert([reconciler reconcile]);
+
+	// Cost of reconciling unchanged children
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<100; i++)
+	{
+		[reconciler reconcile];
+	}
+
+	NSLog(@"Child reconciliation: %.0f ns/unchanged child", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / (100 * childCount));
+
+	XCTAssertEqual(registry.createdChildCount, childCount, @"Unchanged children were re-created");
+	XCTAssertEqual(delegate.appearedChildren.count, childCount);
+	XCTAssertEqual(delegate.disappearedChildren.count, 0);
+}
+
+- (void)testUserClientAttachDetachScaling
+{
+	MediatorTestFakeRegistry *registry = [[MediatorTestFakeRegistry new] autorelease];
+	ISIOResourceMediator *mediator = [[[ISIOResourceMediator alloc] initMediatorForResourceWithIdentifier:@"com.iospirit.benchmark.userclients" deviceClassName:nil userClientClassName:nil delegate:nil] autorelease];
+	NSMutableArray <ISIOObject *> *userClients = [NSMutableArray array];
+	NSUInteger appCount = 50, clientsPerApp = 10, clientCount = appCount * clientsPerApp;
+	pid_t basePID = 90000;
+	CFAbsoluteTime startTime;
+
+	mediator.registry = registry;
+
+	for (NSUInteger i=0; i<clientCount; i++)
+	{
+		ISIOObject *userClient = [[ISIOObject new] autorelease];
+
+		userClient.uniqueID = 0x100000000ULL + i;
+
+		[registry.propertiesByEntryID setObject:@{ @"IOUserClientCreator" : [NSString stringWithFormat:@"pid %d, App%lu", (int)(basePID + (i % appCount)), (unsigned long)(i % appCount)] } forKey:@(userClient.uniqueID)];
+		[userClients addObject:userClient];
+	}
+
+	// Attach
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (ISIOObject *userClient in userClients)
+	{
+		[mediator _handleUserClientMatched:userClient];
+	}
+
+	NSLog(@"User client attach: %.0f ns/client", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / clientCount);
+
+	XCTAssertEqual(mediator.users.count, appCount);
+	XCTAssertEqual(((NSDictionary *)[mediator resourceUserForPID:basePID createIfNotExists:NO].trackingObject).count, clientsPerApp);
+
+	// Matching known user clients again uses the cached creators
+	for (ISIOObject *userClient in userClients)
+	{
+		[mediator _handleUserClientMatched:userClient];
+	}
+
+	XCTAssertEqual(registry.propertyFetchCount, clientCount, @"Creators of known user clients were fetched again");
+	XCTAssertEqual(((NSDictionary *)[mediator resourceUserForPID:basePID createIfNotExists:NO].trackingObject).count, clientsPerApp);
+
+	// Detach all but the last user client of each app
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<clientCount-appCount; i++)
+	{
+		[mediator _handleUserClientTerminated:userClients[i]];
+	}
+
+	NSLog(@"User client detach: %.0f ns/client", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / (clientCount-appCount));
+
+	XCTAssertEqual(mediator.users.count, appCount, @"User removed while it still had user clients");
+
+	// Detaching the last user client of an app removes its user
+	for (NSUInteger i=clientCount-appCount; i<clientCount; i++)
+	{
+		[mediator _handleUserClientTerminated:userClients[i]];
+	}
+
+	XCTAssertEqual(mediator.users.count, 0);
+
+	// Unknown user clients are ignored
+	[mediator _handleUserClientTerminated:userClients[0]];
+	XCTAssertEqual(mediator.users.count, 0);
+}
+
+- (void)testProcessWatcherFansOutExits
+{
+	ISResourceMediatorProcessWatcher *watcher = [[[ISResourceMediatorProcessWatcher alloc] initWithQueue:dispatch_get_main_queue()] autorelease];
+	NSMutableArray <MediatorTestExitObserver *> *observers = [NSMutableArray array];
+	NSMutableArray <ISResourceMediator *> *mediators = [NSMutableArray array];
+	NSUInteger observerCount = 200;
+	NSTask *task, *exitedTask;
+	CFAbsoluteTime startTime;
+
+	// A process that is already gone can't be watched
+	exitedTask = [NSTask launchedTaskWithLaunchPath:@"/usr/bin/true" arguments:@[]];
+	[exitedTask waitUntilExit];
+
+	XCTAssertFalse([watcher addObserver:[[MediatorTestExitObserver new] autorelease] forPID:exitedTask.processIdentifier]);
+
+	// A non-app process, watched by many observers and mediators
+	task = [NSTask launchedTaskWithLaunchPath:@"/bin/sleep" arguments:@[ @"30" ]];
+
+	startTime = CFAbsoluteTimeGetCurrent();
+
+	for (NSUInteger i=0; i<observerCount; i++)
+	{
+		MediatorTestExitObserver *observer = [[MediatorTestExitObserver new] autorelease];
+
+		XCTAssertTrue([watcher addObserver:observer forPID:task.processIdentifier]);
+		[observers addObject:observer];
+	}
+
+	NSLog(@"Process watcher subscription: %.0f ns/observer", (CFAbsoluteTimeGetCurrent() - startTime) * 1e9 / observerCount);
+
+	for (NSUInteger i=0; i<10; i++)
+	{
+		ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:[NSString stringWithFormat:@"com.iospirit.benchmark.exit.%lu", (unsigned long)i] delegate:nil] autorelease];
+
+		mediator.processWatcher = watcher;
+
+		XCTAssertNotNil([mediator resourceUserForPID:task.processIdentifier createIfNotExists:YES]);
+		[mediators addObject:mediator];
+	}
+
+	XCTAssertEqual(watcher.watchedProcessCount, 1, @"Process watched more than once");
+
+	// Unsubscribed observers aren't notified
+	[watcher removeObserver:observers.lastObject forPID:task.processIdentifier];
+
+	[task terminate];
+
+	XCTAssertTrue([self waitForCondition:^{
+		for (ISResourceMediator *mediator in mediators)
+		{
+			if (mediator.users.count != 0)
+			{
+				return (NO);
+			}
+		}
+
+		return (YES);
+	} timeout:10.0], @"Mediators didn't remove the user of an exited process");
+
+	for (MediatorTestExitObserver *observer in observers)
+	{
+		if (observer == observers.lastObject)
+		{
+			XCTAssertEqual(observer.exitedPIDs.count, 0);
+		}
+		else
+		{
+			XCTAssertEqualObjects(observer.exitedPIDs, @[ @(task.processIdentifier) ]);
+		}
+	}
+
+	XCTAssertEqual(watcher.watchedProcessCount, 0);
+}
+
+@end
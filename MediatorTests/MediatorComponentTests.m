@@ -0,0 +1,781 @@
+//
+//  MediatorComponentTests.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorTestSupport.h"
+#include <sys/wait.h>
+
+@interface MediatorComponentTests : MediatorTestCase
+
+@end
+
+@implementation MediatorComponentTests
+
+#pragma mark - Codec
+- (void)testCodecRejectsMalformedData
+{
+	NSData *binaryData = [ISResourceMediatorCodec binaryDataWithUserInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x100A),
+		kISResourceMediatorNotificationResourceIdentifierKey	: @"mediator.test",
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationBroadcastInfoKey		: @""
+	}];
+
+	XCTAssertNotNil(binaryData);
+	XCTAssertNil([ISResourceMediatorCodec userInfoWithBinaryData:[binaryData subdataWithRange:NSMakeRange(0, binaryData.length-3)]], @"Truncated data was accepted");
+	XCTAssertNil([ISResourceMediatorCodec binaryDataWithUserInfo:@{ @"unknownKey" : @(1) }], @"Unknown key was encoded");
+}
+
+#pragma mark - Status table
+- (void)testStatusTableReclaimsStaleSlots
+{
+	ISResourceMediatorStatusTable *statusTable = [[ISResourceMediatorStatusTable alloc] initWithResourceIdentifier:@"statustable.reclaim" directoryPath:[self statusTableDirectoryPath]];
+	ISResourceMediatorStatusTableEntry entries[kISResourceMediatorStatusTableSlotCount];
+	ISResourceMediatorStatusTableEntry entry = { .pid = getpid(), .actualAccess = kISResourceMediatorResourceAccessShared };
+	pid_t exitedPID;
+
+	XCTAssertNotNil(statusTable);
+
+	// Obtain the pid of a process that no longer exists
+	if ((exitedPID = fork()) == 0)
+	{
+		_exit(0);
+	}
+
+	waitpid(exitedPID, NULL, 0);
+
+	XCTAssertTrue([statusTable claimSlotForPID:exitedPID]);
+	XCTAssertTrue([statusTable claimSlotForPID:getpid()]);
+	XCTAssertTrue([statusTable writeEntry:&entry]);
+
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 2);
+	XCTAssertEqual([statusTable reclaimStaleSlots], 1);
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 1);
+	XCTAssertEqual(entries[0].pid, getpid());
+	XCTAssertEqual(entries[0].actualAccess, kISResourceMediatorResourceAccessShared);
+
+	[statusTable releaseSlotForPID:getpid()];
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 0);
+
+	[[NSFileManager defaultManager] removeItemAtPath:statusTable.path error:NULL];
+	[statusTable release];
+}
+
+- (void)testStatusTableCountsClaimsPerPID
+{
+	ISResourceMediatorStatusTable *statusTable = [[ISResourceMediatorStatusTable alloc] initWithResourceIdentifier:@"statustable.claims" directoryPath:[self statusTableDirectoryPath]];
+	ISResourceMediatorStatusTableEntry entries[kISResourceMediatorStatusTableSlotCount];
+
+	XCTAssertNotNil(statusTable);
+
+	// Two mediators of the same process
+	XCTAssertTrue([statusTable claimSlotForPID:getpid()]);
+	XCTAssertTrue([statusTable claimSlotForPID:getpid()]);
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 1, @"Mediators of one process don't share a slot");
+
+	// The slot stays claimed until the last of them deactivates
+	[statusTable releaseSlotForPID:getpid()];
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 1, @"Slot freed while still in use");
+
+	[statusTable releaseSlotForPID:getpid()];
+	XCTAssertEqual([statusTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 0, @"Slot not freed after the last release");
+
+	[[NSFileManager defaultManager] removeItemAtPath:statusTable.path error:NULL];
+	[statusTable release];
+}
+
+- (void)testStatusTableCountsClaimsAcrossTableObjects
+{
+	ISResourceMediatorStatusTable *firstTable = [[ISResourceMediatorStatusTable alloc] initWithResourceIdentifier:@"statustable.objects" directoryPath:[self statusTableDirectoryPath]];
+	ISResourceMediatorStatusTable *secondTable = [[ISResourceMediatorStatusTable alloc] initWithResourceIdentifier:@"statustable.objects" directoryPath:[self statusTableDirectoryPath]];
+	ISResourceMediatorStatusTableEntry entries[kISResourceMediatorStatusTableSlotCount];
+
+	XCTAssertNotNil(firstTable);
+	XCTAssertNotNil(secondTable);
+
+	// Two mediators of the same process, each with its own table object for the same file
+	XCTAssertTrue([firstTable claimSlotForPID:getpid()]);
+	XCTAssertTrue([secondTable claimSlotForPID:getpid()]);
+	XCTAssertEqual([secondTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 1);
+
+	[firstTable releaseSlotForPID:getpid()];
+	XCTAssertEqual([secondTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 1, @"Slot freed while still claimed through another table object");
+
+	[secondTable releaseSlotForPID:getpid()];
+	XCTAssertEqual([firstTable readEntries:entries maximumCount:kISResourceMediatorStatusTableSlotCount], 0, @"Slot not freed after the last release");
+
+	[[NSFileManager defaultManager] removeItemAtPath:firstTable.path error:NULL];
+	[firstTable release];
+	[secondTable release];
+
+	// The process-wide table is opened once per resource identifier
+	XCTAssertNotNil([ISResourceMediatorStatusTable statusTableForResourceIdentifier:@"statustable.shared"]);
+	XCTAssertEqual([ISResourceMediatorStatusTable statusTableForResourceIdentifier:@"statustable.shared"], [ISResourceMediatorStatusTable statusTableForResourceIdentifier:@"statustable.shared"]);
+}
+
+#pragma mark - Status
+- (void)testStatusCoalescingAndDeltaSequencing
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"status.test" delegate:nil] autorelease];
+	NSArray <NSDictionary *> *statusMessages;
+	NSDictionary *delta;
+	ISResourceUser *peer;
+
+	mediator.pid = 0x6000;
+	mediator.hub = hub;
+	mediator.active = YES;
+
+	// Several changes within one run loop turn => one [STATUS]
+	mediator.accessPressure = kISResourceMediatorAccessPressureRequired;
+	mediator.broadcastInfo = @{ @"name" : @"first" };
+	mediator.broadcastInfo = @{ @"name" : @"second" };
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	mediator.broadcastInfo = @{ @"name" : @"third" };
+	mediator.broadcastInfo = @{ @"name" : @"third" };
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	statusMessages = [transport.postedMessages filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"messageType == %@", @(kISResourceMediatorMessageTypeStatus)]];
+
+	XCTAssertEqual(statusMessages.count, 2, @"Status changes were not coalesced");
+	XCTAssertEqualObjects(statusMessages[0][kISResourceMediatorNotificationBroadcastInfoKey], (@{ @"name" : @"second" }));
+	XCTAssertNil(statusMessages[0][kISResourceMediatorNotificationStatusDeltaKey], @"First status must be full");
+
+	delta = statusMessages[1];
+	XCTAssertEqualObjects(delta[kISResourceMediatorNotificationStatusDeltaKey], @(1));
+	XCTAssertEqualObjects(delta[kISResourceMediatorNotificationBroadcastInfoHashKey], @([ISResourceMediatorCodec contentHashOfPropertyList:@{ @"name" : @"third" }]));
+	XCTAssertNil(delta[kISResourceMediatorNotificationBroadcastInfoKey], @"broadcastInfo sent along although no user needs it");
+	XCTAssertNil(delta[kISResourceMediatorNotificationAccessPressureKey], @"Unchanged field included in delta");
+	XCTAssertEqual([delta[kISResourceMediatorNotificationStatusSequenceKey] unsignedLongLongValue], [statusMessages[0][kISResourceMediatorNotificationStatusSequenceKey] unsignedLongLongValue] + 1);
+
+	// Receiving: full status, in-order delta, duplicate, gap
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6001),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(5),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	peer = [mediator resourceUserForPID:0x6001 createIfNotExists:NO];
+	XCTAssertEqual(peer.statusSequence, 5);
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6001),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(6),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(peer.actualAccess, kISResourceMediatorResourceAccessShared);
+	XCTAssertEqual(peer.preferredAccess, kISResourceMediatorResourceAccessShared, @"Field missing from delta was changed");
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6001),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(8),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(peer.actualAccess, kISResourceMediatorResourceAccessShared, @"Delta applied despite gap");
+	XCTAssertEqual(peer.statusSequence, 6);
+	XCTAssertEqual(transport.postedMessages.count, 1, @"No resync requested");
+	XCTAssertEqualObjects(transport.postedMessages.lastObject[@"messageType"], @(kISResourceMediatorMessageTypeScan));
+	XCTAssertEqualObjects(transport.postedMessages.lastObject[kISResourceMediatorNotificationTargetPIDKey], @(0x6001));
+
+	// A lease return is no full status: it neither moves the sequence nor lifts the resync throttle
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6001),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0x6000),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(0),
+		kISResourceMediatorNotificationLeaseEpochKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(peer.statusSequence, 6, @"Lease return changed the sequence");
+
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6001),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(9),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(transport.postedMessages.count, 0, @"Lease return was taken for a full status and lifted the resync throttle");
+
+	// A delta from an unknown user is not applied - the full status is requested instead
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6002),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(3),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	peer = [mediator resourceUserForPID:0x6002 createIfNotExists:NO];
+	XCTAssertEqual(peer.preferredAccess, kISResourceMediatorResourceAccessUnknown, @"Delta applied to unknown user");
+	XCTAssertEqual(peer.statusSequence, 0);
+	XCTAssertEqual(transport.postedMessages.count, 1, @"No resync requested");
+	XCTAssertEqualObjects(transport.postedMessages.lastObject[@"messageType"], @(kISResourceMediatorMessageTypeScan));
+	XCTAssertEqualObjects(transport.postedMessages.lastObject[kISResourceMediatorNotificationTargetPIDKey], @(0x6002));
+
+	// After reactivation, the first status is full again
+	mediator.active = NO;
+	mediator.active = YES;
+
+	[transport.postedMessages removeAllObjects];
+
+	mediator.accessPressure = kISResourceMediatorAccessPressureOptional;
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	statusMessages = [transport.postedMessages filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"messageType == %@ AND targetPID == nil", @(kISResourceMediatorMessageTypeStatus)]];
+
+	XCTAssertGreaterThan(statusMessages.count, 0);
+	XCTAssertNil(statusMessages.lastObject[kISResourceMediatorNotificationStatusDeltaKey], @"First status after reactivation must be full");
+	XCTAssertEqualObjects(statusMessages.lastObject[kISResourceMediatorNotificationBroadcastInfoKey], (@{ @"name" : @"third" }));
+
+	mediator.active = NO;
+}
+
+- (void)testBroadcastInfoIsFetchedOnlyWhenUnknown
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	MediatorTestDelegate *delegate = [[MediatorTestDelegate new] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"broadcastinfo.test" delegate:delegate] autorelease];
+	NSMutableDictionary *firstInfo = [NSMutableDictionary dictionary], *reorderedFirstInfo = [NSMutableDictionary dictionary];
+	NSDictionary *secondInfo = @{ @"name" : @"second" };
+	uint64_t firstHash, secondHash;
+	ISResourceUser *peer;
+	NSDictionary *message;
+
+	// Hashes depend on content only
+	for (NSUInteger i=0; i<100; i++)
+	{
+		[firstInfo setObject:@(i) forKey:[NSString stringWithFormat:@"key%lu", (unsigned long)i]];
+		[reorderedFirstInfo setObject:@(99-i) forKey:[NSString stringWithFormat:@"key%lu", (unsigned long)(99-i)]];
+	}
+
+	firstHash = [ISResourceMediatorCodec contentHashOfPropertyList:firstInfo];
+	secondHash = [ISResourceMediatorCodec contentHashOfPropertyList:secondInfo];
+
+	XCTAssertEqual(firstHash, [ISResourceMediatorCodec contentHashOfPropertyList:reorderedFirstInfo]);
+	XCTAssertNotEqual(firstHash, secondHash);
+	XCTAssertNotEqual([ISResourceMediatorCodec contentHashOfPropertyList:@{ @"value" : @(1) }], [ISResourceMediatorCodec contentHashOfPropertyList:@{ @"value" : @"1" }]);
+	XCTAssertEqual([ISResourceMediatorCodec contentHashOfPropertyList:nil], 0);
+
+	mediator.pid = 0x6100;
+	mediator.hub = hub;
+	mediator.active = YES;
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	// Full status carries broadcastInfo
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationCapabilitiesKey		: @(kISResourceMediatorCapabilityBroadcastInfoHash),
+		kISResourceMediatorNotificationBroadcastInfoKey		: firstInfo,
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(firstHash),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	peer = [mediator resourceUserForPID:0x6101 createIfNotExists:NO];
+	XCTAssertEqualObjects(peer.broadcastInfo, firstInfo);
+	XCTAssertEqual(delegate.updatedBroadcastInfoCount, 0, @"New user reported as updated");
+
+	// Unknown hash => fetched with a targeted [SCAN], once
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(secondHash),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(2),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(3),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	message = transport.postedMessages.firstObject;
+	XCTAssertEqual(transport.postedMessages.count, 1);
+	XCTAssertEqualObjects(message[@"messageType"], @(kISResourceMediatorMessageTypeScan));
+	XCTAssertEqualObjects(message[kISResourceMediatorNotificationTargetPIDKey], @(0x6101));
+	XCTAssertEqualObjects(message[kISResourceMediatorNotificationBroadcastInfoHashKey], @(secondHash));
+	XCTAssertEqualObjects(peer.broadcastInfo, firstInfo, @"broadcastInfo changed before it was fetched");
+	XCTAssertEqual(delegate.updatedBroadcastInfoCount, 0);
+
+	// Reply to the fetch: applies without touching the sequence
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0x6100),
+		kISResourceMediatorNotificationBroadcastInfoKey		: secondInfo,
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(secondHash),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqualObjects(peer.broadcastInfo, secondInfo);
+	XCTAssertEqual(peer.statusSequence, 3);
+	XCTAssertEqual(delegate.updatedBroadcastInfoCount, 1);
+
+	// Cached hash => applied without fetching
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(firstHash),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(4),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqualObjects(peer.broadcastInfo, firstInfo);
+	XCTAssertEqual(transport.postedMessages.count, 0, @"Cached broadcastInfo was fetched");
+	XCTAssertEqual(delegate.updatedBroadcastInfoCount, 2);
+
+	// Unchanged broadcastInfo from peers predating hashes => no update
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationBroadcastInfoKey		: reorderedFirstInfo,
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(delegate.updatedBroadcastInfoCount, 2, @"Unchanged broadcastInfo reported as updated");
+
+	// Sending: deltas carry only the hash, fetches are answered with a targeted [STATUS]
+	mediator.broadcastInfo = secondInfo;
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	message = transport.postedMessages.lastObject;
+	XCTAssertEqualObjects(message[@"messageType"], @(kISResourceMediatorMessageTypeStatus));
+	XCTAssertEqualObjects(message[kISResourceMediatorNotificationBroadcastInfoHashKey], @(secondHash));
+	XCTAssertNil(message[kISResourceMediatorNotificationBroadcastInfoKey]);
+
+	[transport.postedMessages removeAllObjects];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeScan userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6101),
+		kISResourceMediatorNotificationTargetPIDKey		: @(0x6100),
+		kISResourceMediatorNotificationBroadcastInfoHashKey	: @(secondHash),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	message = transport.postedMessages.firstObject;
+	XCTAssertEqual(transport.postedMessages.count, 1);
+	XCTAssertEqualObjects(message[kISResourceMediatorNotificationTargetPIDKey], @(0x6101));
+	XCTAssertEqualObjects(message[kISResourceMediatorNotificationBroadcastInfoKey], secondInfo);
+	XCTAssertNil(message[kISResourceMediatorNotificationStatusSequenceKey], @"Fetch reply took part in sequencing");
+
+	mediator.active = NO;
+}
+
+- (void)testUserUpdatesAreChangeDetectedAndBatched
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	MediatorTestDelegate *delegate = [[MediatorTestDelegate new] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"userchanges.test" delegate:delegate] autorelease];
+	NSArray <ISResourceUser *> *snapshot;
+	uint64_t generation;
+
+	mediator.pid = 0x6200;
+	mediator.hub = hub;
+	mediator.active = YES;
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6201),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	snapshot = mediator.usersSnapshot;
+	generation = mediator.usersGeneration;
+
+	XCTAssertEqual(snapshot.count, 1);
+
+	// Repeated status => nothing reported, nothing changed
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6201),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(2),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	XCTAssertEqualObjects(delegate.userChanges, @[], @"Unchanged user reported as updated");
+	XCTAssertEqual(mediator.usersGeneration, generation);
+	XCTAssertEqual(mediator.usersSnapshot, snapshot, @"Snapshot rebuilt without changes");
+
+	// Changes within one run loop turn => one call with all changed properties
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6201),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessShared),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(3),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6201),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureRequired),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(4),
+		kISResourceMediatorNotificationStatusDeltaKey		: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqualObjects(delegate.userChanges, @[], @"Changes reported before the end of the run loop turn");
+	XCTAssertGreaterThan(mediator.usersGeneration, generation);
+
+	[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+	XCTAssertEqualObjects(delegate.userChanges, @[ @(kISResourceUserChangeActualAccess | kISResourceUserChangeAccessPressure) ]);
+	XCTAssertEqual(mediator.usersSnapshot, snapshot, @"Snapshot rebuilt although membership didn't change");
+
+	// New user => new snapshot, the old one stays as it was
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6202),
+		kISResourceMediatorNotificationStatusSequenceKey	: @(1),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(mediator.usersSnapshot.count, 2);
+	XCTAssertEqual(snapshot.count, 1);
+
+	mediator.active = NO;
+}
+
+- (void)testAutomaticWireFormatBroadcastsInBinaryOnlyOnceAllPeersUseIt
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"wireformat.test" delegate:nil] autorelease];
+	__block NSUInteger statusChangeCount = 0;
+	NSNumber *(^broadcastFormatAfterStatusChange)(void) = ^{
+		NSArray <NSDictionary *> *statusMessages;
+
+		[transport.postedMessages removeAllObjects];
+
+		mediator.broadcastInfo = @{ @"change" : @(++statusChangeCount) };
+
+		[self waitForCondition:^{ return (NO); } timeout:0.1];
+
+		statusMessages = [transport.postedMessages filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"messageType == %@ AND targetPID == nil", @(kISResourceMediatorMessageTypeStatus)]];
+
+		return (statusMessages.lastObject[@"messageFormat"]);
+	};
+
+	mediator.pid = 0x6500;
+	mediator.hub = hub;
+	mediator.active = YES;
+
+	// Peers that haven't answered the [SCAN] yet may predate the binary format
+	XCTAssertEqualObjects(broadcastFormatAfterStatusChange(), @(kISResourceMediatorWireFormatPropertyList), @"Binary broadcast during discovery");
+
+	[self waitForCondition:^{ return (NO); } timeout:(hub.discoveryTimeout + 0.2)];
+
+	XCTAssertEqualObjects(broadcastFormatAfterStatusChange(), @(kISResourceMediatorWireFormatBinary), @"No peers, but no binary broadcast after discovery");
+
+	// A peer using property lists
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6501),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+	} peerFormat:kISResourceMediatorWireFormatPropertyList];
+
+	XCTAssertEqualObjects(broadcastFormatAfterStatusChange(), @(kISResourceMediatorWireFormatPropertyList));
+
+	// ..that turns out to be a newer one, which understands the binary format
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x6501),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessNone),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessNone),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqualObjects(broadcastFormatAfterStatusChange(), @(kISResourceMediatorWireFormatBinary));
+
+	// A mediator user whose format is unknown, as it was only seen in the status table
+	[mediator resourceUserForPID:0x6502 createIfNotExists:YES].isUsingResourceMediator = YES;
+
+	XCTAssertEqualObjects(broadcastFormatAfterStatusChange(), @(kISResourceMediatorWireFormatPropertyList), @"Binary broadcast to a peer of unknown format");
+
+	mediator.active = NO;
+}
+
+#pragma mark - Deadlines
+- (void)testDeadlineSchedulerOrderAndCancellation
+{
+	ISResourceMediatorDeadlineScheduler *scheduler = [[[ISResourceMediatorDeadlineScheduler alloc] initWithQueue:dispatch_get_main_queue()] autorelease];
+	NSMutableArray <NSNumber *> *firedKeys = [NSMutableArray array];
+	NSTimeInterval now = [scheduler currentTime];
+
+	for (NSUInteger i=0; i<100; i++)
+	{
+		NSUInteger key = (i * 37) % 100;
+
+		[scheduler scheduleDeadline:(now + 0.05 + (key * 0.001)) forKey:@(key) handler:^{
+			[firedKeys addObject:@(key)];
+		}];
+	}
+
+	// Cancel odd keys, reschedule key 0 to fire last
+	for (NSUInteger key=1; key<100; key+=2)
+	{
+		XCTAssert([scheduler cancelDeadlineForKey:@(key)], @"Deadline for key %lu not found", (unsigned long)key);
+	}
+
+	[scheduler scheduleDeadline:(now + 0.2) forKey:@(0) handler:^{
+		[firedKeys addObject:@(0)];
+	}];
+
+	XCTAssertEqual(scheduler.count, 50);
+
+	XCTAssert([self waitForCondition:^{ return ((BOOL)(firedKeys.count == 50)); } timeout:2.0], @"Deadlines didn't fire");
+
+	for (NSUInteger i=0; i<49; i++)
+	{
+		XCTAssertEqualObjects(firedKeys[i], @(2 + (i * 2)), @"Deadlines fired out of order");
+	}
+
+	XCTAssertEqualObjects(firedKeys.lastObject, @(0), @"Rescheduled deadline fired early");
+	XCTAssertEqual(scheduler.count, 0);
+
+	[scheduler cancelAllDeadlines];
+}
+
+#pragma mark - Access requests
+- (void)testUnansweredAccessRequestRetriesAndTimesOut
+{
+	MediatorTestRecordingTransport *transport = [[MediatorTestRecordingTransport new] autorelease];
+	ISResourceMediatorHub *hub = [[[ISResourceMediatorHub alloc] initWithTransport:transport] autorelease];
+	MediatorTestDelegate *delegate = [[MediatorTestDelegate new] autorelease];
+	ISResourceMediator *mediator = [[[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:@"deadline.test" delegate:delegate] autorelease];
+	NSPredicate *accessRequestPredicate = [NSPredicate predicateWithFormat:@"messageType == %@", @(kISResourceMediatorMessageTypeAccessRequest)];
+	NSUInteger (^accessRequestCount)(void) = ^{
+		@synchronized(transport.postedMessages)
+		{
+			return ([[transport.postedMessages filteredArrayUsingPredicate:accessRequestPredicate] count]);
+		}
+	};
+
+	mediator.pid = 0x9000;
+	mediator.hub = hub;
+	mediator.accessRequestTimeout = 0.05;
+	mediator.accessRequestRetryLimit = 2;
+	mediator.accessRequestBackoffFactor = 2.0;
+	mediator.active = YES;
+
+	// Let discovery time out
+	[self waitForCondition:^{ return (NO); } timeout:0.3];
+
+	// A blocking holder that never answers
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x9001),
+		kISResourceMediatorNotificationPreferredAccessKey	: @(kISResourceMediatorResourceAccessBlocking),
+		kISResourceMediatorNotificationActualAccessKey		: @(kISResourceMediatorResourceAccessBlocking),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressureRequired),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+
+	XCTAssertEqual(accessRequestCount(), 1);
+
+	// 1 request + 2 retries after 0.05 + 0.1 s, giving up after another 0.2 s
+	XCTAssert([self waitForCondition:^{ return ((BOOL)(delegate.accessRequestResults.count > 0)); } timeout:2.0], @"Timeout not reported");
+	XCTAssertEqualObjects(delegate.accessRequestResults.firstObject, @(kISResourceMediatorResultTimeout));
+	XCTAssertEqual(accessRequestCount(), 3, @"Unexpected number of access requests");
+
+	// Given up => no further requests until the holder's status changes
+	[mediator considerRequestingAccess];
+	XCTAssertEqual(accessRequestCount(), 3, @"Request re-sent after giving up");
+
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeStatus userInfo:@{
+		kISResourceMediatorNotificationPIDKey			: @(0x9001),
+		kISResourceMediatorNotificationAccessPressureKey	: @(kISResourceMediatorAccessPressurePartiallySupported),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(accessRequestCount(), 4, @"Request not re-sent after status change");
+
+	// Changing preferredAccess cancels the pending request and its deadline
+	mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+
+	XCTAssertEqual(mediator.deadlineScheduler.count, 0, @"Deadline not cancelled");
+
+	// A late response to the cancelled request is ignored
+	[mediator handleMediatorMessage:kISResourceMediatorMessageTypeAccessResponse userInfo:@{
+		kISResourceMediatorNotificationPIDKey		: @(0x9001),
+		kISResourceMediatorNotificationResultKey	: @(kISResourceMediatorResultSuccess),
+	} peerFormat:kISResourceMediatorWireFormatBinary];
+
+	XCTAssertEqual(delegate.accessRequestResults.count, 1, @"Late response not ignored");
+	XCTAssertEqual(mediator.actualAccess, kISResourceMediatorResourceAccessNone);
+
+	mediator.active = NO;
+}
+
+#pragma mark - Child reconciliation
+- (void)testChildReconcilerIsIncremental
+{
+	MediatorTestFakeRegistry *registry = [[MediatorTestFakeRegistry new] autorelease];
+	MediatorTestReconcilerDelegate *delegate = [[MediatorTestReconcilerDelegate new] autorelease];
+	ISIOChildReconciler *reconciler = [[[ISIOChildReconciler alloc] initWithEntry:@"device" registry:registry deadlineScheduler:[[[MediatorTestManualScheduler alloc] initWithQueue:NULL] autorelease]] autorelease];
+	NSUInteger childCount = 1000;
+
+	reconciler.delegate = delegate;
+
+	for (NSUInteger i=0; i<childCount; i++)
+	{
+		[registry.childEntryIDs addObject:@(0x100000000ULL + i)];
+	}
+
+	XCTAssert([reconciler reconcile]);
+	XCTAssertEqual(delegate.appearedChildren.count, childCount);
+	XCTAssertEqual(registry.createdChildCount, childCount);
+
+	// One child added, two removed
+	[delegate.appearedChildren removeAllObjects];
+	[registry.childEntryIDs addObject:@(0x200000000ULL)];
+	[registry.childEntryIDs removeObjectAtIndex:10];
+	[registry.childEntryIDs removeObjectAtIndex:20];
+
+	XCTAssert([reconciler reconcile]);
+	XCTAssertEqualObjects(delegate.appearedChildren, @[ @"child-8589934592" ]);
+	XCTAssertEqualObjects([NSSet setWithArray:delegate.disappearedChildren], ([NSSet setWithObjects:@"child-4294967306", @"child-4294967317", nil]));
+	XCTAssertEqual(registry.createdChildCount, childCount + 1, @"Unchanged children were re-created");
+	XCTAssertEqual(reconciler.children.count, childCount - 1);
+
+	// A failed enumeration keeps the known children
+	[delegate.disappearedChildren removeAllObjects];
+	registry.failsEnumeration = YES;
+	XCTAssertFalse([reconciler reconcile]);
+	XCTAssertEqual(delegate.disappearedChildren.count, 0);
+	XCTAssertEqual(reconciler.children.count, childCount - 1);
+	registry.failsEnumeration = NO;
+}
+
+- (void)testChildReconcilerCoalescesChangeBursts
+{
+	MediatorTestFakeRegistry *registry = [[MediatorTestFakeRegistry new] autorelease];
+	MediatorTestManualScheduler *scheduler = [[[MediatorTestManualScheduler alloc] initWithQueue:NULL] autorelease];
+	ISIOChildReconciler *reconciler = [[[ISIOChildReconciler alloc] initWithEntry:@"device" registry:registry deadlineScheduler:scheduler] autorelease];
+
+	reconciler.debounceInterval = 0.125; // Binary fractions, so virtual times add up exactly
+	reconciler.maximumDelay = 1.0;
+
+	// A burst of changes within the debounce interval results in one reconciliation, debounceInterval after the last change
+	for (NSUInteger i=0; i<10; i++)
+	{
+		[reconciler setNeedsReconciliation];
+		[scheduler advanceBy:0.0625];
+	}
+
+	XCTAssertEqual(reconciler.reconciliationCount, 0, @"Reconciled before the device settled");
+	XCTAssertEqual(scheduler.count, 1, @"More than one reconciliation scheduled");
+
+	[scheduler advanceBy:0.0625];
+
+	XCTAssertEqual(reconciler.reconciliationCount, 1);
+	XCTAssertEqual(registry.enumerationCount, 1);
+	XCTAssertEqual(reconciler.changeGeneration, 10);
+
+	// A device that never settles is reconciled after maximumDelay
+	for (NSUInteger i=0; i<30; i++)
+	{
+		[reconciler setNeedsReconciliation];
+		[scheduler advanceBy:0.0625];
+	}
+
+	XCTAssertEqual(reconciler.reconciliationCount, 2, @"Reconciliation of a chatty device wasn't capped at maximumDelay");
+
+	// Cancellation
+	[reconciler setNeedsReconciliation];
+	[reconciler invalidate];
+	[scheduler advanceBy:2.0];
+
+	XCTAssertEqual(reconciler.reconciliationCount, 2, @"Invalidated reconciler still reconciled");
+	XCTAssertEqual(scheduler.count, 0);
+}
+
+#pragma mark - Process watcher
+- (void)testProcessWatcherRemovesObserversWithoutWaitingForItsQueue
+{
+	dispatch_queue_t queue = dispatch_queue_create("com.iospirit.test.processwatcher", DISPATCH_QUEUE_SERIAL);
+	ISResourceMediatorProcessWatcher *watcher = [[[ISResourceMediatorProcessWatcher alloc] initWithQueue:queue] autorelease];
+	MediatorTestExitObserver *firstObserver = [[MediatorTestExitObserver new] autorelease];
+	MediatorTestExitObserver *secondObserver = [[MediatorTestExitObserver new] autorelease];
+	MediatorTestExitObserver *removedObserver = [[MediatorTestExitObserver new] autorelease];
+	dispatch_semaphore_t queueBlockSemaphore = dispatch_semaphore_create(0);
+	NSTask *task = [NSTask launchedTaskWithLaunchPath:@"/bin/sleep" arguments:@[ @"30" ]];
+
+	XCTAssertTrue([watcher addObserver:firstObserver forPID:task.processIdentifier]);
+	XCTAssertTrue([watcher addObserver:secondObserver forPID:task.processIdentifier]);
+	XCTAssertTrue([watcher addObserver:removedObserver forPID:task.processIdentifier]);
+
+	// An observer that isn't being notified is removed right away - even while the watcher's queue is busy
+	dispatch_async(queue, ^{
+		dispatch_semaphore_wait(queueBlockSemaphore, DISPATCH_TIME_FOREVER);
+	});
+
+	[watcher removeObserver:removedObserver];
+
+	dispatch_semaphore_signal(queueBlockSemaphore);
+
+	// Whichever observer is notified first removes the other one, which then mustn't be notified anymore
+	firstObserver.observerToRemove = secondObserver;
+	secondObserver.observerToRemove = firstObserver;
+
+	[task terminate];
+
+	XCTAssertTrue([self waitForCondition:^{ return ((BOOL)(watcher.watchedProcessCount == 0)); } timeout:10.0], @"Exit not noticed");
+
+	// Let the notifications finish
+	dispatch_sync(queue, ^{});
+
+	XCTAssertEqual(firstObserver.exitedPIDs.count + secondObserver.exitedPIDs.count, 1, @"Observer notified after its removal");
+	XCTAssertEqual(removedObserver.exitedPIDs.count, 0);
+
+	dispatch_release(queueBlockSemaphore);
+	dispatch_release(queue);
+}
+
+@end
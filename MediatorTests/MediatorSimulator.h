@@ -0,0 +1,179 @@
+//
+//  MediatorSimulator.h
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	MediatorSimulator runs any number of ISResourceMediator instances in-process, on a virtual clock.
+
+	Every simulated mediator gets its own hub and MediatorSimulatorTransport, just like a separate process would. Messages
+	are delivered through the simulator's event queue after a configurable latency plus random jitter (which reorders
+	messages) and can be dropped at a configurable loss rate. Mediator timers run on a MediatorSimulatorScheduler, so
+	discovery, status coalescing and access request timeouts all follow the virtual clock.
+
+	Runs are deterministic: the same seed, network conditions and scenario produce the same sequence of events.
+*/
+
+#import <Foundation/Foundation.h>
+#import "ISResourceMediator.h"
+#import "ScarceResource.h"
+
+@class MediatorSimulator;
+@class MediatorSimulatorNode;
+
+@interface MediatorSimulatorScheduler : ISResourceMediatorDeadlineScheduler
+{
+	MediatorSimulator *simulator;
+}
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator;
+
+@end
+
+@interface MediatorSimulatorTransport : NSObject <ISResourceMediatorTransport>
+{
+	MediatorSimulator *simulator;
+	MediatorSimulatorNode *node;
+	ISResourceMediatorHub *hub;
+
+	NSMutableDictionary <NSString *, NSNumber *> *subscribedPIDsByResourceIdentifier;
+}
+
+@property(assign,readonly) MediatorSimulator *simulator;
+@property(assign) MediatorSimulatorNode *node; //!< The node sending through the transport.
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator;
+
+- (BOOL)isSubscribedToResourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID; //!< YES if the transport subscribed to resourceIdentifier - for targetPID, if it is not 0.
+
+@end
+
+@interface MediatorSimulatorNode : NSObject <ISResourceMediatorDelegate>
+{
+	MediatorSimulator *simulator;
+
+	ISResourceMediator *mediator;
+	MediatorSimulatorTransport *transport;
+	ISResourceMediatorHub *hub;
+
+	NSTimeInterval completionDelay;
+	NSTimeInterval statusDelay;
+
+	NSUInteger handoffCount;
+	NSUInteger accessChangeCount;
+
+	NSTimeInterval waitStartTime;
+	NSTimeInterval longestWaitTime;
+}
+
+@property(retain,readonly) ISResourceMediator *mediator;
+@property(retain,readonly) MediatorSimulatorTransport *transport;
+@property(assign) NSTimeInterval completionDelay; //!< Virtual time the simulated app takes to change its access to the resource. Defaults to 0.
+@property(assign) NSTimeInterval statusDelay; //!< Virtual time [STATUS] messages of this node are held back before they are sent, so other messages can overtake them. Defaults to 0.
+
+@property(readonly) NSUInteger handoffCount; //!< Number of successful responses to access requests this node received.
+@property(readonly) NSUInteger accessChangeCount; //!< Number of actualAccess changes.
+@property(readonly) NSTimeInterval longestWaitTime; //!< Longest virtual time the node wanted access it didn't get (including an ongoing wait). Sampled whenever the node sends a message or its access changes.
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator pid:(pid_t)pid resourceIdentifier:(NSString *)resourceIdentifier; //!< Use -[MediatorSimulator addNodeWithPID:resourceIdentifier:] instead.
+
+@end
+
+@interface MediatorSimulator : NSObject
+{
+	NSTimeInterval startTime;
+	NSTimeInterval now;
+
+	uint64_t randomState;
+
+	struct MediatorSimulatorEventQueue *eventQueue;
+
+	NSTimeInterval latency;
+	NSTimeInterval jitter;
+	double lossRate;
+
+	NSMutableArray <MediatorSimulatorTransport *> *transports;
+	NSMutableDictionary <NSNumber *, MediatorSimulatorTransport *> *transportsByPID;
+	NSMutableArray <MediatorSimulatorNode *> *nodes;
+
+	ScarceResource *resource;
+
+	NSUInteger eventCount;
+	NSUInteger messagesSent;
+	NSUInteger messagesDelivered;
+	NSUInteger messagesLost;
+	NSUInteger accessOverlapCount;
+	NSTimeInterval lastAccessChangeTime;
+}
+
+@property(readonly) NSTimeInterval now; //!< Current virtual time (seconds since the reference date, as used by the mediators).
+@property(readonly) NSTimeInterval elapsedTime; //!< Virtual time elapsed since the simulator was created.
+
+@property(assign) NSTimeInterval latency; //!< Minimum message delivery latency. Defaults to 1 ms.
+@property(assign) NSTimeInterval jitter; //!< Random additional delivery latency of up to jitter. Messages can overtake each other if jitter > 0. Defaults to 0.
+@property(assign) double lossRate; //!< Probability of a message delivery being dropped. Defaults to 0.
+
+@property(retain,readonly) NSArray <MediatorSimulatorNode *> *nodes;
+@property(retain,readonly) ScarceResource *resource; //!< The resource shared by all nodes.
+
+@property(readonly) NSUInteger eventCount; //!< Number of events processed.
+@property(readonly) NSUInteger messagesSent; //!< Number of messages posted by mediators.
+@property(readonly) NSUInteger messagesDelivered; //!< Number of message deliveries to hubs (a broadcast counts once per receiver).
+@property(readonly) NSUInteger messagesLost; //!< Number of dropped message deliveries.
+@property(readonly) NSUInteger handoffCount; //!< Sum of the handoffCount of all nodes.
+@property(readonly) NSUInteger accessChangeCount; //!< Sum of the accessChangeCount of all nodes.
+@property(readonly) NSTimeInterval longestWaitTime; //!< Longest longestWaitTime of all nodes: the starvation bound.
+@property(readonly) NSUInteger accessOverlapCount; //!< Number of times a node's access changed while it conflicted with the access of another node - or its shared access oversubscribed a counted resource.
+@property(readonly) NSTimeInterval lastAccessChangeTime; //!< Elapsed virtual time at which the last actualAccess change happened.
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSeed:(uint64_t)seed;
+
+#pragma mark - Nodes
+- (MediatorSimulatorNode *)addNodeWithPID:(pid_t)pid resourceIdentifier:(NSString *)resourceIdentifier; //!< Creates an inactive mediator for pid.
+- (void)removeAllNodes; //!< Deactivates all mediators and breaks retain cycles. Call when done.
+
+#pragma mark - Events
+- (void)scheduleBlock:(dispatch_block_t)block atTime:(NSTimeInterval)time; //!< Runs block once the virtual clock reaches time.
+- (void)scheduleBlock:(dispatch_block_t)block afterDelay:(NSTimeInterval)delay;
+
+- (BOOL)runUntilIdleWithTimeLimit:(NSTimeInterval)timeLimit; //!< Processes events until there are none left (returns YES) or timeLimit virtual seconds have elapsed (returns NO).
+
+#pragma mark - Network
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo; //!< Called by MediatorSimulatorTransport.
+
+#pragma mark - Randomness
+- (double)randomValue; //!< Deterministic pseudo random number in [0, 1).
+
+@end
@@ -0,0 +1,664 @@
+//
+//  MediatorSimulator.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorSimulator.h"
+#include <Block.h>
+
+#pragma mark - Event queue
+// Binary min-heap of blocks, ordered by time - and by insertion order for events scheduled for the same time
+typedef struct
+{
+	NSTimeInterval time;
+	uint64_t sequence;
+	dispatch_block_t block;
+} MediatorSimulatorEvent;
+
+struct MediatorSimulatorEventQueue
+{
+	MediatorSimulatorEvent *events;
+	size_t count;
+	size_t capacity;
+
+	uint64_t nextSequence;
+};
+
+static BOOL MediatorSimulatorEventIsEarlier(MediatorSimulatorEvent *event, MediatorSimulatorEvent *otherEvent)
+{
+	return ((event->time < otherEvent->time) || ((event->time == otherEvent->time) && (event->sequence < otherEvent->sequence)));
+}
+
+static void MediatorSimulatorEventQueuePush(struct MediatorSimulatorEventQueue *queue, NSTimeInterval time, dispatch_block_t block)
+{
+	size_t index;
+
+	if (queue->count == queue->capacity)
+	{
+		queue->capacity = (queue->capacity == 0) ? 1024 : (queue->capacity * 2);
+		queue->events = reallocf(queue->events, queue->capacity * sizeof(MediatorSimulatorEvent));
+	}
+
+	index = queue->count++;
+
+	queue->events[index].time = time;
+	queue->events[index].sequence = queue->nextSequence++;
+	queue->events[index].block = Block_copy(block);
+
+	while (index > 0)
+	{
+		size_t parentIndex = (index - 1) / 2;
+		MediatorSimulatorEvent swapEvent;
+
+		if (!MediatorSimulatorEventIsEarlier(&queue->events[index], &queue->events[parentIndex]))
+		{
+			break;
+		}
+
+		swapEvent = queue->events[parentIndex];
+		queue->events[parentIndex] = queue->events[index];
+		queue->events[index] = swapEvent;
+
+		index = parentIndex;
+	}
+}
+
+static BOOL MediatorSimulatorEventQueuePop(struct MediatorSimulatorEventQueue *queue, MediatorSimulatorEvent *outEvent)
+{
+	size_t index = 0;
+
+	if (queue->count == 0)
+	{
+		return (NO);
+	}
+
+	*outEvent = queue->events[0];
+	queue->events[0] = queue->events[--queue->count];
+
+	while (YES)
+	{
+		size_t earliestIndex = index, leftIndex = (2 * index) + 1, rightIndex = leftIndex + 1;
+		MediatorSimulatorEvent swapEvent;
+
+		if ((leftIndex < queue->count) && MediatorSimulatorEventIsEarlier(&queue->events[leftIndex], &queue->events[earliestIndex]))
+		{
+			earliestIndex = leftIndex;
+		}
+
+		if ((rightIndex < queue->count) && MediatorSimulatorEventIsEarlier(&queue->events[rightIndex], &queue->events[earliestIndex]))
+		{
+			earliestIndex = rightIndex;
+		}
+
+		if (earliestIndex == index)
+		{
+			break;
+		}
+
+		swapEvent = queue->events[earliestIndex];
+		queue->events[earliestIndex] = queue->events[index];
+		queue->events[index] = swapEvent;
+
+		index = earliestIndex;
+	}
+
+	return (YES);
+}
+
+static void MediatorSimulatorEventQueueFree(struct MediatorSimulatorEventQueue *queue)
+{
+	for (size_t i=0; i < queue->count; i++)
+	{
+		Block_release(queue->events[i].block);
+	}
+
+	free(queue->events);
+	free(queue);
+}
+
+@interface MediatorSimulator (NodeCallbacks)
+
+- (void)_noteAccessChangeOfNode:(MediatorSimulatorNode *)node;
+
+@end
+
+@interface MediatorSimulatorNode (TransportCallbacks)
+
+- (void)_updateWaitTime;
+
+@end
+
+#pragma mark - Scheduler
+@implementation MediatorSimulatorScheduler
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator
+{
+	if ((self = [super initWithQueue:NULL]) != nil)
+	{
+		simulator = aSimulator;
+	}
+
+	return (self);
+}
+
+- (NSTimeInterval)currentTime
+{
+	return (simulator.now);
+}
+
+- (void)scheduleDeadline:(NSTimeInterval)deadline forKey:(id<NSCopying>)key handler:(dispatch_block_t)handler
+{
+	[super scheduleDeadline:deadline forKey:key handler:handler];
+
+	// Wake up at the deadline. Wake-ups for cancelled or replaced deadlines don't fire anything.
+	[simulator scheduleBlock:^{
+		[self fireDueDeadlines];
+	} atTime:deadline];
+}
+
+@end
+
+#pragma mark - Transport
+@implementation MediatorSimulatorTransport
+
+@synthesize hub;
+@synthesize simulator;
+@synthesize node;
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator
+{
+	if ((self = [super init]) != nil)
+	{
+		simulator = aSimulator;
+
+		subscribedPIDsByResourceIdentifier = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[subscribedPIDsByResourceIdentifier release];
+	subscribedPIDsByResourceIdentifier = nil;
+
+	[super dealloc];
+}
+
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier
+{
+	[subscribedPIDsByResourceIdentifier setObject:@(pid) forKey:resourceIdentifier];
+}
+
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier
+{
+	[subscribedPIDsByResourceIdentifier removeObjectForKey:resourceIdentifier];
+}
+
+- (BOOL)isSubscribedToResourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID
+{
+	NSNumber *subscribedPIDNumber;
+
+	if ((subscribedPIDNumber = [subscribedPIDsByResourceIdentifier objectForKey:resourceIdentifier]) != nil)
+	{
+		return ((targetPID == 0) || (subscribedPIDNumber.intValue == targetPID));
+	}
+
+	return (NO);
+}
+
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	// Changes of preferredAccess are followed by a [STATUS]
+	[node _updateWaitTime];
+
+	if ((messageType == kISResourceMediatorMessageTypeStatus) && (node.statusDelay > 0))
+	{
+		[simulator scheduleBlock:^{
+			[simulator postMessage:messageType resourceIdentifier:resourceIdentifier targetPID:targetPID object:encodedUserInfo];
+		} afterDelay:node.statusDelay];
+
+		return;
+	}
+
+	[simulator postMessage:messageType resourceIdentifier:resourceIdentifier targetPID:targetPID object:encodedUserInfo];
+}
+
+@end
+
+#pragma mark - Node
+@implementation MediatorSimulatorNode
+
+@synthesize mediator;
+@synthesize transport;
+@synthesize completionDelay;
+@synthesize statusDelay;
+@synthesize handoffCount;
+@synthesize accessChangeCount;
+
+- (instancetype)initWithSimulator:(MediatorSimulator *)aSimulator pid:(pid_t)pid resourceIdentifier:(NSString *)resourceIdentifier
+{
+	if ((self = [super init]) != nil)
+	{
+		MediatorSimulatorScheduler *scheduler;
+
+		simulator = aSimulator;
+
+		transport = [[MediatorSimulatorTransport alloc] initWithSimulator:aSimulator];
+		transport.node = self;
+		hub = [[ISResourceMediatorHub alloc] initWithTransport:transport];
+
+		mediator = [[ISResourceMediator alloc] initMediatorForResourceWithIdentifier:resourceIdentifier delegate:self];
+		mediator.pid = pid;
+		mediator.hub = hub;
+		mediator.processWatcher = nil; // Simulated pids don't belong to real processes
+
+		waitStartTime = -1;
+
+		if ((scheduler = [[MediatorSimulatorScheduler alloc] initWithSimulator:aSimulator]) != nil)
+		{
+			mediator.deadlineScheduler = scheduler;
+			[scheduler release];
+		}
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[mediator release];
+	mediator = nil;
+
+	[hub release];
+	hub = nil;
+
+	transport.node = nil;
+	[transport release];
+	transport = nil;
+
+	[super dealloc];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)aMediator setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+{
+	dispatch_block_t changeAccess = ^{
+		ISResourceMediatorResult result = kISResourceMediatorResultError;
+
+		switch (access)
+		{
+			case kISResourceMediatorResourceAccessNone:
+				[simulator.resource unlockWithObject:self];
+				result = kISResourceMediatorResultSuccess;
+			break;
+
+			case kISResourceMediatorResourceAccessShared:
+				if ([simulator.resource trySharedLockWithObject:self])
+				{
+					result = kISResourceMediatorResultSuccess;
+				}
+			break;
+
+			case kISResourceMediatorResourceAccessBlocking:
+				if ([simulator.resource tryExclusiveLockWithObject:self])
+				{
+					result = kISResourceMediatorResultSuccess;
+				}
+			break;
+
+			default:
+			break;
+		}
+
+		completionHandler(result);
+	};
+
+	if (completionDelay > 0)
+	{
+		[simulator scheduleBlock:changeAccess afterDelay:completionDelay];
+	}
+	else
+	{
+		changeAccess();
+	}
+}
+
+- (void)_updateWaitTime
+{
+	BOOL isWaiting = (mediator.preferredAccess != kISResourceMediatorResourceAccessNone) && (mediator.actualAccess != mediator.preferredAccess);
+
+	if (isWaiting && (waitStartTime < 0))
+	{
+		waitStartTime = simulator.now;
+	}
+	else if (!isWaiting && (waitStartTime >= 0))
+	{
+		longestWaitTime = MAX(longestWaitTime, simulator.now - waitStartTime);
+		waitStartTime = -1;
+	}
+}
+
+- (NSTimeInterval)longestWaitTime
+{
+	return ((waitStartTime >= 0) ? MAX(longestWaitTime, simulator.now - waitStartTime) : longestWaitTime);
+}
+
+- (void)resourceMediator:(ISResourceMediator *)aMediator actualAccessChangedTo:(ISResourceMediatorResourceAccess)actualAccess
+{
+	accessChangeCount++;
+
+	[self _updateWaitTime];
+
+	[simulator _noteAccessChangeOfNode:self];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)aMediator user:(ISResourceUser *)user respondedToAccessRequestWith:(ISResourceMediatorResult)accessRequestResponse
+{
+	if (accessRequestResponse == kISResourceMediatorResultSuccess)
+	{
+		handoffCount++;
+	}
+}
+
+@end
+
+#pragma mark - Simulator
+@implementation MediatorSimulator
+
+@synthesize now;
+@synthesize latency;
+@synthesize jitter;
+@synthesize lossRate;
+@synthesize nodes;
+@synthesize resource;
+@synthesize eventCount;
+@synthesize messagesSent;
+@synthesize messagesDelivered;
+@synthesize messagesLost;
+@synthesize accessOverlapCount;
+@synthesize lastAccessChangeTime;
+
+#pragma mark - Init & Dealloc
+- (instancetype)initWithSeed:(uint64_t)seed
+{
+	if ((self = [super init]) != nil)
+	{
+		// Start at a fixed point in time, so runs don't depend on the wall clock
+		startTime = now = 500000000.0;
+
+		randomState = (seed != 0) ? seed : 0x9E3779B97F4A7C15ULL;
+
+		eventQueue = calloc(1, sizeof(struct MediatorSimulatorEventQueue));
+
+		latency = 0.001;
+
+		transports = [NSMutableArray new];
+		transportsByPID = [NSMutableDictionary new];
+		nodes = [NSMutableArray new];
+
+		resource = [ScarceResource new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[self removeAllNodes];
+
+	if (eventQueue != NULL)
+	{
+		MediatorSimulatorEventQueueFree(eventQueue);
+		eventQueue = NULL;
+	}
+
+	[transports release];
+	transports = nil;
+
+	[transportsByPID release];
+	transportsByPID = nil;
+
+	[nodes release];
+	nodes = nil;
+
+	[resource release];
+	resource = nil;
+
+	[super dealloc];
+}
+
+#pragma mark - Nodes
+- (MediatorSimulatorNode *)addNodeWithPID:(pid_t)pid resourceIdentifier:(NSString *)resourceIdentifier
+{
+	MediatorSimulatorNode *node;
+
+	if ((node = [[MediatorSimulatorNode alloc] initWithSimulator:self pid:pid resourceIdentifier:resourceIdentifier]) != nil)
+	{
+		[nodes addObject:node];
+
+		[transports addObject:node.transport];
+		[transportsByPID setObject:node.transport forKey:@(pid)];
+
+		[node release];
+	}
+
+	return (node);
+}
+
+- (void)removeAllNodes
+{
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		node.mediator.active = NO;
+		node.mediator.delegate = nil;
+	}
+
+	// Drop pending events (which retain mediators and schedulers)
+	if (eventQueue != NULL)
+	{
+		MediatorSimulatorEventQueueFree(eventQueue);
+		eventQueue = calloc(1, sizeof(struct MediatorSimulatorEventQueue));
+	}
+
+	[transports removeAllObjects];
+	[transportsByPID removeAllObjects];
+	[nodes removeAllObjects];
+}
+
+- (NSUInteger)handoffCount
+{
+	NSUInteger handoffCount = 0;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		handoffCount += node.handoffCount;
+	}
+
+	return (handoffCount);
+}
+
+- (NSUInteger)accessChangeCount
+{
+	NSUInteger accessChangeCount = 0;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		accessChangeCount += node.accessChangeCount;
+	}
+
+	return (accessChangeCount);
+}
+
+- (NSTimeInterval)longestWaitTime
+{
+	NSTimeInterval longestWaitTime = 0;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		longestWaitTime = MAX(longestWaitTime, node.longestWaitTime);
+	}
+
+	return (longestWaitTime);
+}
+
+- (NSTimeInterval)elapsedTime
+{
+	return (now - startTime);
+}
+
+- (void)_noteAccessChangeOfNode:(MediatorSimulatorNode *)changedNode
+{
+	ISResourceMediatorResourceAccess changedAccess = changedNode.mediator.actualAccess;
+
+	lastAccessChangeTime = now - startTime;
+
+	if (changedAccess != kISResourceMediatorResourceAccessNone)
+	{
+		NSUInteger resourceCapacity = changedNode.mediator.resourceCapacity;
+		NSUInteger usedSlots = (changedAccess == kISResourceMediatorResourceAccessShared) ? changedNode.mediator.slotCount : 0;
+
+		for (MediatorSimulatorNode *node in nodes)
+		{
+			ISResourceMediatorResourceAccess access;
+
+			if ((node != changedNode) && ((access = node.mediator.actualAccess) != kISResourceMediatorResourceAccessNone))
+			{
+				if ((access == kISResourceMediatorResourceAccessBlocking) || (changedAccess == kISResourceMediatorResourceAccessBlocking))
+				{
+					accessOverlapCount++;
+					break;
+				}
+
+				// Counted resources: shared holders must not use more slots than there are
+				usedSlots += node.mediator.slotCount;
+
+				if ((resourceCapacity != 0) && (usedSlots > resourceCapacity))
+				{
+					accessOverlapCount++;
+					break;
+				}
+			}
+		}
+	}
+}
+
+#pragma mark - Events
+- (void)scheduleBlock:(dispatch_block_t)block atTime:(NSTimeInterval)time
+{
+	MediatorSimulatorEventQueuePush(eventQueue, MAX(time, now), block);
+}
+
+- (void)scheduleBlock:(dispatch_block_t)block afterDelay:(NSTimeInterval)delay
+{
+	[self scheduleBlock:block atTime:(now + delay)];
+}
+
+- (BOOL)runUntilIdleWithTimeLimit:(NSTimeInterval)timeLimit
+{
+	NSTimeInterval endTime = now + timeLimit;
+	MediatorSimulatorEvent event;
+
+	while ((eventQueue->count > 0) && (eventQueue->events[0].time <= endTime))
+	{
+		if (MediatorSimulatorEventQueuePop(eventQueue, &event))
+		{
+			now = event.time;
+			eventCount++;
+
+			@autoreleasepool
+			{
+				event.block();
+			}
+
+			Block_release(event.block);
+		}
+	}
+
+	return (eventQueue->count == 0);
+}
+
+#pragma mark - Network
+- (void)_deliverMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier object:(NSString *)encodedUserInfo toTransport:(MediatorSimulatorTransport *)transport
+{
+	if ((lossRate > 0) && ([self randomValue] < lossRate))
+	{
+		messagesLost++;
+		return;
+	}
+
+	[self scheduleBlock:^{
+		messagesDelivered++;
+
+		[transport.hub routeMessage:messageType resourceIdentifier:resourceIdentifier object:encodedUserInfo];
+	} afterDelay:(latency + ((jitter > 0) ? (jitter * [self randomValue]) : 0))];
+}
+
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	messagesSent++;
+
+	if (targetPID != 0)
+	{
+		// Targeted messages only need to reach the target (as with the socket broker)
+		MediatorSimulatorTransport *transport;
+
+		if (((transport = [transportsByPID objectForKey:@(targetPID)]) != nil) && [transport isSubscribedToResourceIdentifier:resourceIdentifier targetPID:targetPID])
+		{
+			[self _deliverMessage:messageType resourceIdentifier:resourceIdentifier object:encodedUserInfo toTransport:transport];
+		}
+	}
+	else
+	{
+		for (MediatorSimulatorTransport *transport in transports)
+		{
+			if ([transport isSubscribedToResourceIdentifier:resourceIdentifier targetPID:0])
+			{
+				[self _deliverMessage:messageType resourceIdentifier:resourceIdentifier object:encodedUserInfo toTransport:transport];
+			}
+		}
+	}
+}
+
+#pragma mark - Randomness
+- (double)randomValue
+{
+	// xorshift64*
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+
+	return ((double)((randomState * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53));
+}
+
+@end
@@ -0,0 +1,265 @@
+//
+//  MediatorSimulatorBenchmarks.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorSimulatorTestCase.h"
+
+@interface MediatorSimulatorBenchmarks : MediatorSimulatorTestCase
+
+@end
+
+@implementation MediatorSimulatorBenchmarks
+
+#pragma mark - Helpers
+- (NSArray <NSNumber *> *)nodeCounts
+{
+	return (@[ @(4), @(16), @(64), @(128) ]);
+}
+
+- (void)logScenario:(NSString *)scenarioName nodeCount:(NSUInteger)nodeCount result:(NSDictionary *)result simulator:(MediatorSimulator *)simulator wallTime:(NSTimeInterval)wallTime
+{
+	NSLog(@"%@ N=%3lu: %@ in %7.1f ms, %7lu messages sent, %9lu delivered, %4lu handoffs, %lu lost, %lu overlaps, %.2f s wall time",
+		scenarioName,
+		(unsigned long)nodeCount,
+		([[result objectForKey:@"idle"] boolValue] ? @"converged" : @"NOT CONVERGED"),
+		[[result objectForKey:@"convergenceTime"] doubleValue] * 1000.0,
+		(unsigned long)[[result objectForKey:@"messagesSent"] unsignedIntegerValue],
+		(unsigned long)[[result objectForKey:@"messagesDelivered"] unsignedIntegerValue],
+		(unsigned long)[[result objectForKey:@"handoffs"] unsignedIntegerValue],
+		(unsigned long)simulator.messagesLost,
+		(unsigned long)simulator.accessOverlapCount,
+		wallTime);
+}
+
+#pragma mark - Benchmarks
+- (void)testReturnChainScaling
+{
+	for (NSNumber *nodeCount in [self nodeCounts])
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:1] autorelease];
+			CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+			NSDictionary *result = [self runReturnChainWithNodeCount:nodeCount.unsignedIntegerValue simulator:simulator verify:YES];
+
+			XCTAssert([result[@"idle"] boolValue], @"Return chain didn't settle (N=%@)", nodeCount);
+
+			[self logScenario:[NSString stringWithFormat:@"Return chain (%@ chain breaks)", result[@"chainBreaks"]] nodeCount:nodeCount.unsignedIntegerValue result:result simulator:simulator wallTime:(CFAbsoluteTimeGetCurrent() - startTime)];
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+- (void)testAccessPressureChangeScaling
+{
+	for (NSNumber *nodeCount in [self nodeCounts])
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:1] autorelease];
+			CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+			NSDictionary *result = [self runAccessPressureChangeWithNodeCount:nodeCount.unsignedIntegerValue simulator:simulator verify:YES];
+
+			XCTAssert([result[@"idle"] boolValue], @"Access pressure change didn't settle (N=%@)", nodeCount);
+
+			[self logScenario:@"Access pressure change" nodeCount:nodeCount.unsignedIntegerValue result:result simulator:simulator wallTime:(CFAbsoluteTimeGetCurrent() - startTime)];
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+- (void)testAccessPressureChangeWithJitter
+{
+	// Jitter larger than the latency reorders messages
+	for (NSNumber *nodeCount in @[ @(4), @(16), @(64) ])
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:7] autorelease];
+			CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+			NSDictionary *result;
+
+			simulator.latency = 0.001;
+			simulator.jitter = 0.01;
+
+			result = [self runAccessPressureChangeWithNodeCount:nodeCount.unsignedIntegerValue simulator:simulator verify:YES];
+
+			XCTAssert([result[@"idle"] boolValue], @"Access pressure change with jitter didn't settle (N=%@)", nodeCount);
+
+			[self logScenario:@"Access pressure change, 1+10 ms jitter" nodeCount:nodeCount.unsignedIntegerValue result:result simulator:simulator wallTime:(CFAbsoluteTimeGetCurrent() - startTime)];
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+- (void)testReturnChainWithMessageLoss
+{
+	// Lost messages are only recovered by access request retries and discovery timeouts, so this only measures
+	for (NSNumber *lossRate in @[ @(0.01), @(0.05) ])
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:3] autorelease];
+			CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+			NSDictionary *result;
+
+			simulator.jitter = 0.002;
+			simulator.lossRate = lossRate.doubleValue;
+
+			result = [self runReturnChainWithNodeCount:16 simulator:simulator verify:NO];
+
+			[self logScenario:[NSString stringWithFormat:@"Return chain, %.0f%% loss (%@ chain breaks, final access %@)", lossRate.doubleValue * 100.0, result[@"chainBreaks"], [[self actualAccessOfNodes:simulator.nodes] componentsJoinedByString:@""]] nodeCount:16 result:result simulator:simulator wallTime:(CFAbsoluteTimeGetCurrent() - startTime)];
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+- (void)testMulticastAccessRequestToSharedHolders
+{
+	for (NSNumber *nodeCount in @[ @(4), @(16), @(64) ])
+	{
+		NSDictionary *results[2];
+
+		for (NSUInteger multicast=0; multicast<2; multicast++)
+		{
+			@autoreleasepool
+			{
+				MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:5] autorelease];
+				CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+				NSDictionary *result = [self runSharedHoldersWithNodeCount:nodeCount.unsignedIntegerValue simulator:simulator multicast:(multicast != 0) denyingHolder:NO];
+
+				XCTAssert([result[@"idle"] boolValue], @"Shared holders didn't settle (N=%@)", nodeCount);
+				XCTAssertEqualObjects(result[@"actualAccess"], [self expectedAccessWithNodeCount:nodeCount.unsignedIntegerValue access:kISResourceMediatorResourceAccessBlocking atIndex:0], @"Requester didn't get blocking access (N=%@, multicast=%lu)", nodeCount, (unsigned long)multicast);
+
+				[self logScenario:(multicast ? @"Shared holders, multicast request" : @"Shared holders, targeted requests") nodeCount:nodeCount.unsignedIntegerValue result:result simulator:simulator wallTime:(CFAbsoluteTimeGetCurrent() - startTime)];
+
+				results[multicast] = [[result retain] autorelease];
+
+				[simulator removeAllNodes];
+			}
+		}
+
+		XCTAssertLessThan([results[1][@"messagesSent"] unsignedIntegerValue], [results[0][@"messagesSent"] unsignedIntegerValue], @"Multicast request didn't save messages (N=%@)", nodeCount);
+	}
+}
+
+/*
+	Thrashing: N nodes with the same pressure want blocking access and - every 100 ms, at different times - briefly give it
+	up and claim it again. As newer claims win, each new claim takes access from the current holder, unless minimumHoldTime
+	makes the holder keep it for a while.
+*/
+- (NSDictionary *)runThrashingWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator minimumHoldTime:(NSTimeInterval)minimumHoldTime
+{
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:nodeCount toSimulator:simulator];
+	NSUInteger accessChangeCount;
+	NSTimeInterval phaseStartTime;
+	NSMutableDictionary *result;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		node.mediator.minimumHoldTime = minimumHoldTime;
+		node.mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+		node.mediator.active = YES;
+	}
+
+	[simulator runUntilIdleWithTimeLimit:kMediatorSimulatorTimeLimit];
+
+	accessChangeCount = simulator.accessChangeCount;
+	phaseStartTime = simulator.elapsedTime;
+
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=0; i<nodeCount; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			for (NSUInteger toggle=0; toggle<20; toggle++)
+			{
+				NSTimeInterval toggleTime = (toggle * 0.1) + (i * 0.1 / nodeCount);
+
+				[simulator scheduleBlock:^{
+					node.mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+				} afterDelay:toggleTime];
+
+				[simulator scheduleBlock:^{
+					node.mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+				} afterDelay:(toggleTime + 0.005)];
+			}
+		}
+	}];
+
+	[result setObject:@((simulator.accessChangeCount - accessChangeCount) / MAX(simulator.elapsedTime - phaseStartTime, 0.001)) forKey:@"accessChangeRate"];
+	[result setObject:@(simulator.longestWaitTime) forKey:@"longestWaitTime"];
+
+	return (result);
+}
+
+- (void)testMinimumHoldTimeDampensThrashing
+{
+	NSDictionary *results[2];
+	NSTimeInterval minimumHoldTimes[2] = { 0, 0.25 };
+
+	for (NSUInteger run=0; run<2; run++)
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:13] autorelease];
+			NSDictionary *result = [self runThrashingWithNodeCount:4 simulator:simulator minimumHoldTime:minimumHoldTimes[run]];
+
+			XCTAssert([result[@"idle"] boolValue], @"Thrashing nodes didn't settle (minimumHoldTime=%.2f)", minimumHoldTimes[run]);
+
+			NSLog(@"Thrashing N=4, minimumHoldTime %3.0f ms: %5.1f access changes/s, %4lu handoffs, longest wait %6.1f ms, %lu overlaps",
+				minimumHoldTimes[run] * 1000.0,
+				[result[@"accessChangeRate"] doubleValue],
+				(unsigned long)[result[@"handoffs"] unsignedIntegerValue],
+				[result[@"longestWaitTime"] doubleValue] * 1000.0,
+				(unsigned long)simulator.accessOverlapCount);
+
+			results[run] = [result retain];
+
+			[simulator removeAllNodes];
+		}
+	}
+
+	XCTAssertLessThan([results[1][@"accessChangeRate"] doubleValue], [results[0][@"accessChangeRate"] doubleValue], @"minimumHoldTime didn't reduce the access change rate");
+
+	[results[0] release];
+	[results[1] release];
+}
+
+@end
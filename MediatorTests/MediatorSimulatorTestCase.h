@@ -0,0 +1,64 @@
+//
+//  MediatorSimulatorTestCase.h
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import <XCTest/XCTest.h>
+#import "MediatorSimulator.h"
+
+#define kMediatorSimulatorResourceIdentifier	@"mediator.simulation"
+#define kMediatorSimulatorTimeLimit		600.0
+#define kMediatorSimulatorFirstPID		0x10000
+
+/*
+	Base class of the simulator tests and benchmarks, with helpers to set up nodes, run phases of a scenario and the
+	scenarios shared by both.
+*/
+@interface MediatorSimulatorTestCase : XCTestCase
+
+#pragma mark - Helpers
+- (NSArray <MediatorSimulatorNode *> *)addNodes:(NSUInteger)nodeCount toSimulator:(MediatorSimulator *)simulator; //!< Adds nodeCount nodes with consecutive pids, starting at kMediatorSimulatorFirstPID.
+
+- (NSMutableDictionary *)runPhaseOfSimulator:(MediatorSimulator *)simulator actions:(dispatch_block_t)actions; //!< Runs actions, then the simulator until idle. Returns "idle", "convergenceTime", "messagesSent", "messagesDelivered" and "handoffs" of the phase.
+- (void)addPhase:(NSDictionary *)phase toTotals:(NSMutableDictionary *)totals;
+
+- (NSArray <NSNumber *> *)actualAccessOfNodes:(NSArray <MediatorSimulatorNode *> *)nodes;
+- (NSArray <NSNumber *> *)expectedAccessWithNodeCount:(NSUInteger)nodeCount access:(ISResourceMediatorResourceAccess)access atIndex:(NSUInteger)accessIndex; //!< access for the node at accessIndex, none for all others.
+
+#pragma mark - Scenarios
+- (NSDictionary *)runReturnChainWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator verify:(BOOL)verify; //!< Adds "chainBreaks" to the phase totals.
+- (NSDictionary *)runAccessPressureChangeWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator verify:(BOOL)verify;
+- (NSDictionary *)runSharedHoldersWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator multicast:(BOOL)multicast denyingHolder:(BOOL)denyingHolder; //!< Adds "accessChanges" and "actualAccess" to the result of the last phase.
+
+@end
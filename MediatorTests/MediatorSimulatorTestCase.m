@@ -0,0 +1,259 @@
+//
+//  MediatorSimulatorTestCase.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorSimulatorTestCase.h"
+
+@implementation MediatorSimulatorTestCase
+
+#pragma mark - Helpers
+- (NSArray <MediatorSimulatorNode *> *)addNodes:(NSUInteger)nodeCount toSimulator:(MediatorSimulator *)simulator
+{
+	NSMutableArray <MediatorSimulatorNode *> *nodes = [NSMutableArray arrayWithCapacity:nodeCount];
+
+	for (NSUInteger i=0; i<nodeCount; i++)
+	{
+		[nodes addObject:[simulator addNodeWithPID:(pid_t)(kMediatorSimulatorFirstPID + i) resourceIdentifier:kMediatorSimulatorResourceIdentifier]];
+	}
+
+	return (nodes);
+}
+
+- (NSMutableDictionary *)runPhaseOfSimulator:(MediatorSimulator *)simulator actions:(dispatch_block_t)actions
+{
+	NSTimeInterval phaseStartTime = simulator.elapsedTime;
+	NSUInteger messagesSent = simulator.messagesSent, messagesDelivered = simulator.messagesDelivered, handoffCount = simulator.handoffCount;
+	BOOL isIdle;
+
+	if (actions != nil)
+	{
+		actions();
+	}
+
+	isIdle = [simulator runUntilIdleWithTimeLimit:kMediatorSimulatorTimeLimit];
+
+	return ([NSMutableDictionary dictionaryWithDictionary:@{
+		@"idle"			: @(isIdle),
+		@"convergenceTime"	: @((simulator.lastAccessChangeTime > phaseStartTime) ? (simulator.lastAccessChangeTime - phaseStartTime) : 0),
+		@"messagesSent"		: @(simulator.messagesSent - messagesSent),
+		@"messagesDelivered"	: @(simulator.messagesDelivered - messagesDelivered),
+		@"handoffs"		: @(simulator.handoffCount - handoffCount),
+	}]);
+}
+
+- (void)addPhase:(NSDictionary *)phase toTotals:(NSMutableDictionary *)totals
+{
+	for (NSString *key in phase)
+	{
+		if ([key isEqual:@"idle"])
+		{
+			[totals setObject:@([[totals objectForKey:key] boolValue] && [[phase objectForKey:key] boolValue]) forKey:key];
+		}
+		else
+		{
+			[totals setObject:@([[totals objectForKey:key] doubleValue] + [[phase objectForKey:key] doubleValue]) forKey:key];
+		}
+	}
+}
+
+- (NSArray <NSNumber *> *)actualAccessOfNodes:(NSArray <MediatorSimulatorNode *> *)nodes
+{
+	NSMutableArray <NSNumber *> *actualAccesses = [NSMutableArray arrayWithCapacity:nodes.count];
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		[actualAccesses addObject:@(node.mediator.actualAccess)];
+	}
+
+	return (actualAccesses);
+}
+
+- (NSArray <NSNumber *> *)expectedAccessWithNodeCount:(NSUInteger)nodeCount access:(ISResourceMediatorResourceAccess)access atIndex:(NSUInteger)accessIndex
+{
+	NSMutableArray <NSNumber *> *expectedAccesses = [NSMutableArray arrayWithCapacity:nodeCount];
+
+	for (NSUInteger i=0; i<nodeCount; i++)
+	{
+		[expectedAccesses addObject:@((i == accessIndex) ? access : kISResourceMediatorResourceAccessNone)];
+	}
+
+	return (expectedAccesses);
+}
+
+#pragma mark - Scenarios
+/*
+	Return chain (generalizes -[MediatorTests testOneSharedTwoExclusivesLockReturnChain]):
+	node 0 wants shared access, nodes 1..N-1 activate one after another wanting blocking access, each taking it from its
+	predecessor. Then the holders give up access in reverse order, until node 0 has shared access again.
+*/
+- (NSDictionary *)runReturnChainWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator verify:(BOOL)verify
+{
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:nodeCount toSimulator:simulator];
+	NSMutableDictionary *totals = [NSMutableDictionary dictionaryWithObject:@(YES) forKey:@"idle"];
+	NSUInteger chainBreaks = 0;
+
+	[self addPhase:[self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=0; i<nodeCount; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			[simulator scheduleBlock:^{
+				node.mediator.preferredAccess = (i == 0) ? kISResourceMediatorResourceAccessShared : kISResourceMediatorResourceAccessBlocking;
+				node.mediator.active = YES;
+			} afterDelay:(i * 0.05)];
+		}
+	}] toTotals:totals];
+
+	if (verify)
+	{
+		XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:nodeCount access:kISResourceMediatorResourceAccessBlocking atIndex:nodeCount-1], @"Last node doesn't have blocking access (N=%lu)", (unsigned long)nodeCount);
+	}
+
+	for (NSUInteger i=nodeCount-1; i>0; i--)
+	{
+		MediatorSimulatorNode *node = nodes[i];
+
+		[self addPhase:[self runPhaseOfSimulator:simulator actions:^{
+			node.mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+		}] toTotals:totals];
+
+		if ((i > 1) && (nodes[i-1].mediator.actualAccess != kISResourceMediatorResourceAccessBlocking))
+		{
+			chainBreaks++;
+		}
+	}
+
+	if (verify)
+	{
+		XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:nodeCount access:kISResourceMediatorResourceAccessShared atIndex:0], @"First node doesn't have shared access at the end of the chain (N=%lu)", (unsigned long)nodeCount);
+	}
+
+	[totals setObject:@(chainBreaks) forKey:@"chainBreaks"];
+
+	return (totals);
+}
+
+/*
+	Access pressure change (generalizes -[MediatorTests testAccessPressureChange]):
+	node 0 wants shared access, node 1 blocking access with required pressure, nodes 2..N-1 blocking access with optional
+	pressure. Then node 1 lowers its pressure and node 2 raises its pressure to required, which should move access to node 2.
+*/
+- (NSDictionary *)runAccessPressureChangeWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator verify:(BOOL)verify
+{
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:nodeCount toSimulator:simulator];
+	NSMutableDictionary *totals = [NSMutableDictionary dictionaryWithObject:@(YES) forKey:@"idle"];
+
+	[self addPhase:[self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=0; i<nodeCount; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			[simulator scheduleBlock:^{
+				node.mediator.preferredAccess = (i == 0) ? kISResourceMediatorResourceAccessShared : kISResourceMediatorResourceAccessBlocking;
+				node.mediator.accessPressure = (i == 1) ? kISResourceMediatorAccessPressureRequired : kISResourceMediatorAccessPressureOptional;
+				node.mediator.active = YES;
+			} afterDelay:((i < 2) ? (i * 0.05) : (0.1 + (i * 0.001)))];
+		}
+	}] toTotals:totals];
+
+	if (verify)
+	{
+		XCTAssertEqual(nodes[1].mediator.actualAccess, kISResourceMediatorResourceAccessBlocking, @"Node with required pressure doesn't have access (N=%lu)", (unsigned long)nodeCount);
+	}
+
+	[self addPhase:[self runPhaseOfSimulator:simulator actions:^{
+		nodes[1].mediator.accessPressure = kISResourceMediatorAccessPressurePartiallySupported;
+		nodes[2].mediator.accessPressure = kISResourceMediatorAccessPressureRequired;
+	}] toTotals:totals];
+
+	if (verify)
+	{
+		XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:nodeCount access:kISResourceMediatorResourceAccessBlocking atIndex:2], @"Access didn't move to the node with the highest pressure (N=%lu)", (unsigned long)nodeCount);
+	}
+
+	return (totals);
+}
+
+/*
+	Shared holders: nodes 1..N-1 hold shared access, then node 0 requests blocking access from all of them.
+	If denyingHolder is YES, node 1 holds its access with required pressure and denies the request.
+*/
+- (NSDictionary *)runSharedHoldersWithNodeCount:(NSUInteger)nodeCount simulator:(MediatorSimulator *)simulator multicast:(BOOL)multicast denyingHolder:(BOOL)denyingHolder
+{
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:nodeCount toSimulator:simulator];
+	NSMutableDictionary *result;
+	NSUInteger accessChangeCountBefore = 0, accessChangeCountAfter = 0;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		node.mediator.usesMulticastAccessRequests = multicast;
+	}
+
+	[self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=1; i<nodeCount; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			[simulator scheduleBlock:^{
+				node.mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+				node.mediator.accessPressure = ((i == 1) && denyingHolder) ? kISResourceMediatorAccessPressureRequired : kISResourceMediatorAccessPressureOptional;
+				node.mediator.active = YES;
+			} afterDelay:(i * 0.001)];
+		}
+	}];
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		accessChangeCountBefore += node.accessChangeCount;
+	}
+
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		nodes[0].mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+		nodes[0].mediator.accessPressure = kISResourceMediatorAccessPressurePartiallySupported;
+		nodes[0].mediator.active = YES;
+	}];
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		accessChangeCountAfter += node.accessChangeCount;
+	}
+
+	[result setObject:@(accessChangeCountAfter - accessChangeCountBefore) forKey:@"accessChanges"];
+	[result setObject:[self actualAccessOfNodes:nodes] forKey:@"actualAccess"];
+
+	return (result);
+}
+
+@end
@@ -0,0 +1,476 @@
+//
+//  MediatorSimulatorTests.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorSimulatorTestCase.h"
+#import "ISResourceMediatorTraceReplayer.h"
+
+#define kMediatorSimulatorWaiterAgingRate	10.0 // Access pressure a waiter gains per second waited (kISResourceMediatorWaiterAgingRate)
+
+@interface ISResourceMediator (MediatorSimulatorTestsWaiters)
+
+- (NSArray *)_waitersInQueueOrder;
+
+@end
+
+@interface MediatorSimulatorTests : MediatorSimulatorTestCase
+
+@end
+
+@implementation MediatorSimulatorTests
+
+#pragma mark - Helpers
+- (NSArray <NSNumber *> *)waiterPIDsOfNode:(MediatorSimulatorNode *)node
+{
+	return ([[node.mediator _waitersInQueueOrder] valueForKeyPath:@"user.pid"]);
+}
+
+- (void)scheduleBlockingClaimOfNode:(MediatorSimulatorNode *)node accessPressure:(ISResourceMediatorAccessPressure)accessPressure simulator:(MediatorSimulator *)simulator afterDelay:(NSTimeInterval)delay
+{
+	[simulator scheduleBlock:^{
+		node.mediator.accessPressure = accessPressure;
+		node.mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+		node.mediator.active = YES;
+	} afterDelay:delay];
+}
+
+#pragma mark - Leases
+- (void)testReturnChainHandsBackLeases
+{
+	// Every node gets access back from the node it lent it to, so access travels back down the chain without breaks
+	for (NSNumber *nodeCount in @[ @(4), @(16), @(64) ])
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:1] autorelease];
+			NSDictionary *result = [self runReturnChainWithNodeCount:nodeCount.unsignedIntegerValue simulator:simulator verify:YES];
+
+			XCTAssert([result[@"idle"] boolValue], @"Return chain didn't settle (N=%@)", nodeCount);
+			XCTAssertEqual([result[@"chainBreaks"] unsignedIntegerValue], 0, @"Lease wasn't handed back to the lender (N=%@)", nodeCount);
+			XCTAssertEqual(simulator.accessOverlapCount, 0, @"Access overlapped while handing back leases (N=%@)", nodeCount);
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+#pragma mark - Multicast access requests
+- (void)testMulticastAccessRequestIsAllOrNothing
+{
+	for (NSUInteger multicast=0; multicast<2; multicast++)
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:5] autorelease];
+			NSDictionary *result = [self runSharedHoldersWithNodeCount:8 simulator:simulator multicast:(multicast != 0) denyingHolder:YES];
+			NSMutableArray <NSNumber *> *expectedAccess = [NSMutableArray array];
+
+			XCTAssert([result[@"idle"] boolValue], @"Shared holders didn't settle");
+
+			[expectedAccess addObject:@(kISResourceMediatorResourceAccessNone)];
+
+			for (NSUInteger i=1; i<8; i++)
+			{
+				[expectedAccess addObject:@(kISResourceMediatorResourceAccessShared)];
+			}
+
+			NSLog(@"Denied request to shared holders, %@: %@ access changes, %@ messages, final access %@", (multicast ? @"multicast" : @"targeted"), result[@"accessChanges"], result[@"messagesSent"], [result[@"actualAccess"] componentsJoinedByString:@""]);
+
+			if (multicast)
+			{
+				// No holder gave up access (with targeted requests, all but the denying holder do)
+				XCTAssertEqualObjects(result[@"actualAccess"], expectedAccess, @"Holders didn't keep shared access");
+				XCTAssertEqual([result[@"accessChanges"] unsignedIntegerValue], 0, @"Holders released access although one of them denied");
+			}
+
+			[simulator removeAllNodes];
+		}
+	}
+}
+
+#pragma mark - Counted resources
+- (void)testCountedResourcePreemptsLowestPressureHolders
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:11] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:5 toSimulator:simulator];
+	NSArray <NSNumber *> *accessPressures = @[
+		@(kISResourceMediatorAccessPressureOptional),
+		@(kISResourceMediatorAccessPressurePartiallySupported),
+		@(kISResourceMediatorAccessPressureOptional),
+		@(kISResourceMediatorAccessPressureRequired),
+		@(kISResourceMediatorAccessPressureRequired)
+	];
+	ISResourceMediatorResourceAccess shared = kISResourceMediatorResourceAccessShared, none = kISResourceMediatorResourceAccessNone;
+	NSDictionary *result;
+
+	// Four slots, taken by nodes 0-3
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=0; i<4; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			[simulator scheduleBlock:^{
+				node.mediator.resourceCapacity = 4;
+				node.mediator.accessPressure = accessPressures[i].unsignedIntegerValue;
+				node.mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+				node.mediator.active = YES;
+			} afterDelay:(i * 0.05)];
+		}
+	}];
+
+	XCTAssert([result[@"idle"] boolValue], @"Shared holders didn't settle");
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], (@[ @(shared), @(shared), @(shared), @(shared), @(none) ]), @"Not all slots are in use");
+
+	// Node 4 needs two slots: only the two holders with optional pressure should give up theirs
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		nodes[4].mediator.resourceCapacity = 4;
+		nodes[4].mediator.slotCount = 2;
+		nodes[4].mediator.accessPressure = accessPressures[4].unsignedIntegerValue;
+		nodes[4].mediator.preferredAccess = kISResourceMediatorResourceAccessShared;
+		nodes[4].mediator.active = YES;
+	}];
+
+	XCTAssert([result[@"idle"] boolValue], @"Counted resource didn't settle");
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], (@[ @(none), @(shared), @(none), @(shared), @(shared) ]), @"Wrong holders gave up their slots");
+
+	// Once node 4 is done, its slots are taken again
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		nodes[4].mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+	}];
+
+	XCTAssert([result[@"idle"] boolValue], @"Counted resource didn't settle after release");
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], (@[ @(shared), @(shared), @(shared), @(shared), @(none) ]), @"Freed slots weren't taken again");
+	XCTAssertEqual(simulator.accessOverlapCount, 0, @"Counted resource was oversubscribed");
+
+	[simulator removeAllNodes];
+}
+
+- (void)testAccessRequestOvertakingStatusKeepsRequesterUnknown
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:37] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:2 toSimulator:simulator];
+	ISResourceUser *requester;
+
+	[self runPhaseOfSimulator:simulator actions:^{
+		nodes[0].mediator.accessPressure = kISResourceMediatorAccessPressureOptional;
+		nodes[0].mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+		nodes[0].mediator.active = YES;
+	}];
+
+	XCTAssertEqual(nodes[0].mediator.actualAccess, kISResourceMediatorResourceAccessBlocking);
+
+	// Node 1's [STATUS] is held back until long after its discovery timed out and its access request reached node 0
+	nodes[1].statusDelay = 1.0;
+	nodes[1].mediator.slotCount = 2;
+	nodes[1].mediator.accessPressure = kISResourceMediatorAccessPressureRequired;
+	nodes[1].mediator.preferredAccess = kISResourceMediatorResourceAccessBlocking;
+	nodes[1].mediator.active = YES;
+
+	[simulator runUntilIdleWithTimeLimit:0.5];
+
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:2 access:kISResourceMediatorResourceAccessBlocking atIndex:1], @"Requester didn't get access");
+
+	requester = [nodes[0].mediator resourceUserForPID:nodes[1].mediator.pid createIfNotExists:NO];
+
+	XCTAssertNotNil(requester);
+	XCTAssertFalse(requester.isUsingResourceMediator, @"Access request made the requester a mediator user");
+	XCTAssertEqual(requester.slotCount, 2, @"slotCount of the access request wasn't kept");
+	XCTAssertEqualObjects([nodes[0].mediator metricsSnapshot][@"messagesSent"][@"accessRequest"], @(0), @"Access requested from a requester of unknown access");
+
+	// Once its [STATUS] arrives, the requester is a mediator user - with the slotCount from its request
+	XCTAssert([simulator runUntilIdleWithTimeLimit:kMediatorSimulatorTimeLimit], @"Nodes didn't settle");
+	XCTAssertTrue(requester.isUsingResourceMediator);
+	XCTAssertEqual(requester.slotCount, 2);
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:2 access:kISResourceMediatorResourceAccessBlocking atIndex:1], @"Access moved away from the node with the highest pressure");
+	XCTAssertEqual(simulator.accessOverlapCount, 0, @"Access overlapped");
+
+	[simulator removeAllNodes];
+}
+
+#pragma mark - Waiter queue
+- (void)testWaiterQueueOrdersByAgedAccessPressure
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:17] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:4 toSimulator:simulator];
+
+	// Node 0 holds access with required pressure. Node 1 (optional) queues first, node 2 (partially supported) shortly
+	// after, node 3 (partially supported) only after node 1 aged past its pressure.
+	[self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[0] accessPressure:kISResourceMediatorAccessPressureRequired		simulator:simulator afterDelay:0.0];
+		[self scheduleBlockingClaimOfNode:nodes[1] accessPressure:kISResourceMediatorAccessPressureOptional		simulator:simulator afterDelay:0.1];
+		[self scheduleBlockingClaimOfNode:nodes[2] accessPressure:kISResourceMediatorAccessPressurePartiallySupported	simulator:simulator afterDelay:0.2];
+		[self scheduleBlockingClaimOfNode:nodes[3] accessPressure:kISResourceMediatorAccessPressurePartiallySupported	simulator:simulator afterDelay:4.0];
+	}];
+
+	XCTAssertEqual(nodes[0].mediator.actualAccess, kISResourceMediatorResourceAccessBlocking, @"Node with required pressure doesn't hold access");
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[0]], (@[ @(nodes[2].mediator.pid), @(nodes[1].mediator.pid), @(nodes[3].mediator.pid) ]), @"Waiters not ordered by aged access pressure");
+
+	[simulator removeAllNodes];
+}
+
+- (void)testReleasingHolderGrantsAccessToFirstWaiter
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:19] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:3 toSimulator:simulator];
+	NSUInteger handoffCount;
+
+	// Node 1 (optional) waited long enough to be ahead of node 2 (partially supported)
+	[self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[0] accessPressure:kISResourceMediatorAccessPressureRequired		simulator:simulator afterDelay:0.0];
+		[self scheduleBlockingClaimOfNode:nodes[1] accessPressure:kISResourceMediatorAccessPressureOptional		simulator:simulator afterDelay:0.1];
+		[self scheduleBlockingClaimOfNode:nodes[2] accessPressure:kISResourceMediatorAccessPressurePartiallySupported	simulator:simulator afterDelay:4.0];
+	}];
+
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[0]], (@[ @(nodes[1].mediator.pid), @(nodes[2].mediator.pid) ]), @"Aged waiter isn't first in the queue");
+
+	handoffCount = nodes[1].handoffCount;
+
+	// The holder's unsolicited [ACCESS_RESPONSE] is all it takes
+	nodes[0].mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+
+	[simulator runUntilIdleWithTimeLimit:(simulator.latency * 1.5)];
+
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:1], @"First waiter didn't get access within one message after release");
+	XCTAssertEqual(nodes[1].handoffCount, handoffCount + 1, @"First waiter didn't get access from the holder");
+
+	// From there on, the higher pressure takes over as usual
+	XCTAssert([simulator runUntilIdleWithTimeLimit:kMediatorSimulatorTimeLimit], @"Waiters didn't settle");
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:2], @"Access didn't move to the waiter with the higher pressure");
+	XCTAssertEqual(simulator.accessOverlapCount, 0, @"Access overlapped");
+
+	[simulator removeAllNodes];
+}
+
+- (void)testReturnedLeaseTakesPrecedenceOverWaiters
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:23] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:3 toSimulator:simulator];
+	NSUInteger handoffCount;
+
+	// Node 0 lends access to node 1, which queues node 2
+	[self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[0] accessPressure:kISResourceMediatorAccessPressureOptional		simulator:simulator afterDelay:0.0];
+		[self scheduleBlockingClaimOfNode:nodes[1] accessPressure:kISResourceMediatorAccessPressureRequired		simulator:simulator afterDelay:0.1];
+		[self scheduleBlockingClaimOfNode:nodes[2] accessPressure:kISResourceMediatorAccessPressurePartiallySupported	simulator:simulator afterDelay:0.2];
+	}];
+
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:1], @"Access wasn't lent to the node with the highest pressure");
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[1]], (@[ @(nodes[2].mediator.pid) ]), @"Requester wasn't queued");
+
+	handoffCount = nodes[2].handoffCount;
+
+	nodes[1].mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+
+	[simulator runUntilIdleWithTimeLimit:(simulator.latency * 1.5)];
+
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:0], @"Lease didn't go back to the lender first");
+	XCTAssertEqual(nodes[2].handoffCount, handoffCount, @"Waiter was granted access that had to go back to the lender");
+
+	XCTAssert([simulator runUntilIdleWithTimeLimit:kMediatorSimulatorTimeLimit], @"Nodes didn't settle");
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:2], @"Waiter didn't get access from the lender");
+	XCTAssertEqual(simulator.accessOverlapCount, 0, @"Access overlapped");
+
+	[simulator removeAllNodes];
+}
+
+- (void)testWaitersAreDroppedWhenAccessIsLost
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:29] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:3 toSimulator:simulator];
+
+	[self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[0] accessPressure:kISResourceMediatorAccessPressurePartiallySupported	simulator:simulator afterDelay:0.0];
+		[self scheduleBlockingClaimOfNode:nodes[1] accessPressure:kISResourceMediatorAccessPressureOptional		simulator:simulator afterDelay:0.1];
+	}];
+
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[0]], (@[ @(nodes[1].mediator.pid) ]), @"Requester wasn't queued");
+
+	// Node 2 takes access from node 0: its waiters have to ask node 2 now (node 0 itself waits for its lease to come back)
+	[self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[2] accessPressure:kISResourceMediatorAccessPressureRequired simulator:simulator afterDelay:0.0];
+	}];
+
+	XCTAssertEqualObjects([self actualAccessOfNodes:nodes], [self expectedAccessWithNodeCount:3 access:kISResourceMediatorResourceAccessBlocking atIndex:2], @"Access didn't move to the node with the highest pressure");
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[0]], @[], @"Waiters weren't dropped with access");
+	XCTAssertEqualObjects([self waiterPIDsOfNode:nodes[2]], (@[ @(nodes[1].mediator.pid) ]), @"Waiter didn't queue at the new holder");
+
+	[simulator removeAllNodes];
+}
+
+/*
+	Starvation bound: a waiter can only be overtaken by requesters with a higher pressure that queue within (pressure
+	difference / aging rate) after it - no matter how many keep arriving.
+*/
+- (void)testWaiterQueueBoundsOvertaking
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:31] autorelease];
+	NSUInteger arrivalCount = 20, overtakingCount = 0;
+	NSTimeInterval arrivalInterval = 0.3, lowPressureQueueTime = 0.1;
+	NSTimeInterval agingTime = (kISResourceMediatorAccessPressurePartiallySupported - kISResourceMediatorAccessPressureOptional) / kMediatorSimulatorWaiterAgingRate;
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:(2 + arrivalCount) toSimulator:simulator];
+	NSDictionary *result;
+
+	result = [self runPhaseOfSimulator:simulator actions:^{
+		[self scheduleBlockingClaimOfNode:nodes[0] accessPressure:kISResourceMediatorAccessPressureRequired simulator:simulator afterDelay:0.0];
+		[self scheduleBlockingClaimOfNode:nodes[1] accessPressure:kISResourceMediatorAccessPressureOptional simulator:simulator afterDelay:lowPressureQueueTime];
+
+		for (NSUInteger i=0; i<arrivalCount; i++)
+		{
+			[self scheduleBlockingClaimOfNode:nodes[2+i] accessPressure:kISResourceMediatorAccessPressurePartiallySupported simulator:simulator afterDelay:((i + 1) * arrivalInterval)];
+		}
+	}];
+
+	for (NSUInteger i=0; i<arrivalCount; i++)
+	{
+		if ((((i + 1) * arrivalInterval) - lowPressureQueueTime) < agingTime)
+		{
+			overtakingCount++;
+		}
+	}
+
+	XCTAssert([result[@"idle"] boolValue], @"Waiters didn't settle");
+	XCTAssertLessThan(overtakingCount, arrivalCount, @"Scenario doesn't outlast the aging time");
+	XCTAssertEqual([self waiterPIDsOfNode:nodes[0]].count, arrivalCount + 1, @"Not all requesters were queued");
+	XCTAssertEqual([[self waiterPIDsOfNode:nodes[0]] indexOfObject:@(nodes[1].mediator.pid)], overtakingCount, @"Low pressure waiter was overtaken by more requesters than aging allows");
+
+	[simulator removeAllNodes];
+}
+
+#pragma mark - Determinism
+- (void)testSimulationIsDeterministic
+{
+	NSMutableArray <NSDictionary *> *runs = [NSMutableArray array];
+
+	for (NSUInteger run=0; run<2; run++)
+	{
+		@autoreleasepool
+		{
+			MediatorSimulator *simulator = [[MediatorSimulator alloc] initWithSeed:42];
+			NSMutableDictionary *result;
+
+			simulator.jitter = 0.005;
+			simulator.lossRate = 0.02;
+
+			// Lossy runs may legitimately end in a different state - only compare the runs with each other
+			result = [NSMutableDictionary dictionaryWithDictionary:[self runAccessPressureChangeWithNodeCount:16 simulator:simulator verify:NO]];
+
+			[result setObject:@(simulator.eventCount) forKey:@"eventCount"];
+			[result setObject:@(simulator.messagesLost) forKey:@"messagesLost"];
+			[result setObject:[self actualAccessOfNodes:simulator.nodes] forKey:@"actualAccess"];
+
+			[runs addObject:result];
+
+			[simulator removeAllNodes];
+			[simulator release];
+		}
+	}
+
+	XCTAssertEqualObjects(runs[0], runs[1], @"Runs with the same seed differ");
+}
+
+#pragma mark - Trace replay
+- (void)testTraceReplayReproducesDecisions
+{
+	MediatorSimulator *simulator = [[[MediatorSimulator alloc] initWithSeed:7] autorelease];
+	NSString *tracePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"MediatorTrace-%d.isrmtrace", getpid()]];
+	ISResourceMediatorTraceRecorder *recorder = [[[ISResourceMediatorTraceRecorder alloc] initWithPath:tracePath] autorelease];
+	NSArray <MediatorSimulatorNode *> *nodes = [self addNodes:8 toSimulator:simulator];
+	NSArray <NSNumber *> *accessPressures = @[ @(kISResourceMediatorAccessPressureOptional), @(kISResourceMediatorAccessPressurePartiallySupported), @(kISResourceMediatorAccessPressureRequired) ];
+	NSArray <ISResourceMediatorTraceRecord *> *records;
+	ISResourceMediatorTraceReplayer *replayer;
+	NSData *traceData;
+
+	XCTAssertNotNil(recorder, @"Trace log couldn't be created");
+
+	simulator.jitter = 0.002;
+
+	for (MediatorSimulatorNode *node in nodes)
+	{
+		node.mediator.traceRecorder = recorder;
+	}
+
+	// Contended access: everyone joins, then the holders leave one by one
+	[self runPhaseOfSimulator:simulator actions:^{
+		for (NSUInteger i=0; i<nodes.count; i++)
+		{
+			MediatorSimulatorNode *node = nodes[i];
+
+			[simulator scheduleBlock:^{
+				node.mediator.accessPressure = accessPressures[i % accessPressures.count].unsignedIntegerValue;
+				node.mediator.preferredAccess = (i % 2) ? kISResourceMediatorResourceAccessShared : kISResourceMediatorResourceAccessBlocking;
+				node.mediator.active = YES;
+			} afterDelay:(i * 0.02)];
+		}
+	}];
+
+	for (NSUInteger i=0; i<nodes.count; i++)
+	{
+		[self runPhaseOfSimulator:simulator actions:^{
+			nodes[nodes.count - 1 - i].mediator.preferredAccess = kISResourceMediatorResourceAccessNone;
+		}];
+	}
+
+	[simulator removeAllNodes];
+	[recorder close];
+
+	// Read and replay
+	records = [ISResourceMediatorTraceRecord recordsWithContentsOfFile:tracePath];
+
+	XCTAssertGreaterThan(records.count, nodes.count, @"Trace is missing records");
+
+	for (NSUInteger idx=1; idx < records.count; idx++)
+	{
+		XCTAssertGreaterThanOrEqual(records[idx].monotonicTime, records[idx-1].monotonicTime, @"Monotonic timestamps decrease at record %lu", (unsigned long)idx);
+	}
+
+	replayer = [[[ISResourceMediatorTraceReplayer alloc] initWithRecords:records] autorelease];
+	[replayer replay];
+
+	NSLog(@"Replayed %lu records (%lu bytes) with %lu decisions: %@", (unsigned long)records.count, (unsigned long)recorder.length, (unsigned long)replayer.decisionCount, replayer.processingCostReport);
+
+	XCTAssertGreaterThan(replayer.decisionCount, 0, @"Trace contains no decisions");
+	XCTAssertEqualObjects(replayer.mismatches, @[], @"Replay made different decisions");
+	XCTAssertNotNil(replayer.processingCostReport[@"status"], @"No processing cost reported for [STATUS]");
+
+	// A log cut off mid-record (f.ex. by a crash) is read up to the last complete record
+	traceData = [NSData dataWithContentsOfFile:tracePath];
+	[[traceData subdataWithRange:NSMakeRange(0, traceData.length - 3)] writeToFile:tracePath atomically:NO];
+
+	XCTAssertEqual([ISResourceMediatorTraceRecord recordsWithContentsOfFile:tracePath].count, records.count - 1, @"Truncated trace not read up to the last complete record");
+
+	[[NSFileManager defaultManager] removeItemAtPath:tracePath error:NULL];
+}
+
+@end
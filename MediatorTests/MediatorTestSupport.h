@@ -0,0 +1,134 @@
+//
+//  MediatorTestSupport.h
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+/*
+	Helpers shared by the tests and benchmarks that exercise single mediators and their components directly (rather
+	than through MediatorSimulator).
+*/
+
+#import <XCTest/XCTest.h>
+#import "ISResourceMediator.h"
+#import "ISIOResourceMediator.h"
+
+@interface MediatorTestRecordingTransport : NSObject <ISResourceMediatorTransport>
+{
+	ISResourceMediatorHub *hub;
+
+	NSMutableArray <NSDictionary *> *postedMessages;
+}
+
+@property(retain,readonly) NSMutableArray <NSDictionary *> *postedMessages; //!< Decoded userInfo of all posted messages, with the message type added as "messageType" and the wire format as "messageFormat"
+
+@end
+
+@interface MediatorTestDelegate : NSObject <ISResourceMediatorDelegate>
+{
+	CFAbsoluteTime firstArbitrationTime;
+	CFAbsoluteTime firstAccessTime;
+
+	NSMutableArray <NSNumber *> *accessRequestResults;
+
+	NSUInteger updatedBroadcastInfoCount;
+	NSMutableArray <NSNumber *> *userChanges;
+}
+
+@property(assign) CFAbsoluteTime firstArbitrationTime; //!< Time of the first -resourceMediator:setApplicationAccessForResource:requestedBy:completion: call
+@property(assign) CFAbsoluteTime firstAccessTime; //!< Time actualAccess first changed to something other than kISResourceMediatorResourceAccessNone
+@property(retain,readonly) NSMutableArray <NSNumber *> *accessRequestResults; //!< Results reported to -resourceMediator:user:respondedToAccessRequestWith:
+@property(assign) NSUInteger updatedBroadcastInfoCount; //!< Number of -resourceMediator:user:updatedBroadcastInfo: calls
+@property(retain,readonly) NSMutableArray <NSNumber *> *userChanges; //!< Changes reported to -resourceMediator:userUpdated:changes:
+
+@end
+
+@interface MediatorTestFakeRegistry : NSObject <ISIORegistry>
+{
+	NSMutableArray <NSNumber *> *childEntryIDs;
+	NSMutableDictionary <NSNumber *, NSDictionary *> *propertiesByEntryID;
+	NSUInteger enumerationCount;
+	NSUInteger createdChildCount;
+	NSUInteger propertyFetchCount;
+	BOOL failsEnumeration;
+}
+
+@property(retain,readonly) NSMutableArray <NSNumber *> *childEntryIDs;
+@property(retain,readonly) NSMutableDictionary <NSNumber *, NSDictionary *> *propertiesByEntryID; //!< Properties of entries, keyed by their ISIOObject.uniqueID
+@property(readonly) NSUInteger enumerationCount;
+@property(readonly) NSUInteger createdChildCount;
+@property(readonly) NSUInteger propertyFetchCount;
+@property(assign) BOOL failsEnumeration;
+
+@end
+
+@interface MediatorTestManualScheduler : ISResourceMediatorDeadlineScheduler
+{
+	NSTimeInterval now;
+}
+
+@property(assign) NSTimeInterval now;
+
+- (void)advanceBy:(NSTimeInterval)interval;
+
+@end
+
+@interface MediatorTestReconcilerDelegate : NSObject <ISIOChildReconcilerDelegate>
+{
+	NSMutableArray *appearedChildren;
+	NSMutableArray *disappearedChildren;
+}
+
+@property(retain,readonly) NSMutableArray *appearedChildren;
+@property(retain,readonly) NSMutableArray *disappearedChildren;
+
+@end
+
+@interface MediatorTestExitObserver : NSObject <ISResourceMediatorProcessWatcherObserver>
+{
+	NSMutableArray <NSNumber *> *exitedPIDs;
+	id <ISResourceMediatorProcessWatcherObserver> observerToRemove;
+}
+
+@property(retain,readonly) NSMutableArray <NSNumber *> *exitedPIDs;
+@property(assign) id <ISResourceMediatorProcessWatcherObserver> observerToRemove; //!< Removed from the watcher when notified, if set
+
+@end
+
+@interface MediatorTestCase : XCTestCase
+
+- (BOOL)waitForCondition:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout; //!< Runs the current run loop until condition returns YES or timeout elapsed. Returns the last result of condition.
+
+- (NSString *)statusTableDirectoryPath; //!< Temporary directory for status tables, created if needed.
+
+@end
@@ -0,0 +1,330 @@
+//
+//  MediatorTestSupport.m
+//  MediatorTests
+//
+//  Copyright © 2026 IOSPIRIT GmbH. All rights reserved.
+//
+/*
+Copyright (c) 2016 IOSPIRIT GmbH (https://www.iospirit.com/)
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this list
+  of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of IOSPIRIT GmbH nor the names of its contributors may be used to
+  endorse or promote products derived from this software without specific prior
+  written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+DAMAGE.
+*/
+
+#import "MediatorTestSupport.h"
+
+@implementation MediatorTestRecordingTransport
+
+@synthesize hub;
+@synthesize postedMessages;
+
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		postedMessages = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[postedMessages release];
+	postedMessages = nil;
+
+	[super dealloc];
+}
+
+- (void)subscribePID:(pid_t)pid toResourceIdentifier:(NSString *)resourceIdentifier
+{
+}
+
+- (void)unsubscribePID:(pid_t)pid fromResourceIdentifier:(NSString *)resourceIdentifier
+{
+}
+
+- (void)postMessage:(ISResourceMediatorMessageType)messageType resourceIdentifier:(NSString *)resourceIdentifier targetPID:(pid_t)targetPID object:(NSString *)encodedUserInfo
+{
+	ISResourceMediatorWireFormat messageFormat = kISResourceMediatorWireFormatAutomatic;
+	NSMutableDictionary *message = [NSMutableDictionary dictionaryWithDictionary:[ISResourceMediatorCodec userInfoWithString:encodedUserInfo format:&messageFormat error:NULL]];
+
+	[message setObject:@(messageType) forKey:@"messageType"];
+	[message setObject:@(messageFormat) forKey:@"messageFormat"];
+
+	@synchronized(postedMessages)
+	{
+		[postedMessages addObject:message];
+	}
+}
+
+@end
+
+@implementation MediatorTestDelegate
+
+@synthesize firstArbitrationTime;
+@synthesize firstAccessTime;
+@synthesize accessRequestResults;
+@synthesize updatedBroadcastInfoCount;
+@synthesize userChanges;
+
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		accessRequestResults = [NSMutableArray new];
+		userChanges = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[accessRequestResults release];
+	accessRequestResults = nil;
+
+	[userChanges release];
+	userChanges = nil;
+
+	[super dealloc];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator setApplicationAccessForResource:(ISResourceMediatorResourceAccess)access requestedBy:(ISResourceUser *)user completion:(void(^)(ISResourceMediatorResult result))completionHandler
+{
+	if (firstArbitrationTime == 0)
+	{
+		firstArbitrationTime = CFAbsoluteTimeGetCurrent();
+	}
+
+	completionHandler(kISResourceMediatorResultSuccess);
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator actualAccessChangedTo:(ISResourceMediatorResourceAccess)actualAccess
+{
+	if ((firstAccessTime == 0) && (actualAccess != kISResourceMediatorResourceAccessNone))
+	{
+		firstAccessTime = CFAbsoluteTimeGetCurrent();
+	}
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user respondedToAccessRequestWith:(ISResourceMediatorResult)accessRequestResponse
+{
+	[accessRequestResults addObject:@(accessRequestResponse)];
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator user:(ISResourceUser *)user updatedBroadcastInfo:(NSDictionary *)newBroadcastInfo
+{
+	updatedBroadcastInfoCount++;
+}
+
+- (void)resourceMediator:(ISResourceMediator *)mediator userUpdated:(ISResourceUser *)user changes:(ISResourceUserChanges)changes
+{
+	[userChanges addObject:@(changes)];
+}
+
+@end
+
+@implementation MediatorTestFakeRegistry
+
+@synthesize childEntryIDs;
+@synthesize propertiesByEntryID;
+@synthesize enumerationCount;
+@synthesize createdChildCount;
+@synthesize propertyFetchCount;
+@synthesize failsEnumeration;
+
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		childEntryIDs = [NSMutableArray new];
+		propertiesByEntryID = [NSMutableDictionary new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[childEntryIDs release];
+	childEntryIDs = nil;
+
+	[propertiesByEntryID release];
+	propertiesByEntryID = nil;
+
+	[super dealloc];
+}
+
+- (BOOL)enumerateChildrenOfEntry:(id)entry usingBlock:(void (^)(uint64_t, void *))block
+{
+	enumerationCount++;
+
+	if (failsEnumeration)
+	{
+		return (NO);
+	}
+
+	for (NSNumber *childEntryID in childEntryIDs)
+	{
+		block(childEntryID.unsignedLongLongValue, NULL);
+	}
+
+	return (YES);
+}
+
+- (id)newChildWithEntryID:(uint64_t)childEntryID ref:(void *)childRef
+{
+	createdChildCount++;
+
+	return ([[NSString alloc] initWithFormat:@"child-%llu", childEntryID]);
+}
+
+- (id)newPropertyForKey:(NSString *)key ofEntry:(id)entry
+{
+	propertyFetchCount++;
+
+	return ([[[propertiesByEntryID objectForKey:@(((ISIOObject *)entry).uniqueID)] objectForKey:key] retain]);
+}
+
+@end
+
+@implementation MediatorTestManualScheduler
+
+@synthesize now;
+
+- (NSTimeInterval)currentTime
+{
+	return (now);
+}
+
+- (void)advanceBy:(NSTimeInterval)interval
+{
+	now += interval;
+
+	[self fireDueDeadlines];
+}
+
+@end
+
+@implementation MediatorTestReconcilerDelegate
+
+@synthesize appearedChildren;
+@synthesize disappearedChildren;
+
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		appearedChildren = [NSMutableArray new];
+		disappearedChildren = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[appearedChildren release];
+	appearedChildren = nil;
+
+	[disappearedChildren release];
+	disappearedChildren = nil;
+
+	[super dealloc];
+}
+
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childAppeared:(id)child
+{
+	[appearedChildren addObject:child];
+}
+
+- (void)childReconciler:(ISIOChildReconciler *)reconciler childDisappeared:(id)child
+{
+	[disappearedChildren addObject:child];
+}
+
+@end
+
+@implementation MediatorTestExitObserver
+
+@synthesize exitedPIDs;
+@synthesize observerToRemove;
+
+- (instancetype)init
+{
+	if ((self = [super init]) != nil)
+	{
+		exitedPIDs = [NSMutableArray new];
+	}
+
+	return (self);
+}
+
+- (void)dealloc
+{
+	[exitedPIDs release];
+	exitedPIDs = nil;
+
+	[super dealloc];
+}
+
+- (void)processWatcher:(ISResourceMediatorProcessWatcher *)processWatcher processDidExit:(pid_t)pid
+{
+	[exitedPIDs addObject:@(pid)];
+
+	if (observerToRemove != nil)
+	{
+		[processWatcher removeObserver:observerToRemove];
+	}
+}
+
+@end
+
+@implementation MediatorTestCase
+
+- (BOOL)waitForCondition:(BOOL(^)(void))condition timeout:(NSTimeInterval)timeout
+{
+	NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:timeout];
+
+	while (!condition() && ([timeoutDate timeIntervalSinceNow] > 0))
+	{
+		[[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+	}
+
+	return (condition());
+}
+
+- (NSString *)statusTableDirectoryPath
+{
+	NSString *directoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"rm-test-%d", getpid()]];
+
+	[[NSFileManager defaultManager] createDirectoryAtPath:directoryPath withIntermediateDirectories:YES attributes:nil error:NULL];
+
+	return (directoryPath);
+}
+
+@end
@@ -629,6 +629,10 @@ DAMAGE.
 		case kISResourceMediatorResultDeny:
 			accessRequestResponseString = @"denied";
 		break;
+
+		case kISResourceMediatorResultTimeout:
+			accessRequestResponseString = @"timeout";
+		break;
 	}
 	
 	NSLog(@"Access Request: %x -> %x => %@", mediator.pid, user.pid, accessRequestResponseString);